@@ -40,7 +40,14 @@
  * - LV_STDLIB_RTTHREAD:    RT-Thread implementation
  * - LV_STDLIB_CUSTOM:      Implement the functions externally
  */
-#define LV_USE_STDLIB_MALLOC    LV_STDLIB_CLIB
+/* LVGL allocations come from a dedicated pool (internal RAM first, PSRAM spill),
+ * implemented in lib/lvgl_heap so they never share the general heap.
+ * The host build (env:native) uses the built-in pool with the same total size. */
+#ifdef ESP_PLATFORM
+#define LV_USE_STDLIB_MALLOC    LV_STDLIB_CUSTOM
+#else
+#define LV_USE_STDLIB_MALLOC    LV_STDLIB_BUILTIN
+#endif
 #define LV_USE_STDLIB_STRING    LV_STDLIB_CLIB
 #define LV_USE_STDLIB_SPRINTF   LV_STDLIB_CLIB
 
@@ -53,7 +60,7 @@
 
 #if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
     /*Size of the memory available for `lv_malloc()` in bytes (>= 2kB)*/
-    #define LV_MEM_SIZE (64 * 1024U)          /*[bytes]*/
+    #define LV_MEM_SIZE (352 * 1024U)          /*[bytes]*/
 
     /*Size of the memory expand for `lv_malloc()` in bytes*/
     #define LV_MEM_POOL_EXPAND_SIZE 0
@@ -89,7 +96,11 @@
  * - LV_OS_WINDOWS
  * - LV_OS_MQX
  * - LV_OS_CUSTOM */
+#ifdef ESP_PLATFORM
 #define LV_USE_OS   LV_OS_FREERTOS
+#else
+#define LV_USE_OS   LV_OS_PTHREAD   /* Host build (env:native) */
+#endif
 
 #if LV_USE_OS == LV_OS_CUSTOM
     #define LV_OS_CUSTOM_INCLUDE <stdint.h>
@@ -129,9 +140,14 @@
 
 /* The stack size of the drawing thread.
  * NOTE: If FreeType or ThorVG is enabled, it is recommended to set it to 32KB or more.
+ * One stack is allocated per SW draw unit, so the total is LV_DRAW_SW_DRAW_UNIT_CNT times this.
  */
 #define LV_DRAW_THREAD_STACK_SIZE    (8 * 1024)   /*[bytes]*/
 
+/* Priority of the drawing threads. Kept below the sensor task (SENSOR_TASK_PRIORITY in main.cpp)
+ * so a full-screen redraw can never delay a temperature sample. */
+#define LV_DRAW_THREAD_PRIO LV_THREAD_PRIO_MID
+
 #define LV_USE_DRAW_SW 1
 #if LV_USE_DRAW_SW == 1
 
@@ -154,8 +170,13 @@
 
 	/* Set the number of draw unit.
      * > 1 requires an operating system enabled in `LV_USE_OS`
-     * > 1 means multiple threads will render the screen in parallel */
-    #define LV_DRAW_SW_DRAW_UNIT_CNT    1
+     * > 1 means multiple threads will render the screen in parallel
+     * The draw threads are not pinned, so with 2 units FreeRTOS spreads them over both ESP32-S3 cores.
+     * Override with -DNCIR_DRAW_UNIT_CNT=1 to benchmark the single-threaded renderer. */
+    #ifndef NCIR_DRAW_UNIT_CNT
+        #define NCIR_DRAW_UNIT_CNT      2
+    #endif
+    #define LV_DRAW_SW_DRAW_UNIT_CNT    NCIR_DRAW_UNIT_CNT
 
     /* Use Arm-2D to accelerate the sw render */
     #define LV_USE_DRAW_ARM2D_SYNC      0
@@ -479,16 +500,22 @@
  *===================*/
 
 /*Montserrat fonts with ASCII range and some symbols using bpp = 4
- *https://fonts.google.com/specimen/Montserrat*/
+ *https://fonts.google.com/specimen/Montserrat
+ *Not needed when tools/gen_fonts.py provides glyph subsets (NCIR_USE_SUBSET_FONTS, see include/ui_fonts.h)*/
+#ifdef NCIR_USE_SUBSET_FONTS
+    #define NCIR_BUILTIN_FONTS 0
+#else
+    #define NCIR_BUILTIN_FONTS 1
+#endif
 #define LV_FONT_MONTSERRAT_8  0
 #define LV_FONT_MONTSERRAT_10 0
-#define LV_FONT_MONTSERRAT_12 1
-#define LV_FONT_MONTSERRAT_14 1
-#define LV_FONT_MONTSERRAT_16 1
-#define LV_FONT_MONTSERRAT_18 1
-#define LV_FONT_MONTSERRAT_20 1
+#define LV_FONT_MONTSERRAT_12 NCIR_BUILTIN_FONTS
+#define LV_FONT_MONTSERRAT_14 NCIR_BUILTIN_FONTS
+#define LV_FONT_MONTSERRAT_16 NCIR_BUILTIN_FONTS
+#define LV_FONT_MONTSERRAT_18 NCIR_BUILTIN_FONTS
+#define LV_FONT_MONTSERRAT_20 NCIR_BUILTIN_FONTS
 #define LV_FONT_MONTSERRAT_22 0
-#define LV_FONT_MONTSERRAT_24 1
+#define LV_FONT_MONTSERRAT_24 NCIR_BUILTIN_FONTS
 #define LV_FONT_MONTSERRAT_26 0
 #define LV_FONT_MONTSERRAT_28 0
 #define LV_FONT_MONTSERRAT_30 0
@@ -515,10 +542,18 @@
 /*Optionally declare custom fonts here.
  *You can use these fonts as default font too and they will be available globally.
  *E.g. #define LV_FONT_CUSTOM_DECLARE   LV_FONT_DECLARE(my_font_1) LV_FONT_DECLARE(my_font_2)*/
-#define LV_FONT_CUSTOM_DECLARE
+#ifdef NCIR_USE_SUBSET_FONTS
+    #define LV_FONT_CUSTOM_DECLARE  LV_FONT_DECLARE(ncir_font_14)
+#else
+    #define LV_FONT_CUSTOM_DECLARE
+#endif
 
 /*Always set a default font*/
-#define LV_FONT_DEFAULT &lv_font_montserrat_14
+#ifdef NCIR_USE_SUBSET_FONTS
+    #define LV_FONT_DEFAULT &ncir_font_14
+#else
+    #define LV_FONT_DEFAULT &lv_font_montserrat_14
+#endif
 
 /*Enable handling large font and/or fonts with a lot of characters.
  *The limit depends on the font size, font face and bpp.
@@ -526,7 +561,11 @@
 #define LV_FONT_FMT_TXT_LARGE 0
 
 /*Enables/disables support for compressed fonts.*/
-#define LV_USE_FONT_COMPRESSED 0
+#ifdef NCIR_FONT_COMPRESSED
+    #define LV_USE_FONT_COMPRESSED 1
+#else
+    #define LV_USE_FONT_COMPRESSED 0
+#endif
 
 /*Enable drawing placeholders when glyph dsc is not found*/
 #define LV_USE_FONT_PLACEHOLDER 1
@@ -0,0 +1,37 @@
+#ifndef __UI_FONTS_H__
+#define __UI_FONTS_H__
+
+#include "lvgl.h"
+
+// UI font selection. With NCIR_USE_SUBSET_FONTS (set by tools/gen_fonts.py) the UI uses
+// Montserrat subsets generated from the on-screen string literals in src/ and lib/,
+// otherwise LVGL's full built-ins. The subsets come from Montserrat-Medium.ttf alone, so
+// UI strings must stick to its glyphs: no LV_SYMBOL_* icons, box-drawing or arrows.
+
+#ifdef NCIR_USE_SUBSET_FONTS
+LV_FONT_DECLARE(ncir_font_12)
+LV_FONT_DECLARE(ncir_font_14)
+LV_FONT_DECLARE(ncir_font_16)
+LV_FONT_DECLARE(ncir_font_18)
+LV_FONT_DECLARE(ncir_font_20)
+LV_FONT_DECLARE(ncir_font_24)
+LV_FONT_DECLARE(ncir_font_digits_40)
+
+#define UI_FONT_12 (&ncir_font_12)
+#define UI_FONT_14 (&ncir_font_14)
+#define UI_FONT_16 (&ncir_font_16)
+#define UI_FONT_18 (&ncir_font_18)
+#define UI_FONT_20 (&ncir_font_20)
+#define UI_FONT_24 (&ncir_font_24)
+#define UI_FONT_DIGITS (&ncir_font_digits_40)  // 0-9 - + . C F only
+#else
+#define UI_FONT_12 (&lv_font_montserrat_12)
+#define UI_FONT_14 (&lv_font_montserrat_14)
+#define UI_FONT_16 (&lv_font_montserrat_16)
+#define UI_FONT_18 (&lv_font_montserrat_18)
+#define UI_FONT_20 (&lv_font_montserrat_20)
+#define UI_FONT_24 (&lv_font_montserrat_24)
+#define UI_FONT_DIGITS (&lv_font_montserrat_24)
+#endif
+
+#endif  // __UI_FONTS_H__
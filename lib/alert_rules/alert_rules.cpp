@@ -0,0 +1,87 @@
+
+#include "alert_rules.hpp"
+#include <string.h>
+
+bool alert_engine_set_table(AlertEngine *engine, const AlertRuleTable *table) {
+    if (table->version != ALERT_TABLE_VERSION || table->count > ALERT_MAX_RULES) return false;
+
+    memset(engine, 0, sizeof(*engine));
+    engine->table = *table;
+    return true;
+}
+
+// First-order low-pass on the sample-to-sample derivative
+static void update_rate(AlertEngine *engine, uint32_t timestamp_ms, float raw_c) {
+    if (engine->has_last) {
+        uint32_t dt_ms = timestamp_ms - engine->last_ms;
+        if (dt_ms == 0) return;
+        float raw_rate = (raw_c - engine->last_value_c) * 1000.0f / dt_ms;
+        float alpha = (float)dt_ms / (ALERT_RATE_TAU_MS + dt_ms);
+        engine->rate_c_per_s += alpha * (raw_rate - engine->rate_c_per_s);
+    }
+    engine->last_value_c = raw_c;
+    engine->last_ms = timestamp_ms;
+    engine->has_last = true;
+}
+
+uint32_t alert_engine_update(AlertEngine *engine, uint32_t timestamp_ms, float raw_c, float level_c) {
+    if (raw_c != raw_c) return 0;  // NaN from a failed sensor read
+    update_rate(engine, timestamp_ms, raw_c);
+
+    float level = level_c * 10.0f;
+    float rate = engine->rate_c_per_s * 10.0f;
+    uint32_t fired = 0;
+
+    for (int i = 0; i < engine->table.count; i++) {
+        const AlertRule &rule = engine->table.rules[i];
+        AlertRuleState &state = engine->state[i];
+
+        // Map every kind onto "x >= threshold" so one comparison pair serves all rules
+        float x;
+        float threshold = rule.threshold;
+        switch (rule.kind) {
+            case ALERT_RULE_ABOVE: x = level; break;
+            case ALERT_RULE_BELOW: x = -level; threshold = -threshold; break;
+            case ALERT_RULE_RISE_RATE: x = rate; break;
+            case ALERT_RULE_FALL_RATE: x = -rate; break;
+            default: continue;
+        }
+
+        if (state.active) {
+            if (x < threshold - rule.hysteresis) {
+                state.active = false;
+                engine->active_mask &= ~(1UL << i);
+            }
+            continue;
+        }
+
+        if (x < threshold) {
+            state.pending = false;
+            continue;
+        }
+        if (!state.pending) {
+            state.pending = true;
+            state.pending_since_ms = timestamp_ms;
+        }
+        if (timestamp_ms - state.pending_since_ms < rule.sustain_ds * 100UL) continue;
+        if (state.fired_once && timestamp_ms - state.last_fired_ms < rule.cooldown_s * 1000UL) continue;
+
+        state.active = true;
+        state.pending = false;
+        state.fired_once = true;
+        state.last_fired_ms = timestamp_ms;
+        engine->active_mask |= 1UL << i;
+        fired |= 1UL << i;
+    }
+    return fired;
+}
+
+const char *alert_rule_kind_name(uint8_t kind) {
+    switch (kind) {
+        case ALERT_RULE_ABOVE: return "High temperature";
+        case ALERT_RULE_BELOW: return "Low temperature";
+        case ALERT_RULE_RISE_RATE: return "Rapid rise";
+        case ALERT_RULE_FALL_RATE: return "Rapid fall";
+        default: return "Unused";
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef __ALERT_RULES_H__
+#define __ALERT_RULES_H__
+
+#include <stdint.h>
+
+// Table-driven temperature alert engine.
+// Each rule compares either the temperature or its rate of change against a threshold,
+// must hold for a sustain time before it fires, clears through its own hysteresis band
+// and cannot fire again within its cooldown. Rules are evaluated once per sample in
+// fixed time (at most ALERT_MAX_RULES comparisons). The rule table is a plain struct so
+// it can be stored in NVS as a single blob.
+
+#define ALERT_MAX_RULES 8
+#define ALERT_TABLE_VERSION 3
+
+// Time constant of the rate-of-change (derivative) filter
+#ifndef ALERT_RATE_TAU_MS
+#define ALERT_RATE_TAU_MS 2000
+#endif
+
+enum AlertRuleKind {
+  ALERT_RULE_NONE = 0,   // Unused slot
+  ALERT_RULE_ABOVE,      // Temperature >= threshold
+  ALERT_RULE_BELOW,      // Temperature <= threshold
+  ALERT_RULE_RISE_RATE,  // Rising at >= threshold per second
+  ALERT_RULE_FALL_RATE   // Falling at >= threshold per second
+};
+
+// Actions carried out by the caller when a rule fires
+#define ALERT_ACTION_SOUND 0x01
+#define ALERT_ACTION_LED 0x02   // LED pattern shown while the rule is active
+#define ALERT_ACTION_LOG 0x04
+#define ALERT_ACTION_READOUT 0x08  // Follow the sound with a readout of the temperature
+
+struct AlertRule {
+  uint8_t kind;          // AlertRuleKind
+  uint8_t actions;       // ALERT_ACTION_* bits
+  uint8_t sound;         // Caller's sound cue index for ALERT_ACTION_SOUND
+  uint8_t led_pattern;   // Caller's LED pattern index for ALERT_ACTION_LED
+  uint8_t led_priority;  // Higher wins when several LED rules are active
+  uint8_t reserved;
+  int16_t threshold;     // Tenths of a degree C (tenths of a degree C per second for rates)
+  uint16_t hysteresis;   // Same unit as threshold
+  uint16_t sustain_ds;   // Condition must hold this long before firing (tenths of a second)
+  uint16_t cooldown_s;   // Minimum time between two firings
+};
+
+// NVS blob layout
+struct AlertRuleTable {
+  uint8_t version;       // ALERT_TABLE_VERSION
+  uint8_t count;
+  AlertRule rules[ALERT_MAX_RULES];
+};
+
+struct AlertRuleState {
+  bool active;               // Fired and not yet cleared
+  bool pending;              // Condition true, waiting for the sustain time
+  bool fired_once;
+  uint32_t pending_since_ms;
+  uint32_t last_fired_ms;
+};
+
+struct AlertEngine {
+  AlertRuleTable table;
+  AlertRuleState state[ALERT_MAX_RULES];
+  uint32_t active_mask;      // Bit per rule currently active
+  float rate_c_per_s;        // Filtered rate of change
+  float last_value_c;
+  uint32_t last_ms;
+  bool has_last;
+};
+
+// Install a rule table and reset all rule state (invalid tables are rejected)
+bool alert_engine_set_table(AlertEngine *engine, const AlertRuleTable *table);
+
+// Feed one sample. raw_c drives the rate filter, level_c is compared by the threshold
+// rules (the firmware passes the raw reading to both). Returns a bit per rule that fired on this sample.
+uint32_t alert_engine_update(AlertEngine *engine, uint32_t timestamp_ms, float raw_c, float level_c);
+
+const char *alert_rule_kind_name(uint8_t kind);
+
+#endif  // __ALERT_RULES_H__
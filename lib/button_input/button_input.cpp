@@ -0,0 +1,51 @@
+
+#include "button_input.hpp"
+#include <string.h>
+
+void button_input_init(ButtonInput *input, uint8_t count) {
+  memset(input, 0, sizeof(*input));
+  input->count = count < BUTTON_INPUT_MAX ? count : BUTTON_INPUT_MAX;
+}
+
+static int emit(ButtonEvent *events, int n, int max, uint8_t button, uint8_t type, bool long_press) {
+  if (n >= max) return n;
+  events[n].button = button;
+  events[n].type = type;
+  events[n].long_press = long_press;
+  return n + 1;
+}
+
+int button_input_update(ButtonInput *input, uint32_t now_ms, const bool *pressed, ButtonEvent *events, int max) {
+  int n = 0;
+  for (uint8_t i = 0; i < input->count; i++) {
+    ButtonTracker &button = input->buttons[i];
+
+    if (pressed[i] != button.pressed && now_ms - button.changed_ms >= BUTTON_DEBOUNCE_MS) {
+      button.pressed = pressed[i];
+      button.changed_ms = now_ms;
+      if (button.pressed) {
+        button.long_sent = false;
+        button.next_ms = now_ms + BUTTON_LONG_MS;
+        n = emit(events, n, max, i, BUTTON_EVENT_DOWN, false);
+      } else {
+        n = emit(events, n, max, i, BUTTON_EVENT_UP, button.long_sent);
+      }
+      continue;
+    }
+
+    // Signed difference so the due time works across millis() wrap-around
+    if (button.pressed && (int32_t)(now_ms - button.next_ms) >= 0) {
+      n = emit(events, n, max, i, button.long_sent ? BUTTON_EVENT_REPEAT : BUTTON_EVENT_LONG, false);
+      button.long_sent = true;
+      button.next_ms = now_ms + BUTTON_REPEAT_MS;
+    }
+  }
+  return n;
+}
+
+bool button_input_any_pressed(const ButtonInput *input) {
+  for (uint8_t i = 0; i < input->count; i++) {
+    if (input->buttons[i].pressed) return true;
+  }
+  return false;
+}
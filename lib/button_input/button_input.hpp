@@ -0,0 +1,58 @@
+#ifndef __BUTTON_INPUT_H__
+#define __BUTTON_INPUT_H__
+
+#include <stdint.h>
+
+// Button press classification.
+// The caller feeds the pressed state of every button once per poll. A change is taken
+// at once unless the button changed less than BUTTON_DEBOUNCE_MS ago (contact bounce),
+// so a press is reported on the poll that sees it. Each press produces:
+//
+//   DOWN                   on the press
+//   LONG                   once, after it has been held BUTTON_LONG_MS
+//   REPEAT                 every BUTTON_REPEAT_MS after LONG while still held
+//   UP                     on release (long_press tells whether LONG was sent)
+//
+// Mapping events to actions is left to the caller (see the input table in main.cpp).
+// The library has no platform dependencies.
+
+#define BUTTON_INPUT_MAX 4
+#define BUTTON_DEBOUNCE_MS 30
+#define BUTTON_LONG_MS 600
+#define BUTTON_REPEAT_MS 150
+
+enum ButtonEventType {
+  BUTTON_EVENT_DOWN,
+  BUTTON_EVENT_LONG,
+  BUTTON_EVENT_REPEAT,
+  BUTTON_EVENT_UP
+};
+
+struct ButtonEvent {
+  uint8_t button;
+  uint8_t type;          // ButtonEventType
+  bool long_press;       // UP only: LONG was sent for this press
+};
+
+struct ButtonTracker {
+  bool pressed;
+  bool long_sent;
+  uint32_t changed_ms;   // Last accepted change
+  uint32_t next_ms;      // When LONG or the next REPEAT is due
+};
+
+struct ButtonInput {
+  uint8_t count;
+  ButtonTracker buttons[BUTTON_INPUT_MAX];
+};
+
+void button_input_init(ButtonInput *input, uint8_t count);
+
+// Track one poll of the buttons (pressed[i] for button i), returns the number of events
+// written to events (at most max, one per button)
+int button_input_update(ButtonInput *input, uint32_t now_ms, const bool *pressed, ButtonEvent *events, int max);
+
+// True while any button is held
+bool button_input_any_pressed(const ButtonInput *input);
+
+#endif  // __BUTTON_INPUT_H__
@@ -0,0 +1,325 @@
+
+#include "debug_log.hpp"
+#include <atomic>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+// Bounded multi-producer ring (Vyukov): a slot is free for enqueue position pos when its
+// sequence equals pos and holds a record for the reader when it equals pos + 1. Producers
+// claim positions with a CAS and never wait on each other or on the reader.
+struct DebugLogSlot {
+  std::atomic<uint32_t> sequence;
+  DebugLogRecord record;
+};
+
+static DebugLogSlot slots[DEBUG_LOG_SLOTS];
+static std::atomic<uint32_t> enqueue_pos(0);
+static uint32_t dequeue_pos = 0;
+static volatile bool started = false;
+static std::atomic<uint32_t> printed(0);   // Records taken off the ring and printed
+static Print *output = NULL;
+static TaskHandle_t reader_task = NULL;
+static std::atomic<bool> reader_waiting(false);   // Reader found the ring empty and is blocking
+
+static std::atomic<uint32_t> written_count(0);
+static std::atomic<uint32_t> dropped_count(0);
+static std::atomic<uint32_t> suppressed_count(0);
+static std::atomic<uint32_t> truncated_count(0);
+
+static const char level_chars[] = {'-', 'E', 'W', 'I', 'D'};
+
+// Only the producer that sees the reader's flag set pays for a notify
+static void wake_reader() {
+  if (reader_waiting.exchange(false)) xTaskNotifyGive(reader_task);
+}
+
+bool debug_log_begin(DebugLogSite *site, uint8_t level, const char *format, DebugLogRecord *record) {
+  if (!started) return false;
+
+  // Per-site limiter; a race between tasks on one site only blurs the count
+  uint32_t now = millis();
+  if (now - site->window_start_ms >= DEBUG_LOG_RATE_WINDOW_MS) {
+    site->window_start_ms = now;
+    site->count = 0;
+  }
+  if (site->count >= DEBUG_LOG_RATE_BURST) {
+    if (site->suppressed < UINT16_MAX) site->suppressed++;
+    suppressed_count.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  site->count++;
+
+  record->format = format;
+  record->timestamp_ms = now;
+  record->level = level;
+  record->truncated = 0;
+  record->suppressed = site->suppressed;
+  record->length = 0;
+  site->suppressed = 0;
+  return true;
+}
+
+void debug_log_put_raw(DebugLogRecord *record, uint8_t type, const void *value, size_t size) {
+  if (record->truncated || record->length + 1 + size > sizeof(record->args)) {
+    record->truncated = 1;
+    return;
+  }
+  record->args[record->length++] = type;
+  memcpy(record->args + record->length, value, size);
+  record->length += size;
+}
+
+void debug_log_put(DebugLogRecord *record, const char *value) {
+  if (!value) value = "(null)";
+  size_t length = strnlen(value, DEBUG_LOG_STRING_MAX);
+  if (record->truncated || record->length + 2 + length > sizeof(record->args)) {
+    record->truncated = 1;
+    return;
+  }
+  record->args[record->length++] = DLOG_ARG_STR;
+  record->args[record->length++] = (uint8_t)length;
+  memcpy(record->args + record->length, value, length);
+  record->length += length;
+}
+
+void debug_log_commit(DebugLogRecord *record) {
+  if (record->truncated) truncated_count.fetch_add(1, std::memory_order_relaxed);
+
+  uint32_t pos = enqueue_pos.load(std::memory_order_relaxed);
+  DebugLogSlot *slot;
+  for (;;) {
+    slot = &slots[pos & (DEBUG_LOG_SLOTS - 1)];
+    int32_t diff = (int32_t)(slot->sequence.load(std::memory_order_acquire) - pos);
+    if (diff == 0) {
+      if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (diff < 0) {
+      dropped_count.fetch_add(1, std::memory_order_relaxed);  // Reader is a full ring behind
+      wake_reader();
+      return;
+    } else {
+      pos = enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  memcpy(&slot->record, record, offsetof(DebugLogRecord, args) + record->length);
+  slot->sequence.store(pos + 1, std::memory_order_seq_cst);
+  written_count.fetch_add(1, std::memory_order_relaxed);
+  wake_reader();
+}
+
+// Next captured argument, false when the record has no more
+struct ArgCursor {
+  const DebugLogRecord *record;
+  size_t at;
+};
+
+static bool next_arg(ArgCursor *cursor, uint8_t *type, const uint8_t **value, size_t *size) {
+  const DebugLogRecord *record = cursor->record;
+  if (cursor->at >= record->length) return false;
+  *type = record->args[cursor->at++];
+  switch (*type) {
+    case DLOG_ARG_I32:
+    case DLOG_ARG_U32: *size = 4; break;
+    case DLOG_ARG_I64:
+    case DLOG_ARG_U64:
+    case DLOG_ARG_F64: *size = 8; break;
+    case DLOG_ARG_PTR: *size = sizeof(void *); break;
+    case DLOG_ARG_STR: *size = record->args[cursor->at++]; break;
+    default: return false;
+  }
+  *value = record->args + cursor->at;
+  cursor->at += *size;
+  return cursor->at <= record->length;
+}
+
+static long long arg_signed(uint8_t type, const uint8_t *value) {
+  int32_t i32;
+  int64_t i64;
+  double f64;
+  switch (type) {
+    case DLOG_ARG_I32: memcpy(&i32, value, 4); return i32;
+    case DLOG_ARG_U32: { uint32_t u32; memcpy(&u32, value, 4); return u32; }
+    case DLOG_ARG_F64: memcpy(&f64, value, 8); return (long long)f64;
+    default: memcpy(&i64, value, 8); return i64;
+  }
+}
+
+static double arg_double(uint8_t type, const uint8_t *value) {
+  if (type != DLOG_ARG_F64) return (double)arg_signed(type, value);
+  double f64;
+  memcpy(&f64, value, 8);
+  return f64;
+}
+
+// Format one conversion with its captured argument. Length modifiers in the format are
+// ignored: the captured type decides, and integers are printed through "ll".
+static int format_arg(char *out, size_t max, const char *flags, size_t flags_length, char conversion,
+                      uint8_t type, const uint8_t *value, size_t size) {
+  char spec[24];
+  memcpy(spec, flags, flags_length);
+  size_t n = flags_length;
+
+  switch (conversion) {
+    case 'd': case 'i': case 'u': case 'x': case 'X': case 'o':
+      if (type == DLOG_ARG_STR || type == DLOG_ARG_PTR) break;
+      spec[n++] = 'l';
+      spec[n++] = 'l';
+      spec[n++] = conversion;
+      spec[n] = 0;
+      if (conversion == 'd' || conversion == 'i') return snprintf(out, max, spec, arg_signed(type, value));
+      if (type == DLOG_ARG_I32 || type == DLOG_ARG_U32) {
+        uint32_t u32;
+        memcpy(&u32, value, 4);
+        return snprintf(out, max, spec, (unsigned long long)u32);
+      }
+      return snprintf(out, max, spec, (unsigned long long)arg_signed(type, value));
+    case 'c':
+      if (type == DLOG_ARG_STR || type == DLOG_ARG_PTR) break;
+      spec[n++] = 'c';
+      spec[n] = 0;
+      return snprintf(out, max, spec, (int)arg_signed(type, value));
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+      if (type == DLOG_ARG_STR || type == DLOG_ARG_PTR) break;
+      spec[n++] = conversion;
+      spec[n] = 0;
+      return snprintf(out, max, spec, arg_double(type, value));
+    case 's': {
+      if (type != DLOG_ARG_STR) break;
+      char text[DEBUG_LOG_STRING_MAX + 1];
+      memcpy(text, value, size);
+      text[size] = 0;
+      spec[n++] = 's';
+      spec[n] = 0;
+      return snprintf(out, max, spec, text);
+    }
+    case 'p': {
+      if (type != DLOG_ARG_PTR) break;
+      const void *p;
+      memcpy(&p, value, sizeof(p));
+      return snprintf(out, max, "%p", p);
+    }
+  }
+  return snprintf(out, max, "?");
+}
+
+size_t debug_log_format(const DebugLogRecord *record, char *out, size_t max) {
+  uint8_t level = record->level < sizeof(level_chars) ? record->level : 0;
+  int prefix = snprintf(out, max, "%lu.%03lu %c ", (unsigned long)(record->timestamp_ms / 1000),
+                        (unsigned long)(record->timestamp_ms % 1000), level_chars[level]);
+  size_t n = prefix > 0 ? (size_t)prefix : 0;
+  ArgCursor cursor = {record, 0};
+
+  for (const char *p = record->format; *p && n + 1 < max;) {
+    if (*p != '%') {
+      out[n++] = *p++;
+      continue;
+    }
+    if (p[1] == '%') {
+      out[n++] = '%';
+      p += 2;
+      continue;
+    }
+
+    // %[flags][width][.precision][length]conversion
+    const char *flags = p++;
+    while (*p && strchr("-+ #0", *p)) p++;
+    while (*p && (isdigit((unsigned char)*p) || *p == '.')) p++;
+    size_t flags_length = p - flags;
+    while (*p && strchr("hlLqjzt", *p)) p++;
+    if (!*p || flags_length > 12) break;
+    char conversion = *p++;
+
+    uint8_t type;
+    const uint8_t *value;
+    size_t size;
+    int written = next_arg(&cursor, &type, &value, &size)
+                  ? format_arg(out + n, max - n, flags, flags_length, conversion, type, value, size)
+                  : snprintf(out + n, max - n, "?");
+    if (written > 0) n += (size_t)written;
+    if (n >= max) n = max - 1;
+  }
+
+  if (record->truncated && n + 1 < max) {
+    int written = snprintf(out + n, max - n, " [args cut]");
+    if (written > 0) n += (size_t)written;
+  }
+  if (record->suppressed && n + 1 < max) {
+    int written = snprintf(out + n, max - n, " [+%u suppressed]", record->suppressed);
+    if (written > 0) n += (size_t)written;
+  }
+  if (n >= max) n = max - 1;
+  out[n] = 0;
+  return n;
+}
+
+static void write_line(const char *line, size_t length) {
+  output->write((const uint8_t *)line, length);
+}
+
+static void debug_log_task(void *arg) {
+  (void)arg;
+  DebugLogRecord record;
+  char line[DEBUG_LOG_LINE_MAX + 1];
+  uint32_t reported_drops = 0;
+
+  for (;;) {
+    DebugLogSlot *slot = &slots[dequeue_pos & (DEBUG_LOG_SLOTS - 1)];
+    if (slot->sequence.load(std::memory_order_acquire) != dequeue_pos + 1) {
+      uint32_t drops = dropped_count.load(std::memory_order_relaxed);
+      if (drops != reported_drops) {
+        uint32_t now = millis();
+        size_t n = snprintf(line, sizeof(line), "%lu.%03lu W debug log: %u records dropped (ring full)\n",
+                            (unsigned long)(now / 1000), (unsigned long)(now % 1000), (unsigned)(drops - reported_drops));
+        write_line(line, n < sizeof(line) ? n : sizeof(line) - 1);
+        reported_drops = drops;
+      }
+
+      // Raise the flag, then look again: a producer either sees the flag and notifies,
+      // or committed before it was raised and its record shows up here (both seq_cst)
+      reader_waiting.store(true);
+      if (slot->sequence.load() != dequeue_pos + 1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      }
+      reader_waiting.store(false);
+      continue;
+    }
+
+    memcpy(&record, &slot->record, sizeof(record));
+    slot->sequence.store(dequeue_pos + DEBUG_LOG_SLOTS, std::memory_order_release);
+    dequeue_pos++;
+
+    size_t n = debug_log_format(&record, line, DEBUG_LOG_LINE_MAX);
+    line[n++] = '\n';
+    write_line(line, n);
+    printed.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+bool debug_log_start(Print *port, UBaseType_t priority, BaseType_t core) {
+  output = port;
+  for (uint32_t i = 0; i < DEBUG_LOG_SLOTS; i++) {
+    slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  if (xTaskCreatePinnedToCore(debug_log_task, "debug_log", DEBUG_LOG_STACK_SIZE, NULL,
+                              priority, &reader_task, core) != pdPASS) {
+    return false;
+  }
+  started = true;
+  return true;
+}
+
+void debug_log_flush(uint32_t timeout_ms) {
+  uint32_t start = millis();
+  while (started && printed.load(std::memory_order_relaxed) != written_count.load(std::memory_order_relaxed) &&
+         millis() - start < timeout_ms) {
+    vTaskDelay(pdMS_TO_TICKS(DEBUG_LOG_FLUSH_POLL_MS));
+  }
+}
+
+void debug_log_get_stats(DebugLogStats *stats) {
+  stats->written = written_count.load(std::memory_order_relaxed);
+  stats->dropped = dropped_count.load(std::memory_order_relaxed);
+  stats->suppressed = suppressed_count.load(std::memory_order_relaxed);
+  stats->truncated = truncated_count.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,160 @@
+#ifndef __DEBUG_LOG_H__
+#define __DEBUG_LOG_H__
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Deferred debug logging.
+// DLOG_E/W/I/D(format, ...) capture the format pointer (it must be a string literal)
+// and the raw argument values into a fixed-size record in a lock-free multi-producer
+// ring; formatting and printing happen later on an idle-priority task, which blocks on a
+// task notification while the ring is empty (no periodic wakeups). A log call never
+// waits for the port: when the ring is full the record is dropped and counted. Each
+// call site is also limited to DEBUG_LOG_RATE_BURST records per DEBUG_LOG_RATE_WINDOW_MS,
+// and the number it suppressed is shown on its next line.
+//
+// Lines get a timestamp and level prefix and a newline, so formats carry neither.
+// Levels above NCIR_LOG_LEVEL compile to nothing, arguments included.
+
+#define DLOG_LEVEL_NONE 0
+#define DLOG_LEVEL_ERROR 1
+#define DLOG_LEVEL_WARN 2
+#define DLOG_LEVEL_INFO 3
+#define DLOG_LEVEL_DEBUG 4
+
+#ifndef NCIR_LOG_LEVEL
+#define NCIR_LOG_LEVEL DLOG_LEVEL_INFO
+#endif
+
+#define DEBUG_LOG_SLOTS 64             // Ring records, power of two
+#define DEBUG_LOG_ARGS_SIZE 80         // Captured argument bytes per record
+#define DEBUG_LOG_STRING_MAX 32        // %s arguments are copied and cut to this length
+#define DEBUG_LOG_LINE_MAX 192
+#define DEBUG_LOG_RATE_BURST 10
+#define DEBUG_LOG_RATE_WINDOW_MS 1000
+#define DEBUG_LOG_FLUSH_POLL_MS 10     // debug_log_flush progress check
+#define DEBUG_LOG_STACK_SIZE 3072
+
+// Tags of the captured arguments
+enum DebugLogArgType {
+  DLOG_ARG_I32,
+  DLOG_ARG_U32,
+  DLOG_ARG_I64,
+  DLOG_ARG_U64,
+  DLOG_ARG_F64,
+  DLOG_ARG_STR,   // Length byte + characters
+  DLOG_ARG_PTR
+};
+
+struct DebugLogRecord {
+  const char *format;
+  uint32_t timestamp_ms;
+  uint8_t level;
+  uint8_t truncated;     // Arguments that did not fit were left out
+  uint16_t suppressed;   // Records this call site dropped by rate limit since its last one
+  uint16_t length;       // Bytes used in args
+  uint8_t args[DEBUG_LOG_ARGS_SIZE];
+};
+
+// Rate limiter state, one per DLOG_x statement
+struct DebugLogSite {
+  uint32_t window_start_ms;
+  uint16_t count;
+  uint16_t suppressed;
+};
+
+struct DebugLogStats {
+  uint32_t written;      // Records queued
+  uint32_t dropped;      // Ring full
+  uint32_t suppressed;   // Rate limited
+  uint32_t truncated;    // Queued without some of their arguments
+};
+
+bool debug_log_start(Print *port, UBaseType_t priority, BaseType_t core);
+
+// Wait up to timeout_ms for every queued record to be printed (before a halt or reset)
+void debug_log_flush(uint32_t timeout_ms);
+
+void debug_log_get_stats(DebugLogStats *stats);
+
+// Format a record into out, returns the line length (no newline)
+size_t debug_log_format(const DebugLogRecord *record, char *out, size_t max);
+
+// Capture internals used by the macros below
+bool debug_log_begin(DebugLogSite *site, uint8_t level, const char *format, DebugLogRecord *record);
+void debug_log_commit(DebugLogRecord *record);
+void debug_log_put_raw(DebugLogRecord *record, uint8_t type, const void *value, size_t size);
+void debug_log_put(DebugLogRecord *record, const char *value);
+
+template <typename T>
+inline void debug_log_put_int(DebugLogRecord *record, T value, bool is_signed) {
+  if (sizeof(T) <= 4) {
+    uint32_t v = (uint32_t)value;
+    debug_log_put_raw(record, is_signed ? DLOG_ARG_I32 : DLOG_ARG_U32, &v, sizeof(v));
+  } else {
+    uint64_t v = (uint64_t)value;
+    debug_log_put_raw(record, is_signed ? DLOG_ARG_I64 : DLOG_ARG_U64, &v, sizeof(v));
+  }
+}
+
+inline void debug_log_put(DebugLogRecord *record, bool value) { debug_log_put_int(record, (int)value, true); }
+inline void debug_log_put(DebugLogRecord *record, char value) { debug_log_put_int(record, (int)value, true); }
+inline void debug_log_put(DebugLogRecord *record, signed char value) { debug_log_put_int(record, value, true); }
+inline void debug_log_put(DebugLogRecord *record, unsigned char value) { debug_log_put_int(record, value, false); }
+inline void debug_log_put(DebugLogRecord *record, short value) { debug_log_put_int(record, value, true); }
+inline void debug_log_put(DebugLogRecord *record, unsigned short value) { debug_log_put_int(record, value, false); }
+inline void debug_log_put(DebugLogRecord *record, int value) { debug_log_put_int(record, value, true); }
+inline void debug_log_put(DebugLogRecord *record, unsigned int value) { debug_log_put_int(record, value, false); }
+inline void debug_log_put(DebugLogRecord *record, long value) { debug_log_put_int(record, value, true); }
+inline void debug_log_put(DebugLogRecord *record, unsigned long value) { debug_log_put_int(record, value, false); }
+inline void debug_log_put(DebugLogRecord *record, long long value) { debug_log_put_int(record, value, true); }
+inline void debug_log_put(DebugLogRecord *record, unsigned long long value) { debug_log_put_int(record, value, false); }
+inline void debug_log_put(DebugLogRecord *record, double value) {
+  debug_log_put_raw(record, DLOG_ARG_F64, &value, sizeof(value));
+}
+inline void debug_log_put(DebugLogRecord *record, float value) { debug_log_put(record, (double)value); }
+inline void debug_log_put(DebugLogRecord *record, char *value) { debug_log_put(record, (const char *)value); }
+inline void debug_log_put(DebugLogRecord *record, const void *value) {
+  debug_log_put_raw(record, DLOG_ARG_PTR, &value, sizeof(value));
+}
+
+template <typename... Args>
+inline void debug_log_write(DebugLogSite *site, uint8_t level, const char *format, Args... args) {
+  DebugLogRecord record;
+  if (!debug_log_begin(site, level, format, &record)) return;
+  int expand[] = {0, (debug_log_put(&record, args), 0)...};
+  (void)expand;
+  debug_log_commit(&record);
+}
+
+#define DLOG_AT(level, format, ...) do { \
+    static DebugLogSite dlog_site = {0, 0, 0}; \
+    debug_log_write(&dlog_site, level, format, ##__VA_ARGS__); \
+  } while (0)
+
+#if NCIR_LOG_LEVEL >= DLOG_LEVEL_ERROR
+#define DLOG_E(format, ...) DLOG_AT(DLOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#else
+#define DLOG_E(format, ...) do {} while (0)
+#endif
+
+#if NCIR_LOG_LEVEL >= DLOG_LEVEL_WARN
+#define DLOG_W(format, ...) DLOG_AT(DLOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#else
+#define DLOG_W(format, ...) do {} while (0)
+#endif
+
+#if NCIR_LOG_LEVEL >= DLOG_LEVEL_INFO
+#define DLOG_I(format, ...) DLOG_AT(DLOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#else
+#define DLOG_I(format, ...) do {} while (0)
+#endif
+
+#if NCIR_LOG_LEVEL >= DLOG_LEVEL_DEBUG
+#define DLOG_D(format, ...) DLOG_AT(DLOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#else
+#define DLOG_D(format, ...) do {} while (0)
+#endif
+
+#endif  // __DEBUG_LOG_H__
@@ -0,0 +1,28 @@
+
+#include "display_math.hpp"
+#include <math.h>
+
+#define DEG_TO_RAD_F 0.017453292519943295f
+
+float celsius_to_fahrenheit(float celsius) {
+  return celsius * 9.0f / 5.0f + 32.0f;
+}
+
+float fahrenheit_to_celsius(float fahrenheit) {
+  return (fahrenheit - 32.0f) * 5.0f / 9.0f;
+}
+
+float gauge_needle_angle(float temp) {
+  // Written so NaN fails the first test and lands on the minimum
+  float clamped = temp > GAUGE_TEMP_MIN ? (temp < GAUGE_TEMP_MAX ? temp : GAUGE_TEMP_MAX) : GAUGE_TEMP_MIN;
+  return GAUGE_START_DEG + (clamped - GAUGE_TEMP_MIN) / (GAUGE_TEMP_MAX - GAUGE_TEMP_MIN) * GAUGE_SWEEP_DEG;
+}
+
+void gauge_needle_tip(float angle_deg, int32_t center_x, int32_t center_y, int32_t length,
+                      int32_t *x, int32_t *y) {
+  // Single precision: the S3 FPU has no double support, and a 70 px needle needs
+  // nowhere near double accuracy
+  float angle_rad = (angle_deg - 90.0f) * DEG_TO_RAD_F;
+  *x = center_x + (int32_t)(length * cosf(angle_rad));
+  *y = center_y + (int32_t)(length * sinf(angle_rad));
+}
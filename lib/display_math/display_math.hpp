@@ -0,0 +1,28 @@
+#ifndef __DISPLAY_MATH_H__
+#define __DISPLAY_MATH_H__
+
+#include <stdint.h>
+
+// Numeric kernels of the display paths: unit conversion and the gauge needle geometry.
+// Plain float math with no LVGL or Arduino dependencies, so the native tests and
+// micro-benchmarks (test/test_display_math) exercise exactly what the firmware runs.
+
+// Gauge scale: GAUGE_TEMP_MIN..GAUGE_TEMP_MAX (display units) over a GAUGE_SWEEP_DEG arc
+// that starts at GAUGE_START_DEG, angles measured clockwise from straight up
+#define GAUGE_TEMP_MIN 0.0f
+#define GAUGE_TEMP_MAX 400.0f
+#define GAUGE_START_DEG 135.0f
+#define GAUGE_SWEEP_DEG 270.0f
+
+float celsius_to_fahrenheit(float celsius);
+float fahrenheit_to_celsius(float fahrenheit);
+
+// Needle angle for a reading, clamped to the arc (NaN parks the needle at the start)
+float gauge_needle_angle(float temp);
+
+// Tip of a needle of the given length pivoting at (center_x, center_y), truncated to
+// whole pixels
+void gauge_needle_tip(float angle_deg, int32_t center_x, int32_t center_y, int32_t length,
+                      int32_t *x, int32_t *y);
+
+#endif  // __DISPLAY_MATH_H__
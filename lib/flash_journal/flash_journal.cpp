@@ -0,0 +1,187 @@
+
+#include "flash_journal.hpp"
+#include <string.h>
+
+enum SlotState {
+  SLOT_ERASED,  // Never programmed since the last sector erase
+  SLOT_VALID,
+  SLOT_TORN,    // Programmed but incomplete or damaged
+  SLOT_FOREIGN  // Not written by the journal (other data, never erased)
+};
+
+uint32_t flash_journal_crc32(const void *data, size_t length, uint32_t crc) {
+  static const uint32_t nibble_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+  };
+  const uint8_t *bytes = (const uint8_t *)data;
+  crc = ~crc;
+  while (length--) {
+    crc = (crc >> 4) ^ nibble_table[(crc ^ *bytes) & 0x0F];
+    crc = (crc >> 4) ^ nibble_table[(crc ^ (*bytes++ >> 4)) & 0x0F];
+  }
+  return ~crc;
+}
+
+static uint32_t total_slots(const FlashJournal *journal) {
+  return journal->sectors * journal->slots_per_sector;
+}
+
+static uint32_t slot_offset(const FlashJournal *journal, uint32_t slot) {
+  return journal->base + slot * journal->slot_size;
+}
+
+// Classify slot (a position in the ring). A valid record's seq must map back to the
+// slot, which also rejects leftovers from a different journal geometry. The payload
+// is copied to data when it is not NULL (max bytes available).
+static SlotState read_slot(const FlashJournal *journal, uint32_t slot, uint32_t *seq, uint16_t *length,
+                           void *data, uint16_t max) {
+  FlashJournalHeader header;
+  uint32_t offset = slot_offset(journal, slot);
+  if (!journal->io.read(journal->io.context, offset, &header, sizeof(header))) return SLOT_TORN;
+
+  static const uint8_t erased[sizeof(FlashJournalHeader)] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+  };
+  if (!memcmp(&header, erased, sizeof(header))) return SLOT_ERASED;  // Header goes first
+  // A cut write leaves at most some of the magic's zero bits unprogrammed
+  if ((header.magic & FLASH_JOURNAL_MAGIC) != FLASH_JOURNAL_MAGIC) return SLOT_FOREIGN;
+  if (header.magic != FLASH_JOURNAL_MAGIC || header.seq % total_slots(journal) != slot ||
+      header.length > FLASH_JOURNAL_PAYLOAD_MAX(journal->slot_size)) {
+    return SLOT_TORN;
+  }
+
+  uint32_t crc = flash_journal_crc32(&header, offsetof(FlashJournalHeader, crc), 0);
+  offset += sizeof(header);
+  if (data) {
+    if (header.length > max || !journal->io.read(journal->io.context, offset, data, header.length)) return SLOT_TORN;
+    crc = flash_journal_crc32(data, header.length, crc);
+  } else {
+    uint8_t chunk[64];
+    for (uint16_t done = 0; done < header.length;) {
+      uint16_t n = header.length - done;
+      if (n > sizeof(chunk)) n = sizeof(chunk);
+      if (!journal->io.read(journal->io.context, offset + done, chunk, n)) return SLOT_TORN;
+      crc = flash_journal_crc32(chunk, n, crc);
+      done += n;
+    }
+  }
+  if (crc != header.crc) return SLOT_TORN;
+  *seq = header.seq;
+  if (length) *length = header.length;
+  return SLOT_VALID;
+}
+
+// Seq of the first slot of sector, from its first valid record. Torn slots are
+// skipped; an erased slot ends the search since slots are programmed in order, and
+// a foreign one means the sector has not been used by the journal since its last erase.
+static bool sector_base_seq(FlashJournal *journal, uint32_t sector, uint32_t *base_seq) {
+  for (uint32_t i = 0; i < journal->slots_per_sector; i++) {
+    uint32_t seq;
+    journal->open_reads++;
+    SlotState state = read_slot(journal, sector * journal->slots_per_sector + i, &seq, NULL, NULL, 0);
+    if (state == SLOT_ERASED || state == SLOT_FOREIGN) return false;
+    if (state == SLOT_VALID) {
+      *base_seq = seq - i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool flash_journal_open(FlashJournal *journal, const FlashJournalIo *io, uint32_t base,
+                        uint32_t sectors, uint32_t slot_size) {
+  memset(journal, 0, sizeof(*journal));
+  journal->io = *io;
+  journal->base = base;
+  journal->sectors = sectors;
+  journal->slot_size = slot_size;
+  journal->slots_per_sector = slot_size ? FLASH_JOURNAL_SECTOR_SIZE / slot_size : 0;
+  journal->last_seq = FLASH_JOURNAL_NO_SEQ;
+  if (sectors < 2 || slot_size <= sizeof(FlashJournalHeader) || FLASH_JOURNAL_SECTOR_SIZE % slot_size ||
+      base % FLASH_JOURNAL_SECTOR_SIZE) {
+    return false;
+  }
+
+  // Sectors from the reference up to the head hold increasing seqs; the sector after
+  // the head is erased, half-erased or from the previous lap. Sector 0 is the reference
+  // unless the head just wrapped into it and its erase or first write was cut.
+  uint32_t reference, reference_seq;
+  if (sector_base_seq(journal, 0, &reference_seq)) {
+    reference = 0;
+  } else if (sector_base_seq(journal, 1, &reference_seq)) {
+    reference = 1;
+  } else {
+    return true;  // Empty
+  }
+
+  uint32_t lo = reference, hi = sectors - 1;
+  uint32_t head_seq = reference_seq;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo + 1) / 2;
+    uint32_t mid_seq;
+    if (sector_base_seq(journal, mid, &mid_seq) && mid_seq >= reference_seq) {
+      lo = mid;
+      head_seq = mid_seq;
+    } else {
+      hi = mid - 1;
+    }
+  }
+
+  // Only the head sector is scanned: the next slot follows the last programmed one
+  uint32_t last_used = 0;
+  for (uint32_t i = 0; i < journal->slots_per_sector; i++) {
+    uint32_t seq;
+    journal->open_reads++;
+    SlotState state = read_slot(journal, lo * journal->slots_per_sector + i, &seq, NULL, NULL, 0);
+    if (state == SLOT_ERASED) break;
+    last_used = i;
+    if (state == SLOT_VALID) journal->last_seq = seq;
+  }
+  journal->next_seq = head_seq + last_used + 1;
+  return true;
+}
+
+bool flash_journal_append(FlashJournal *journal, const void *data, uint16_t length, uint32_t *seq) {
+  if (!journal->slots_per_sector || length > FLASH_JOURNAL_PAYLOAD_MAX(journal->slot_size)) return false;
+
+  uint32_t record_seq = journal->next_seq++;
+  uint32_t slot = record_seq % total_slots(journal);
+  if (seq) *seq = record_seq;
+
+  if (slot % journal->slots_per_sector == 0 &&
+      !journal->io.erase_sector(journal->io.context, slot_offset(journal, slot))) {
+    return false;
+  }
+
+  FlashJournalHeader header;
+  header.seq = record_seq;
+  header.magic = FLASH_JOURNAL_MAGIC;
+  header.length = length;
+  header.crc = flash_journal_crc32(&header, offsetof(FlashJournalHeader, crc), 0);
+  header.crc = flash_journal_crc32(data, length, header.crc);
+
+  uint32_t offset = slot_offset(journal, slot);
+  if (!journal->io.program(journal->io.context, offset, &header, sizeof(header)) ||
+      !journal->io.program(journal->io.context, offset + sizeof(header), data, length)) {
+    return false;
+  }
+  journal->last_seq = record_seq;
+  return true;
+}
+
+uint32_t flash_journal_first_seq(const FlashJournal *journal) {
+  // The head sector was erased when the head entered it. On a sector boundary the next
+  // sector may already be partly erased by an append that was cut, so it never counts.
+  uint32_t kept = (journal->sectors - 1) * journal->slots_per_sector + journal->next_seq % journal->slots_per_sector;
+  return journal->next_seq > kept ? journal->next_seq - kept : 0;
+}
+
+int flash_journal_read(const FlashJournal *journal, uint32_t seq, void *data, uint16_t max) {
+  if (!journal->slots_per_sector || seq >= journal->next_seq || seq < flash_journal_first_seq(journal)) return -1;
+
+  uint32_t found;
+  uint16_t length;
+  if (read_slot(journal, seq % total_slots(journal), &found, &length, data, max) != SLOT_VALID) return -1;
+  return found == seq ? length : -1;
+}
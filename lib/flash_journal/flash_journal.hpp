@@ -0,0 +1,74 @@
+#ifndef __FLASH_JOURNAL_H__
+#define __FLASH_JOURNAL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Append-only journal of CRC-checked records on a region of raw NOR flash.
+// The region is a ring of fixed-size slots, FLASH_JOURNAL_SECTOR_SIZE / slot_size per
+// erase sector. Every append programs the next slot once (a sector is erased when the
+// head enters it) and the record sequence number is the absolute slot number, so a
+// record's position follows from its seq and nothing is ever rewritten in place.
+//
+// A write torn by power loss leaves one slot that fails its CRC; it is skipped and its
+// seq is not reused, except when it is the only slot written in its sector: the sector
+// then has no valid record to date it, so reopening erases it again and the next append
+// gets the same seq (the torn record never became readable). Recovery finds the head sector by binary search over the first
+// valid record of each sector and scans only that sector, so opening costs
+// O(log sectors + slots per sector) reads whatever the journal holds.
+//
+// The library has no platform dependencies: flash access goes through FlashJournalIo
+// (see flash_partition_io.hpp for the ESP32 partition backend).
+
+#define FLASH_JOURNAL_SECTOR_SIZE 4096
+#define FLASH_JOURNAL_MAGIC 0x4A46   // "FJ"
+#define FLASH_JOURNAL_NO_SEQ UINT32_MAX
+
+struct FlashJournalIo {
+  void *context;
+  bool (*read)(void *context, uint32_t offset, void *data, size_t length);
+  // NOR semantics: programming can only clear bits of erased (0xFF) bytes
+  bool (*program)(void *context, uint32_t offset, const void *data, size_t length);
+  bool (*erase_sector)(void *context, uint32_t offset);
+};
+
+// Written in front of every record
+struct FlashJournalHeader {
+  uint32_t seq;
+  uint16_t magic;
+  uint16_t length;   // Payload bytes
+  uint32_t crc;      // CRC-32 of seq, magic, length and payload
+};
+
+#define FLASH_JOURNAL_PAYLOAD_MAX(slot_size) ((slot_size) - (int)sizeof(FlashJournalHeader))
+
+struct FlashJournal {
+  FlashJournalIo io;
+  uint32_t base;             // Region start (sector aligned)
+  uint32_t sectors;
+  uint32_t slot_size;        // Divides FLASH_JOURNAL_SECTOR_SIZE
+  uint32_t slots_per_sector;
+  uint32_t next_seq;         // Slot the next append goes to
+  uint32_t last_seq;         // Newest valid record, FLASH_JOURNAL_NO_SEQ if none
+  uint32_t open_reads;       // Slot reads done by the last flash_journal_open()
+};
+
+// Recover the head of the journal. Returns false only for an invalid geometry or a
+// read error; an empty or damaged region opens as an empty journal.
+bool flash_journal_open(FlashJournal *journal, const FlashJournalIo *io, uint32_t base,
+                        uint32_t sectors, uint32_t slot_size);
+
+// Program one record into the next slot. The slot is consumed even if programming
+// fails. *seq (optional) receives the record's sequence number.
+bool flash_journal_append(FlashJournal *journal, const void *data, uint16_t length, uint32_t *seq);
+
+// Read record seq. Returns its payload length, or -1 if it was overwritten, never
+// written, torn or longer than max.
+int flash_journal_read(const FlashJournal *journal, uint32_t seq, void *data, uint16_t max);
+
+// Oldest seq that can still be read (records between it and next_seq may be missing)
+uint32_t flash_journal_first_seq(const FlashJournal *journal);
+
+uint32_t flash_journal_crc32(const void *data, size_t length, uint32_t crc);
+
+#endif  // __FLASH_JOURNAL_H__
@@ -0,0 +1,35 @@
+
+#ifdef ESP_PLATFORM
+
+#include "flash_partition_io.hpp"
+#include <esp_partition.h>
+
+static bool partition_read(void *context, uint32_t offset, void *data, size_t length) {
+  return esp_partition_read((const esp_partition_t *)context, offset, data, length) == ESP_OK;
+}
+
+static bool partition_program(void *context, uint32_t offset, const void *data, size_t length) {
+  return esp_partition_write((const esp_partition_t *)context, offset, data, length) == ESP_OK;
+}
+
+static bool partition_erase_sector(void *context, uint32_t offset) {
+  return esp_partition_erase_range((const esp_partition_t *)context, offset, FLASH_JOURNAL_SECTOR_SIZE) == ESP_OK;
+}
+
+bool flash_partition_io_init(FlashJournalIo *io, const char *label) {
+  const esp_partition_t *partition =
+    esp_partition_find_first(ESP_PARTITION_TYPE_DATA, label ? ESP_PARTITION_SUBTYPE_ANY : ESP_PARTITION_SUBTYPE_DATA_SPIFFS, label);
+  if (!partition) return false;
+
+  io->context = (void *)partition;
+  io->read = partition_read;
+  io->program = partition_program;
+  io->erase_sector = partition_erase_sector;
+  return true;
+}
+
+uint32_t flash_partition_io_size(const FlashJournalIo *io) {
+  return io->context ? ((const esp_partition_t *)io->context)->size : 0;
+}
+
+#endif  // ESP_PLATFORM
@@ -0,0 +1,11 @@
+#ifndef __FLASH_PARTITION_IO_H__
+#define __FLASH_PARTITION_IO_H__
+
+#include "flash_journal.hpp"
+
+// FlashJournalIo backend on an ESP32 data partition (esp_partition API, offsets relative
+// to the partition start). label NULL selects the first "spiffs" subtype data partition.
+bool flash_partition_io_init(FlashJournalIo *io, const char *label);
+uint32_t flash_partition_io_size(const FlashJournalIo *io);
+
+#endif  // __FLASH_PARTITION_IO_H__
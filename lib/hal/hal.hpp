@@ -0,0 +1,170 @@
+#ifndef __HAL_H__
+#define __HAL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "flash_journal.hpp"
+
+// Hardware abstraction layer.
+// Everything the application needs from the board goes through these calls: the
+// MLX90614 sensor, the three buttons, the speaker, the LED, the clock, heap and stack
+// usage, the NVS key-value store, the raw data partition and the LCD/touch panel.
+// hal_esp32.cpp implements them on the CoreS3 (M5Unified, Adafruit MLX90614, LEDC,
+// Preferences); hal_native.cpp backs them with mocks for the Linux host build
+// (env:native) - a simulated sensor, buttons and touch set by the host program, a RAM
+// flash and an in-memory framebuffer.
+
+enum HalButton {
+  HAL_BUTTON_1,     // GPIO17 on the CoreS3
+  HAL_BUTTON_2,     // GPIO18
+  HAL_BUTTON_KEY,   // GPIO8
+  HAL_BUTTON_COUNT
+};
+
+// Board bring-up (power, I2C, display); call first
+void hal_begin();
+
+// Poll the touch panel and the power button over I2C. The touch driver calls it for
+// every panel read (see m5gfx_lvgl.hpp), and loop() every HAL_UPDATE_PERIOD_MS.
+void hal_update();
+
+// Clock (same types as the Arduino millis() and micros())
+unsigned long hal_millis();
+unsigned long hal_micros();
+void hal_delay(uint32_t ms);
+
+// Power management. hal_power_begin() enables CPU frequency scaling between max_mhz and
+// min_mhz and, with light_sleep, automatic light sleep whenever every task is blocked.
+// It returns the mode it got: HAL_POWER_FULL when the SDK was built without power
+// management (and always on the host). I2C and SPI transfers inside the HAL hold a PM
+// lock, so the buses run at full APB clock and never stop half-way. While a USB cable is
+// connected (checked by hal_update()) the chip stays out of light sleep, which would
+// suspend the USB CDC serial port.
+enum HalPowerMode {
+  HAL_POWER_FULL,       // Fixed CPU clock
+  HAL_POWER_DFS,        // Frequency scaling
+  HAL_POWER_DFS_SLEEP   // Frequency scaling and automatic light sleep
+};
+
+HalPowerMode hal_power_begin(uint32_t max_mhz, uint32_t min_mhz, bool light_sleep);
+
+// Current CPU clock (0 when unknown)
+uint32_t hal_cpu_mhz();
+
+// Battery current in mA, signed as the power IC reports it. False when it cannot be
+// measured (host build).
+bool hal_battery_current_ma(int32_t *ma);
+
+// Free general-purpose heap now and since boot
+uint32_t hal_free_heap();
+uint32_t hal_min_free_heap();
+
+// Heap capability regions, as reported to the memory monitor (mem_monitor.hpp)
+enum MemRegion {
+  MEM_REGION_INTERNAL,   // MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT
+  MEM_REGION_DMA,        // MALLOC_CAP_DMA
+  MEM_REGION_PSRAM,      // MALLOC_CAP_SPIRAM
+  MEM_REGION_COUNT
+};
+
+struct MemRegionInfo {
+  bool present;          // false when the board has no such memory (or on the host)
+  uint32_t total;
+  uint32_t free;
+  uint32_t largest_free; // Largest single allocation that would succeed
+  uint32_t min_free;     // Low-water mark of free bytes since boot
+};
+
+// Heap capability region for the memory monitor (false when the region does not exist)
+bool hal_heap_info(MemRegion region, MemRegionInfo *info);
+
+// Stack high-water mark of a task in bytes (name NULL = the calling task). False when
+// no such task runs or stacks cannot be measured (host build).
+bool hal_task_stack_free(const char *name, uint32_t *free_bytes);
+
+// The same for a task handle (TaskHandle_t), for tasks that share a name
+bool hal_task_handle_stack_free(void *task, uint32_t *free_bytes);
+
+// Object and ambient temperature in Celsius
+bool hal_sensor_begin();
+float hal_sensor_object_c();
+float hal_sensor_ambient_c();
+
+// Buttons are read as pin levels: HIGH when released, LOW while pressed (pull-ups)
+void hal_buttons_begin();
+int hal_button_read(HalButton button);
+
+// Speaker, 8-bit unsigned mono PCM per virtual channel. A clip is queued behind the one
+// playing on its channel; the call blocks while the channel already has one waiting.
+bool hal_speaker_begin();
+void hal_speaker_play(const uint8_t *data, uint32_t length, uint32_t sample_rate, uint8_t channel);
+bool hal_speaker_busy(uint8_t channel);
+void hal_speaker_set_volume(uint8_t channel, uint8_t volume);
+
+// LED PWM, 8-bit duty. A fade runs in hardware and cannot be stopped, only
+// overridden once it has finished.
+bool hal_led_begin();
+void hal_led_set(uint8_t duty);
+void hal_led_fade(uint8_t duty, uint32_t ms);
+
+// Read-only key-value store (NVS namespace), used to migrate settings saved by older
+// firmware. The getters return fallback when the key is missing.
+bool hal_kv_open(const char *name);
+void hal_kv_close();
+bool hal_kv_get_bool(const char *key, bool fallback);
+int32_t hal_kv_get_int(const char *key, int32_t fallback);
+uint16_t hal_kv_get_ushort(const char *key, uint16_t fallback);
+float hal_kv_get_float(const char *key, float fallback);
+size_t hal_kv_get_bytes(const char *key, void *data, size_t length);
+
+// Raw flash for the settings journal and the sample log, returns the region size
+// (0 when there is none)
+uint32_t hal_storage_open(FlashJournalIo *io);
+
+// Push RGB565 pixels to the panel, in panel byte order (high byte first). Returns
+// once the pixels are out and the buffer can be reused.
+void hal_display_flush(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *pixels);
+
+// Backlight level (0-255). 0 switches the backlight off and puts the panel to sleep,
+// any other level wakes it first.
+void hal_display_set_brightness(uint8_t level);
+
+// Touch point from the last hal_update(), false when the panel is not touched
+bool hal_touch_read(int16_t *x, int16_t *y);
+
+// Touch controller interrupt line. hal_touch_irq_begin() returns false when the board
+// cannot signal touches; hal_touch_irq_take() returns whether the line fired since the
+// last call and re-arms it.
+bool hal_touch_irq_begin();
+bool hal_touch_irq_take();
+
+#ifndef ESP_PLATFORM
+// Host backend controls (hal_native.cpp)
+
+// Fixed readings instead of the simulated ones (NAN restores the simulation)
+void hal_native_set_temperatures(float object_c, float ambient_c);
+void hal_native_set_button(HalButton button, bool pressed);
+void hal_native_set_touch(bool pressed, int16_t x, int16_t y);
+
+struct HalNativeStats {
+  uint32_t flushes;          // hal_display_flush calls
+  uint64_t pixels;           // Pixels pushed
+  uint32_t clips_played;
+  uint8_t led_duty;          // Last duty set or faded to
+  uint8_t backlight;         // Last hal_display_set_brightness level
+};
+
+void hal_native_get_stats(HalNativeStats *stats);
+
+// The panel contents (LCD_WIDTH x LCD_HEIGHT, panel byte order)
+const uint16_t *hal_native_framebuffer();
+
+// Write the panel contents as a binary PPM image
+bool hal_native_save_ppm(const char *path);
+
+// Back the raw flash with a file so settings and samples survive restarts (call before
+// hal_storage_open; without it the flash lives in RAM and starts erased)
+void hal_native_set_storage_file(const char *path);
+#endif
+
+#endif  // __HAL_H__
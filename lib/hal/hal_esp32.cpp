@@ -0,0 +1,376 @@
+
+#ifdef ESP_PLATFORM
+
+#include "hal.hpp"
+#include "flash_partition_io.hpp"
+#include <Arduino.h>
+#include <M5Unified.h>
+#include <Adafruit_MLX90614.h>
+#include <Preferences.h>
+#include <driver/ledc.h>
+#include <esp_heap_caps.h>
+#include <esp_idf_version.h>
+#include <esp_pm.h>
+#include <string.h>
+
+// CoreS3 wiring
+#define LED_PIN 9
+#define BUTTON1_PIN 17
+#define BUTTON2_PIN 18
+#define KEY_PIN 8
+
+// The FT6336 touch INT goes through the AW9523 IO expander, whose own INT output is on
+// GPIO21. Reading the expander input port clears it.
+#define TOUCH_INT_PIN 21
+#define AW9523_ADDR 0x58
+#define AW9523_INPUT_P1 0x01
+#define AW9523_I2C_HZ 400000
+
+// LEDC resources for the LED (low-speed mode, 8-bit duty)
+#define LED_MODE LEDC_LOW_SPEED_MODE
+#define LED_CHANNEL LEDC_CHANNEL_7
+#define LED_TIMER LEDC_TIMER_3
+#define LED_PWM_HZ 5000
+
+static const uint8_t button_pins[HAL_BUTTON_COUNT] = {BUTTON1_PIN, BUTTON2_PIN, KEY_PIN};
+
+// heap_caps capabilities of each MemRegion
+static const uint32_t region_caps[MEM_REGION_COUNT] = {
+  MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, MALLOC_CAP_DMA, MALLOC_CAP_SPIRAM
+};
+
+static Adafruit_MLX90614 mlx = Adafruit_MLX90614();
+static Preferences preferences;
+static volatile bool touch_irq_pending = false;
+
+#ifdef CONFIG_PM_ENABLE
+// Created by hal_power_begin(), NULL while power management is off
+static esp_pm_lock_handle_t bus_lock = NULL;   // APB at full clock for I2C/SPI transfers
+static esp_pm_lock_handle_t led_lock = NULL;   // LEDC runs on the APB clock, which light sleep stops
+static esp_pm_lock_handle_t usb_lock = NULL;   // Light sleep suspends USB CDC (serial log, telemetry)
+static bool led_lock_held = false;
+static bool usb_lock_held = false;
+static uint32_t last_usb_check = 0;
+#endif
+
+// VBUS on the USB-C port is checked at most this often (one PMIC read over I2C)
+#define USB_CHECK_PERIOD_MS 1000
+// AXP2101 VBUS reading above which a USB cable counts as connected
+#define USB_VBUS_MIN_MV 4000
+
+static void bus_lock_acquire() {
+#ifdef CONFIG_PM_ENABLE
+  if (bus_lock) esp_pm_lock_acquire(bus_lock);
+#endif
+}
+
+static void bus_lock_release() {
+#ifdef CONFIG_PM_ENABLE
+  if (bus_lock) esp_pm_lock_release(bus_lock);
+#endif
+}
+
+// Keep the chip out of light sleep from the first non-zero LED duty until it is set to 0
+static void led_lock_set(bool on) {
+#ifdef CONFIG_PM_ENABLE
+  if (!led_lock || on == led_lock_held) return;
+  if (on) {
+    esp_pm_lock_acquire(led_lock);
+  } else {
+    esp_pm_lock_release(led_lock);
+  }
+  led_lock_held = on;
+#else
+  (void)on;
+#endif
+}
+
+// Keep the chip out of light sleep while a USB cable is connected, so the USB CDC serial
+// port stays up for the debug log and telemetry. On battery nobody is listening.
+static void usb_lock_update(bool force) {
+#ifdef CONFIG_PM_ENABLE
+  if (!usb_lock) return;
+  uint32_t now = millis();
+  if (!force && now - last_usb_check < USB_CHECK_PERIOD_MS) return;
+  last_usb_check = now;
+  bool connected = M5.Power.getVBUSVoltage() >= USB_VBUS_MIN_MV;
+  if (connected == usb_lock_held) return;
+  if (connected) {
+    esp_pm_lock_acquire(usb_lock);
+  } else {
+    esp_pm_lock_release(usb_lock);
+  }
+  usb_lock_held = connected;
+#else
+  (void)force;
+#endif
+}
+
+void hal_begin() {
+  auto cfg = M5.config();
+  M5.begin(cfg);
+}
+
+void hal_update() {
+  bus_lock_acquire();
+  M5.update();
+  usb_lock_update(false);
+  bus_lock_release();
+}
+
+unsigned long hal_millis() {
+  return millis();
+}
+
+unsigned long hal_micros() {
+  return micros();
+}
+
+void hal_delay(uint32_t ms) {
+  delay(ms);
+}
+
+HalPowerMode hal_power_begin(uint32_t max_mhz, uint32_t min_mhz, bool light_sleep) {
+#ifdef CONFIG_PM_ENABLE
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  esp_pm_config_t config;
+#else
+  esp_pm_config_esp32s3_t config;
+#endif
+  memset(&config, 0, sizeof(config));
+  config.max_freq_mhz = max_mhz;
+  config.min_freq_mhz = min_mhz;
+#ifdef CONFIG_FREERTOS_USE_TICKLESS_IDLE
+  config.light_sleep_enable = light_sleep;
+#else
+  light_sleep = false;  // Light sleep needs the tickless idle hook
+#endif
+  if (esp_pm_configure(&config) != ESP_OK) return HAL_POWER_FULL;
+
+  if (!bus_lock) esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "hal_bus", &bus_lock);
+  if (!led_lock) esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "hal_led", &led_lock);
+  if (!usb_lock) esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "hal_usb", &usb_lock);
+  bus_lock_acquire();
+  usb_lock_update(true);
+  bus_lock_release();
+  return light_sleep ? HAL_POWER_DFS_SLEEP : HAL_POWER_DFS;
+#else
+  (void)max_mhz;
+  (void)min_mhz;
+  (void)light_sleep;
+  return HAL_POWER_FULL;
+#endif
+}
+
+uint32_t hal_cpu_mhz() {
+  return getCpuFrequencyMhz();
+}
+
+bool hal_battery_current_ma(int32_t *ma) {
+  bus_lock_acquire();
+  *ma = M5.Power.getBatteryCurrent();
+  bus_lock_release();
+  return true;
+}
+
+uint32_t hal_free_heap() {
+  return ESP.getFreeHeap();
+}
+
+uint32_t hal_min_free_heap() {
+  return ESP.getMinFreeHeap();
+}
+
+bool hal_heap_info(MemRegion region, MemRegionInfo *info) {
+  memset(info, 0, sizeof(*info));
+  uint32_t caps = region_caps[region];
+  info->total = heap_caps_get_total_size(caps);
+  if (!info->total) return false;
+
+  multi_heap_info_t heap;
+  heap_caps_get_info(&heap, caps);
+  info->present = true;
+  info->free = heap.total_free_bytes;
+  info->largest_free = heap.largest_free_block;
+  info->min_free = heap.minimum_free_bytes;
+  return true;
+}
+
+bool hal_task_stack_free(const char *name, uint32_t *free_bytes) {
+  return hal_task_handle_stack_free(name ? xTaskGetHandle(name) : xTaskGetCurrentTaskHandle(), free_bytes);
+}
+
+bool hal_task_handle_stack_free(void *task, uint32_t *free_bytes) {
+  if (!task) return false;
+  // ESP-IDF counts stacks in bytes (StackType_t is uint8_t)
+  *free_bytes = uxTaskGetStackHighWaterMark((TaskHandle_t)task);
+  return true;
+}
+
+bool hal_sensor_begin() {
+  return mlx.begin();
+}
+
+float hal_sensor_object_c() {
+  bus_lock_acquire();
+  float value = mlx.readObjectTempC();
+  bus_lock_release();
+  return value;
+}
+
+float hal_sensor_ambient_c() {
+  bus_lock_acquire();
+  float value = mlx.readAmbientTempC();
+  bus_lock_release();
+  return value;
+}
+
+void hal_buttons_begin() {
+  for (int i = 0; i < HAL_BUTTON_COUNT; i++) {
+    pinMode(button_pins[i], INPUT_PULLUP);
+  }
+}
+
+int hal_button_read(HalButton button) {
+  return digitalRead(button_pins[button]);
+}
+
+bool hal_speaker_begin() {
+  return M5.Speaker.begin();
+}
+
+void hal_speaker_play(const uint8_t *data, uint32_t length, uint32_t sample_rate, uint8_t channel) {
+  M5.Speaker.playRaw(data, length, sample_rate, false, 1, channel, false);
+}
+
+bool hal_speaker_busy(uint8_t channel) {
+  return M5.Speaker.isPlaying(channel);
+}
+
+void hal_speaker_set_volume(uint8_t channel, uint8_t volume) {
+  M5.Speaker.setChannelVolume(channel, volume);
+}
+
+bool hal_led_begin() {
+  ledc_timer_config_t timer_cfg;
+  memset(&timer_cfg, 0, sizeof(timer_cfg));
+  timer_cfg.speed_mode = LED_MODE;
+  timer_cfg.duty_resolution = LEDC_TIMER_8_BIT;
+  timer_cfg.timer_num = LED_TIMER;
+  timer_cfg.freq_hz = LED_PWM_HZ;
+  timer_cfg.clk_cfg = LEDC_AUTO_CLK;
+  if (ledc_timer_config(&timer_cfg) != ESP_OK) return false;
+
+  ledc_channel_config_t channel_cfg;
+  memset(&channel_cfg, 0, sizeof(channel_cfg));
+  channel_cfg.gpio_num = LED_PIN;
+  channel_cfg.speed_mode = LED_MODE;
+  channel_cfg.channel = LED_CHANNEL;
+  channel_cfg.timer_sel = LED_TIMER;
+  channel_cfg.duty = 0;
+  if (ledc_channel_config(&channel_cfg) != ESP_OK) return false;
+  ledc_fade_func_install(0);
+  return true;
+}
+
+void hal_led_set(uint8_t duty) {
+  if (duty) led_lock_set(true);
+  ledc_set_duty(LED_MODE, LED_CHANNEL, duty);
+  ledc_update_duty(LED_MODE, LED_CHANNEL);
+  if (!duty) led_lock_set(false);
+}
+
+// A fade down to 0 keeps the lock until the next hal_led_set(0)
+void hal_led_fade(uint8_t duty, uint32_t ms) {
+  if (duty) led_lock_set(true);
+  ledc_set_fade_with_time(LED_MODE, LED_CHANNEL, duty, ms);
+  ledc_fade_start(LED_MODE, LED_CHANNEL, LEDC_FADE_NO_WAIT);
+}
+
+bool hal_kv_open(const char *name) {
+  return preferences.begin(name, true);
+}
+
+void hal_kv_close() {
+  preferences.end();
+}
+
+bool hal_kv_get_bool(const char *key, bool fallback) {
+  return preferences.getBool(key, fallback);
+}
+
+int32_t hal_kv_get_int(const char *key, int32_t fallback) {
+  return preferences.getInt(key, fallback);
+}
+
+uint16_t hal_kv_get_ushort(const char *key, uint16_t fallback) {
+  return preferences.getUShort(key, fallback);
+}
+
+float hal_kv_get_float(const char *key, float fallback) {
+  return preferences.getFloat(key, fallback);
+}
+
+size_t hal_kv_get_bytes(const char *key, void *data, size_t length) {
+  return preferences.getBytes(key, data, length);
+}
+
+uint32_t hal_storage_open(FlashJournalIo *io) {
+  return flash_partition_io_init(io, NULL) ? flash_partition_io_size(io) : 0;
+}
+
+void hal_display_flush(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *pixels) {
+  bus_lock_acquire();
+  M5.Display.startWrite();
+  M5.Display.pushImageDMA<uint16_t>(x, y, w, h, pixels);
+  M5.Display.waitDMA();
+  M5.Display.endWrite();
+  bus_lock_release();
+}
+
+void hal_display_set_brightness(uint8_t level) {
+  static bool asleep = false;
+  bus_lock_acquire();
+  if (!level) {
+    M5.Display.setBrightness(0);
+    M5.Display.sleep();
+    asleep = true;
+  } else {
+    if (asleep) M5.Display.wakeup();
+    asleep = false;
+    M5.Display.setBrightness(level);
+  }
+  bus_lock_release();
+}
+
+bool hal_touch_read(int16_t *x, int16_t *y) {
+  auto t = M5.Touch.getDetail();
+  if (!t.isPressed()) return false;
+  *x = t.x;
+  *y = t.y;
+  return true;
+}
+
+static void IRAM_ATTR touch_irq_isr() {
+  touch_irq_pending = true;
+}
+
+bool hal_touch_irq_begin() {
+  pinMode(TOUCH_INT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(TOUCH_INT_PIN), touch_irq_isr, FALLING);
+  bus_lock_acquire();
+  M5.In_I2C.readRegister8(AW9523_ADDR, AW9523_INPUT_P1, AW9523_I2C_HZ);  // Drop a stale interrupt
+  bus_lock_release();
+  return true;
+}
+
+bool hal_touch_irq_take() {
+  if (!touch_irq_pending) return false;
+  touch_irq_pending = false;
+  bus_lock_acquire();
+  M5.In_I2C.readRegister8(AW9523_ADDR, AW9523_INPUT_P1, AW9523_I2C_HZ);
+  bus_lock_release();
+  return true;
+}
+
+#endif  // ESP_PLATFORM
@@ -0,0 +1,379 @@
+
+#ifndef ESP_PLATFORM
+
+#include "hal.hpp"
+#include <Arduino.h>
+#include <atomic>
+#include <math.h>
+#include <mutex>
+#include <string.h>
+#include <vector>
+
+// Size of the RAM flash behind hal_storage_open (the CoreS3 "spiffs" partition is larger,
+// but this holds the settings journal and a full sample log)
+#ifndef HAL_NATIVE_STORAGE_SIZE
+#define HAL_NATIVE_STORAGE_SIZE (4 * 1024 * 1024)
+#endif
+
+#define SPEAKER_CHANNELS 8
+
+// Sensor: a slow object temperature swing over a drifting ambient, with a little noise
+static std::mutex sensor_lock;
+static float fixed_object_c = NAN;
+static float fixed_ambient_c = NAN;
+static uint32_t noise_state = 12345;
+
+static std::atomic<bool> buttons_pressed[HAL_BUTTON_COUNT];
+
+static std::mutex touch_lock;
+static bool touch_pressed = false;
+static int16_t touch_x = 0;
+static int16_t touch_y = 0;
+static std::atomic<bool> touch_irq(false);
+
+// Speaker: each channel plays one clip and queues one more, timed from the clip lengths
+struct SpeakerChannel {
+  uint32_t last_start_us;   // Start of the newest clip (in the future while it waits)
+  uint32_t last_end_us;
+};
+static std::mutex speaker_lock;
+static SpeakerChannel speaker_channels[SPEAKER_CHANNELS];
+
+static std::atomic<uint8_t> led_duty(0);
+static std::atomic<uint8_t> backlight(0);
+
+static std::vector<uint8_t> storage;
+static const char *storage_path = NULL;
+static FILE *storage_file = NULL;
+
+static uint16_t framebuffer[LCD_WIDTH * LCD_HEIGHT];
+static std::atomic<uint32_t> flush_count(0);
+static std::atomic<uint64_t> pixel_count(0);
+static std::atomic<uint32_t> clip_count(0);
+
+void hal_begin() {
+}
+
+void hal_update() {
+}
+
+unsigned long hal_millis() {
+  return millis();
+}
+
+unsigned long hal_micros() {
+  return micros();
+}
+
+void hal_delay(uint32_t ms) {
+  delay(ms);
+}
+
+// Not tracked on the host
+HalPowerMode hal_power_begin(uint32_t max_mhz, uint32_t min_mhz, bool light_sleep) {
+  (void)max_mhz;
+  (void)min_mhz;
+  (void)light_sleep;
+  return HAL_POWER_FULL;
+}
+
+uint32_t hal_cpu_mhz() {
+  return 0;
+}
+
+bool hal_battery_current_ma(int32_t *ma) {
+  (void)ma;
+  return false;
+}
+
+uint32_t hal_free_heap() {
+  return 0;
+}
+
+uint32_t hal_min_free_heap() {
+  return 0;
+}
+
+bool hal_heap_info(MemRegion region, MemRegionInfo *info) {
+  (void)region;
+  memset(info, 0, sizeof(*info));
+  return false;
+}
+
+// Tasks are host threads with OS-managed stacks
+bool hal_task_stack_free(const char *name, uint32_t *free_bytes) {
+  (void)name;
+  (void)free_bytes;
+  return false;
+}
+
+bool hal_task_handle_stack_free(void *task, uint32_t *free_bytes) {
+  (void)task;
+  (void)free_bytes;
+  return false;
+}
+
+bool hal_sensor_begin() {
+  return true;
+}
+
+static float simulated_ambient_c(float t) {
+  return 22.0f + 0.5f * sinf(t * 2.0f * (float)PI / 600.0f);
+}
+
+float hal_sensor_object_c() {
+  std::lock_guard<std::mutex> guard(sensor_lock);
+  if (!isnan(fixed_object_c)) return fixed_object_c;
+  float t = millis() / 1000.0f;
+  noise_state = noise_state * 1103515245u + 12345u;
+  float noise = ((noise_state >> 16) & 0xFF) / 255.0f - 0.5f;
+  return simulated_ambient_c(t) + 8.0f + 12.0f * sinf(t * 2.0f * (float)PI / 90.0f) + 0.1f * noise;
+}
+
+float hal_sensor_ambient_c() {
+  std::lock_guard<std::mutex> guard(sensor_lock);
+  if (!isnan(fixed_ambient_c)) return fixed_ambient_c;
+  return simulated_ambient_c(millis() / 1000.0f);
+}
+
+void hal_native_set_temperatures(float object_c, float ambient_c) {
+  std::lock_guard<std::mutex> guard(sensor_lock);
+  fixed_object_c = object_c;
+  fixed_ambient_c = ambient_c;
+}
+
+void hal_buttons_begin() {
+  for (int i = 0; i < HAL_BUTTON_COUNT; i++) buttons_pressed[i] = false;
+}
+
+int hal_button_read(HalButton button) {
+  return buttons_pressed[button] ? LOW : HIGH;
+}
+
+void hal_native_set_button(HalButton button, bool pressed) {
+  if (button < HAL_BUTTON_COUNT) buttons_pressed[button] = pressed;
+}
+
+bool hal_speaker_begin() {
+  std::lock_guard<std::mutex> guard(speaker_lock);
+  memset(speaker_channels, 0, sizeof(speaker_channels));
+  return true;
+}
+
+void hal_speaker_play(const uint8_t *data, uint32_t length, uint32_t sample_rate, uint8_t channel) {
+  (void)data;
+  if (channel >= SPEAKER_CHANNELS || !sample_rate) return;
+  uint32_t duration_us = (uint32_t)((uint64_t)length * 1000000 / sample_rate);
+
+  std::unique_lock<std::mutex> guard(speaker_lock);
+  SpeakerChannel &ch = speaker_channels[channel];
+  // A clip is already waiting: block until it starts playing
+  for (int32_t wait; (wait = (int32_t)(ch.last_start_us - micros())) > 0;) {
+    guard.unlock();
+    delay(wait / 1000 + 1);
+    guard.lock();
+  }
+  uint32_t now = micros();
+  ch.last_start_us = (int32_t)(ch.last_end_us - now) > 0 ? ch.last_end_us : now;
+  ch.last_end_us = ch.last_start_us + duration_us;
+  clip_count++;
+}
+
+bool hal_speaker_busy(uint8_t channel) {
+  if (channel >= SPEAKER_CHANNELS) return false;
+  std::lock_guard<std::mutex> guard(speaker_lock);
+  return (int32_t)(speaker_channels[channel].last_end_us - micros()) > 0;
+}
+
+void hal_speaker_set_volume(uint8_t channel, uint8_t volume) {
+  (void)channel;
+  (void)volume;
+}
+
+bool hal_led_begin() {
+  led_duty = 0;
+  return true;
+}
+
+void hal_led_set(uint8_t duty) {
+  led_duty = duty;
+}
+
+// Only the fade target is recorded
+void hal_led_fade(uint8_t duty, uint32_t ms) {
+  (void)ms;
+  led_duty = duty;
+}
+
+// No NVS on the host: every namespace is empty, so legacy settings come up as defaults
+bool hal_kv_open(const char *name) {
+  (void)name;
+  return false;
+}
+
+void hal_kv_close() {
+}
+
+bool hal_kv_get_bool(const char *key, bool fallback) {
+  (void)key;
+  return fallback;
+}
+
+int32_t hal_kv_get_int(const char *key, int32_t fallback) {
+  (void)key;
+  return fallback;
+}
+
+uint16_t hal_kv_get_ushort(const char *key, uint16_t fallback) {
+  (void)key;
+  return fallback;
+}
+
+float hal_kv_get_float(const char *key, float fallback) {
+  (void)key;
+  return fallback;
+}
+
+size_t hal_kv_get_bytes(const char *key, void *data, size_t length) {
+  (void)key;
+  (void)data;
+  (void)length;
+  return 0;
+}
+
+// NOR flash in RAM: programming clears bits, erasing sets a sector to 0xFF. With a
+// storage file every change is written through.
+static void storage_write_through(uint32_t offset, size_t length) {
+  if (!storage_file) return;
+  fseek(storage_file, offset, SEEK_SET);
+  fwrite(&storage[offset], 1, length, storage_file);
+  fflush(storage_file);
+}
+
+static bool storage_read(void *context, uint32_t offset, void *data, size_t length) {
+  (void)context;
+  if (offset + length > storage.size()) return false;
+  memcpy(data, &storage[offset], length);
+  return true;
+}
+
+static bool storage_program(void *context, uint32_t offset, const void *data, size_t length) {
+  (void)context;
+  if (offset + length > storage.size()) return false;
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (size_t i = 0; i < length; i++) storage[offset + i] &= bytes[i];
+  storage_write_through(offset, length);
+  return true;
+}
+
+static bool storage_erase_sector(void *context, uint32_t offset) {
+  (void)context;
+  if (offset % FLASH_JOURNAL_SECTOR_SIZE || offset + FLASH_JOURNAL_SECTOR_SIZE > storage.size()) return false;
+  memset(&storage[offset], 0xFF, FLASH_JOURNAL_SECTOR_SIZE);
+  storage_write_through(offset, FLASH_JOURNAL_SECTOR_SIZE);
+  return true;
+}
+
+void hal_native_set_storage_file(const char *path) {
+  storage_path = path;
+}
+
+uint32_t hal_storage_open(FlashJournalIo *io) {
+  if (storage.empty()) {
+    storage.assign(HAL_NATIVE_STORAGE_SIZE, 0xFF);
+    if (storage_path) {
+      storage_file = fopen(storage_path, "r+b");
+      if (storage_file) {
+        size_t loaded = fread(&storage[0], 1, storage.size(), storage_file);
+        (void)loaded;  // A short file leaves the rest erased
+      } else {
+        storage_file = fopen(storage_path, "w+b");
+      }
+      if (!storage_file) {
+        log_e("Cannot open flash file %s", storage_path);
+        return 0;
+      }
+      storage_write_through(0, storage.size());
+    }
+  }
+
+  io->context = NULL;
+  io->read = storage_read;
+  io->program = storage_program;
+  io->erase_sector = storage_erase_sector;
+  return storage.size();
+}
+
+void hal_display_flush(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *pixels) {
+  for (int32_t row = 0; row < h; row++) {
+    int32_t py = y + row;
+    if (py < 0 || py >= LCD_HEIGHT) continue;
+    int32_t x0 = x < 0 ? 0 : x;
+    int32_t x1 = x + w > LCD_WIDTH ? LCD_WIDTH : x + w;
+    if (x1 <= x0) continue;
+    memcpy(&framebuffer[py * LCD_WIDTH + x0], &pixels[row * w + (x0 - x)], (x1 - x0) * sizeof(uint16_t));
+  }
+  flush_count++;
+  pixel_count += (uint64_t)w * h;
+}
+
+void hal_display_set_brightness(uint8_t level) {
+  backlight = level;
+}
+
+bool hal_touch_read(int16_t *x, int16_t *y) {
+  std::lock_guard<std::mutex> guard(touch_lock);
+  if (!touch_pressed) return false;
+  *x = touch_x;
+  *y = touch_y;
+  return true;
+}
+
+// Every change raises the simulated interrupt line
+bool hal_touch_irq_begin() {
+  return true;
+}
+
+bool hal_touch_irq_take() {
+  return touch_irq.exchange(false);
+}
+
+void hal_native_set_touch(bool pressed, int16_t x, int16_t y) {
+  std::lock_guard<std::mutex> guard(touch_lock);
+  touch_pressed = pressed;
+  touch_x = x;
+  touch_y = y;
+  touch_irq = true;
+}
+
+void hal_native_get_stats(HalNativeStats *stats) {
+  stats->flushes = flush_count;
+  stats->pixels = pixel_count;
+  stats->clips_played = clip_count;
+  stats->led_duty = led_duty;
+  stats->backlight = backlight;
+}
+
+const uint16_t *hal_native_framebuffer() {
+  return framebuffer;
+}
+
+bool hal_native_save_ppm(const char *path) {
+  FILE *f = fopen(path, "wb");
+  if (!f) return false;
+  fprintf(f, "P6\n%d %d\n255\n", LCD_WIDTH, LCD_HEIGHT);
+  std::vector<uint8_t> row(LCD_WIDTH * 3);
+  for (int y = 0; y < LCD_HEIGHT; y++) {
+    for (int x = 0; x < LCD_WIDTH; x++) {
+      uint16_t p = framebuffer[y * LCD_WIDTH + x];
+      p = (uint16_t)((p >> 8) | (p << 8));  // Panel order to RGB565
+      row[x * 3] = (uint8_t)(((p >> 11) & 0x1F) * 255 / 31);
+      row[x * 3 + 1] = (uint8_t)(((p >> 5) & 0x3F) * 255 / 63);
+      row[x * 3 + 2] = (uint8_t)((p & 0x1F) * 255 / 31);
+    }
+    fwrite(&row[0], 1, row.size(), f);
+  }
+  return fclose(f) == 0;
+}
+
+#endif  // !ESP_PLATFORM
@@ -0,0 +1,42 @@
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+// FreeRTOS subset for the Linux host build (see Arduino.h).
+// Tasks are detached threads, a tick is one millisecond and priorities and core
+// affinity are accepted but ignored: the host scheduler decides.
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskIDLE_PRIORITY 0
+#define configMAX_PRIORITIES 25
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+// Critical sections are a spinlock shared by every thread (there is no interrupt
+// masking to emulate); keep them as short as on the device
+struct portMUX_TYPE {
+  volatile int locked;
+};
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+void host_mux_lock(portMUX_TYPE *mux);
+void host_mux_unlock(portMUX_TYPE *mux);
+
+#define portENTER_CRITICAL(mux) host_mux_lock(mux)
+#define portEXIT_CRITICAL(mux) host_mux_unlock(mux)
+#define portENTER_CRITICAL_ISR(mux) host_mux_lock(mux)
+#define portEXIT_CRITICAL_ISR(mux) host_mux_unlock(mux)
+
+#endif  // __HOST_FREERTOS_H__
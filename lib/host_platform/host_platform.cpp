@@ -0,0 +1,428 @@
+
+#include <Arduino.h>
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock HostClock;
+
+static HostClock::time_point start_time() {
+  static const HostClock::time_point start = HostClock::now();
+  return start;
+}
+
+static int64_t host_time_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(HostClock::now() - start_time()).count();
+}
+
+static void sleep_ms(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+unsigned long millis() {
+  return (unsigned long)(uint32_t)(host_time_us() / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)(uint32_t)host_time_us();
+}
+
+void delay(uint32_t ms) {
+  sleep_ms(ms);
+}
+
+void yield() {
+  sched_yield();
+}
+
+// Print / Serial
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (n < size && write(buffer[n])) n++;
+  return n;
+}
+
+size_t Print::println(const char *text) {
+  size_t n = write(text);
+  return n + write((const uint8_t *)"\r\n", 2);
+}
+
+size_t Print::printf(const char *format, ...) {
+  char line[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (length < 0) return 0;
+  if ((size_t)length < sizeof(line)) return write((const uint8_t *)line, length);
+
+  std::vector<char> big(length + 1);
+  va_start(args, format);
+  vsnprintf(big.data(), big.size(), format, args);
+  va_end(args);
+  return write((const uint8_t *)big.data(), length);
+}
+
+HardwareSerial Serial;
+
+void HardwareSerial::flush() {
+  fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  size_t n = fwrite(buffer, 1, size, stdout);
+  fflush(stdout);
+  return n;
+}
+
+// Critical sections
+
+void host_mux_lock(portMUX_TYPE *mux) {
+  while (__atomic_exchange_n(&mux->locked, 1, __ATOMIC_ACQUIRE)) sched_yield();
+}
+
+void host_mux_unlock(portMUX_TYPE *mux) {
+  __atomic_store_n(&mux->locked, 0, __ATOMIC_RELEASE);
+}
+
+// Tasks
+
+struct HostTask {
+  std::mutex lock;
+  std::condition_variable notified;
+  uint32_t notify_count;
+  TaskFunction_t function;
+  void *arg;
+};
+
+static thread_local HostTask *current_task = NULL;
+
+static void *task_entry(void *context) {
+  current_task = (HostTask *)context;
+  current_task->function(current_task->arg);
+  return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stack_size, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+  (void)name;
+  (void)stack_size;  // Host stacks are much larger than any task needs
+  (void)priority;
+  (void)core;
+  HostTask *host_task = new HostTask();
+  host_task->notify_count = 0;
+  host_task->function = task;
+  host_task->arg = arg;
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  pthread_t thread;
+  int rc = pthread_create(&thread, &attr, task_entry, host_task);
+  pthread_attr_destroy(&attr);
+  if (rc != 0) {
+    delete host_task;
+    return pdFAIL;
+  }
+  if (handle) *handle = host_task;
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char *name, uint32_t stack_size, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle) {
+  return xTaskCreatePinnedToCore(task, name, stack_size, arg, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (task == NULL || task == current_task) pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t ticks) {
+  sleep_ms(ticks);
+}
+
+void vTaskDelayUntil(TickType_t *previous_wake, TickType_t period) {
+  *previous_wake += period;
+  int32_t remaining = (int32_t)(*previous_wake - xTaskGetTickCount());
+  if (remaining > 0) sleep_ms(remaining);
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  // Threads not started by xTaskCreate (the main thread) get a handle on first use
+  if (!current_task) {
+    current_task = new HostTask();
+    current_task->notify_count = 0;
+    current_task->function = NULL;
+    current_task->arg = NULL;
+  }
+  return current_task;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  (void)task;
+  return 0;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t timeout) {
+  HostTask *task = xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> guard(task->lock);
+  if (timeout == portMAX_DELAY) {
+    task->notified.wait(guard, [task] { return task->notify_count > 0; });
+  } else {
+    task->notified.wait_for(guard, std::chrono::milliseconds(timeout), [task] { return task->notify_count > 0; });
+  }
+  uint32_t count = task->notify_count;
+  if (count) task->notify_count = clear_on_exit ? 0 : count - 1;
+  return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  {
+    std::lock_guard<std::mutex> guard(task->lock);
+    task->notify_count++;
+  }
+  task->notified.notify_one();
+  return pdPASS;
+}
+
+// Queues
+
+struct HostQueue {
+  std::mutex lock;
+  std::condition_variable changed;
+  std::vector<uint8_t> items;
+  UBaseType_t length;
+  UBaseType_t item_size;
+  UBaseType_t head;
+  UBaseType_t count;
+};
+
+// Wait on a condition variable for at most timeout ticks (portMAX_DELAY: forever)
+template <typename Predicate>
+static bool wait_ticks(std::condition_variable &cv, std::unique_lock<std::mutex> &guard, TickType_t timeout,
+                       Predicate ready) {
+  if (timeout == portMAX_DELAY) {
+    cv.wait(guard, ready);
+    return true;
+  }
+  return cv.wait_for(guard, std::chrono::milliseconds(timeout), ready);
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  if (!length || !item_size) return NULL;
+  HostQueue *queue = new HostQueue();
+  queue->items.resize((size_t)length * item_size);
+  queue->length = length;
+  queue->item_size = item_size;
+  queue->head = 0;
+  queue->count = 0;
+  return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t timeout) {
+  std::unique_lock<std::mutex> guard(queue->lock);
+  if (!wait_ticks(queue->changed, guard, timeout, [queue] { return queue->count < queue->length; })) {
+    return pdFALSE;
+  }
+  UBaseType_t tail = (queue->head + queue->count) % queue->length;
+  memcpy(&queue->items[(size_t)tail * queue->item_size], item, queue->item_size);
+  queue->count++;
+  guard.unlock();
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t timeout) {
+  std::unique_lock<std::mutex> guard(queue->lock);
+  if (!wait_ticks(queue->changed, guard, timeout, [queue] { return queue->count > 0; })) {
+    return pdFALSE;
+  }
+  memcpy(item, &queue->items[(size_t)queue->head * queue->item_size], queue->item_size);
+  queue->head = (queue->head + 1) % queue->length;
+  queue->count--;
+  guard.unlock();
+  queue->changed.notify_all();
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> guard(queue->lock);
+  return queue->count;
+}
+
+// Mutexes
+
+struct HostSemaphore {
+  std::timed_mutex mutex;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return new HostSemaphore();
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t timeout) {
+  if (timeout == portMAX_DELAY) {
+    semaphore->mutex.lock();
+    return pdTRUE;
+  }
+  return semaphore->mutex.try_lock_for(std::chrono::milliseconds(timeout)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  semaphore->mutex.unlock();
+  return pdTRUE;
+}
+
+// esp_timer
+
+struct HostTimer {
+  esp_timer_cb_t callback;
+  void *arg;
+  bool armed;
+  int64_t due_us;
+  uint64_t period_us;   // 0 for one-shot
+};
+
+static std::mutex timers_lock;
+static std::condition_variable timers_changed;
+static std::vector<HostTimer *> timers;
+static bool dispatcher_started = false;
+
+static void *timer_dispatcher(void *arg) {
+  (void)arg;
+  std::unique_lock<std::mutex> guard(timers_lock);
+  for (;;) {
+    HostTimer *next = NULL;
+    for (size_t i = 0; i < timers.size(); i++) {
+      if (timers[i]->armed && (!next || timers[i]->due_us < next->due_us)) next = timers[i];
+    }
+    if (!next) {
+      timers_changed.wait(guard);
+      continue;
+    }
+    if (next->due_us > host_time_us()) {
+      timers_changed.wait_until(guard, start_time() + std::chrono::microseconds(next->due_us));
+      continue;  // Timers may have changed while waiting
+    }
+
+    if (next->period_us) {
+      next->due_us += next->period_us;
+    } else {
+      next->armed = false;
+    }
+    esp_timer_cb_t callback = next->callback;
+    void *callback_arg = next->arg;
+    guard.unlock();
+    callback(callback_arg);
+    guard.lock();
+  }
+  return NULL;
+}
+
+int64_t esp_timer_get_time() {
+  return host_time_us();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *timer) {
+  if (!args || !args->callback || !timer) return ESP_ERR_INVALID_ARG;
+  HostTimer *host_timer = new HostTimer();
+  host_timer->callback = args->callback;
+  host_timer->arg = args->arg;
+  host_timer->armed = false;
+  host_timer->due_us = 0;
+  host_timer->period_us = 0;
+
+  std::lock_guard<std::mutex> guard(timers_lock);
+  if (!dispatcher_started) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, timer_dispatcher, NULL) != 0) {
+      delete host_timer;
+      return ESP_ERR_NO_MEM;
+    }
+    pthread_detach(thread);
+    dispatcher_started = true;
+  }
+  timers.push_back(host_timer);
+  *timer = host_timer;
+  return ESP_OK;
+}
+
+static esp_err_t timer_arm(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us) {
+  {
+    std::lock_guard<std::mutex> guard(timers_lock);
+    if (timer->armed) return ESP_ERR_INVALID_STATE;
+    timer->armed = true;
+    timer->due_us = host_time_us() + (int64_t)timeout_us;
+    timer->period_us = period_us;
+  }
+  timers_changed.notify_all();
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+  return timer_arm(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+  return timer_arm(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  std::lock_guard<std::mutex> guard(timers_lock);
+  if (!timer->armed) return ESP_ERR_INVALID_STATE;
+  timer->armed = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+  std::lock_guard<std::mutex> guard(timers_lock);
+  if (timer->armed) return ESP_ERR_INVALID_STATE;
+  for (size_t i = 0; i < timers.size(); i++) {
+    if (timers[i] == timer) {
+      timers.erase(timers.begin() + i);
+      break;
+    }
+  }
+  delete timer;
+  return ESP_OK;
+}
+
+// Heap capabilities
+
+void *heap_caps_malloc(size_t size, uint32_t caps) {
+  (void)caps;
+  return malloc(size);
+}
+
+void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps) {
+  (void)caps;
+  void *p = NULL;
+  return posix_memalign(&p, alignment < sizeof(void *) ? sizeof(void *) : alignment, size) == 0 ? p : NULL;
+}
+
+void heap_caps_free(void *p) {
+  free(p);
+}
@@ -0,0 +1,114 @@
+#include "led_pattern.hpp"
+#include "hal.hpp"
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <string.h>
+
+struct LedRequest {
+    bool active;
+    uint8_t priority;
+    LedPattern pattern;
+};
+
+static LedRequest requests[LED_PATTERN_SOURCES];
+
+// Shared between the caller and the timer task. All LED writes happen in the timer
+// callback, so they are serialised and never race a running hardware fade.
+static LedPattern shown_pattern;       // Pattern on the LED (kind OFF when dark)
+static LedPattern next_pattern;        // Pattern to switch to at the next transition
+static bool pending_switch = false;
+static bool phase_on = false;          // Blink: LED lit / Pulse: fading up
+static esp_timer_handle_t transition_timer = NULL;
+static portMUX_TYPE led_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool initialized = false;
+
+static bool same_pattern(const LedPattern &a, const LedPattern &b) {
+    return a.kind == b.kind && a.brightness == b.brightness && a.on_ms == b.on_ms && a.off_ms == b.off_ms;
+}
+
+// Runs only at pattern transitions (blink edge, fade reversal, pattern switch)
+static void transition_cb(void *arg) {
+    (void)arg;
+    portENTER_CRITICAL(&led_lock);
+    if (pending_switch) {
+        shown_pattern = next_pattern;
+        pending_switch = false;
+        phase_on = true;
+    } else {
+        phase_on = !phase_on;
+    }
+    LedPattern pattern = shown_pattern;
+    bool on = phase_on;
+    portEXIT_CRITICAL(&led_lock);
+
+    if (pattern.kind == LED_PATTERN_OFF || pattern.kind == LED_PATTERN_SOLID) {
+        hal_led_set(pattern.kind == LED_PATTERN_SOLID ? pattern.brightness : 0);
+        return;
+    }
+
+    uint16_t phase_ms = on ? pattern.on_ms : pattern.off_ms;
+    if (pattern.kind == LED_PATTERN_BLINK) {
+        hal_led_set(on ? pattern.brightness : 0);
+    } else {
+        // Hardware fade: the PWM steps the duty itself for the whole phase
+        hal_led_fade(on ? pattern.brightness : 0, phase_ms);
+    }
+    esp_timer_start_once(transition_timer, (uint64_t)(phase_ms ? phase_ms : 1) * 1000);
+}
+
+// Pick the highest-priority request and hand it to the timer task if the winner changed
+static void arbitrate() {
+    int winner = -1;
+    for (int i = 0; i < LED_PATTERN_SOURCES; i++) {
+        if (!requests[i].active || requests[i].pattern.kind == LED_PATTERN_OFF) continue;
+        if (winner < 0 || requests[i].priority > requests[winner].priority) winner = i;
+    }
+
+    LedPattern pattern;
+    memset(&pattern, 0, sizeof(pattern));
+    if (winner >= 0) pattern = requests[winner].pattern;
+
+    portENTER_CRITICAL(&led_lock);
+    bool changed = !same_pattern(pending_switch ? next_pattern : shown_pattern, pattern);
+    next_pattern = pattern;
+    pending_switch = pending_switch || changed;
+    // A running fade cannot be stopped, so a pulse switches when its current phase ends
+    bool wait_for_fade = shown_pattern.kind == LED_PATTERN_PULSE;
+    portEXIT_CRITICAL(&led_lock);
+
+    if (!changed || wait_for_fade) return;
+    esp_timer_stop(transition_timer);
+    while (esp_timer_start_once(transition_timer, 1) != ESP_OK) {
+        esp_timer_stop(transition_timer);  // Re-armed by a callback that was already running
+    }
+}
+
+bool led_pattern_init() {
+    if (!hal_led_begin()) return false;
+
+    esp_timer_create_args_t timer_args;
+    memset(&timer_args, 0, sizeof(timer_args));
+    timer_args.callback = transition_cb;
+    timer_args.name = "led_pattern";
+    if (esp_timer_create(&timer_args, &transition_timer) != ESP_OK) return false;
+
+    initialized = true;
+    return true;
+}
+
+void led_pattern_request(uint8_t source, const LedPattern &pattern, uint8_t priority) {
+    if (!initialized || source >= LED_PATTERN_SOURCES) return;
+    LedRequest &request = requests[source];
+    if (request.active && request.priority == priority && same_pattern(request.pattern, pattern)) return;
+
+    request.active = true;
+    request.priority = priority;
+    request.pattern = pattern;
+    arbitrate();
+}
+
+void led_pattern_release(uint8_t source) {
+    if (!initialized || source >= LED_PATTERN_SOURCES || !requests[source].active) return;
+    requests[source].active = false;
+    arbitrate();
+}
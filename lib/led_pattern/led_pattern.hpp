@@ -0,0 +1,36 @@
+#ifndef __LED_PATTERN_H__
+#define __LED_PATTERN_H__
+
+#include <stdint.h>
+
+// Non-blocking LED pattern driver.
+// The LED is driven through the HAL PWM (LEDC on the device). Solid patterns are a fixed
+// duty, pulses are hardware fades and blinks are duty steps. A one-shot esp_timer fires only at
+// pattern transitions (blink edge, fade reversal), so nothing runs in between.
+// Any number of sources (one per alert rule) can request a pattern with a priority; the
+// highest-priority request is shown and the LED only changes when the winner changes.
+
+#define LED_PATTERN_SOURCES 8
+
+enum LedPatternKind {
+  LED_PATTERN_OFF = 0,
+  LED_PATTERN_SOLID,  // Constant brightness
+  LED_PATTERN_BLINK,  // on_ms at brightness, off_ms dark
+  LED_PATTERN_PULSE   // Fade up over on_ms, fade down over off_ms
+};
+
+struct LedPattern {
+  uint8_t kind;        // LedPatternKind
+  uint8_t brightness;  // Peak duty (0-255)
+  uint16_t on_ms;
+  uint16_t off_ms;
+};
+
+bool led_pattern_init();
+
+// Request a pattern for a source (higher priority wins, ties go to the lower source).
+// Re-requesting the same pattern is cheap and does not restart it.
+void led_pattern_request(uint8_t source, const LedPattern &pattern, uint8_t priority);
+void led_pattern_release(uint8_t source);
+
+#endif  // __LED_PATTERN_H__
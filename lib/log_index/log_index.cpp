@@ -0,0 +1,233 @@
+
+#include "log_index.hpp"
+#include <esp_heap_caps.h>
+#include <string.h>
+
+static uint32_t level_size(const LogIndex *index, int k) {
+  uint32_t size = index->blocks;
+  while (k--) size /= LOG_INDEX_FANOUT;
+  return size;
+}
+
+static int level_shift(int k) {
+  int shift = 0;
+  for (uint32_t span = LOG_INDEX_FANOUT; span > 1; span >>= 1) shift++;
+  return shift * k;
+}
+
+// Entry j of level k, or NULL if its slot holds another (or no) entry
+static const LogSummary *entry(const LogIndex *index, int k, uint32_t j) {
+  const LogSummary *e = &index->level[k][j % level_size(index, k)];
+  return e->seq == (j << level_shift(k)) ? e : NULL;
+}
+
+static void summary_merge(LogSummary *into, const LogSummary *from) {
+  if (from->min != LOG_INDEX_NO_DATA) {
+    if (into->min == LOG_INDEX_NO_DATA || from->min < into->min) into->min = from->min;
+    if (into->max == LOG_INDEX_NO_DATA || from->max > into->max) into->max = from->max;
+  }
+  if (from->start_s < into->start_s) into->start_s = from->start_s;
+  if (from->end_s > into->end_s) into->end_s = from->end_s;
+  into->sum += from->sum;
+  into->samples += from->samples;
+}
+
+// Store e unless its slot already holds a newer entry
+static bool store(LogIndex *index, int k, const LogSummary *e) {
+  LogSummary *slot = &index->level[k][(e->seq >> level_shift(k)) % level_size(index, k)];
+  if (slot->seq != LOG_INDEX_EMPTY && slot->seq > e->seq) return false;
+  *slot = *e;
+  return true;
+}
+
+bool log_index_init(LogIndex *index, uint32_t blocks) {
+  memset(index, 0, sizeof(*index));
+  index->blocks = blocks;
+  index->oldest_seq = LOG_INDEX_EMPTY;
+  index->lock = xSemaphoreCreateMutex();
+  if (!index->lock) return false;
+
+  for (uint32_t size = blocks; size; size /= LOG_INDEX_FANOUT) {
+    if (index->levels == LOG_INDEX_MAX_LEVELS) return false;
+    size_t bytes = size * sizeof(LogSummary);
+    LogSummary *level = (LogSummary *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!level) level = (LogSummary *)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    if (!level) return false;
+    memset(level, 0xFF, bytes);  // seq = LOG_INDEX_EMPTY
+    index->level[index->levels++] = level;
+    if (size == 1) break;
+  }
+  return true;
+}
+
+void log_index_add(LogIndex *index, const LogSummary *block) {
+  xSemaphoreTake(index->lock, portMAX_DELAY);
+  if (store(index, 0, block)) {
+    if (index->oldest_seq == LOG_INDEX_EMPTY || block->seq < index->oldest_seq) index->oldest_seq = block->seq;
+    if (block->seq + 1 > index->next_seq) index->next_seq = block->seq + 1;
+
+    // Rebuild each ancestor from its children that are still in the ring
+    for (int k = 1; k < index->levels; k++) {
+      uint32_t j = block->seq >> level_shift(k);
+      LogSummary parent = {j << level_shift(k), UINT32_MAX, 0, LOG_INDEX_NO_DATA, LOG_INDEX_NO_DATA, 0, 0};
+      for (uint32_t child = j * LOG_INDEX_FANOUT; child < (j + 1) * LOG_INDEX_FANOUT; child++) {
+        const LogSummary *e = entry(index, k - 1, child);
+        if (e) summary_merge(&parent, e);
+      }
+      if (!store(index, k, &parent)) break;
+    }
+    index->generation++;
+  }
+  xSemaphoreGive(index->lock);
+}
+
+// Blocks that can still be in the ring: [first, index->next_seq)
+static uint32_t first_live_seq(const LogIndex *index) {
+  uint32_t first = index->next_seq > index->blocks ? index->next_seq - index->blocks : 0;
+  return index->oldest_seq > first ? index->oldest_seq : first;
+}
+
+// First level 0 entry at or after seq that is still indexed, hi if none before hi
+static uint32_t next_valid(const LogIndex *index, uint32_t seq, uint32_t hi) {
+  while (seq < hi && !entry(index, 0, seq)) seq++;
+  return seq;
+}
+
+// First block in [lo, hi) whose end (or start, by_start) is at or after t_s. Damaged or
+// missing blocks in between are skipped, so this stays O(log n) for a healthy ring.
+static uint32_t search_time(const LogIndex *index, uint32_t lo, uint32_t hi, uint32_t t_s, bool by_start) {
+  uint32_t found = hi;
+  while (lo < hi) {
+    uint32_t mid = next_valid(index, lo + (hi - lo) / 2, hi);
+    if (mid == hi) {
+      hi = lo + (hi - lo) / 2;
+      continue;
+    }
+    const LogSummary *e = entry(index, 0, mid);
+    if ((by_start ? e->start_s : e->end_s) >= t_s) {
+      found = mid;
+      hi = lo + (hi - lo) / 2;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return found;
+}
+
+static bool find_blocks(const LogIndex *index, uint32_t start_s, uint32_t end_s, uint32_t *first, uint32_t *last) {
+  if (index->oldest_seq == LOG_INDEX_EMPTY || end_s <= start_s) return false;
+  uint32_t lo = first_live_seq(index);
+  uint32_t hi = index->next_seq;
+  *first = search_time(index, lo, hi, start_s, false);
+  uint32_t after = search_time(index, *first, hi, end_s, true);
+  if (after == *first) return false;
+  *last = after - 1;
+  return true;
+}
+
+bool log_index_range(LogIndex *index, uint32_t *start_s, uint32_t *end_s) {
+  xSemaphoreTake(index->lock, portMAX_DELAY);
+  bool found = false;
+  if (index->oldest_seq != LOG_INDEX_EMPTY) {
+    uint32_t first = next_valid(index, first_live_seq(index), index->next_seq);
+    const LogSummary *newest = entry(index, 0, index->next_seq - 1);
+    if (first < index->next_seq && newest) {
+      *start_s = entry(index, 0, first)->start_s;
+      *end_s = newest->end_s;
+      found = true;
+    }
+  }
+  xSemaphoreGive(index->lock);
+  return found;
+}
+
+bool log_index_find_blocks(LogIndex *index, uint32_t start_s, uint32_t end_s,
+                           uint32_t *first_seq, uint32_t *last_seq) {
+  xSemaphoreTake(index->lock, portMAX_DELAY);
+  bool found = find_blocks(index, start_s, end_s, first_seq, last_seq);
+  xSemaphoreGive(index->lock);
+  return found;
+}
+
+void log_columns_clear(LogColumn *columns, int count) {
+  for (int i = 0; i < count; i++) {
+    columns[i].min = columns[i].max = columns[i].mean = LOG_INDEX_NO_DATA;
+    columns[i].samples = 0;
+    columns[i].sum = 0;
+  }
+}
+
+void log_column_add(LogColumn *column, int16_t value) {
+  if (value == LOG_INDEX_NO_DATA) return;
+  if (column->min == LOG_INDEX_NO_DATA || value < column->min) column->min = value;
+  if (column->max == LOG_INDEX_NO_DATA || value > column->max) column->max = value;
+  column->sum += value;
+  column->samples++;
+}
+
+void log_columns_finish(LogColumn *columns, int count) {
+  for (int i = 0; i < count; i++) {
+    if (columns[i].samples) columns[i].mean = (int16_t)(columns[i].sum / (int64_t)columns[i].samples);
+  }
+}
+
+// Merge entry j of level k into the columns it overlaps. Once the ring has wrapped, the
+// entry holding the oldest blocks has been replaced by a newer one, so its children
+// still in [first, last] are merged instead.
+static bool query_merge(const LogIndex *index, int k, uint32_t j, uint32_t first, uint32_t last,
+                        uint32_t start_s, uint32_t end_s, LogColumn *columns, int count) {
+  const LogSummary *e = entry(index, k, j);
+  if (!e) {
+    if (k == 0) return false;
+    uint32_t lo = first >> level_shift(k - 1), hi = last >> level_shift(k - 1);
+    bool any = false;
+    for (uint32_t child = j * LOG_INDEX_FANOUT; child < (j + 1) * LOG_INDEX_FANOUT; child++) {
+      if (child >= lo && child <= hi && query_merge(index, k - 1, child, first, last, start_s, end_s, columns, count)) {
+        any = true;
+      }
+    }
+    return any;
+  }
+  if (!e->samples || e->end_s < start_s || e->start_s >= end_s) return false;
+
+  uint64_t span = end_s - start_s;
+  uint32_t from = e->start_s > start_s ? e->start_s : start_s;
+  uint32_t to = e->end_s < end_s ? e->end_s : end_s - 1;
+  int c0 = (int)((from - start_s) * (uint64_t)count / span);
+  int c1 = (int)((to - start_s) * (uint64_t)count / span);
+  for (int c = c0; c <= c1; c++) {
+    LogColumn &column = columns[c];
+    if (column.min == LOG_INDEX_NO_DATA || e->min < column.min) column.min = e->min;
+    if (column.max == LOG_INDEX_NO_DATA || e->max > column.max) column.max = e->max;
+    column.sum += e->sum;
+    column.samples += e->samples;
+  }
+  return true;
+}
+
+int log_index_query(LogIndex *index, uint32_t start_s, uint32_t end_s, LogColumn *columns, int count) {
+  log_columns_clear(columns, count);
+
+  xSemaphoreTake(index->lock, portMAX_DELAY);
+  uint32_t first, last;
+  if (!find_blocks(index, start_s, end_s, &first, &last)) {
+    xSemaphoreGive(index->lock);
+    return -1;
+  }
+
+  // Finest level with at most LOG_INDEX_OVERSAMPLE entries per column
+  int k = 0;
+  while (k + 1 < index->levels &&
+         (last >> level_shift(k)) - (first >> level_shift(k)) + 1 > (uint32_t)count * LOG_INDEX_OVERSAMPLE) {
+    k++;
+  }
+
+  bool any = false;
+  for (uint32_t j = first >> level_shift(k); j <= last >> level_shift(k); j++) {
+    if (query_merge(index, k, j, first, last, start_s, end_s, columns, count)) any = true;
+  }
+  xSemaphoreGive(index->lock);
+
+  log_columns_finish(columns, count);
+  return any ? k : -1;
+}
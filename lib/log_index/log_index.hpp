@@ -0,0 +1,80 @@
+#ifndef __LOG_INDEX_H__
+#define __LOG_INDEX_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+// Multi-resolution time index over the blocks of the sample log.
+// Level 0 holds one summary (time range, min/max/sum) per log block; every level above
+// merges LOG_INDEX_FANOUT entries of the one below, up to a single entry for the whole
+// ring. Entry j of level k covers blocks [j * FANOUT^k, (j + 1) * FANOUT^k) and lives in
+// slot j % (blocks / FANOUT^k), so each level is a ring that wraps with the log itself.
+//
+// A query for a time window picks the finest level that has at most a few entries per
+// output column, so drawing any window, from one block up to the whole ring, reads
+// O(columns) summaries and never touches the log on flash. After the ring wraps, a
+// coarse entry whose first blocks were overwritten is gone; the query merges its
+// remaining children instead, at most FANOUT per level for the oldest entry.
+
+#define LOG_INDEX_FANOUT 8
+#define LOG_INDEX_MAX_LEVELS 6             // Enough for 8^5 = 32768 blocks
+#define LOG_INDEX_OVERSAMPLE 2             // Entries per column a query may merge
+#define LOG_INDEX_EMPTY UINT32_MAX         // Slot never filled
+#define LOG_INDEX_NO_DATA INT16_MIN        // Column or entry without valid readings
+
+// Values are tenths of a degree Celsius, times are seconds on the sample log timeline
+struct LogSummary {
+  uint32_t seq;       // First block covered (entry j of level k: j * FANOUT^k)
+  uint32_t start_s;
+  uint32_t end_s;
+  int16_t min;
+  int16_t max;
+  int64_t sum;
+  uint32_t samples;
+};
+
+struct LogColumn {
+  int16_t min;        // LOG_INDEX_NO_DATA when nothing falls into the column
+  int16_t max;
+  int16_t mean;
+  uint32_t samples;
+  int64_t sum;
+};
+
+struct LogIndex {
+  uint32_t blocks;                          // Ring capacity (a power of LOG_INDEX_FANOUT)
+  int levels;
+  LogSummary *level[LOG_INDEX_MAX_LEVELS];  // blocks / FANOUT^k entries each
+  uint32_t oldest_seq;                      // Lowest block added, LOG_INDEX_EMPTY if none
+  uint32_t next_seq;                        // Newest block added + 1
+  volatile uint32_t generation;             // Bumped by every log_index_add()
+  SemaphoreHandle_t lock;
+};
+
+// Allocate the levels (PSRAM when available). blocks must be a power of LOG_INDEX_FANOUT.
+bool log_index_init(LogIndex *index, uint32_t blocks);
+
+// Add or replace the level 0 summary of block->seq and update its parents, O(levels).
+// An entry is never replaced by an older block, so blocks may arrive in any order.
+void log_index_add(LogIndex *index, const LogSummary *block);
+
+// Time covered by the index (false when empty)
+bool log_index_range(LogIndex *index, uint32_t *start_s, uint32_t *end_s);
+
+// Blocks overlapping [start_s, end_s) (false when none)
+bool log_index_find_blocks(LogIndex *index, uint32_t start_s, uint32_t end_s,
+                           uint32_t *first_seq, uint32_t *last_seq);
+
+// Merge [start_s, end_s) into count equal-width columns. Returns the level used, or -1
+// when the window holds no data. Entries are merged whole, so a coarse entry that straddles
+// a column edge contributes to every column it overlaps.
+int log_index_query(LogIndex *index, uint32_t start_s, uint32_t end_s, LogColumn *columns, int count);
+
+// Merge one reading into a column (used when columns are filled from raw blocks)
+void log_column_add(LogColumn *column, int16_t value);
+
+// Reset columns to empty / compute the means after log_column_add()
+void log_columns_clear(LogColumn *columns, int count);
+void log_columns_finish(LogColumn *columns, int count);
+
+#endif  // __LOG_INDEX_H__
@@ -0,0 +1,202 @@
+
+#include "lvgl_heap.hpp"
+#include "debug_log.hpp"
+#include "lvgl.h"
+#include <Arduino.h>
+#include <string.h>
+
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM
+
+#include <multi_heap.h>
+
+// Each region is a multi_heap (TLSF on ESP-IDF 5) guarded by its own spinlock, since
+// the LVGL draw threads allocate layer buffers concurrently with the UI task
+struct LvglHeapRegion {
+    multi_heap_handle_t heap;
+    uint8_t *base;
+    size_t size;
+    portMUX_TYPE lock;
+};
+
+static uint8_t internal_pool[LVGL_HEAP_INTERNAL_SIZE] __attribute__((aligned(8)));
+
+static LvglHeapRegion internal_region = {NULL, NULL, 0, portMUX_INITIALIZER_UNLOCKED};
+static LvglHeapRegion psram_region = {NULL, NULL, 0, portMUX_INITIALIZER_UNLOCKED};
+
+static volatile uint32_t spill_count = 0;
+static volatile uint32_t fail_count = 0;
+
+static bool region_register(LvglHeapRegion *region, void *mem, size_t size) {
+    region->heap = multi_heap_register(mem, size);
+    if (!region->heap) return false;
+    multi_heap_set_lock(region->heap, &region->lock);
+    region->base = (uint8_t *)mem;
+    region->size = size;
+    return true;
+}
+
+static LvglHeapRegion *region_of(void *p) {
+    uint8_t *addr = (uint8_t *)p;
+    if (internal_region.heap && addr >= internal_region.base && addr < internal_region.base + internal_region.size) {
+        return &internal_region;
+    }
+    if (psram_region.heap && addr >= psram_region.base && addr < psram_region.base + psram_region.size) {
+        return &psram_region;
+    }
+    return NULL;
+}
+
+static void region_stats(const LvglHeapRegion *region, LvglHeapRegionStats *out) {
+    memset(out, 0, sizeof(*out));
+    if (!region->heap) return;
+
+    multi_heap_info_t info;
+    multi_heap_get_info(region->heap, &info);
+    out->total = region->size;
+    out->used = info.total_allocated_bytes;
+    out->free = info.total_free_bytes;
+    out->largest_free = info.largest_free_block;
+    out->min_free = info.minimum_free_bytes;
+    out->frag_pct = out->free ? (uint8_t)(100 - (out->largest_free * 100) / out->free) : 0;
+}
+
+// LVGL custom stdlib hooks (see lv_mem.h)
+void lv_mem_init(void) {
+    if (!region_register(&internal_region, internal_pool, sizeof(internal_pool))) {
+        log_e("Failed to register LVGL internal heap");
+    }
+
+#if LVGL_HEAP_PSRAM_SIZE > 0
+    void *psram = heap_caps_malloc(LVGL_HEAP_PSRAM_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!psram || !region_register(&psram_region, psram, LVGL_HEAP_PSRAM_SIZE)) {
+        log_w("LVGL PSRAM spill region unavailable");
+        if (psram) heap_caps_free(psram);
+    }
+#endif
+}
+
+void lv_mem_deinit(void) {
+    // Regions live for the whole uptime
+}
+
+lv_mem_pool_t lv_mem_add_pool(void *mem, size_t bytes) {
+    LV_UNUSED(mem);
+    LV_UNUSED(bytes);
+    return NULL;
+}
+
+void lv_mem_remove_pool(lv_mem_pool_t pool) {
+    LV_UNUSED(pool);
+}
+
+void *lv_malloc_core(size_t size) {
+    void *p = internal_region.heap ? multi_heap_malloc(internal_region.heap, size) : NULL;
+    if (!p && psram_region.heap) {
+        p = multi_heap_malloc(psram_region.heap, size);
+        if (p) spill_count++;
+    }
+    if (!p) fail_count++;
+    return p;
+}
+
+void *lv_realloc_core(void *p, size_t new_size) {
+    if (!p) return lv_malloc_core(new_size);
+
+    LvglHeapRegion *region = region_of(p);
+    if (!region) return NULL;
+
+    void *resized = multi_heap_realloc(region->heap, p, new_size);
+    if (resized) return resized;
+
+    // Region is full: move the block to wherever lv_malloc_core can place it
+    size_t old_size = multi_heap_get_allocated_size(region->heap, p);
+    void *moved = lv_malloc_core(new_size);
+    if (!moved) return NULL;
+    memcpy(moved, p, old_size < new_size ? old_size : new_size);
+    multi_heap_free(region->heap, p);
+    return moved;
+}
+
+void lv_free_core(void *p) {
+    LvglHeapRegion *region = region_of(p);
+    if (region) multi_heap_free(region->heap, p);
+}
+
+void lv_mem_monitor_core(lv_mem_monitor_t *mon_p) {
+    LvglHeapStats stats;
+    lvgl_heap_get_stats(&stats);
+
+    size_t total = stats.internal.total + stats.psram.total;
+    mon_p->total_size = total;
+    mon_p->free_size = stats.internal.free + stats.psram.free;
+    mon_p->free_biggest_size = stats.internal.largest_free > stats.psram.largest_free ?
+                               stats.internal.largest_free : stats.psram.largest_free;
+    mon_p->max_used = total - (stats.internal.min_free + stats.psram.min_free);
+    mon_p->used_pct = total ? (uint8_t)(((total - mon_p->free_size) * 100) / total) : 0;
+    mon_p->frag_pct = mon_p->free_size ?
+                      (uint8_t)(100 - (mon_p->free_biggest_size * 100) / mon_p->free_size) : 0;
+
+    multi_heap_info_t info;
+    mon_p->free_cnt = 0;
+    mon_p->used_cnt = 0;
+    if (internal_region.heap) {
+        multi_heap_get_info(internal_region.heap, &info);
+        mon_p->free_cnt += info.free_blocks;
+        mon_p->used_cnt += info.allocated_blocks;
+    }
+    if (psram_region.heap) {
+        multi_heap_get_info(psram_region.heap, &info);
+        mon_p->free_cnt += info.free_blocks;
+        mon_p->used_cnt += info.allocated_blocks;
+    }
+}
+
+lv_result_t lv_mem_test_core(void) {
+    if (internal_region.heap && !multi_heap_check(internal_region.heap, true)) return LV_RESULT_INVALID;
+    if (psram_region.heap && !multi_heap_check(psram_region.heap, true)) return LV_RESULT_INVALID;
+    return LV_RESULT_OK;
+}
+
+void lvgl_heap_get_stats(LvglHeapStats *stats) {
+    region_stats(&internal_region, &stats->internal);
+    region_stats(&psram_region, &stats->psram);
+    stats->spill_count = spill_count;
+    stats->fail_count = fail_count;
+}
+
+#elif LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+
+// Host build: LVGL's own pool of LV_MEM_SIZE bytes, reported as the internal region
+void lvgl_heap_get_stats(LvglHeapStats *stats) {
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    memset(stats, 0, sizeof(*stats));
+    stats->internal.total = mon.total_size;
+    stats->internal.used = mon.total_size - mon.free_size;
+    stats->internal.free = mon.free_size;
+    stats->internal.largest_free = mon.free_biggest_size;
+    stats->internal.min_free = mon.total_size - mon.max_used;
+    stats->internal.frag_pct = mon.frag_pct;
+}
+
+#endif
+
+void lvgl_heap_log_stats(void) {
+    LvglHeapStats stats;
+    lvgl_heap_get_stats(&stats);
+
+    DLOG_I("LVGL heap internal: used %u free %u largest %u min_free %u frag %u%%",
+           stats.internal.used, stats.internal.free, stats.internal.largest_free,
+           stats.internal.min_free, stats.internal.frag_pct);
+    if (stats.psram.total) {
+        DLOG_I("LVGL heap psram: used %u free %u largest %u min_free %u frag %u%% (spills %u)",
+               stats.psram.used, stats.psram.free, stats.psram.largest_free,
+               stats.psram.min_free, stats.psram.frag_pct, stats.spill_count);
+    }
+    if (stats.internal.frag_pct >= LVGL_HEAP_FRAG_WARN_PCT) {
+        DLOG_W("LVGL internal heap fragmented (%u%%)", stats.internal.frag_pct);
+    }
+    if (stats.fail_count) {
+        DLOG_W("%u LVGL allocations failed", stats.fail_count);
+    }
+}
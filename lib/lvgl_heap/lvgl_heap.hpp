@@ -0,0 +1,51 @@
+#ifndef __LVGL_HEAP_H__
+#define __LVGL_HEAP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Dedicated LVGL heap (LV_USE_STDLIB_MALLOC == LV_STDLIB_CUSTOM).
+// Widgets, styles and label strings are served from a private internal-RAM region so
+// screen rebuilds never fragment the heap shared with Arduino, NVS and Wi-Fi. When the
+// internal region is exhausted allocations spill into an optional PSRAM region.
+// The host build uses LVGL's built-in pool instead and only reports its statistics.
+
+// Internal RAM region size (static, lives in .bss)
+#ifndef LVGL_HEAP_INTERNAL_SIZE
+#define LVGL_HEAP_INTERNAL_SIZE (96 * 1024)
+#endif
+
+// PSRAM spill region size (0 disables the spill region)
+#ifndef LVGL_HEAP_PSRAM_SIZE
+#ifdef BOARD_HAS_PSRAM
+#define LVGL_HEAP_PSRAM_SIZE (256 * 1024)
+#else
+#define LVGL_HEAP_PSRAM_SIZE 0
+#endif
+#endif
+
+// Fragmentation (percent of free space not in the largest block) that triggers a warning
+#ifndef LVGL_HEAP_FRAG_WARN_PCT
+#define LVGL_HEAP_FRAG_WARN_PCT 50
+#endif
+
+struct LvglHeapRegionStats {
+  size_t total;          // Region size in bytes
+  size_t used;           // Bytes currently allocated
+  size_t free;           // Bytes currently free
+  size_t largest_free;   // Largest single allocation that would succeed
+  size_t min_free;       // Low-water mark of free bytes since boot
+  uint8_t frag_pct;      // 100 - largest_free * 100 / free
+};
+
+struct LvglHeapStats {
+  LvglHeapRegionStats internal;
+  LvglHeapRegionStats psram;     // All zero when the spill region is disabled
+  uint32_t spill_count;          // Allocations served from PSRAM
+  uint32_t fail_count;           // Allocations that failed in both regions
+};
+
+void lvgl_heap_get_stats(LvglHeapStats *stats);
+void lvgl_heap_log_stats(void);
+
+#endif  // __LVGL_HEAP_H__
@@ -1,8 +1,23 @@
 
 #include "m5gfx_lvgl.hpp"
+#include "hal.hpp"
+#include <string.h>
+#if LV_USE_OS == LV_OS_FREERTOS && LV_USE_DRAW_SW
+#include "lvgl_private.h"  // Draw unit list and lv_draw_sw_unit_t
+#endif
 
 SemaphoreHandle_t xGuiSemaphore;
 
+// Only touched by the flush and read callbacks and the wake poll (LVGL task)
+static M5gfxLvglStats flush_stats;
+
+static lv_indev_t *touch_indev = nullptr;
+static TouchMode touch_mode = TOUCH_MODE_POLLED;
+static uint32_t touch_period_ms = NCIR_TOUCH_POLL_MS;
+static bool touch_down = false;
+static bool touch_held = false;  // Touch that woke the display, kept from LVGL until lifted
+static uint32_t touch_last_read_ms = 0;
+
 LV_IMG_DECLARE(cursor_hand);
 
 static void m5gfx_lvgl_flush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
@@ -10,29 +25,93 @@ static void m5gfx_lvgl_flush(lv_display_t *disp, const lv_area_t *area, uint8_t
     uint32_t h = (area->y2 - area->y1 + 1);
 
     // 等待之前的 DMA 傳輸完成
+    uint32_t start = hal_micros();
     lv_draw_sw_rgb565_swap(px_map, w * h);
-    M5.Display.startWrite();
-    M5.Display.pushImageDMA<uint16_t>(area->x1, area->y1, w, h, (uint16_t *)px_map);
-    M5.Display.waitDMA();
-    M5.Display.endWrite();
+    hal_display_flush(area->x1, area->y1, w, h, (const uint16_t *)px_map);
     lv_display_flush_ready(disp);
+
+    flush_stats.flushes++;
+    flush_stats.pixels += w * h;
+    flush_stats.flush_us += hal_micros() - start;
+}
+
+void m5gfx_lvgl_get_stats(M5gfxLvglStats *stats) {
+    *stats = flush_stats;
 }
 
 static void m5gfx_lvgl_read(lv_indev_t * drv, lv_indev_data_t * data) {
-    M5.update();
-    auto t = M5.Touch.getDetail();
-    
-    if (t.isPressed()) {
+    uint32_t start = hal_micros();
+    hal_update();
+    int16_t x, y;
+
+    touch_down = hal_touch_read(&x, &y);
+    if (!touch_down) touch_held = false;
+    if (touch_down && !touch_held) {
         data->state = LV_INDEV_STATE_PRESSED;
-        data->point.x = t.x;
-        data->point.y = t.y;
+        data->point.x = x;
+        data->point.y = y;
     } else {
         data->state = LV_INDEV_STATE_RELEASED;
     }
+
+    touch_last_read_ms = hal_millis();
+    flush_stats.touch_reads++;
+    flush_stats.touch_us += hal_micros() - start;
+}
+
+TouchMode m5gfx_lvgl_set_touch_mode(TouchMode mode, uint32_t period_ms) {
+    if (mode == TOUCH_MODE_INTERRUPT && !hal_touch_irq_begin()) {
+        mode = TOUCH_MODE_POLLED;
+    }
+    touch_mode = mode;
+    touch_period_ms = period_ms;
+    touch_down = false;
+    touch_held = false;
+    if (!touch_indev) return mode;
+
+    // Event mode pauses the read timer, only m5gfx_lvgl_touch_service() reads then
+    lv_indev_set_mode(touch_indev, mode == TOUCH_MODE_POLLED ? LV_INDEV_MODE_TIMER : LV_INDEV_MODE_EVENT);
+    lv_indev_enable(touch_indev, mode != TOUCH_MODE_OFF);
+    lv_timer_t *timer = lv_indev_get_read_timer(touch_indev);
+    if (timer) lv_timer_set_period(timer, period_ms);
+    return mode;
+}
+
+TouchMode m5gfx_lvgl_get_touch_mode(void) {
+    return touch_mode;
+}
+
+void m5gfx_lvgl_touch_service(void) {
+    if (touch_mode != TOUCH_MODE_INTERRUPT || !touch_indev) return;
+
+    // The lift does not always raise the line, so a pressed panel is polled until released
+    bool irq = hal_touch_irq_take();
+    if (irq || (touch_down && hal_millis() - touch_last_read_ms >= touch_period_ms)) {
+        lv_indev_read(touch_indev);
+    }
+}
+
+bool m5gfx_lvgl_touch_wake(void) {
+    if (touch_mode == TOUCH_MODE_OFF || touch_held) return false;
+    if (touch_mode == TOUCH_MODE_INTERRUPT) {
+        if (!hal_touch_irq_take()) return false;
+    } else if (hal_millis() - touch_last_read_ms < touch_period_ms) {
+        return false;
+    }
+
+    uint32_t start = hal_micros();
+    hal_update();
+    int16_t x, y;
+    touch_down = hal_touch_read(&x, &y);
+    touch_held = touch_down;
+    touch_last_read_ms = hal_millis();
+    flush_stats.touch_reads++;
+    flush_stats.touch_us += hal_micros() - start;
+    return touch_down;
 }
 
 static uint32_t my_tick_function() {
-  return (esp_timer_get_time() / 1000LL);
+  return hal_millis();
 }
 
 
@@ -72,7 +151,7 @@ void m5gfx_lvgl_init(void) {
     //lv_display_set_antialiasing(disp, true);
 
     // Configure touch input
-    lv_indev_t* touch_indev = lv_indev_create();
+    touch_indev = lv_indev_create();
     if (!touch_indev) {
         log_e("Failed to create touch input device");
         return;
@@ -80,6 +159,7 @@ void m5gfx_lvgl_init(void) {
 
     lv_indev_set_type(touch_indev, LV_INDEV_TYPE_POINTER);
     lv_indev_set_read_cb(touch_indev, m5gfx_lvgl_read);
+    m5gfx_lvgl_set_touch_mode(NCIR_TOUCH_MODE, NCIR_TOUCH_POLL_MS);
 
     // Set up LVGL timer
     xGuiSemaphore                                     = xSemaphoreCreateMutex();
@@ -93,4 +173,17 @@ void m5gfx_lvgl_init(void) {
     ESP_ERROR_CHECK(esp_timer_start_periodic(periodic_timer, LV_TICK_PERIOD_MS * 1000));
     */
 
-}
\ No newline at end of file
+}
+
+TaskHandle_t m5gfx_lvgl_draw_thread(uint32_t index) {
+#if LV_USE_OS == LV_OS_FREERTOS && LV_USE_DRAW_SW
+    for (lv_draw_unit_t *unit = LV_GLOBAL_DEFAULT()->draw_info.unit_head; unit; unit = unit->next) {
+        if (!unit->name || strcmp(unit->name, "SW") != 0) continue;
+        lv_draw_sw_unit_t *sw_unit = (lv_draw_sw_unit_t *)unit;
+        if (sw_unit->idx == index) return sw_unit->thread.xTaskHandle;
+    }
+#else
+    (void)index;
+#endif
+    return NULL;
+}
@@ -1,13 +1,66 @@
 #ifndef __M5GFX_LVGL_H__
 #define __M5GFX_LVGL_H__
 
+#include <Arduino.h>
 #include "lvgl.h"
-#include "M5Unified.h"
-#include "M5GFX.h"
+
+// LVGL display and touch driver on the HAL panel (M5GFX on the CoreS3, an in-memory
+// framebuffer in the host build)
+
+// How the touch indev reads the panel (each read is an I2C transaction on the CoreS3):
+//   TOUCH_MODE_OFF        never - hardware buttons only, e.g. for use with gloves
+//   TOUCH_MODE_POLLED     every period_ms from LVGL's indev read timer
+//   TOUCH_MODE_INTERRUPT  when the controller's INT line fires, then every period_ms
+//                         until the finger is lifted (from m5gfx_lvgl_touch_service)
+// m5gfx_lvgl_init() starts in NCIR_TOUCH_MODE with NCIR_TOUCH_POLL_MS.
+enum TouchMode {
+  TOUCH_MODE_OFF,
+  TOUCH_MODE_POLLED,
+  TOUCH_MODE_INTERRUPT
+};
+
+#ifndef NCIR_TOUCH_MODE
+#define NCIR_TOUCH_MODE TOUCH_MODE_POLLED
+#endif
+#ifndef NCIR_TOUCH_POLL_MS
+#define NCIR_TOUCH_POLL_MS 50
+#endif
 
 // Declare xGuiSemaphore as extern
 extern SemaphoreHandle_t xGuiSemaphore;
 
 void m5gfx_lvgl_init(void);
 
+// Change the touch mode, returns the one in effect (TOUCH_MODE_INTERRUPT falls back to
+// polling when the board has no touch interrupt)
+TouchMode m5gfx_lvgl_set_touch_mode(TouchMode mode, uint32_t period_ms);
+TouchMode m5gfx_lvgl_get_touch_mode(void);
+
+// Read the panel after a touch interrupt, call once per loop (TOUCH_MODE_INTERRUPT only)
+void m5gfx_lvgl_touch_service(void);
+
+// While the display is off and LVGL is not running: read the panel at the touch mode's
+// rate (on the INT line, or every period_ms when polled) and return true when it is
+// touched. That touch is not passed to LVGL, its indev reports released until the
+// finger lifts, so waking the display does not also click the hidden UI.
+bool m5gfx_lvgl_touch_wake(void);
+
+// Counters since boot, for the render benchmarks and the touch cost: flush callbacks,
+// pixels sent to the panel and time spent in the panel transfer, touch panel reads
+// and the time they took (I2C and driver)
+struct M5gfxLvglStats {
+  uint32_t flushes;
+  uint32_t pixels;
+  uint32_t flush_us;
+  uint32_t touch_reads;
+  uint32_t touch_us;
+};
+
+void m5gfx_lvgl_get_stats(M5gfxLvglStats *stats);
+
+// FreeRTOS task of SW draw unit index (0..LV_DRAW_SW_DRAW_UNIT_CNT-1), NULL when LVGL
+// does not run its draw units on FreeRTOS threads (host build). All of them are named
+// "swdraw", so they can only be told apart by handle.
+TaskHandle_t m5gfx_lvgl_draw_thread(uint32_t index);
+
 #endif  // __M5GFX_LVGL_H__
\ No newline at end of file
@@ -0,0 +1,58 @@
+
+#include "mem_monitor.hpp"
+#include <string.h>
+
+// Raise bit when value < limit, clear it once value >= limit plus the hysteresis
+static void check_limit(uint32_t *active, uint32_t bit, uint32_t value, uint32_t limit) {
+  if (*active & bit) {
+    if ((uint64_t)value * 100 >= (uint64_t)limit * (100 + MEM_MONITOR_HYSTERESIS_PCT)) *active &= ~bit;
+  } else if (value < limit) {
+    *active |= bit;
+  }
+}
+
+void mem_monitor_init(MemMonitor *monitor) {
+  memset(monitor, 0, sizeof(*monitor));
+}
+
+uint32_t mem_monitor_check(MemMonitor *monitor, const MemSnapshot *snapshot) {
+  uint32_t active = monitor->active;
+
+  const MemRegionInfo &internal = snapshot->regions[MEM_REGION_INTERNAL];
+  if (internal.present) {
+    check_limit(&active, MEM_WARN_INTERNAL_FREE, internal.free, MEM_LIMIT_INTERNAL_FREE);
+    check_limit(&active, MEM_WARN_INTERNAL_BLOCK, internal.largest_free, MEM_LIMIT_INTERNAL_BLOCK);
+  }
+  if (snapshot->regions[MEM_REGION_DMA].present) {
+    check_limit(&active, MEM_WARN_DMA_FREE, snapshot->regions[MEM_REGION_DMA].free, MEM_LIMIT_DMA_FREE);
+  }
+  if (snapshot->regions[MEM_REGION_PSRAM].present) {
+    check_limit(&active, MEM_WARN_PSRAM_FREE, snapshot->regions[MEM_REGION_PSRAM].free, MEM_LIMIT_PSRAM_FREE);
+  }
+  if (snapshot->lvgl_total) {
+    uint32_t free_pct = (uint32_t)((uint64_t)(snapshot->lvgl_total - snapshot->lvgl_used) * 100 / snapshot->lvgl_total);
+    check_limit(&active, MEM_WARN_LVGL_FREE, free_pct, MEM_LIMIT_LVGL_FREE_PCT);
+  }
+
+  for (int i = 0; i < snapshot->task_count && i < MEM_MONITOR_MAX_TASKS; i++) {
+    if (snapshot->tasks[i].present) {
+      check_limit(&active, MEM_WARN_TASK(i), snapshot->tasks[i].stack_free, MEM_LIMIT_STACK_FREE);
+    }
+  }
+
+  uint32_t raised = active & ~monitor->active;
+  for (uint32_t bits = raised; bits; bits &= bits - 1) monitor->raised++;
+  monitor->active = active;
+  return raised;
+}
+
+const char *mem_warning_name(uint32_t bit) {
+  switch (bit) {
+    case MEM_WARN_INTERNAL_FREE: return "Internal RAM low";
+    case MEM_WARN_INTERNAL_BLOCK: return "Internal RAM fragmented";
+    case MEM_WARN_DMA_FREE: return "DMA RAM low";
+    case MEM_WARN_PSRAM_FREE: return "PSRAM low";
+    case MEM_WARN_LVGL_FREE: return "LVGL heap low";
+    default: return "Stack low";
+  }
+}
@@ -0,0 +1,68 @@
+#ifndef __MEM_MONITOR_H__
+#define __MEM_MONITOR_H__
+
+#include <stdint.h>
+#include "hal.hpp"
+
+// Memory health snapshot and threshold warnings.
+// The application fills a MemSnapshot every MEM_MONITOR_PERIOD_MS from the heap
+// capability regions (hal_heap_info), the LVGL heap and the stack high-water marks of
+// its tasks (hal_task_stack_free), shows it on the diagnostics screen and streams it as
+// telemetry. mem_monitor_check() compares a snapshot with the limits below: a warning
+// is raised once when a value drops under its limit and only clears after the value has
+// recovered MEM_MONITOR_HYSTERESIS_PCT above it, so a value hovering at the limit does
+// not flood the log. The library has no platform dependencies; it only takes the region
+// types (MemRegion, MemRegionInfo) from hal.hpp.
+
+#define MEM_MONITOR_PERIOD_MS 5000
+#define MEM_MONITOR_MAX_TASKS 8
+#define MEM_MONITOR_HYSTERESIS_PCT 25
+
+// Warning limits
+#define MEM_LIMIT_INTERNAL_FREE (24 * 1024)    // Free internal RAM (Wi-Fi, NVS, task stacks)
+#define MEM_LIMIT_INTERNAL_BLOCK (8 * 1024)    // Largest internal block (fragmentation)
+#define MEM_LIMIT_DMA_FREE (16 * 1024)         // DMA-capable RAM (display flush buffers)
+#define MEM_LIMIT_PSRAM_FREE (64 * 1024)
+#define MEM_LIMIT_LVGL_FREE_PCT 15             // Free share of the LVGL heap
+#define MEM_LIMIT_STACK_FREE 512               // Stack bytes a task has never touched
+
+struct MemTaskInfo {
+  const char *name;
+  uint32_t stack_size;   // Bytes given at creation
+  uint32_t stack_free;   // High-water mark: fewest free bytes since the task started
+  bool present;          // false when the task is not running or cannot be measured
+};
+
+struct MemSnapshot {
+  uint32_t timestamp_ms;
+  MemRegionInfo regions[MEM_REGION_COUNT];
+  uint32_t lvgl_total;   // LVGL heap, internal and PSRAM spill regions together
+  uint32_t lvgl_used;
+  uint32_t lvgl_largest_free;
+  uint8_t task_count;
+  MemTaskInfo tasks[MEM_MONITOR_MAX_TASKS];
+};
+
+// Warning bits (MemMonitor.active and the TELEMETRY_MEMORY record)
+#define MEM_WARN_INTERNAL_FREE (1UL << 0)
+#define MEM_WARN_INTERNAL_BLOCK (1UL << 1)
+#define MEM_WARN_DMA_FREE (1UL << 2)
+#define MEM_WARN_PSRAM_FREE (1UL << 3)
+#define MEM_WARN_LVGL_FREE (1UL << 4)
+#define MEM_WARN_TASK_SHIFT 8
+#define MEM_WARN_TASK(i) (1UL << (MEM_WARN_TASK_SHIFT + (i)))  // Stack of snapshot task i
+
+struct MemMonitor {
+  uint32_t active;       // Warnings currently raised
+  uint32_t raised;       // Times any warning was raised since init
+};
+
+void mem_monitor_init(MemMonitor *monitor);
+
+// Update the active warnings from a snapshot, returns the ones newly raised
+uint32_t mem_monitor_check(MemMonitor *monitor, const MemSnapshot *snapshot);
+
+// Short description of a warning bit below MEM_WARN_TASK_SHIFT ("Internal RAM low", ...)
+const char *mem_warning_name(uint32_t bit);
+
+#endif  // __MEM_MONITOR_H__
@@ -0,0 +1,359 @@
+
+#include "sample_log.hpp"
+#include <esp_timer.h>
+#include <string.h>
+
+// Worst-case record: three 5-byte varints
+#define MAX_RECORD_SIZE 15
+
+struct SampleLogBuffer {
+  SampleLogBlockHeader header;
+  uint8_t payload[SAMPLE_LOG_PAYLOAD_SIZE];
+  // Encoder state, not written to flash
+  uint32_t last_cs;
+  int16_t last_object;
+  int16_t last_ambient;
+  int32_t sum_object;
+};
+
+static SampleLogBuffer buffers[SAMPLE_LOG_RAM_BLOCKS];
+static QueueHandle_t free_queue = NULL;   // Empty buffers for the producer
+static QueueHandle_t full_queue = NULL;   // Finished buffers for the flush task
+static SampleLogBuffer *active = NULL;    // Buffer being filled (producer side)
+static portMUX_TYPE log_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint16_t log_boot_id = 0;
+static uint32_t log_epoch_s = 0;          // Log time of millis() == 0 for this boot
+static SampleLogBlockHook block_hook = NULL;
+static FlashJournalIo flash_io;
+static uint32_t flash_base = 0;
+static FlashJournal ring;                 // Finished blocks, block seq == journal seq
+static FlashJournal wal;                  // Snapshots of the block being filled
+static volatile bool ring_ready = false;
+static SampleLogStats stats;
+
+uint16_t sample_log_crc16(const uint8_t *data, size_t len, uint16_t crc) {
+  while (len--) {
+    crc ^= (uint16_t)(*data++) << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+static int16_t to_tenths(float value_c) {
+  float tenths = value_c * 10.0f;
+  if (tenths != tenths) return SAMPLE_LOG_NO_DATA;
+  if (tenths > 32767.0f) return 32767;
+  if (tenths < -32767.0f) return -32767;
+  return (int16_t)(tenths < 0 ? tenths - 0.5f : tenths + 0.5f);
+}
+
+static size_t put_varint(uint8_t *out, uint32_t value) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+static bool get_varint(const uint8_t *data, size_t len, size_t *pos, uint32_t *value) {
+  *value = 0;
+  for (int shift = 0; shift < 35 && *pos < len; shift += 7) {
+    uint8_t byte = data[(*pos)++];
+    *value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+static uint32_t zigzag(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static void summary_add(SampleLogBlockHeader *header, int32_t *sum, int16_t object) {
+  if (object == SAMPLE_LOG_NO_DATA) return;
+  if (!header->summary_count || object < header->min_object) header->min_object = object;
+  if (!header->summary_count || object > header->max_object) header->max_object = object;
+  *sum += object;
+  header->summary_count++;
+}
+
+// Give a sealed block its ring seq
+static void stamp_block(SampleLogBlockHeader *header, const uint8_t *payload, uint32_t seq) {
+  header->seq = seq;
+  header->crc = 0;
+  uint16_t crc = sample_log_crc16((const uint8_t *)header, sizeof(*header), 0xFFFF);
+  header->crc = sample_log_crc16(payload, header->used, crc);
+}
+
+// Seal a block image for writing as ring block seq
+static void seal_block(SampleLogBlockHeader *header, uint8_t *payload, int32_t sum_object, uint32_t seq) {
+  memset(payload + header->used, 0xFF, SAMPLE_LOG_PAYLOAD_SIZE - header->used);
+  header->boot_id = log_boot_id;
+  header->log_s = log_epoch_s + header->base_ms / 1000;
+  header->mean_object = header->summary_count ? (int16_t)(sum_object / (int32_t)header->summary_count) : SAMPLE_LOG_NO_DATA;
+  stamp_block(header, payload, seq);
+}
+
+// Only the loop task appends. The flush task reads the active block under log_lock,
+// so the lock only covers the pointer swap and the record copy.
+void sample_log_append(uint32_t timestamp_ms, float object_c, float ambient_c) {
+  int16_t object = to_tenths(object_c);
+  int16_t ambient = to_tenths(ambient_c);
+  uint32_t now_cs = timestamp_ms / 10;
+
+  if (active && active->header.used + MAX_RECORD_SIZE > SAMPLE_LOG_PAYLOAD_SIZE) {
+    SampleLogBuffer *done = active;
+    portENTER_CRITICAL(&log_lock);
+    active = NULL;
+    portEXIT_CRITICAL(&log_lock);
+    xQueueSend(full_queue, &done, 0);  // Cannot fail: one slot per buffer
+  }
+
+  if (!active) {
+    // Start a new block with this sample as its absolute base record
+    SampleLogBuffer *next;
+    bool have_buffer = free_queue && xQueueReceive(free_queue, &next, 0) == pdTRUE;
+    if (have_buffer) {
+      memset(&next->header, 0, sizeof(next->header));
+      next->header.magic = SAMPLE_LOG_MAGIC;
+      next->header.version = SAMPLE_LOG_VERSION;
+      next->header.count = 1;
+      next->header.base_ms = timestamp_ms;
+      next->header.base_object = object;
+      next->header.base_ambient = ambient;
+      next->sum_object = 0;
+      summary_add(&next->header, &next->sum_object, object);
+      next->last_cs = now_cs;
+      next->last_object = object;
+      next->last_ambient = ambient;
+    }
+
+    portENTER_CRITICAL(&log_lock);
+    stats.samples++;
+    if (have_buffer) {
+      active = next;
+    } else {
+      stats.dropped++;
+    }
+    portEXIT_CRITICAL(&log_lock);
+    return;
+  }
+
+  uint8_t record[MAX_RECORD_SIZE];
+  size_t n = put_varint(record, now_cs - active->last_cs);
+  n += put_varint(record + n, zigzag((int32_t)object - active->last_object));
+  n += put_varint(record + n, zigzag((int32_t)ambient - active->last_ambient));
+
+  portENTER_CRITICAL(&log_lock);
+  SampleLogBlockHeader &header = active->header;
+  memcpy(active->payload + header.used, record, n);
+  header.used += n;
+  header.count++;
+  header.span_cs = now_cs - header.base_ms / 10;
+  summary_add(&header, &active->sum_object, object);
+  stats.samples++;
+  portEXIT_CRITICAL(&log_lock);
+
+  active->last_cs = now_cs;
+  active->last_object = object;
+  active->last_ambient = ambient;
+}
+
+int sample_log_decode(const uint8_t *block, SampleLogRecord *out, int max) {
+  SampleLogBlockHeader header;
+  memcpy(&header, block, sizeof(header));
+  if (header.magic != SAMPLE_LOG_MAGIC || header.version != SAMPLE_LOG_VERSION) return -1;
+  if (header.used > SAMPLE_LOG_PAYLOAD_SIZE || header.count == 0) return -1;
+
+  const uint8_t *payload = block + sizeof(header);
+  uint16_t stored_crc = header.crc;
+  header.crc = 0;
+  uint16_t crc = sample_log_crc16((const uint8_t *)&header, sizeof(header), 0xFFFF);
+  if (sample_log_crc16(payload, header.used, crc) != stored_crc) return -1;
+
+  // Offsets are kept in 10 ms units from the base record's own time step
+  uint32_t base_cs = header.base_ms / 10;
+  uint32_t cs = base_cs;
+  SampleLogRecord record = {header.base_ms % 1000, header.base_object, header.base_ambient};
+  int n = 0;
+  if (n < max) out[n++] = record;
+
+  size_t pos = 0;
+  for (uint16_t i = 1; i < header.count && n < max; i++) {
+    uint32_t dt, d_object, d_ambient;
+    if (!get_varint(payload, header.used, &pos, &dt) ||
+        !get_varint(payload, header.used, &pos, &d_object) ||
+        !get_varint(payload, header.used, &pos, &d_ambient)) {
+      return -1;
+    }
+    cs += dt;
+    record.offset_ms = header.base_ms % 1000 + (cs - base_cs) * 10;
+    record.object = (int16_t)(record.object + unzigzag(d_object));
+    record.ambient = (int16_t)(record.ambient + unzigzag(d_ambient));
+    out[n++] = record;
+  }
+  return n;
+}
+
+// Append a sealed block to the ring or the WAL and report it to the hook
+static void append_block(FlashJournal *journal, const uint8_t *block) {
+  int64_t start = esp_timer_get_time();
+  bool ok = flash_journal_append(journal, block, SAMPLE_LOG_BLOCK_SIZE, NULL);
+  uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+
+  portENTER_CRITICAL(&log_lock);
+  stats.bytes_written += SAMPLE_LOG_SLOT_SIZE;
+  if (elapsed > stats.max_write_us) stats.max_write_us = elapsed;
+  if (journal == &ring) {
+    stats.blocks_written++;
+    stats.next_seq = ring.next_seq;
+  }
+  portEXIT_CRITICAL(&log_lock);
+
+  if (ok && block_hook) block_hook((const SampleLogBlockHeader *)block);
+}
+
+// Recover both journals from their tails and commit a WAL snapshot the ring is missing.
+// Returns false if the flash region cannot be used.
+static bool recover(uint8_t *block) {
+  if (!flash_journal_open(&ring, &flash_io, flash_base, SAMPLE_LOG_RING_SECTORS, SAMPLE_LOG_SLOT_SIZE) ||
+      !flash_journal_open(&wal, &flash_io, flash_base + SAMPLE_LOG_RING_SECTORS * FLASH_JOURNAL_SECTOR_SIZE,
+                          SAMPLE_LOG_WAL_SECTORS, SAMPLE_LOG_SLOT_SIZE)) {
+    return false;
+  }
+  uint32_t recovery_reads = ring.open_reads + wal.open_reads;
+  bool recovered = false;
+
+  // The newest snapshot holds the block that was being filled when power was lost,
+  // unless that block was completed and committed afterwards
+  SampleLogBlockHeader *header = (SampleLogBlockHeader *)block;
+  uint32_t last_block = ring.last_seq;
+  if (wal.last_seq != FLASH_JOURNAL_NO_SEQ &&
+      flash_journal_read(&wal, wal.last_seq, block, SAMPLE_LOG_BLOCK_SIZE) == SAMPLE_LOG_BLOCK_SIZE &&
+      sample_log_decode(block, NULL, 0) >= 0 &&
+      (last_block == FLASH_JOURNAL_NO_SEQ || header->seq > last_block)) {
+    stamp_block(header, block + sizeof(*header), ring.next_seq);
+    recovered = flash_journal_append(&ring, block, SAMPLE_LOG_BLOCK_SIZE, NULL);
+  }
+
+  // The log timeline continues one second after the newest block
+  if (ring.last_seq != FLASH_JOURNAL_NO_SEQ &&
+      flash_journal_read(&ring, ring.last_seq, block, SAMPLE_LOG_BLOCK_SIZE) == SAMPLE_LOG_BLOCK_SIZE &&
+      sample_log_decode(block, NULL, 0) >= 0) {
+    log_epoch_s = header->log_s + header->span_cs / 100 + 1;
+  }
+
+  portENTER_CRITICAL(&log_lock);
+  stats.recovery_reads = recovery_reads;
+  if (recovered) stats.recovered++;
+  stats.next_seq = ring.next_seq;
+  portEXIT_CRITICAL(&log_lock);
+  return true;
+}
+
+// Report every block still in the ring so an index can be rebuilt
+static void scan_ring(uint8_t *block) {
+  if (!block_hook) return;
+  for (uint32_t seq = flash_journal_first_seq(&ring); seq < ring.next_seq; seq++) {
+    if (flash_journal_read(&ring, seq, block, SAMPLE_LOG_BLOCK_SIZE) != SAMPLE_LOG_BLOCK_SIZE) continue;
+    if (sample_log_decode(block, NULL, 0) < 0) continue;
+    block_hook((const SampleLogBlockHeader *)block);
+  }
+}
+
+static void sample_log_task(void *arg) {
+  (void)arg;
+  // Recovery happens here so setup() never waits on flash; samples collect in the RAM
+  // blocks meanwhile
+  static uint8_t block[SAMPLE_LOG_BLOCK_SIZE];
+  uint32_t start_ms = millis();
+  if (!recover(block)) {
+    log_e("Sample log: flash region unusable");
+    vTaskDelete(NULL);
+    return;
+  }
+  ring_ready = true;
+  uint32_t recovery_ms = max(1UL, millis() - start_ms);
+  portENTER_CRITICAL(&log_lock);
+  stats.recovery_ms = recovery_ms;
+  portEXIT_CRITICAL(&log_lock);
+
+  start_ms = millis();
+  scan_ring(block);
+  uint32_t scan_ms = max(1UL, millis() - start_ms);
+  portENTER_CRITICAL(&log_lock);
+  stats.scan_ms = scan_ms;
+  portEXIT_CRITICAL(&log_lock);
+  // Only this task writes these fields, so they can be read without the lock
+  log_i("Sample log: resuming at block %u, recovery %u ms (%u reads, %u committed), scan %u ms",
+        stats.next_seq, recovery_ms, stats.recovery_reads, stats.recovered, scan_ms);
+
+  uint16_t snapshot_count = 0;  // Records of the active block already in the WAL
+  SampleLogBuffer *full;
+  for (;;) {
+    if (xQueueReceive(full_queue, &full, pdMS_TO_TICKS(SAMPLE_LOG_FLUSH_MS)) == pdTRUE) {
+      seal_block(&full->header, full->payload, full->sum_object, ring.next_seq);
+      append_block(&ring, (const uint8_t *)full);
+      snapshot_count = 0;
+      xQueueSend(free_queue, &full, 0);
+      if (uxQueueMessagesWaiting(full_queue)) continue;  // Catch up before any snapshot
+    }
+
+    // Journal the block still being filled so a power cut loses little data. The
+    // snapshot carries the ring seq the block will get once it is complete.
+    portENTER_CRITICAL(&log_lock);
+    bool fresh = active && active->header.count != snapshot_count;
+    int32_t sum_object = 0;
+    if (fresh) {
+      memcpy(block, active, SAMPLE_LOG_BLOCK_SIZE);
+      sum_object = active->sum_object;
+      snapshot_count = active->header.count;
+    }
+    portEXIT_CRITICAL(&log_lock);
+    if (!fresh) continue;
+
+    seal_block((SampleLogBlockHeader *)block, block + sizeof(SampleLogBlockHeader), sum_object, ring.next_seq);
+    append_block(&wal, block);
+  }
+}
+
+bool sample_log_start(uint16_t boot_id, const FlashJournalIo *io, uint32_t base,
+                      UBaseType_t priority, BaseType_t core, SampleLogBlockHook hook) {
+  log_boot_id = boot_id;
+  flash_io = *io;
+  flash_base = base;
+  block_hook = hook;
+  memset(&stats, 0, sizeof(stats));
+  stats.started_ms = millis();
+
+  free_queue = xQueueCreate(SAMPLE_LOG_RAM_BLOCKS, sizeof(SampleLogBuffer *));
+  full_queue = xQueueCreate(SAMPLE_LOG_RAM_BLOCKS, sizeof(SampleLogBuffer *));
+  if (!free_queue || !full_queue) return false;
+  for (int i = 0; i < SAMPLE_LOG_RAM_BLOCKS; i++) {
+    SampleLogBuffer *buffer = &buffers[i];
+    xQueueSend(free_queue, &buffer, 0);
+  }
+
+  return xTaskCreatePinnedToCore(sample_log_task, "sample_log", SAMPLE_LOG_STACK_SIZE, NULL,
+                                 priority, NULL, core) == pdPASS;
+}
+
+bool sample_log_read_block(uint32_t seq, uint8_t *block) {
+  if (!ring_ready) return false;
+  return flash_journal_read(&ring, seq, block, SAMPLE_LOG_BLOCK_SIZE) == SAMPLE_LOG_BLOCK_SIZE &&
+         sample_log_decode(block, NULL, 0) >= 0;
+}
+
+void sample_log_get_stats(SampleLogStats *out) {
+  portENTER_CRITICAL(&log_lock);
+  *out = stats;
+  portEXIT_CRITICAL(&log_lock);
+}
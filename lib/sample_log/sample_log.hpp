@@ -0,0 +1,106 @@
+#ifndef __SAMPLE_LOG_H__
+#define __SAMPLE_LOG_H__
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "flash_journal.hpp"
+
+// Persistent ring log of temperature readings on raw flash.
+// Samples are packed into fixed-size blocks: a header with the absolute first sample,
+// a min/max/mean summary and a CRC, followed by delta records (zigzag varints of the
+// time step in 10 ms units and the tenths of a degree change). Blocks fill in RAM; a
+// background task appends each finished block to the ring journal. sample_log_append()
+// never touches flash and never blocks.
+//
+// Commit protocol: the block still being filled is appended to a small write-ahead
+// journal every SAMPLE_LOG_FLUSH_MS. At boot both journals are recovered from their
+// tails, and a WAL snapshot newer than the last ring block is committed to the ring, so
+// a power cut at any point loses at most SAMPLE_LOG_FLUSH_MS of data (plus finished
+// blocks still queued in RAM) and never damages older blocks.
+//
+// Blocks are stamped on a log timeline in seconds that continues from the newest block
+// found at boot, so time keeps increasing across resets (power-off time is not counted).
+
+#define SAMPLE_LOG_SLOT_SIZE 512      // Journal slot (two flash pages)
+#define SAMPLE_LOG_BLOCK_SIZE FLASH_JOURNAL_PAYLOAD_MAX(SAMPLE_LOG_SLOT_SIZE)
+#define SAMPLE_LOG_RING_SECTORS 512   // 4096 blocks, about a week at 1 Hz
+#define SAMPLE_LOG_WAL_SECTORS 16     // Each WAL sector is erased about once an hour
+#define SAMPLE_LOG_BLOCKS (SAMPLE_LOG_RING_SECTORS * (FLASH_JOURNAL_SECTOR_SIZE / SAMPLE_LOG_SLOT_SIZE))
+#define SAMPLE_LOG_FLASH_SIZE ((SAMPLE_LOG_RING_SECTORS + SAMPLE_LOG_WAL_SECTORS) * FLASH_JOURNAL_SECTOR_SIZE)
+#define SAMPLE_LOG_RAM_BLOCKS 4       // Finished blocks that can wait for flash
+#define SAMPLE_LOG_FLUSH_MS 30000     // Partial block write interval
+#define SAMPLE_LOG_STACK_SIZE 4096
+
+#define SAMPLE_LOG_MAGIC 0x4C53       // "SL"
+#define SAMPLE_LOG_VERSION 3
+#define SAMPLE_LOG_NO_DATA INT16_MIN  // Failed sensor read
+
+struct SampleLogBlockHeader {
+  uint16_t magic;
+  uint8_t version;
+  uint8_t reserved;
+  uint16_t count;          // Records in the block (including the base record)
+  uint16_t used;           // Payload bytes after the header
+  uint32_t seq;            // Block sequence number, increases across boots
+  uint16_t boot_id;
+  uint16_t crc;            // CRC-16/CCITT of header (crc = 0) and payload
+  uint32_t base_ms;        // First record, ms since boot
+  uint32_t log_s;          // First record on the log timeline
+  uint32_t span_cs;        // Last record - first record, 10 ms units
+  int16_t base_object;     // First record, tenths of a degree C
+  int16_t base_ambient;
+  // Object temperature summary of the block
+  int16_t min_object;
+  int16_t max_object;
+  int16_t mean_object;
+  uint16_t summary_count;  // Records with a valid object reading
+};
+
+#define SAMPLE_LOG_PAYLOAD_SIZE (SAMPLE_LOG_BLOCK_SIZE - (int)sizeof(SampleLogBlockHeader))
+
+struct SampleLogRecord {
+  uint32_t offset_ms;      // Time after the block's first record
+  int16_t object;          // Tenths of a degree C
+  int16_t ambient;
+};
+
+struct SampleLogStats {
+  uint32_t samples;        // Appended since start
+  uint32_t dropped;        // Lost because every RAM block was waiting for flash
+  uint32_t blocks_written;
+  uint32_t bytes_written;  // Flash bytes including partial block rewrites
+  uint32_t max_write_us;   // Slowest block write
+  uint32_t started_ms;
+  uint32_t next_seq;
+  uint32_t recovery_ms;    // Tail recovery of both journals (0 while still running)
+  uint32_t recovery_reads; // Journal slots read by the tail recovery
+  uint32_t scan_ms;        // Index rebuild over the whole ring after recovery
+  uint32_t recovered;      // WAL snapshots committed to the ring at boot
+};
+
+// Called by the log task for every valid block in the ring at boot and for every block
+// (or WAL snapshot of a partial block) written afterwards
+typedef void (*SampleLogBlockHook)(const SampleLogBlockHeader *header);
+
+// Start the flush task on SAMPLE_LOG_FLASH_SIZE bytes of flash at base (sector aligned).
+// The task recovers both journals before it writes anything.
+bool sample_log_start(uint16_t boot_id, const FlashJournalIo *io, uint32_t base,
+                      UBaseType_t priority, BaseType_t core, SampleLogBlockHook hook);
+
+// Queue one reading (Celsius). Constant time, RAM only.
+void sample_log_append(uint32_t timestamp_ms, float object_c, float ambient_c);
+
+void sample_log_get_stats(SampleLogStats *stats);
+
+// Read the block with sequence number seq from flash (false if it was overwritten,
+// never written or is damaged). Safe to call from any task.
+bool sample_log_read_block(uint32_t seq, uint8_t *block);
+
+// Decode a block (record times are offsets from header->log_s). Returns the
+// number of records written to out (up to max), or -1 if the header or CRC is invalid.
+int sample_log_decode(const uint8_t *block, SampleLogRecord *out, int max);
+
+uint16_t sample_log_crc16(const uint8_t *data, size_t len, uint16_t crc);
+
+#endif  // __SAMPLE_LOG_H__
@@ -0,0 +1,106 @@
+
+#include "sensor_trace.hpp"
+#include <string.h>
+
+static const uint8_t trace_magic[4] = {'N', 'C', 'T', 'R'};
+
+static void put_u16(uint8_t *out, uint16_t value) {
+  out[0] = (uint8_t)value;
+  out[1] = (uint8_t)(value >> 8);
+}
+
+static void put_u32(uint8_t *out, uint32_t value) {
+  for (int i = 0; i < 4; i++) out[i] = (uint8_t)(value >> (8 * i));
+}
+
+static uint16_t get_u16(const uint8_t *data) {
+  return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *data) {
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static void put_f32(uint8_t *out, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, 4);
+  put_u32(out, bits);
+}
+
+static float get_f32(const uint8_t *data) {
+  uint32_t bits = get_u32(data);
+  float value;
+  memcpy(&value, &bits, 4);
+  return value;
+}
+
+void sensor_trace_write_header(uint8_t *out) {
+  memcpy(out, trace_magic, 4);
+  put_u16(out + 4, SENSOR_TRACE_VERSION);
+  put_u16(out + 6, SENSOR_TRACE_RECORD_SIZE);
+}
+
+void sensor_trace_encode(const SensorTraceRecord *record, uint8_t *out) {
+  put_u32(out, record->timestamp_ms);
+  out[4] = record->type;
+  out[5] = record->button;
+  out[6] = record->pressed;
+  out[7] = 0;
+  put_f32(out + 8, record->object_c);
+  put_f32(out + 12, record->ambient_c);
+}
+
+void sensor_trace_decode(const uint8_t *data, SensorTraceRecord *record) {
+  record->timestamp_ms = get_u32(data);
+  record->type = data[4];
+  record->button = data[5];
+  record->pressed = data[6];
+  record->object_c = get_f32(data + 8);
+  record->ambient_c = get_f32(data + 12);
+}
+
+int32_t sensor_trace_parse(const uint8_t *data, size_t length, SensorTraceRecord *records, size_t max) {
+  if (length < SENSOR_TRACE_HEADER_SIZE || memcmp(data, trace_magic, 4) ||
+      get_u16(data + 4) != SENSOR_TRACE_VERSION || get_u16(data + 6) != SENSOR_TRACE_RECORD_SIZE) {
+    return -1;
+  }
+  // A truncated last record (capture cut short) is ignored
+  size_t count = (length - SENSOR_TRACE_HEADER_SIZE) / SENSOR_TRACE_RECORD_SIZE;
+  if (count > max) count = max;
+  for (size_t i = 0; i < count; i++) {
+    sensor_trace_decode(data + SENSOR_TRACE_HEADER_SIZE + i * SENSOR_TRACE_RECORD_SIZE, &records[i]);
+  }
+  return (int32_t)count;
+}
+
+void sensor_trace_player_start(SensorTracePlayer *player, const SensorTraceRecord *records, size_t count,
+                               float speed, uint32_t now_ms) {
+  player->records = records;
+  player->count = count;
+  player->next = 0;
+  player->speed = speed;
+  player->start_ms = now_ms;
+}
+
+uint32_t sensor_trace_player_wait_ms(const SensorTracePlayer *player, uint32_t now_ms) {
+  if (player->next >= player->count) return UINT32_MAX;
+  if (player->speed <= 0) return 0;
+
+  // Offsets from the first record, so traces can start at any device uptime
+  uint32_t offset_ms = player->records[player->next].timestamp_ms - player->records[0].timestamp_ms;
+  double due_ms = offset_ms / (double)player->speed;
+  double elapsed_ms = (uint32_t)(now_ms - player->start_ms);
+  if (elapsed_ms >= due_ms) return 0;
+  double wait = due_ms - elapsed_ms;
+  return wait < 1 ? 1 : (uint32_t)wait;
+}
+
+bool sensor_trace_player_next(SensorTracePlayer *player, uint32_t now_ms, SensorTraceRecord *record) {
+  if (sensor_trace_player_wait_ms(player, now_ms)) return false;
+  *record = player->records[player->next++];
+  return true;
+}
+
+bool sensor_trace_player_done(const SensorTracePlayer *player) {
+  return player->next >= player->count;
+}
@@ -0,0 +1,64 @@
+#ifndef __SENSOR_TRACE_H__
+#define __SENSOR_TRACE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Sensor and button traces for deterministic replay.
+// A trace file is an 8-byte header ("NCTR", u16 version, u16 record size) followed by
+// fixed-size little-endian records in timestamp order:
+//
+//   u32 timestamp_ms, u8 type, u8 button, u8 pressed, u8 reserved, f32 object_c, f32 ambient_c
+//
+// Samples carry the raw sensor readings (button fields zero), button records carry a
+// HalButton index and its new state (temperatures zero). Traces are captured on the
+// device as telemetry sample and button frames (tools/telemetry_decode.py --trace) and
+// replayed by the host build (src/host_main.cpp --replay).
+//
+// SensorTracePlayer paces a trace against a clock: at speed 1 records come due at
+// their original spacing, at speed N that many times faster, and at speed 0 as fast as
+// the consumer takes them. The library has no platform dependencies.
+
+#define SENSOR_TRACE_VERSION 1
+#define SENSOR_TRACE_HEADER_SIZE 8
+#define SENSOR_TRACE_RECORD_SIZE 16
+
+enum SensorTraceType {
+  SENSOR_TRACE_SAMPLE = 1,
+  SENSOR_TRACE_BUTTON = 2
+};
+
+struct SensorTraceRecord {
+  uint32_t timestamp_ms;
+  uint8_t type;          // SensorTraceType
+  uint8_t button;        // HalButton
+  uint8_t pressed;
+  float object_c;
+  float ambient_c;
+};
+
+struct SensorTracePlayer {
+  const SensorTraceRecord *records;
+  size_t count;
+  size_t next;           // Next record to hand out
+  float speed;           // 0 = as fast as possible
+  uint32_t start_ms;     // Clock time the replay started
+};
+
+void sensor_trace_write_header(uint8_t *out);
+void sensor_trace_encode(const SensorTraceRecord *record, uint8_t *out);
+void sensor_trace_decode(const uint8_t *data, SensorTraceRecord *record);
+
+// Decode a whole trace file held in memory. Returns the number of records stored
+// (at most max), or -1 when the header is not a trace of this version.
+int32_t sensor_trace_parse(const uint8_t *data, size_t length, SensorTraceRecord *records, size_t max);
+
+void sensor_trace_player_start(SensorTracePlayer *player, const SensorTraceRecord *records, size_t count,
+                               float speed, uint32_t now_ms);
+// Take the next record when it is due at now_ms, false when none is due or the trace ended
+bool sensor_trace_player_next(SensorTracePlayer *player, uint32_t now_ms, SensorTraceRecord *record);
+// Time until the next record is due (0 when due, UINT32_MAX at the end of the trace)
+uint32_t sensor_trace_player_wait_ms(const SensorTracePlayer *player, uint32_t now_ms);
+bool sensor_trace_player_done(const SensorTracePlayer *player);
+
+#endif  // __SENSOR_TRACE_H__
@@ -0,0 +1,79 @@
+#include "sound_player.hpp"
+#include "hal.hpp"
+
+static QueueHandle_t cue_queue = NULL;
+static const SoundClip *clip_table = NULL;
+static uint8_t clip_table_count = 0;
+static uint32_t clip_sample_rate = 0;
+static volatile bool playing = false;
+static SoundPlayerStats stats = {0, 0, 0};
+
+static void wait_until_idle() {
+    while (hal_speaker_busy(SOUND_PLAYER_CHANNEL)) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+static void sound_player_task(void *arg) {
+    (void)arg;
+    SoundCue cue;
+    for (;;) {
+        if (xQueueReceive(cue_queue, &cue, portMAX_DELAY) != pdTRUE) continue;
+        playing = true;
+        uint32_t start = millis();
+
+        for (uint8_t i = 0; i < cue.count; i++) {
+            uint8_t id = cue.clips[i];
+            if (id == SOUND_CUE_GAP) {
+                wait_until_idle();
+                vTaskDelay(pdMS_TO_TICKS(SOUND_GAP_MS));
+            } else if (id < clip_table_count) {
+                // Blocks this task (not the caller) while both speaker slots are queued
+                hal_speaker_play(clip_table[id].data, clip_table[id].length, clip_sample_rate, SOUND_PLAYER_CHANNEL);
+            }
+        }
+        wait_until_idle();
+
+        stats.last_cue_ms = millis() - start;
+        stats.cues_played++;
+        playing = false;
+    }
+}
+
+bool sound_player_start(const SoundClip *clips, uint8_t clip_count, uint32_t sample_rate,
+                        UBaseType_t priority, BaseType_t core) {
+    clip_table = clips;
+    clip_table_count = clip_count;
+    clip_sample_rate = sample_rate;
+
+    cue_queue = xQueueCreate(SOUND_PLAYER_QUEUE_LENGTH, sizeof(SoundCue));
+    if (!cue_queue) return false;
+    return xTaskCreatePinnedToCore(sound_player_task, "sound", SOUND_PLAYER_STACK_SIZE, NULL,
+                                   priority, NULL, core) == pdPASS;
+}
+
+bool sound_player_play(const SoundCue &cue) {
+    if (!cue_queue || xQueueSend(cue_queue, &cue, 0) != pdTRUE) {
+        stats.cues_dropped++;
+        return false;
+    }
+    return true;
+}
+
+void sound_player_set_volume(int volume_pct) {
+    if (volume_pct < 0) volume_pct = 0;
+    if (volume_pct > 100) volume_pct = 100;
+    hal_speaker_set_volume(SOUND_PLAYER_CHANNEL, (uint8_t)(volume_pct * 255 / 100));
+}
+
+bool sound_player_busy() {
+    return playing || (cue_queue && uxQueueMessagesWaiting(cue_queue));
+}
+
+void sound_player_get_stats(SoundPlayerStats *out) {
+    *out = stats;
+}
+
+void sound_cue_add(SoundCue *cue, uint8_t clip) {
+    if (cue->count < SOUND_CUE_MAX_CLIPS) cue->clips[cue->count++] = clip;
+}
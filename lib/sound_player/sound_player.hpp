@@ -0,0 +1,50 @@
+#ifndef __SOUND_PLAYER_H__
+#define __SOUND_PLAYER_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+// Alert sound player.
+// Cues are short sequences of precomputed 8-bit PCM clips (see tools/gen_sounds.py)
+// that a low-priority task streams from flash to the HAL speaker. Queuing a cue
+// never blocks the caller; the task waits on the speaker instead of the UI loop.
+
+#define SOUND_CUE_MAX_CLIPS 32
+#define SOUND_CUE_GAP 0xFF        // Cue entry that pauses for SOUND_GAP_MS
+#define SOUND_GAP_MS 300
+#define SOUND_PLAYER_CHANNEL 0    // Speaker virtual channel used for alerts
+#define SOUND_PLAYER_QUEUE_LENGTH 4
+#define SOUND_PLAYER_STACK_SIZE 3072
+
+struct SoundClip {
+  const uint8_t *data;  // Unsigned 8-bit mono PCM
+  uint32_t length;
+};
+
+struct SoundCue {
+  uint8_t count;
+  uint8_t clips[SOUND_CUE_MAX_CLIPS];  // Clip indices or SOUND_CUE_GAP
+};
+
+struct SoundPlayerStats {
+  uint32_t cues_played;
+  uint32_t cues_dropped;      // Queue full when the cue was requested
+  uint32_t last_cue_ms;       // Duration of the last cue
+};
+
+bool sound_player_start(const SoundClip *clips, uint8_t clip_count, uint32_t sample_rate,
+                        UBaseType_t priority, BaseType_t core);
+
+// Queue a cue (returns false and counts a drop when the queue is full)
+bool sound_player_play(const SoundCue &cue);
+
+// Alert channel volume, 0-100
+void sound_player_set_volume(int volume_pct);
+
+bool sound_player_busy();
+void sound_player_get_stats(SoundPlayerStats *stats);
+
+// Append a clip (or SOUND_CUE_GAP); entries beyond SOUND_CUE_MAX_CLIPS are ignored
+void sound_cue_add(SoundCue *cue, uint8_t clip);
+
+#endif  // __SOUND_PLAYER_H__
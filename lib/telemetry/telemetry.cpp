@@ -0,0 +1,151 @@
+
+#include "telemetry.hpp"
+#include <string.h>
+
+static uint8_t ring_buffer[TELEMETRY_RING_SIZE];
+static TelemetryRing ring;
+static portMUX_TYPE ring_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t drain_task = NULL;
+static Print *output = NULL;
+static uint16_t next_seq = 0;
+static TelemetryStats stats = {0, 0, 0, 0};
+
+static void send_status() {
+  TelemetryStatus status;
+  status.timestamp_ms = millis();
+  portENTER_CRITICAL(&ring_lock);
+  status.frames = stats.frames;
+  status.dropped = stats.dropped;
+  status.bytes = stats.bytes;
+  portEXIT_CRITICAL(&ring_lock);
+  telemetry_send(TELEMETRY_STATUS, &status, sizeof(status));
+}
+
+static void telemetry_task(void *arg) {
+  (void)arg;
+  // Leading delimiter in front of every chunk (see telemetry_frame.hpp)
+  uint8_t chunk[TELEMETRY_CHUNK_SIZE + 1];
+  chunk[0] = 0;
+  uint32_t last_status = millis();
+
+  for (;;) {
+    portENTER_CRITICAL(&ring_lock);
+    size_t n = telemetry_ring_pop(&ring, chunk + 1, TELEMETRY_CHUNK_SIZE);
+    portEXIT_CRITICAL(&ring_lock);
+
+    if (n) {
+      output->write(chunk, n + 1);
+      portENTER_CRITICAL(&ring_lock);
+      stats.bytes += n + 1;
+      portEXIT_CRITICAL(&ring_lock);
+      continue;
+    }
+
+    uint32_t since_status = millis() - last_status;
+    if (since_status >= TELEMETRY_STATUS_MS) {
+      send_status();
+      last_status = millis();
+      ulTaskNotifyTake(pdTRUE, 0);  // Drop the wakeup the status frame gave this task
+      continue;
+    }
+
+    // Ring empty: block until a frame lands in it or the next status is due, then give
+    // a burst TELEMETRY_FLUSH_MS to collect (cut short if the ring passes half full)
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TELEMETRY_STATUS_MS - since_status))) {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(TELEMETRY_FLUSH_MS));
+    }
+  }
+}
+
+bool telemetry_start(Print *port, UBaseType_t priority, BaseType_t core) {
+  output = port;
+  telemetry_ring_init(&ring, ring_buffer, sizeof(ring_buffer));
+  return xTaskCreatePinnedToCore(telemetry_task, "telemetry", TELEMETRY_STACK_SIZE, NULL,
+                                 priority, &drain_task, core) == pdPASS;
+}
+
+bool telemetry_send(uint8_t type, const void *payload, size_t length) {
+  if (!drain_task) return false;
+
+  if (length > TELEMETRY_PAYLOAD_MAX) return false;
+
+  // The seq is taken and the frame queued under one lock, so frames from different
+  // tasks and cores reach the ring in seq order (a frame is under 80 bytes to encode)
+  uint8_t frame[TELEMETRY_FRAME_MAX];
+  portENTER_CRITICAL(&ring_lock);
+  size_t n = telemetry_frame_encode(type, next_seq++, payload, length, frame);
+  bool was_empty = telemetry_ring_used(&ring) == 0;
+  bool queued = telemetry_ring_push(&ring, frame, n);
+  if (queued) {
+    stats.frames++;
+  } else {
+    stats.dropped++;
+  }
+  bool wake = (queued && was_empty) || telemetry_ring_used(&ring) >= TELEMETRY_RING_SIZE / 2;
+  portEXIT_CRITICAL(&ring_lock);
+
+  // The first frame wakes the task from its empty-ring wait; later ones ride along in
+  // the same flush unless the ring passes half full
+  if (wake) xTaskNotifyGive(drain_task);
+  return queued;
+}
+
+void telemetry_sample(uint32_t timestamp_ms, float object_c, float ambient_c) {
+  TelemetrySample sample;
+  sample.timestamp_ms = timestamp_ms;
+  sample.object_c = object_c;
+  sample.ambient_c = ambient_c;
+  telemetry_send(TELEMETRY_SAMPLE, &sample, sizeof(sample));
+}
+
+void telemetry_alert(uint8_t rule, uint8_t kind, bool active, float object_c, float rate_c_per_s, float threshold_c) {
+  TelemetryAlert alert;
+  alert.timestamp_ms = millis();
+  alert.rule = rule;
+  alert.kind = kind;
+  alert.active = active ? 1 : 0;
+  alert.reserved = 0;
+  alert.object_c = object_c;
+  alert.rate_c_per_s = rate_c_per_s;
+  alert.threshold_c = threshold_c;
+  telemetry_send(TELEMETRY_ALERT, &alert, sizeof(alert));
+}
+
+void telemetry_profile(uint8_t id, uint32_t duration_us) {
+  TelemetryProfile profile;
+  profile.timestamp_ms = millis();
+  profile.duration_us = duration_us;
+  profile.id = id;
+  memset(profile.reserved, 0, sizeof(profile.reserved));
+  telemetry_send(TELEMETRY_PROFILE, &profile, sizeof(profile));
+}
+
+void telemetry_button(uint8_t button, bool pressed) {
+  TelemetryButton event;
+  event.timestamp_ms = millis();
+  event.button = button;
+  event.pressed = pressed ? 1 : 0;
+  memset(event.reserved, 0, sizeof(event.reserved));
+  telemetry_send(TELEMETRY_BUTTON, &event, sizeof(event));
+}
+
+void telemetry_memory(const TelemetryMemory *memory) {
+  telemetry_send(TELEMETRY_MEMORY, memory, sizeof(*memory));
+}
+
+void telemetry_stack(const char *name, uint32_t stack_size, uint32_t min_free) {
+  TelemetryStack stack;
+  stack.timestamp_ms = millis();
+  stack.stack_size = stack_size;
+  stack.min_free = min_free;
+  memset(stack.name, 0, sizeof(stack.name));
+  strncpy(stack.name, name, sizeof(stack.name) - 1);
+  telemetry_send(TELEMETRY_STACK, &stack, sizeof(stack));
+}
+
+void telemetry_get_stats(TelemetryStats *out) {
+  portENTER_CRITICAL(&ring_lock);
+  *out = stats;
+  out->high_water = ring.high_water;
+  portEXIT_CRITICAL(&ring_lock);
+}
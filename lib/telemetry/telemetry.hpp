@@ -0,0 +1,42 @@
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "telemetry_frame.hpp"
+
+// Binary telemetry stream (frame format in telemetry_frame.hpp).
+// Producers encode a frame on their own stack and copy it into a byte ring under a
+// spinlock, which never blocks; when the ring is full the frame is dropped and counted.
+// A low-priority task drains the ring to the port in chunks that end on a frame
+// boundary, so a slow or disconnected host stalls only that task. With the ring empty
+// the task blocks on a notification until a frame arrives or a status frame is due.
+
+#define TELEMETRY_RING_SIZE 8192      // Power of two
+#define TELEMETRY_CHUNK_SIZE 512      // Largest single write to the port
+#define TELEMETRY_FLUSH_MS 20         // Batching delay after the first frame into an empty ring
+#define TELEMETRY_STATUS_MS 1000
+#define TELEMETRY_STACK_SIZE 3072
+
+struct TelemetryStats {
+  uint32_t frames;       // Frames queued
+  uint32_t dropped;      // Frames dropped because the ring was full
+  uint32_t bytes;        // Bytes written to the port
+  uint32_t high_water;   // Most ring bytes in use
+};
+
+bool telemetry_start(Print *port, UBaseType_t priority, BaseType_t core);
+
+// Queue one record from any task (returns false when dropped or not started)
+bool telemetry_send(uint8_t type, const void *payload, size_t length);
+
+void telemetry_sample(uint32_t timestamp_ms, float object_c, float ambient_c);
+void telemetry_alert(uint8_t rule, uint8_t kind, bool active, float object_c, float rate_c_per_s, float threshold_c);
+void telemetry_profile(uint8_t id, uint32_t duration_us);
+void telemetry_button(uint8_t button, bool pressed);
+void telemetry_memory(const TelemetryMemory *memory);
+void telemetry_stack(const char *name, uint32_t stack_size, uint32_t min_free);
+
+void telemetry_get_stats(TelemetryStats *stats);
+
+#endif  // __TELEMETRY_H__
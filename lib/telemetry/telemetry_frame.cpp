@@ -0,0 +1,136 @@
+
+#include "telemetry_frame.hpp"
+#include <string.h>
+
+uint16_t telemetry_crc16(const void *data, size_t length, uint16_t crc) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  while (length--) {
+    crc ^= (uint16_t)(*bytes++) << 8;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+size_t telemetry_frame_encode(uint8_t type, uint16_t seq, const void *payload, size_t length, uint8_t *out) {
+  if (length > TELEMETRY_PAYLOAD_MAX) return 0;
+
+  uint8_t raw[TELEMETRY_PAYLOAD_MAX + TELEMETRY_FRAME_OVERHEAD];
+  raw[0] = type;
+  raw[1] = (uint8_t)seq;
+  raw[2] = (uint8_t)(seq >> 8);
+  if (length) memcpy(raw + 3, payload, length);
+  uint16_t crc = telemetry_crc16(raw, length + 3, 0xFFFF);
+  raw[length + 3] = (uint8_t)crc;
+  raw[length + 4] = (uint8_t)(crc >> 8);
+
+  // COBS: each code byte gives the distance to the next zero (raw frames are < 254 bytes)
+  size_t raw_length = length + TELEMETRY_FRAME_OVERHEAD;
+  size_t code_at = 0;
+  size_t n = 1;
+  for (size_t i = 0; i < raw_length; i++) {
+    if (raw[i] == 0) {
+      out[code_at] = (uint8_t)(n - code_at);
+      code_at = n++;
+    } else {
+      out[n++] = raw[i];
+    }
+  }
+  out[code_at] = (uint8_t)(n - code_at);
+  out[n++] = 0;
+  return n;
+}
+
+void telemetry_decoder_init(TelemetryDecoder *decoder) {
+  memset(decoder, 0, sizeof(*decoder));
+}
+
+// Decode one delimited chunk, false if it is not a valid frame
+static bool decode_chunk(TelemetryDecoder *decoder, TelemetryFrameHandler handler, void *context) {
+  uint8_t raw[TELEMETRY_FRAME_MAX];
+  size_t n = 0;
+  size_t i = 0;
+  while (i < decoder->length) {
+    uint8_t code = decoder->buffer[i++];
+    if (!code || i + code - 1 > decoder->length) return false;
+    for (uint8_t k = 1; k < code; k++) raw[n++] = decoder->buffer[i++];
+    if (code < 0xFF && i < decoder->length) raw[n++] = 0;
+  }
+
+  if (n < TELEMETRY_FRAME_OVERHEAD) return false;
+  size_t length = n - TELEMETRY_FRAME_OVERHEAD;
+  uint16_t crc = (uint16_t)(raw[n - 2] | (raw[n - 1] << 8));
+  if (telemetry_crc16(raw, length + 3, 0xFFFF) != crc) return false;
+
+  decoder->frames++;
+  if (handler) handler(context, raw[0], (uint16_t)(raw[1] | (raw[2] << 8)), raw + 3, length);
+  return true;
+}
+
+void telemetry_decoder_feed(TelemetryDecoder *decoder, const uint8_t *data, size_t length,
+                            TelemetryFrameHandler handler, void *context) {
+  for (size_t i = 0; i < length; i++) {
+    uint8_t byte = data[i];
+    if (byte) {
+      if (decoder->length < sizeof(decoder->buffer)) {
+        decoder->buffer[decoder->length++] = byte;
+      } else {
+        decoder->overflow = true;
+      }
+      continue;
+    }
+
+    // Delimiter: empty chunks are the padding in front of each transmission
+    if (decoder->overflow || (decoder->length && !decode_chunk(decoder, handler, context))) {
+      decoder->rejected++;
+    }
+    decoder->length = 0;
+    decoder->overflow = false;
+  }
+}
+
+void telemetry_ring_init(TelemetryRing *ring, uint8_t *buffer, uint32_t size) {
+  ring->data = buffer;
+  ring->size = size;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->high_water = 0;
+}
+
+uint32_t telemetry_ring_used(const TelemetryRing *ring) {
+  return ring->head - ring->tail;
+}
+
+bool telemetry_ring_push(TelemetryRing *ring, const uint8_t *frame, size_t length) {
+  uint32_t used = telemetry_ring_used(ring);
+  if (length > ring->size - used) return false;
+
+  uint32_t at = ring->head & (ring->size - 1);
+  uint32_t first = ring->size - at;
+  if (first > length) first = length;
+  memcpy(ring->data + at, frame, first);
+  memcpy(ring->data, frame + first, length - first);
+  ring->head += length;
+  if (used + length > ring->high_water) ring->high_water = used + length;
+  return true;
+}
+
+size_t telemetry_ring_pop(TelemetryRing *ring, uint8_t *out, size_t max) {
+  uint32_t used = telemetry_ring_used(ring);
+  size_t n = used < max ? used : max;
+  if (!n) return 0;
+
+  uint32_t at = ring->tail & (ring->size - 1);
+  size_t first = ring->size - at;
+  if (first > n) first = n;
+  memcpy(out, ring->data + at, first);
+  memcpy(out + first, ring->data, n - first);
+
+  // The ring holds whole frames, so only a partial take needs trimming
+  if (n < used) {
+    while (n && out[n - 1]) n--;
+  }
+  ring->tail += n;
+  return n;
+}
@@ -0,0 +1,141 @@
+#ifndef __TELEMETRY_FRAME_H__
+#define __TELEMETRY_FRAME_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary telemetry framing.
+// A frame is [type u8][seq u16][payload][crc u16] (little-endian, CRC-16/CCITT-FALSE
+// over type, seq and payload), COBS-encoded and terminated by 0x00. COBS output never
+// contains 0x00, so a receiver resynchronizes at the next delimiter after line noise or
+// a debug text line printed on the same port. The writer starts every transmission with
+// an extra 0x00, which keeps such text from running into the first frame that follows.
+//
+// seq counts every frame the producer attempted, so a gap on the host shows frames lost
+// on the device (ring full) or in transport.
+//
+// The library has no platform dependencies (see telemetry.hpp for the ESP32 streaming
+// task; tools/telemetry_decode.py is the host decoder).
+
+#define TELEMETRY_PAYLOAD_MAX 64
+#define TELEMETRY_FRAME_OVERHEAD 5   // type, seq, crc
+// Encoded size bound: one COBS code byte per 254 bytes (payloads stay below that) plus
+// the trailing delimiter
+#define TELEMETRY_FRAME_MAX (TELEMETRY_PAYLOAD_MAX + TELEMETRY_FRAME_OVERHEAD + 2)
+
+// Record types and payloads (fields are little-endian, floats in Celsius)
+enum TelemetryType {
+  TELEMETRY_SAMPLE = 1,
+  TELEMETRY_ALERT = 2,
+  TELEMETRY_PROFILE = 3,
+  TELEMETRY_STATUS = 4,
+  TELEMETRY_BUTTON = 5,
+  TELEMETRY_MEMORY = 6,
+  TELEMETRY_STACK = 7
+};
+
+struct TelemetrySample {
+  uint32_t timestamp_ms;
+  float object_c;
+  float ambient_c;
+};
+
+struct TelemetryAlert {
+  uint32_t timestamp_ms;
+  uint8_t rule;          // Index into the alert rule table
+  uint8_t kind;          // AlertRuleKind
+  uint8_t active;        // 1 = fired, 0 = cleared
+  uint8_t reserved;
+  float object_c;
+  float rate_c_per_s;
+  float threshold_c;     // Per second for rate rules
+};
+
+struct TelemetryProfile {
+  uint32_t timestamp_ms;
+  uint32_t duration_us;
+  uint8_t id;            // Application-defined section
+  uint8_t reserved[3];
+};
+
+// Button edge, for trace capture (lib/sensor_trace)
+struct TelemetryButton {
+  uint32_t timestamp_ms;
+  uint8_t button;        // HalButton
+  uint8_t pressed;
+  uint8_t reserved[2];
+};
+
+// Heap state, sent with the stack records every MEM_MONITOR_PERIOD_MS (lib/mem_monitor).
+// Regions the board does not have read as zero.
+struct TelemetryMemory {
+  uint32_t timestamp_ms;
+  uint32_t internal_free;
+  uint32_t internal_largest;
+  uint32_t internal_min_free;
+  uint32_t dma_free;
+  uint32_t dma_largest;
+  uint32_t psram_free;
+  uint32_t psram_largest;
+  uint32_t lvgl_used;
+  uint32_t lvgl_free;
+  uint32_t lvgl_largest;
+  uint32_t warnings;     // Active MEM_WARN_* bits
+};
+
+// One task's stack high-water mark
+struct TelemetryStack {
+  uint32_t timestamp_ms;
+  uint32_t stack_size;
+  uint32_t min_free;     // Fewest free bytes since the task started
+  char name[16];         // NUL-padded
+};
+
+// Sent by the streaming task about once a second
+struct TelemetryStatus {
+  uint32_t timestamp_ms;
+  uint32_t frames;       // Frames queued since boot
+  uint32_t dropped;      // Frames dropped because the ring was full
+  uint32_t bytes;        // Bytes handed to the port
+};
+
+// Byte ring holding whole encoded frames (size must be a power of two). Not locked:
+// the caller serializes producers and the consumer.
+struct TelemetryRing {
+  uint8_t *data;
+  uint32_t size;
+  uint32_t head;         // Free-running write position
+  uint32_t tail;         // Free-running read position
+  uint32_t high_water;   // Most bytes ever held
+};
+
+typedef void (*TelemetryFrameHandler)(void *context, uint8_t type, uint16_t seq,
+                                      const uint8_t *payload, size_t length);
+
+// Streaming receiver state
+struct TelemetryDecoder {
+  uint8_t buffer[TELEMETRY_FRAME_MAX];
+  size_t length;
+  bool overflow;         // Current chunk is longer than any frame
+  uint32_t frames;       // Frames delivered to the handler
+  uint32_t rejected;     // Chunks that were not a valid frame (noise, text, CRC errors)
+};
+
+uint16_t telemetry_crc16(const void *data, size_t length, uint16_t crc);
+
+// Encode one frame into out (TELEMETRY_FRAME_MAX bytes), returns its length including
+// the trailing delimiter or 0 when the payload is too long
+size_t telemetry_frame_encode(uint8_t type, uint16_t seq, const void *payload, size_t length, uint8_t *out);
+
+void telemetry_decoder_init(TelemetryDecoder *decoder);
+void telemetry_decoder_feed(TelemetryDecoder *decoder, const uint8_t *data, size_t length,
+                            TelemetryFrameHandler handler, void *context);
+
+void telemetry_ring_init(TelemetryRing *ring, uint8_t *buffer, uint32_t size);
+uint32_t telemetry_ring_used(const TelemetryRing *ring);
+// Store a whole frame, or nothing when it does not fit
+bool telemetry_ring_push(TelemetryRing *ring, const uint8_t *frame, size_t length);
+// Take up to max bytes ending on a frame boundary (max >= TELEMETRY_FRAME_MAX)
+size_t telemetry_ring_pop(TelemetryRing *ring, uint8_t *out, size_t max);
+
+#endif  // __TELEMETRY_FRAME_H__
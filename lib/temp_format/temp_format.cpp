@@ -0,0 +1,70 @@
+
+#include "temp_format.hpp"
+
+static const int32_t pow10_table[TEMP_FORMAT_MAX_DECIMALS + 1] = {1, 10, 100, 1000};
+
+int32_t temp_to_fixed(float value, uint8_t decimals) {
+    if (decimals > TEMP_FORMAT_MAX_DECIMALS) decimals = TEMP_FORMAT_MAX_DECIMALS;
+
+    float scaled = value * (float)pow10_table[decimals];
+    if (scaled >= 2147483647.0f) return INT32_MAX;
+    if (scaled <= -2147483647.0f) return -INT32_MAX;
+    if (scaled != scaled) return 0;  // NaN from a failed sensor read
+
+    return (int32_t)(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+}
+
+// Append a NUL-terminated string, leaving room for the terminator
+static size_t append_str(char *buf, size_t size, size_t len, const char *str) {
+    if (!str) return len;
+    while (*str && len + 1 < size) buf[len++] = *str++;
+    return len;
+}
+
+size_t temp_format_fixed(char *buf, size_t size, const char *prefix, int32_t fixed, const TempFormat &fmt) {
+    if (!buf || size == 0) return 0;
+
+    uint8_t decimals = fmt.decimals > TEMP_FORMAT_MAX_DECIMALS ? TEMP_FORMAT_MAX_DECIMALS : fmt.decimals;
+    size_t len = append_str(buf, size, 0, prefix);
+
+    // Sign is decided after rounding, so -0.3 at 0 decimals prints "0" rather than "-0"
+    uint32_t magnitude;
+    char sign = 0;
+    if (fixed < 0) {
+        sign = '-';
+        magnitude = (uint32_t)(-(int64_t)fixed);
+    } else {
+        if (fmt.show_plus && fixed > 0) sign = '+';
+        magnitude = (uint32_t)fixed;
+    }
+
+    // Render digits right to left; at most 10 digits + '.' + leading zero
+    char digits[16];
+    int pos = sizeof(digits);
+    int digit_count = 0;
+    do {
+        if (decimals && digit_count == decimals) digits[--pos] = '.';
+        digits[--pos] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+        digit_count++;
+    } while (magnitude || digit_count <= decimals);
+
+    if (sign && len + 1 < size) buf[len++] = sign;
+    while (pos < (int)sizeof(digits) && len + 1 < size) buf[len++] = digits[pos++];
+
+    len = append_str(buf, size, len, fmt.suffix);
+    buf[len] = '\0';
+    return len;
+}
+
+size_t temp_format(char *buf, size_t size, const char *prefix, float value, const TempFormat &fmt) {
+    if (value != value) {
+        if (!buf || size == 0) return 0;
+        size_t len = append_str(buf, size, 0, prefix);
+        len = append_str(buf, size, len, TEMP_FORMAT_PLACEHOLDER);
+        len = append_str(buf, size, len, fmt.suffix);
+        buf[len] = '\0';
+        return len;
+    }
+    return temp_format_fixed(buf, size, prefix, temp_to_fixed(value, fmt.decimals), fmt);
+}
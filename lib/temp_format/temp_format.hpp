@@ -0,0 +1,32 @@
+#ifndef __TEMP_FORMAT_H__
+#define __TEMP_FORMAT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Integer-only temperature formatting for the UI update paths.
+// Keeps newlib's float printf out of the hot path: values are converted once to
+// fixed point (value * 10^decimals) and rendered digit by digit into a caller buffer.
+
+#define TEMP_FORMAT_MAX_DECIMALS 3
+#define TEMP_FORMAT_PLACEHOLDER "--"  // Shown instead of the digits for a NaN reading
+
+struct TempFormat {
+  uint8_t decimals;    // Digits after the decimal point (0..TEMP_FORMAT_MAX_DECIMALS)
+  bool show_plus;      // Prefix positive values with '+'
+  const char *suffix;  // Unit suffix such as "C" or " C" (may be NULL)
+};
+
+// Round a float reading to fixed point with the given number of decimals
+// (half away from zero, saturating at the int32 range)
+int32_t temp_to_fixed(float value, uint8_t decimals);
+
+// Render prefix + fixed-point value + suffix into buf (always NUL-terminated).
+// Returns the string length, truncating if buf is too small.
+size_t temp_format_fixed(char *buf, size_t size, const char *prefix, int32_t fixed, const TempFormat &fmt);
+
+// Convenience wrapper: temp_to_fixed() followed by temp_format_fixed(). A NaN value
+// (failed sensor read) renders prefix + TEMP_FORMAT_PLACEHOLDER + suffix.
+size_t temp_format(char *buf, size_t size, const char *prefix, float value, const TempFormat &fmt);
+
+#endif  // __TEMP_FORMAT_H__
@@ -0,0 +1,138 @@
+
+#include "temp_stats.hpp"
+#include <math.h>
+#include <string.h>
+
+static float window_value(const TempStatsWindow *window, uint32_t seq) {
+    return window->values[seq % TEMP_STATS_WINDOW_CAPACITY];
+}
+
+static uint32_t deque_front(const TempStatsDeque *deque) {
+    return deque->seq[deque->head];
+}
+
+static uint32_t deque_back(const TempStatsDeque *deque) {
+    return deque->seq[(deque->head + deque->len - 1) % TEMP_STATS_WINDOW_CAPACITY];
+}
+
+// Drop samples from the back that can no longer be the extreme, then append seq.
+// keep_min selects the min deque (values increase front to back) or the max deque.
+static void deque_push(TempStatsDeque *deque, const TempStatsWindow *window, uint32_t seq, bool keep_min) {
+    float value = window_value(window, seq);
+    while (deque->len) {
+        float back = window_value(window, deque_back(deque));
+        if (keep_min ? back < value : back > value) break;
+        deque->len--;
+    }
+    deque->seq[(deque->head + deque->len) % TEMP_STATS_WINDOW_CAPACITY] = seq;
+    deque->len++;
+}
+
+// Drop the front entry once it has left the window
+static void deque_expire(TempStatsDeque *deque, uint32_t oldest_seq) {
+    if (deque->len && deque_front(deque) < oldest_seq) {
+        deque->head = (deque->head + 1) % TEMP_STATS_WINDOW_CAPACITY;
+        deque->len--;
+    }
+}
+
+// Recompute mean/m2 exactly from the ring. Called once per window length, so the cost is
+// O(1) amortised and float rounding in the incremental updates cannot accumulate.
+static void window_resync(TempStatsWindow *window, uint32_t newest_seq) {
+    float sum = 0;
+    for (uint32_t i = 0; i < window->count; i++) sum += window_value(window, newest_seq - i);
+    float mean = sum / window->count;
+    float m2 = 0;
+    for (uint32_t i = 0; i < window->count; i++) {
+        float delta = window_value(window, newest_seq - i) - mean;
+        m2 += delta * delta;
+    }
+    window->mean = mean;
+    window->m2 = m2;
+}
+
+static void window_add(TempStatsWindow *window, float value) {
+    uint32_t seq = window->next_seq++;
+
+    if (window->count < window->length) {
+        // Welford insert
+        window->count++;
+        float delta = value - window->mean;
+        window->mean += delta / window->count;
+        window->m2 += delta * (value - window->mean);
+    } else {
+        // Welford replace: the sample leaving the window is overwritten below
+        float oldest = window_value(window, seq - window->length);
+        float old_mean = window->mean;
+        window->mean += (value - oldest) / window->count;
+        window->m2 += (value - oldest) * (value - window->mean + oldest - old_mean);
+        if (window->m2 < 0) window->m2 = 0;  // Rounding drift on a flat signal
+    }
+    window->values[seq % TEMP_STATS_WINDOW_CAPACITY] = value;
+    if (window->count == window->length && seq % window->length == 0) window_resync(window, seq);
+
+    uint32_t oldest_seq = seq + 1 - window->count;
+    deque_expire(&window->min_deque, oldest_seq);
+    deque_expire(&window->max_deque, oldest_seq);
+    deque_push(&window->min_deque, window, seq, true);
+    deque_push(&window->max_deque, window, seq, false);
+}
+
+void temp_stats_init(TempStats *stats, const uint16_t window_lengths[TEMP_STATS_WINDOWS]) {
+    memset(stats, 0, sizeof(*stats));
+    for (int i = 0; i < TEMP_STATS_WINDOWS; i++) {
+        uint16_t length = window_lengths[i];
+        if (length < 1) length = 1;
+        if (length > TEMP_STATS_WINDOW_CAPACITY) length = TEMP_STATS_WINDOW_CAPACITY;
+        stats->windows[i].length = length;
+    }
+}
+
+void temp_stats_reset(TempStats *stats) {
+    uint16_t lengths[TEMP_STATS_WINDOWS];
+    for (int i = 0; i < TEMP_STATS_WINDOWS; i++) lengths[i] = stats->windows[i].length;
+    temp_stats_init(stats, lengths);
+}
+
+void temp_stats_add(TempStats *stats, float value_c) {
+    if (value_c != value_c) return;  // NaN from a failed sensor read
+
+    TempStatsSession *session = &stats->session;
+    if (session->count == 0) {
+        session->min = value_c;
+        session->max = value_c;
+    } else {
+        if (value_c < session->min) session->min = value_c;
+        if (value_c > session->max) session->max = value_c;
+    }
+    session->count++;
+    float delta = value_c - session->mean;
+    session->mean += delta / session->count;
+    session->m2 += delta * (value_c - session->mean);
+
+    for (int i = 0; i < TEMP_STATS_WINDOWS; i++) {
+        window_add(&stats->windows[i], value_c);
+    }
+}
+
+void temp_stats_session(const TempStats *stats, TempStatsSummary *out) {
+    const TempStatsSession *session = &stats->session;
+    out->count = session->count;
+    out->min = session->min;
+    out->max = session->max;
+    out->mean = session->mean;
+    out->stddev = session->count ? sqrtf(session->m2 / session->count) : 0;
+}
+
+void temp_stats_window(const TempStats *stats, int window_idx, TempStatsSummary *out) {
+    const TempStatsWindow *window = &stats->windows[window_idx];
+    out->count = window->count;
+    if (!window->count) {
+        out->min = out->max = out->mean = out->stddev = 0;
+        return;
+    }
+    out->min = window_value(window, deque_front(&window->min_deque));
+    out->max = window_value(window, deque_front(&window->max_deque));
+    out->mean = window->mean;
+    out->stddev = sqrtf(window->m2 / window->count);
+}
@@ -0,0 +1,71 @@
+#ifndef __TEMP_STATS_H__
+#define __TEMP_STATS_H__
+
+#include <stdint.h>
+
+// Incremental statistics over the object temperature stream.
+// A session accumulator holds min/max and a Welford mean/variance since the last reset
+// (MIN/MAX/AVG hold). Each sliding window keeps the last N samples in a ring with a
+// Welford mean/variance that is updated as samples enter and leave, plus monotonic
+// deques for the window min and max. Adding a sample is O(1) amortised and memory
+// use is fixed at compile time.
+
+#define TEMP_STATS_WINDOW_CAPACITY 64  // Longest sliding window in samples
+#define TEMP_STATS_WINDOWS 2
+
+// Index of each sliding window (lengths are passed to temp_stats_init)
+#define TEMP_STATS_FAST 0  // Short window: stability indicator and alert input
+#define TEMP_STATS_SLOW 1  // Long window: recent range
+
+struct TempStatsSummary {
+  uint32_t count;  // Samples covered (0 = no data, other fields undefined)
+  float min;
+  float max;
+  float mean;
+  float stddev;    // Population standard deviation
+};
+
+struct TempStatsSession {
+  uint32_t count;
+  float min;
+  float max;
+  float mean;
+  float m2;        // Sum of squared deviations from the mean
+};
+
+// Monotonic deque of sample sequence numbers (ring over the window capacity)
+struct TempStatsDeque {
+  uint32_t seq[TEMP_STATS_WINDOW_CAPACITY];
+  uint16_t head;
+  uint16_t len;
+};
+
+struct TempStatsWindow {
+  uint16_t length;                            // Configured window length in samples
+  uint16_t count;                             // Samples currently in the window
+  uint32_t next_seq;                          // Sequence number of the next sample
+  float values[TEMP_STATS_WINDOW_CAPACITY];   // Indexed by seq % capacity
+  float mean;
+  float m2;
+  TempStatsDeque min_deque;                   // Increasing values, front = window min
+  TempStatsDeque max_deque;                   // Decreasing values, front = window max
+};
+
+struct TempStats {
+  TempStatsSession session;
+  TempStatsWindow windows[TEMP_STATS_WINDOWS];
+};
+
+// Window lengths are clamped to 1..TEMP_STATS_WINDOW_CAPACITY samples
+void temp_stats_init(TempStats *stats, const uint16_t window_lengths[TEMP_STATS_WINDOWS]);
+
+// Clear the session hold and all windows, keeping the window lengths
+void temp_stats_reset(TempStats *stats);
+
+// Add one Celsius sample (NaN readings are ignored)
+void temp_stats_add(TempStats *stats, float value_c);
+
+void temp_stats_session(const TempStats *stats, TempStatsSummary *out);
+void temp_stats_window(const TempStats *stats, int window, TempStatsSummary *out);
+
+#endif  // __TEMP_STATS_H__
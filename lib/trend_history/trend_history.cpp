@@ -0,0 +1,89 @@
+
+#include "trend_history.hpp"
+#include <string.h>
+
+static const TrendBucket empty_bucket = {TREND_NO_DATA, TREND_NO_DATA, TREND_NO_DATA};
+
+static int16_t to_tenths(float value_c) {
+    float tenths = value_c * 10.0f;
+    if (tenths != tenths) return TREND_NO_DATA;  // NaN from a failed sensor read
+    if (tenths > 32767.0f) return 32767;
+    if (tenths < -32767.0f) return -32767;
+    return (int16_t)(tenths < 0 ? tenths - 0.5f : tenths + 0.5f);
+}
+
+static void bucket_merge(TrendBucket *into, const TrendBucket &from) {
+    if (from.min < into->min) into->min = from.min;
+    if (from.max > into->max) into->max = from.max;
+    into->last = from.last;
+}
+
+static void level_push(TrendLevel *level, const TrendBucket &bucket) {
+    level->ring[level->head] = bucket;
+    level->head = (level->head + 1) % TREND_COLUMNS;
+    if (level->count < TREND_COLUMNS) level->count++;
+    level->closed_total++;
+}
+
+// Add a bucket stamped at timestamp_ms to a level, cascading closed buckets upwards
+static void level_add(TrendHistory *history, int level_idx, uint32_t timestamp_ms, const TrendBucket &bucket) {
+    TrendLevel *level = &history->levels[level_idx];
+    uint32_t index = timestamp_ms / level->period_ms;
+
+    if (level->open_valid && index == level->open_index) {
+        bucket_merge(&level->open, bucket);
+        return;
+    }
+
+    if (level->open_valid) {
+        level_push(level, level->open);
+        if (level_idx + 1 < TREND_LEVELS) {
+            level_add(history, level_idx + 1, level->open_index * level->period_ms, level->open);
+        }
+
+        // Columns skipped by a sampling gap stay visible as gaps (bounded by the ring size);
+        // on level 0 a column skipped by sample jitter repeats the previous value instead
+        if (index > level->open_index) {
+            uint32_t gap = index - level->open_index - 1;
+            if (gap > TREND_COLUMNS) gap = TREND_COLUMNS;
+            TrendBucket filler = empty_bucket;
+            if (level_idx == 0 && timestamp_ms - history->last_ms <= history->max_interval_ms) {
+                filler.min = filler.max = filler.last = level->open.last;
+            }
+            for (uint32_t i = 0; i < gap; i++) level_push(level, filler);
+        }
+    }
+
+    level->open = bucket;
+    level->open_index = index;
+    level->open_valid = true;
+}
+
+void trend_history_init(TrendHistory *history, const uint32_t periods_ms[TREND_LEVELS], uint32_t sample_ms) {
+    memset(history, 0, sizeof(*history));
+    for (int i = 0; i < TREND_LEVELS; i++) {
+        history->levels[i].period_ms = periods_ms[i];
+    }
+
+    uint32_t base = periods_ms[0];
+    uint32_t next = TREND_LEVELS > 1 ? periods_ms[1] : sample_ms;
+    while (base < next && (base < sample_ms || next % base != 0)) base++;
+    history->levels[0].period_ms = base;
+
+    // Samples up to half a period late still count as on time
+    history->max_interval_ms = sample_ms + sample_ms / 2;
+}
+
+void trend_history_add(TrendHistory *history, uint32_t timestamp_ms, float value_c) {
+    int16_t value = to_tenths(value_c);
+    if (value == TREND_NO_DATA) return;
+
+    TrendBucket bucket = {value, value, value};
+    level_add(history, 0, timestamp_ms, bucket);
+    history->last_ms = timestamp_ms;
+}
+
+const TrendBucket *trend_history_column(const TrendLevel *level, uint16_t age) {
+    if (age >= level->count) return NULL;
+    return &level->ring[(level->head + TREND_COLUMNS - 1 - age) % TREND_COLUMNS];
+}
@@ -0,0 +1,54 @@
+#ifndef __TREND_HISTORY_H__
+#define __TREND_HISTORY_H__
+
+#include <stdint.h>
+
+// Fixed-size min/max/last history for the trend chart.
+// Each level is a ring of TREND_COLUMNS buckets, one per chart column. Samples go into
+// the open bucket of level 0; when a bucket closes it is appended to its ring and merged
+// into the open bucket of the next (coarser) level. Adding a sample is O(1) amortised
+// regardless of the time span shown, and memory use is fixed at compile time.
+//
+// A column needs at least one sample, so init raises the level 0 period to the sample
+// period when it is shorter. A column skipped while samples keep arriving on time (a
+// sample landing just past a column edge) repeats the previous value instead of
+// showing up as a gap; only a real pause in sampling leaves TREND_NO_DATA columns.
+
+#define TREND_COLUMNS 120
+#define TREND_LEVELS 3
+#define TREND_NO_DATA INT16_MIN  // Column without samples (sensor gap)
+
+// Values are stored in tenths of a degree Celsius
+struct TrendBucket {
+  int16_t min;
+  int16_t max;
+  int16_t last;
+};
+
+struct TrendLevel {
+  uint32_t period_ms;             // Time covered by one column
+  uint32_t open_index;            // timestamp / period_ms of the open bucket
+  bool open_valid;
+  TrendBucket open;               // Bucket still accumulating samples
+  TrendBucket ring[TREND_COLUMNS];
+  uint16_t head;                  // Slot the next closed column goes to
+  uint16_t count;                 // Valid columns in ring
+  uint32_t closed_total;          // Columns closed since init (views use it to detect new data)
+};
+
+struct TrendHistory {
+  TrendLevel levels[TREND_LEVELS];
+  uint32_t max_interval_ms;       // Longest sample spacing that is not a gap
+  uint32_t last_ms;               // Timestamp of the last sample added
+};
+
+// periods_ms must grow level by level, each an integer multiple of the previous one.
+// Level 0 becomes the shortest divisor of the level 1 period that is at least
+// sample_ms (read it back from levels[0].period_ms for the span shown).
+void trend_history_init(TrendHistory *history, const uint32_t periods_ms[TREND_LEVELS], uint32_t sample_ms);
+void trend_history_add(TrendHistory *history, uint32_t timestamp_ms, float value_c);
+
+// Closed column by age (0 = newest). Returns NULL if age >= count.
+const TrendBucket *trend_history_column(const TrendLevel *level, uint16_t age);
+
+#endif  // __TREND_HISTORY_H__
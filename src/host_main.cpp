@@ -0,0 +1,199 @@
+
+#ifndef ESP_PLATFORM
+
+// Linux entry point of the host build (env:native). Runs the firmware's setup() and
+// loop() on the mock HAL: simulated sensor, headless framebuffer, RAM flash.
+//
+//   .pio/build/native/program [--seconds N] [--screenshot out.ppm] [--flash flash.bin]
+//                             [--replay run.trc [--speed X] [--min-rate N] [--max-latency-us N]]
+//
+// --seconds stops after N seconds of uptime (default: run until killed), --screenshot
+// saves the last frame and --flash keeps settings and the sample log in a file.
+//
+// --replay feeds a sensor trace (lib/sensor_trace) through the firmware instead of the
+// simulated sensor: samples go into the sensor queue with their trace timestamps, so
+// filters, alerts and charts see exactly the captured readings, and button records
+// press the HAL buttons that loop() polls. --speed 1 (default) keeps the original
+// timing, N replays N times faster and 0 as fast as loop() consumes. Button presses are
+// replayed one per loop() pass, but debouncing still runs on the wall clock, so only
+// speed 1 keeps presses that were close together. Without --seconds the program stops
+// once the trace is consumed and prints the replay throughput and sensor queue latency
+// as bench lines; --min-rate (samples/s) and --max-latency-us make it exit with status 1
+// when they are not met, for regression runs.
+// Benchmark builds (env:native-bench) run their benchmarks in setup() and stop right
+// after it unless --seconds is given.
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "hal.hpp"
+#include "debug_log.hpp"
+#include "sensor_trace.hpp"
+
+void setup();
+void loop();
+bool publish_sensor_sample(uint32_t timestamp_ms, float object_c, float ambient_c, TickType_t wait);
+void bench_print_value(const char *name, double value);
+extern bool sensor_task_enabled;
+extern uint32_t sensor_samples_consumed;
+extern uint32_t sensor_max_latency_us;
+extern uint64_t sensor_total_latency_us;
+
+struct Replay {
+  std::vector<SensorTraceRecord> records;
+  SensorTracePlayer player;
+  bool held;                  // records[player.next - 1] is a sample waiting for queue room
+  uint32_t samples;
+  uint32_t buttons;
+  uint32_t base_ms;           // hal_millis() that the first trace timestamp maps to
+  uint32_t start_us;
+};
+
+static void usage(const char *program) {
+  fprintf(stderr, "usage: %s [--seconds N] [--screenshot out.ppm] [--flash flash.bin]\n"
+                  "          [--replay run.trc [--speed X] [--min-rate N] [--max-latency-us N]]\n", program);
+  exit(2);
+}
+
+static bool load_trace(const char *path, std::vector<SensorTraceRecord> *records) {
+  FILE *f = fopen(path, "rb");
+  if (!f) return false;
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t length;
+  while ((length = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + length);
+  fclose(f);
+
+  records->resize(data.size() / SENSOR_TRACE_RECORD_SIZE + 1);
+  int32_t count = sensor_trace_parse(data.empty() ? NULL : &data[0], data.size(), &(*records)[0], records->size());
+  if (count < 0) return false;
+  records->resize(count);
+  return true;
+}
+
+// Hand the records due now to the firmware: samples until the queue is full, at most
+// one button edge per loop() pass so every press is seen
+static void replay_step(Replay *replay) {
+  SensorTraceRecord record;
+  for (;;) {
+    if (replay->held) {
+      record = replay->records[replay->player.next - 1];
+    } else if (!sensor_trace_player_next(&replay->player, millis(), &record)) {
+      return;
+    }
+
+    if (record.type == SENSOR_TRACE_BUTTON) {
+      hal_native_set_button((HalButton)record.button, record.pressed);
+      replay->buttons++;
+      return;
+    }
+    if (record.type != SENSOR_TRACE_SAMPLE) continue;
+
+    uint32_t timestamp_ms = replay->base_ms + (record.timestamp_ms - replay->records[0].timestamp_ms);
+    replay->held = !publish_sensor_sample(timestamp_ms, record.object_c, record.ambient_c, 0);
+    if (replay->held) return;
+    replay->samples++;
+  }
+}
+
+int main(int argc, char **argv) {
+  uint32_t run_ms = 0;
+  const char *screenshot = NULL;
+  const char *replay_path = NULL;
+  float replay_speed = 1;
+  float min_rate = 0;
+  uint32_t max_latency_us = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) usage(argv[0]);
+    if (!strcmp(argv[i], "--seconds")) {
+      run_ms = (uint32_t)(atof(argv[++i]) * 1000);
+    } else if (!strcmp(argv[i], "--screenshot")) {
+      screenshot = argv[++i];
+    } else if (!strcmp(argv[i], "--flash")) {
+      hal_native_set_storage_file(argv[++i]);
+    } else if (!strcmp(argv[i], "--replay")) {
+      replay_path = argv[++i];
+    } else if (!strcmp(argv[i], "--speed")) {
+      replay_speed = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "--min-rate")) {
+      min_rate = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "--max-latency-us")) {
+      max_latency_us = strtoul(argv[++i], NULL, 10);
+    } else {
+      usage(argv[0]);
+    }
+  }
+
+  Replay replay;
+  if (replay_path) {
+    if (!load_trace(replay_path, &replay.records)) {
+      fprintf(stderr, "Cannot read trace %s\n", replay_path);
+      return 1;
+    }
+    sensor_task_enabled = false;
+  }
+
+  setup();
+#if defined(NCIR_RENDER_BENCHMARK) || defined(NCIR_HISTORY_BENCHMARK)
+  if (!run_ms) run_ms = 1;
+#endif
+
+  if (replay_path) {
+    replay.held = false;
+    replay.samples = 0;
+    replay.buttons = 0;
+    replay.base_ms = millis();
+    replay.start_us = micros();
+    sensor_trace_player_start(&replay.player, replay.records.empty() ? NULL : &replay.records[0],
+                              replay.records.size(), replay_speed, replay.base_ms);
+  }
+
+  while (!run_ms || millis() < run_ms) {
+    if (replay_path) {
+      replay_step(&replay);
+      bool consumed = sensor_trace_player_done(&replay.player) && !replay.held &&
+                      sensor_samples_consumed >= replay.samples;
+      if (consumed && !run_ms) break;
+    }
+    loop();
+  }
+
+  int status = 0;
+  if (replay_path) {
+    uint32_t elapsed_us = micros() - replay.start_us;
+    float rate = elapsed_us ? replay.samples * 1e6f / elapsed_us : 0;
+    uint32_t avg_latency_us = sensor_samples_consumed ? (uint32_t)(sensor_total_latency_us / sensor_samples_consumed) : 0;
+    bench_print_value("replay_samples", replay.samples);
+    bench_print_value("replay_buttons", replay.buttons);
+    bench_print_value("replay_wall_ms", elapsed_us / 1000);
+    bench_print_value("replay_samples_per_s", rate);
+    bench_print_value("replay_latency_avg_us", avg_latency_us);
+    bench_print_value("replay_latency_max_us", sensor_max_latency_us);
+    if (min_rate > 0 && rate < min_rate) {
+      fprintf(stderr, "Replay rate %.1f samples/s is below %.1f\n", rate, min_rate);
+      status = 1;
+    }
+    if (max_latency_us && sensor_max_latency_us > max_latency_us) {
+      fprintf(stderr, "Sensor queue latency %u us is above %u us\n", sensor_max_latency_us, max_latency_us);
+      status = 1;
+    }
+  }
+  if (screenshot && !hal_native_save_ppm(screenshot)) {
+    fprintf(stderr, "Cannot write %s\n", screenshot);
+    status = 1;
+  }
+  HalNativeStats stats;
+  hal_native_get_stats(&stats);
+  fprintf(stderr, "host: %u flushes, %llu pixels, %u clips played\n", stats.flushes,
+          (unsigned long long)stats.pixels, stats.clips_played);
+
+  // The firmware tasks never return: leave without running static destructors under them
+  debug_log_flush(1000);
+  fflush(stdout);
+  _exit(status);
+}
+
+#endif  // !ESP_PLATFORM
@@ -1,20 +1,25 @@
 #include <Arduino.h>
-#include <M5Unified.h>
-#include <Wire.h>
-#include <Adafruit_MLX90614.h>
 #include <lvgl.h>
 #include "lv_conf.h"
+#include "hal.hpp"
 #include "m5gfx_lvgl.hpp"
-#include <Preferences.h>
-
-Adafruit_MLX90614 mlx = Adafruit_MLX90614();
-
-// Hardware pins for button polling
-#define LED_PIN 9
-#define NUM_LEDS 1
-#define BUTTON1_PIN 17
-#define BUTTON2_PIN 18
-#define KEY_PIN 8
+#include "lvgl_heap.hpp"
+#include "temp_format.hpp"
+#include "display_math.hpp"
+#include "ui_fonts.h"
+#include "trend_history.hpp"
+#include "temp_stats.hpp"
+#include "alert_rules.hpp"
+#include "led_pattern.hpp"
+#include "sound_player.hpp"
+#include "sounds/alert_sounds.h"
+#include "sample_log.hpp"
+#include "log_index.hpp"
+#include "flash_journal.hpp"
+#include "telemetry.hpp"
+#include "debug_log.hpp"
+#include "mem_monitor.hpp"
+#include "button_input.hpp"
 
 // Screen dimensions for CoreS3
 #define SCREEN_WIDTH 320
@@ -24,13 +29,43 @@ Adafruit_MLX90614 mlx = Adafruit_MLX90614();
 // LVGL Refresh time
 static const uint32_t screenTickPeriod = 10;
 static uint32_t lastLvglTick = 0;
+static uint32_t lvgl_idle_ms = 0;  // Until the next LVGL timer, from the last lv_task_handler()
+
+// Power management (hal_power_begin): CPU clock range and automatic light sleep. Instead
+// of a fixed 10 ms delay loop() blocks until its next deadline - an LVGL timer, a
+// button poll or a sensor sample (the sensor task notifies it) - so the idle task can
+// drop the clock and light-sleep in between.
+#ifndef NCIR_POWER_MAX_MHZ
+#define NCIR_POWER_MAX_MHZ 240
+#endif
+#ifndef NCIR_POWER_MIN_MHZ
+#define NCIR_POWER_MIN_MHZ 80
+#endif
+// Telemetry streams over the USB CDC serial port, which light sleep suspends
+#ifndef NCIR_LIGHT_SLEEP
+#ifdef NCIR_TELEMETRY
+#define NCIR_LIGHT_SLEEP 0
+#else
+#define NCIR_LIGHT_SLEEP 1
+#endif
+#endif
+#define POWER_IDLE_MAX_MS 50        // Longest wait, buttons are polled
+#define POWER_HELD_WAIT_MS 10       // While a button is held (long press and repeat timing)
+#define POWER_CURRENT_PERIOD_MS 1000
+#define HAL_UPDATE_PERIOD_MS 100    // M5 state (power button, PMIC) whatever the touch mode
+
+HalPowerMode power_mode = HAL_POWER_FULL;
+TaskHandle_t loop_task = NULL;      // Notified by the sensor task for every sample
 
 // Screen states
 enum ScreenState {
     SCREEN_MAIN_MENU,
     SCREEN_TEMP_DISPLAY,
     SCREEN_TEMP_GAUGE,
-    SCREEN_SETTINGS
+    SCREEN_SETTINGS,
+    SCREEN_TREND,
+    SCREEN_HISTORY,
+    SCREEN_DIAGNOSTICS
 };
 
 // Settings screens (page-based instead of tabs)
@@ -42,20 +77,89 @@ enum SettingsScreen {
     SETTINGS_EXIT
 };
 
-// Input states
-volatile bool button1_pressed = false;
-volatile bool button2_pressed = false;
-volatile bool key_pressed = false;
+#define SCREEN_COUNT (SCREEN_DIAGNOSTICS + 1)
+#define SETTINGS_PAGE_COUNT (SETTINGS_EXIT + 1)
+#define SETTINGS_MENU_ITEMS 4
 
-  // Settings navigation state
+// Settings navigation state
 SettingsScreen current_settings_screen = SETTINGS_MENU;
 int current_settings_selection = 0; // current selected menu item (0-3 for 4 items)
 bool exit_selection_cancel = true; // true = Cancel selected (Button 1), false = Save&Exit selected (Button 2)
-unsigned long last_button_time[3] = {0, 0, 0}; // Debounce timers for each button
-const unsigned long DEBOUNCE_DELAY = 150; // Reduced debounce delay for better responsiveness
+
+// Button input - button_input.hpp turns the polled levels into press events, which
+// input_table maps to actions per screen (and per page on the settings screen):
+//   PRESS_SHORT   on the press, or on release before BUTTON_LONG_MS when the button
+//                 also has a PRESS_LONG binding
+//   PRESS_LONG    once the button has been held BUTTON_LONG_MS
+//   PRESS_REPEAT  every BUTTON_REPEAT_MS while held after that, and on the press too
+//                 when the button has neither of the other two
+//   PRESS_RELEASE on the release, after whichever of the above fired
+// A press that changes the screen does not act on the new one with its later events.
+enum InputPress {
+  PRESS_SHORT,
+  PRESS_LONG,
+  PRESS_REPEAT,
+  PRESS_RELEASE,
+  PRESS_TYPES
+};
+
+#define INPUT_ANY_PAGE -1
+#define INPUT_CONTEXTS (SCREEN_COUNT + SETTINGS_PAGE_COUNT)  // Screens, then settings pages
+
+struct InputBinding {
+  uint8_t screen;        // ScreenState
+  int8_t page;           // SettingsScreen on SCREEN_SETTINGS, else INPUT_ANY_PAGE
+  uint8_t button;        // HalButton
+  uint8_t press;         // InputPress
+  void (*action)(int arg);
+  int arg;
+};
+
+ButtonInput button_input;
+static const InputBinding *input_table[INPUT_CONTEXTS][HAL_BUTTON_COUNT][PRESS_TYPES];
+static int8_t input_press_context[HAL_BUTTON_COUNT];  // Context each held button went down in
+
+// Buttons bound to input_key() reach LVGL as keys of a keypad input device, queued as
+// press/release pairs and read by keypad_read(). On the settings pages they move the
+// focus of settings_group and click the focused widget.
+#define KEYPAD_QUEUE_SIZE 8
+
+struct KeypadEvent {
+  uint32_t key;          // LV_KEY_*
+  bool pressed;
+};
+
+lv_indev_t *keypad_indev;
+static KeypadEvent keypad_queue[KEYPAD_QUEUE_SIZE];
+static uint8_t keypad_head = 0;
+static uint8_t keypad_count = 0;
 
 // Display settings
 int brightness_level = 128; // 0-255
+
+// Backlight idle policy: dim to NCIR_DIM_LEVEL after NCIR_DIM_AFTER_S without input, then
+// switch the backlight off and stop rendering after NCIR_OFF_AFTER_S (0 disables a
+// step). A button press or a firing alert wakes the display at once; the press that
+// wakes it from off does nothing else.
+#ifndef NCIR_DIM_AFTER_S
+#define NCIR_DIM_AFTER_S 30
+#endif
+#ifndef NCIR_OFF_AFTER_S
+#define NCIR_OFF_AFTER_S 120
+#endif
+#ifndef NCIR_DIM_LEVEL
+#define NCIR_DIM_LEVEL 20
+#endif
+#define BRIGHTNESS_MIN 16
+#define BRIGHTNESS_STEP 32
+
+enum DisplayState {
+  DISPLAY_ACTIVE,
+  DISPLAY_DIMMED,
+  DISPLAY_OFF            // Backlight off, LVGL not run
+};
+
+DisplayState display_state = DISPLAY_ACTIVE;
 bool sound_enabled = true;
 int sound_volume = 70; // 0-100
 
@@ -64,23 +168,189 @@ float low_temp_threshold = 10.0;
 float high_temp_threshold = 40.0;
 bool alerts_enabled = true;
 
+// Alert rule table - the low/high rules follow the threshold sliders, the rest are
+// loaded from NVS ("alert_rules" blob) or taken from the defaults below
+#define ALERT_RULE_LOW 0
+#define ALERT_RULE_HIGH 1
+
+// LED patterns referenced by AlertRule::led_pattern
+enum AlertLedPattern {
+  ALERT_LED_SOLID,
+  ALERT_LED_SLOW_BLINK,
+  ALERT_LED_FAST_BLINK,
+  ALERT_LED_PULSE
+};
+
+static const LedPattern alert_led_patterns[] = {
+  {LED_PATTERN_SOLID, 255, 0, 0},
+  {LED_PATTERN_BLINK, 255, 500, 500},
+  {LED_PATTERN_BLINK, 255, 120, 120},
+  {LED_PATTERN_PULSE, 255, 800, 800},
+};
+
+// Sound cues referenced by AlertRule::sound
+enum AlertSoundCue {
+  ALERT_CUE_LOW,
+  ALERT_CUE_HIGH,
+  ALERT_CUE_RISE,
+  ALERT_CUE_FALL
+};
+
+static const AlertRuleTable default_alert_rules = {
+  ALERT_TABLE_VERSION, 4, {
+    // kind                actions                                                         sound           LED pattern           priority    thr hyst sustain_ds cooldown_s
+    {ALERT_RULE_BELOW,     ALERT_ACTION_SOUND | ALERT_ACTION_LED | ALERT_ACTION_LOG | ALERT_ACTION_READOUT, ALERT_CUE_LOW,  ALERT_LED_SLOW_BLINK, 2, 0, 100, 20, 0,  0},
+    {ALERT_RULE_ABOVE,     ALERT_ACTION_SOUND | ALERT_ACTION_LED | ALERT_ACTION_LOG | ALERT_ACTION_READOUT, ALERT_CUE_HIGH, ALERT_LED_FAST_BLINK, 3, 0, 400, 20, 0,  0},
+    {ALERT_RULE_RISE_RATE, ALERT_ACTION_SOUND | ALERT_ACTION_LED | ALERT_ACTION_LOG,                        ALERT_CUE_RISE, ALERT_LED_PULSE,      1, 0,  20,  5, 20, 30},
+    {ALERT_RULE_FALL_RATE, ALERT_ACTION_SOUND | ALERT_ACTION_LED | ALERT_ACTION_LOG,                        ALERT_CUE_FALL, ALERT_LED_PULSE,      1, 0,  20,  5, 20, 30},
+  }
+};
+
+AlertEngine alert_engine;
+uint32_t alert_fired_mask = 0;  // Rules fired since the last check_temp_alerts()
+
 // Current state
 ScreenState current_screen = SCREEN_MAIN_MENU;
 
+// Screens are built on first entry. When LVGL heap usage exceeds this budget, an
+// evictable screen is deleted as it is left and rebuilt on its next entry
+// (0 keeps every screen alive once built)
+#define SCREEN_MEM_BUDGET (48 * 1024)
+
 // Temperature variables
 bool use_celsius = true; // Use Celsius by default
 int update_rate = 500; // milliseconds - faster update rate for live reading
-unsigned long last_update = 0;
 float current_object_temp = 0;
 float current_ambient_temp = 0;
 
-// Preferences for persistent storage
-Preferences preferences;
+// Sample published by the sensor task
+struct TempSample {
+  uint32_t timestamp_ms;
+  float object_temp;   // Celsius
+  float ambient_temp;  // Celsius
+  uint32_t queued_us;  // When it entered sensor_queue, for the queue latency
+};
+
+// Sliding statistics windows in samples (~4 s and ~30 s at the default update rate)
+static const uint16_t temp_stats_windows[TEMP_STATS_WINDOWS] = {8, 60};
+#define TEMP_STABLE_STDDEV_C 0.2f  // Fast-window spread below which the reading is "Stable"
+TempStats temp_stats;
+
+// Persistent storage - settings and the sample log share the "spiffs" data partition
+// as raw flash: [settings journal | sample log ring + WAL]. NVS (Preferences) is only
+// read once to migrate settings saved by older firmware. A save that changes nothing is
+// skipped, and the journal spreads the rest over 8 sectors (128 slots per erase cycle).
+#define SETTINGS_JOURNAL_SECTORS 8
+#define SETTINGS_SLOT_SIZE 256
+#define SETTINGS_VERSION 1
+#define SAMPLE_LOG_FLASH_BASE (SETTINGS_JOURNAL_SECTORS * FLASH_JOURNAL_SECTOR_SIZE)
+
+// Every setting in one journal record, so a save is a single append that either
+// lands completely or leaves the previous record in force
+struct StoredSettings {
+  uint16_t version;
+  uint16_t boot_id;
+  uint8_t use_celsius;
+  uint8_t sound_enabled;
+  uint8_t alerts_enabled;
+  uint8_t reserved;
+  int32_t update_rate;
+  int32_t brightness;
+  int32_t sound_volume;
+  float low_temp_threshold;
+  float high_temp_threshold;
+  AlertRuleTable alert_rules;
+};
+static_assert(sizeof(StoredSettings) <= FLASH_JOURNAL_PAYLOAD_MAX(SETTINGS_SLOT_SIZE), "settings record too large");
+
+FlashJournalIo flash_io;
+FlashJournal settings_journal;
+StoredSettings saved_settings;  // Newest record in the journal, to skip identical saves
+bool settings_saved = false;
+bool flash_ready = false;
+uint16_t boot_id = 0;  // Incremented on every boot, tags sample log blocks
+
+// LVGL and the UI run in the Arduino loop task on core 1 (there is no separate LVGL
+// task). Its stack is set here rather than left to the core default so it can be sized
+// from the high-water mark on the diagnostics screen
+#define LOOP_STACK_SIZE 8192
+#ifdef ESP_PLATFORM
+SET_LOOP_TASK_STACK_SIZE(LOOP_STACK_SIZE);
+#endif
+
+// Sensor task parameters - runs above the LVGL draw threads (LV_DRAW_THREAD_PRIO) so
+// rendering on either core never delays a sample
+#define SENSOR_TASK_CORE 0
+#define SENSOR_TASK_PRIORITY 6
+#define SENSOR_STACK_SIZE 4096
+#define SENSOR_QUEUE_LENGTH 8
+
+// Sample log flush task - only writes finished blocks to flash
+#define SAMPLE_LOG_TASK_CORE 0
+#define SAMPLE_LOG_TASK_PRIORITY 1
+
+// Alert sound task - lowest application priority, it only feeds the speaker
+#define SOUND_TASK_CORE 0
+#define SOUND_TASK_PRIORITY 1
+
+// Debug log lines are formatted and printed by an idle-priority task (see debug_log.hpp),
+// so logging from loop() never waits for the serial port
+#define DEBUG_LOG_TASK_CORE 0
+#define DEBUG_LOG_TASK_PRIORITY tskIDLE_PRIORITY
+
+// Binary telemetry stream on the USB serial port (see tools/telemetry_decode.py) -
+// drained by a low-priority task so a slow host never holds up the UI
+#define TELEMETRY_TASK_CORE 0
+#define TELEMETRY_TASK_PRIORITY 1
+
+// Sections timed in TELEMETRY_PROFILE records (names in tools/telemetry_decode.py)
+enum TelemetryProfileId {
+  PROFILE_LVGL_HANDLER,   // lv_task_handler() call
+  PROFILE_SENSOR_READ,    // Object and ambient I2C reads
+  PROFILE_SCREEN_BUILD    // Screen created on first entry
+};
+
+QueueHandle_t sensor_queue = NULL;
+volatile uint32_t sensor_overruns = 0;     // Samples dropped because the queue was full
+volatile uint32_t sensor_max_period_ms = 0; // Worst observed sampling period
+// Without the sensor task samples come from publish_sensor_sample() callers only (trace
+// replay in the host build, see src/host_main.cpp)
+bool sensor_task_enabled = true;
+
+// Samples consumed by loop() and their time in sensor_queue (loop task only)
+uint32_t sensor_samples_consumed = 0;
+uint32_t sensor_max_latency_us = 0;
+uint64_t sensor_total_latency_us = 0;
+
+// Memory monitor - heap regions, LVGL heap and task stacks, sampled every
+// MEM_MONITOR_PERIOD_MS by loop() (see mem_monitor.hpp)
+struct MonitoredTask {
+  const char *name;
+  const char *task_name;  // FreeRTOS task name, NULL for the two kinds below
+  int8_t draw_unit;       // LVGL SW draw unit whose thread this is, -1 if none
+  uint32_t stack_size;
+};
+
+// The loop task is measured as the caller (collect_memory_snapshot() runs in loop()).
+// LVGL creates one thread per SW draw unit, all named "swdraw", so those are looked up
+// by the handle of their draw unit.
+static const MonitoredTask monitored_tasks[] = {
+  {"loop", NULL, -1, LOOP_STACK_SIZE},
+  {"sensor", "sensor", -1, SENSOR_STACK_SIZE},
+  {"sound", "sound", -1, SOUND_PLAYER_STACK_SIZE},
+  {"sample_log", "sample_log", -1, SAMPLE_LOG_STACK_SIZE},
+  {"debug_log", "debug_log", -1, DEBUG_LOG_STACK_SIZE},
+  {"telemetry", "telemetry", -1, TELEMETRY_STACK_SIZE},
+  {"draw0", NULL, 0, LV_DRAW_THREAD_STACK_SIZE},
+#if LV_DRAW_SW_DRAW_UNIT_CNT > 1
+  {"draw1", NULL, 1, LV_DRAW_THREAD_STACK_SIZE},
+#endif
+};
+#define MONITORED_TASK_COUNT (sizeof(monitored_tasks) / sizeof(monitored_tasks[0]))
+static_assert(MONITORED_TASK_COUNT <= MEM_MONITOR_MAX_TASKS, "too many monitored tasks");
 
-// LVGL task parameters
-#define LVGL_TASK_CORE 1
-#define LVGL_TASK_PRIORITY 5
-#define LVGL_STACK_SIZE 32768
+MemSnapshot mem_snapshot;
+MemMonitor mem_monitor;
 
 // UI Objects - Main Menu
 lv_obj_t *main_menu_screen;
@@ -88,6 +358,7 @@ lv_obj_t *menu_title;
 lv_obj_t *temp_display_btn;
 lv_obj_t *temp_gauge_btn;
 lv_obj_t *settings_menu_btn;
+lv_obj_t *trend_menu_btn;
 
 // UI Objects - Temperature Display Screen
 lv_obj_t *temp_display_screen;
@@ -95,6 +366,7 @@ lv_obj_t *temp_display_back_btn;
 lv_obj_t *object_temp_label;
 lv_obj_t *ambient_temp_label;
 lv_obj_t *temp_status_label;
+lv_obj_t *temp_hold_label;
 lv_obj_t *temp_unit_label;
 
   // UI Objects - Temperature Gauge Screen
@@ -104,6 +376,74 @@ lv_obj_t *temp_unit_label;
   lv_obj_t *temp_gauge_needle;
   lv_obj_t *temp_gauge_value_label;
 
+// UI Objects - Temperature Trend Screen
+lv_obj_t *trend_screen;
+lv_obj_t *trend_back_btn;
+lv_obj_t *trend_chart;
+lv_chart_series_t *trend_max_series;
+lv_chart_series_t *trend_min_series;
+lv_chart_series_t *trend_last_series;
+lv_obj_t *trend_span_label;
+lv_obj_t *trend_value_label;
+
+// Trend history - one chart column per bucket, spans of 1 min / 10 min / 1 h. The
+// shortest span grows to one column per sample (2 min at the default 1 s update_rate)
+static const uint32_t trend_periods_ms[TREND_LEVELS] = {
+  60000 / TREND_COLUMNS, 600000 / TREND_COLUMNS, 3600000 / TREND_COLUMNS
+};
+static char trend_span_names[TREND_LEVELS][12];
+
+static void format_trend_span(uint32_t span_ms, char *out, size_t size) {
+  if (span_ms % 3600000 == 0) {
+    snprintf(out, size, "%lu h", (unsigned long)(span_ms / 3600000));
+  } else if (span_ms % 60000 == 0) {
+    snprintf(out, size, "%lu min", (unsigned long)(span_ms / 60000));
+  } else {
+    snprintf(out, size, "%lu s", (unsigned long)(span_ms / 1000));
+  }
+}
+TrendHistory trend_history;
+int trend_span = 0;               // Index into trend_history.levels
+uint32_t trend_chart_closed = 0;  // closed_total of the shown level already on the chart
+int32_t trend_range_min = 0;      // Chart Y range in tenths of the display unit
+int32_t trend_range_max = 0;
+
+// UI Objects - Log History Screen
+lv_obj_t *history_screen;
+lv_obj_t *history_chart;
+lv_chart_series_t *history_max_series;
+lv_chart_series_t *history_min_series;
+lv_chart_series_t *history_mean_series;
+lv_obj_t *history_span_label;
+lv_obj_t *history_range_label;
+
+// Log history - the whole sample log ring through its multi-resolution index. Windows
+// that cover only a few blocks are drawn from the raw records instead.
+#define HISTORY_COLUMNS 120
+#define HISTORY_ZOOMS 7
+#define HISTORY_RAW_BLOCKS 4
+static const uint32_t history_spans_s[HISTORY_ZOOMS] = {
+  7 * 86400, 86400, 6 * 3600, 3600, 900, 300, 60
+};
+static const char *history_span_names[HISTORY_ZOOMS] = {"7 d", "24 h", "6 h", "1 h", "15 min", "5 min", "1 min"};
+LogIndex log_index;
+LogIndex *history_index = &log_index;  // Benchmark swaps in a synthetic index
+int history_zoom = 1;                  // Index into history_spans_s
+uint32_t history_offset_s = 0;         // Window end before the newest data (0 follows it)
+uint32_t history_generation = 0;       // log_index.generation shown on the chart
+
+// UI Objects - Diagnostics Screen
+lv_obj_t *diagnostics_screen;
+lv_obj_t *diag_heap_labels[MEM_REGION_COUNT + 1];  // Heap regions, then the LVGL heap
+lv_obj_t *diag_stack_labels[MONITORED_TASK_COUNT];
+lv_obj_t *diag_warning_label;
+lv_obj_t *diag_power_label;
+lv_obj_t *menu_power_label;
+
+// Battery current per screen, sampled every POWER_CURRENT_PERIOD_MS by loop()
+int64_t screen_current_sum_ma[SCREEN_COUNT];
+uint32_t screen_current_samples[SCREEN_COUNT];
+
 // UI Objects - Settings Screen
 lv_obj_t *settings_screen;
 lv_obj_t *settings_back_btn;
@@ -113,6 +453,14 @@ lv_obj_t *tab_display;
 lv_obj_t *tab_sound;
 lv_obj_t *tab_alerts;
 
+// Settings page widgets in settings_group - the focused one is the selection
+lv_group_t *settings_group;
+bool settings_group_filling = false;  // Focus changes while a page is built are not selections
+lv_obj_t *settings_menu_btns[SETTINGS_MENU_ITEMS];
+lv_obj_t *units_celsius_btn;
+lv_obj_t *units_fahrenheit_btn;
+lv_obj_t *units_current_label;
+
 // Exit tab selection buttons
 lv_obj_t *exit_cancel_btn;
 lv_obj_t *exit_save_btn;
@@ -131,29 +479,79 @@ lv_obj_t *low_temp_label;
 lv_obj_t *high_temp_label;
 
 // Function declarations
-void IRAM_ATTR button1_ISR();
-void IRAM_ATTR button2_ISR();
-void IRAM_ATTR key_ISR();
 void setup_hardware();
 void load_preferences();
+void load_legacy_preferences();
 void save_preferences();
+void apply_alert_thresholds();
 void switch_to_screen(ScreenState screen);
 void create_main_menu_ui();
 void create_temp_display_ui();
 void create_temp_gauge_ui();
 void create_settings_ui();
+void release_settings_ui();
+void keypad_begin();
+void input_key(int key);
+void release_temp_display_ui();
+void release_temp_gauge_ui();
+void create_trend_ui();
+void release_trend_ui();
+void update_trend_screen();
+void reload_trend_chart();
+void cycle_trend_span();
+void create_history_ui();
+void release_history_ui();
+void reload_history_chart();
+void update_history_screen();
+void zoom_history(int step);
+void pan_history(int step);
+void create_diagnostics_ui();
+void release_diagnostics_ui();
+void update_diagnostics_screen();
+void collect_memory_snapshot();
+void report_memory_snapshot();
+void index_log_block(const SampleLogBlockHeader *header);
 void setup_scale_gauge();
-void update_temperature_reading();
+void start_sensor_task();
+void sensor_task(void *arg);
+bool publish_sensor_sample(uint32_t timestamp_ms, float object_c, float ambient_c, TickType_t wait);
+void capture_button_edges();
+void build_input_table();
+void poll_buttons();
+bool update_temperature_reading();
+void update_current_screen();
 void update_temp_display_screen();
+void update_temp_stats_labels();
 void update_temp_gauge_screen();
-void play_beep(int frequency, int duration);
+void append_readout(SoundCue *cue, float temperature);
+void play_alert_sound(const AlertRule &rule);
 void check_temp_alerts();
+void log_sample_log_stats();
+void log_touch_stats();
+void sample_battery_current();
+void log_battery_current();
+void update_power_labels();
+const char *power_mode_name();
+void apply_backlight();
+void set_brightness(int level);
+DisplayState display_wake();
+void update_display_idle();
+
+void set_label_text_if_changed(lv_obj_t *label, const char *text);
 
 // Event handlers
 void main_menu_event_cb(lv_event_t *e);
 void temp_display_back_event_cb(lv_event_t *e);
 void temp_gauge_back_event_cb(lv_event_t *e);
+void trend_back_event_cb(lv_event_t *e);
+void trend_span_event_cb(lv_event_t *e);
+void history_back_event_cb(lv_event_t *e);
+void history_pan_event_cb(lv_event_t *e);
+void diagnostics_back_event_cb(lv_event_t *e);
 void settings_back_event_cb(lv_event_t *e);
+void settings_menu_item_event_cb(lv_event_t *e);
+void settings_units_event_cb(lv_event_t *e);
+void settings_exit_event_cb(lv_event_t *e);
 void temp_unit_switch_event_cb(lv_event_t *e);
 void brightness_slider_event_cb(lv_event_t *e);
 void sound_enable_switch_event_cb(lv_event_t *e);
@@ -161,10 +559,13 @@ void volume_slider_event_cb(lv_event_t *e);
 void alerts_enable_switch_event_cb(lv_event_t *e);
 void temp_alert_slider_event_cb(lv_event_t *e);
 
+static void fill_settings_group();
+
 // Switch between settings screens (page-based navigation)
 void switch_to_settings_screen() {
   // Clear current screen and recreate appropriate UI based on current_settings_screen
   if (settings_screen) {
+    release_settings_ui();
     lv_obj_clean(settings_screen);
     lv_obj_set_style_bg_color(settings_screen, lv_color_hex(0x1a1a40), 0);
 
@@ -181,7 +582,7 @@ void switch_to_settings_screen() {
 
     lv_obj_t *title = lv_label_create(title_bg);
     lv_obj_set_style_text_color(title, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_style_text_font(title, &lv_font_montserrat_20, 0);
+    lv_obj_set_style_text_font(title, UI_FONT_20, 0);
     lv_obj_align(title, LV_ALIGN_CENTER, 10, 0);
 
     // Create appropriate screen based on current_settings_screen
@@ -189,8 +590,8 @@ void switch_to_settings_screen() {
       case SETTINGS_MENU: {
         lv_label_set_text(title, "Configuration");
         // Settings menu with category selection (2x2 grid layout)
-        const char *menu_items[] = {"Units", "Audio", "Alerts", "Exit"};
-        for (int i = 0; i < 4; i++) {
+        const char *menu_items[] = {"Units", "Audio/Display", "Alerts", "Exit"};
+        for (int i = 0; i < SETTINGS_MENU_ITEMS; i++) {
           lv_obj_t *menu_btn = lv_btn_create(settings_screen);
           lv_obj_set_size(menu_btn, 140, 60); // Wider buttons for 2x2 grid
           // 2x2 grid positioning: Top row (y=-40), Bottom row (y=40)
@@ -201,13 +602,13 @@ void switch_to_settings_screen() {
           lv_obj_set_style_bg_color(menu_btn, lv_color_hex(0x34495e), LV_PART_MAIN);
           lv_obj_set_style_border_width(menu_btn, 2, LV_PART_MAIN);
           lv_obj_set_style_border_color(menu_btn, lv_color_hex(0xFF6B35), LV_PART_MAIN);
-          if (i == current_settings_selection) {
-            lv_obj_set_style_border_color(menu_btn, lv_color_hex(0x00FF00), LV_PART_MAIN);
-          }
+          lv_obj_set_style_border_color(menu_btn, lv_color_hex(0x00FF00), LV_PART_MAIN | LV_STATE_FOCUSED);
+          lv_obj_add_event_cb(menu_btn, settings_menu_item_event_cb, LV_EVENT_ALL, (void *)(intptr_t)i);
+          settings_menu_btns[i] = menu_btn;
 
           lv_obj_t *menu_label = lv_label_create(menu_btn);
           lv_label_set_text(menu_label, menu_items[i]);
-          lv_obj_set_style_text_font(menu_label, &lv_font_montserrat_16, 0);
+          lv_obj_set_style_text_font(menu_label, UI_FONT_16, 0);
           lv_obj_set_style_text_color(menu_label, lv_color_hex(0xFFFFFF), 0);
           lv_obj_center(menu_label);
         }
@@ -223,11 +624,14 @@ void switch_to_settings_screen() {
         lv_obj_align(celsius_btn, LV_ALIGN_CENTER, -80, 0);
         lv_obj_set_style_bg_color(celsius_btn, lv_color_hex(0x2c3e50), LV_PART_MAIN);
         lv_obj_set_style_border_width(celsius_btn, 3, LV_PART_MAIN);
-        lv_obj_set_style_border_color(celsius_btn, use_celsius ? lv_color_hex(0x00FF00) : lv_color_hex(0xFF6B35), LV_PART_MAIN);
+        lv_obj_set_style_border_color(celsius_btn, lv_color_hex(0xFF6B35), LV_PART_MAIN);
+        lv_obj_set_style_border_color(celsius_btn, lv_color_hex(0x00FF00), LV_PART_MAIN | LV_STATE_FOCUSED);
+        lv_obj_add_event_cb(celsius_btn, settings_units_event_cb, LV_EVENT_ALL, (void *)(intptr_t)1);
+        units_celsius_btn = celsius_btn;
 
         lv_obj_t *celsius_label = lv_label_create(celsius_btn);
         lv_label_set_text(celsius_label, "C\nCelsius");
-        lv_obj_set_style_text_font(celsius_label, &lv_font_montserrat_18, 0);
+        lv_obj_set_style_text_font(celsius_label, UI_FONT_18, 0);
         lv_obj_center(celsius_label);
 
         lv_obj_t *fahrenheit_btn = lv_btn_create(settings_screen);
@@ -235,59 +639,81 @@ void switch_to_settings_screen() {
         lv_obj_align(fahrenheit_btn, LV_ALIGN_CENTER, 80, 0);
         lv_obj_set_style_bg_color(fahrenheit_btn, lv_color_hex(0x2c3e50), LV_PART_MAIN);
         lv_obj_set_style_border_width(fahrenheit_btn, 3, LV_PART_MAIN);
-        lv_obj_set_style_border_color(fahrenheit_btn, !use_celsius ? lv_color_hex(0x00FF00) : lv_color_hex(0xFF6B35), LV_PART_MAIN);
+        lv_obj_set_style_border_color(fahrenheit_btn, lv_color_hex(0xFF6B35), LV_PART_MAIN);
+        lv_obj_set_style_border_color(fahrenheit_btn, lv_color_hex(0x00FF00), LV_PART_MAIN | LV_STATE_FOCUSED);
+        lv_obj_add_event_cb(fahrenheit_btn, settings_units_event_cb, LV_EVENT_ALL, (void *)(intptr_t)0);
+        units_fahrenheit_btn = fahrenheit_btn;
 
         lv_obj_t *fahrenheit_label = lv_label_create(fahrenheit_btn);
         lv_label_set_text(fahrenheit_label, "F\nFahrenheit");
-        lv_obj_set_style_text_font(fahrenheit_label, &lv_font_montserrat_18, 0);
+        lv_obj_set_style_text_font(fahrenheit_label, UI_FONT_18, 0);
         lv_obj_center(fahrenheit_label);
 
         // Selection indicator showing which unit is currently active
         lv_obj_t *current_indicator = lv_label_create(settings_screen);
-        lv_label_set_text(current_indicator, use_celsius ? "← Current: Celsius (C)" : "Current: Fahrenheit (F) →");
+        lv_label_set_text(current_indicator, use_celsius ? "< Current: Celsius (C)" : "Current: Fahrenheit (F) >");
+        units_current_label = current_indicator;
         lv_obj_set_style_text_color(current_indicator, lv_color_hex(0x00FF00), 0);
-        lv_obj_set_style_text_font(current_indicator, &lv_font_montserrat_16, 0);
+        lv_obj_set_style_text_font(current_indicator, UI_FONT_16, 0);
         lv_obj_align(current_indicator, LV_ALIGN_CENTER, 0, 50);
 
         lv_obj_t *instruction = lv_label_create(settings_screen);
         lv_label_set_text(instruction, "Btn1: Select Celsius     Btn2: Select F     Key: Accept & Return");
         lv_obj_set_style_text_color(instruction, lv_color_hex(0xCCCCCC), 0);
-        lv_obj_set_style_text_font(instruction, &lv_font_montserrat_12, 0);
+        lv_obj_set_style_text_font(instruction, UI_FONT_12, 0);
         lv_obj_align(instruction, LV_ALIGN_BOTTOM_MID, 0, -20);
         break;
       }
 
       case SETTINGS_AUDIO: {
-        lv_label_set_text(title, "Audio Settings");
+        lv_label_set_text(title, "Audio & Display");
         // Sound enable/disable
         lv_obj_t *sound_title = lv_label_create(settings_screen);
         lv_label_set_text(sound_title, "Sound Alerts");
-        lv_obj_set_style_text_font(sound_title, &lv_font_montserrat_18, 0);
+        lv_obj_set_style_text_font(sound_title, UI_FONT_18, 0);
         lv_obj_set_style_text_color(sound_title, lv_color_hex(0xFFFFFF), 0);
         lv_obj_align(sound_title, LV_ALIGN_TOP_MID, 0, 60);
 
         lv_obj_t *sound_on_btn = lv_btn_create(settings_screen);
         lv_obj_set_size(sound_on_btn, 100, 50);
-        lv_obj_align(sound_on_btn, LV_ALIGN_CENTER, -60, 20);
+        lv_obj_align(sound_on_btn, LV_ALIGN_CENTER, -60, 0);
         lv_obj_set_style_bg_color(sound_on_btn, sound_enabled ? lv_color_hex(0x00AA00) : lv_color_hex(0x666666), LV_PART_MAIN);
 
         lv_obj_t *on_label = lv_label_create(sound_on_btn);
         lv_label_set_text(on_label, "ON");
-        lv_obj_set_style_text_font(on_label, &lv_font_montserrat_16, 0);
+        lv_obj_set_style_text_font(on_label, UI_FONT_16, 0);
         lv_obj_center(on_label);
 
         lv_obj_t *sound_off_btn = lv_btn_create(settings_screen);
         lv_obj_set_size(sound_off_btn, 100, 50);
-        lv_obj_align(sound_off_btn, LV_ALIGN_CENTER, 60, 20);
+        lv_obj_align(sound_off_btn, LV_ALIGN_CENTER, 60, 0);
         lv_obj_set_style_bg_color(sound_off_btn, !sound_enabled ? lv_color_hex(0xAA0000) : lv_color_hex(0x666666), LV_PART_MAIN);
 
         lv_obj_t *off_label = lv_label_create(sound_off_btn);
         lv_label_set_text(off_label, "OFF");
-        lv_obj_set_style_text_font(off_label, &lv_font_montserrat_16, 0);
+        lv_obj_set_style_text_font(off_label, UI_FONT_16, 0);
         lv_obj_center(off_label);
 
+        // Backlight brightness
+        lv_obj_t *brightness_title = lv_label_create(settings_screen);
+        lv_label_set_text(brightness_title, "Brightness");
+        lv_obj_set_style_text_color(brightness_title, lv_color_hex(0xFFFFFF), 0);
+        lv_obj_align(brightness_title, LV_ALIGN_LEFT_MID, 20, 50);
+
+        brightness_slider = lv_slider_create(settings_screen);
+        lv_obj_set_size(brightness_slider, 130, 10);
+        lv_slider_set_range(brightness_slider, BRIGHTNESS_MIN, 255);
+        lv_obj_align(brightness_slider, LV_ALIGN_CENTER, 30, 50);
+        lv_obj_add_event_cb(brightness_slider, brightness_slider_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
+        lv_obj_add_event_cb(brightness_slider, brightness_slider_event_cb, LV_EVENT_RELEASED, NULL);
+
+        brightness_label = lv_label_create(settings_screen);
+        lv_obj_set_style_text_color(brightness_label, lv_color_hex(0xFFFFFF), 0);
+        lv_obj_align(brightness_label, LV_ALIGN_RIGHT_MID, -20, 50);
+        set_brightness(brightness_level);
+
         lv_obj_t *instruction = lv_label_create(settings_screen);
-        lv_label_set_text(instruction, "Key: Toggle Sound");
+        lv_label_set_text(instruction, "Key: Toggle Sound     Btn1: Brightness");
         lv_obj_set_style_text_color(instruction, lv_color_hex(0xCCCCCC), 0);
         lv_obj_align(instruction, LV_ALIGN_BOTTOM_MID, 0, -20);
         break;
@@ -307,17 +733,18 @@ void switch_to_settings_screen() {
         lv_obj_align(high_temp_label, LV_ALIGN_TOP_LEFT, 20, 100);
 
         // Actual threshold values (would need to be updated dynamically)
+        const TempFormat threshold_fmt = {1, false, " C"};
         char low_str[16];
-        snprintf(low_str, sizeof(low_str), "%.1f C", low_temp_threshold);
+        temp_format(low_str, sizeof(low_str), NULL, low_temp_threshold, threshold_fmt);
         lv_obj_t *low_value = lv_label_create(settings_screen);
-        lv_label_set_text_fmt(low_value, low_str);
+        lv_label_set_text(low_value, low_str);
         lv_obj_set_style_text_color(low_value, lv_color_hex(0xFFFFFF), 0);
         lv_obj_align(low_value, LV_ALIGN_TOP_LEFT, 150, 60);
 
         char high_str[16];
-        snprintf(high_str, sizeof(high_str), "%.1f C", high_temp_threshold);
+        temp_format(high_str, sizeof(high_str), NULL, high_temp_threshold, threshold_fmt);
         lv_obj_t *high_value = lv_label_create(settings_screen);
-        lv_label_set_text_fmt(high_value, high_str);
+        lv_label_set_text(high_value, high_str);
         lv_obj_set_style_text_color(high_value, lv_color_hex(0xFFFFFF), 0);
         lv_obj_align(high_value, LV_ALIGN_TOP_LEFT, 150, 100);
 
@@ -333,7 +760,7 @@ void switch_to_settings_screen() {
         // Exit confirmation
         lv_obj_t *question = lv_label_create(settings_screen);
         lv_label_set_text(question, "Save settings\nbefore exiting?");
-        lv_obj_set_style_text_font(question, &lv_font_montserrat_20, 0);
+        lv_obj_set_style_text_font(question, UI_FONT_20, 0);
         lv_obj_set_style_text_color(question, lv_color_hex(0xFFFFFF), 0);
         lv_obj_align(question, LV_ALIGN_CENTER, 0, -30);
 
@@ -341,8 +768,11 @@ void switch_to_settings_screen() {
         lv_obj_set_size(cancel_btn, 100, 50);
         lv_obj_align(cancel_btn, LV_ALIGN_CENTER, -60, 40);
         lv_obj_set_style_bg_color(cancel_btn, lv_color_hex(0x666666), LV_PART_MAIN);
-        lv_obj_set_style_border_width(cancel_btn, exit_selection_cancel ? 3 : 1, LV_PART_MAIN);
+        lv_obj_set_style_border_width(cancel_btn, 1, LV_PART_MAIN);
+        lv_obj_set_style_border_width(cancel_btn, 3, LV_PART_MAIN | LV_STATE_FOCUSED);
         lv_obj_set_style_border_color(cancel_btn, lv_color_hex(0x00FF00), LV_PART_MAIN);
+        lv_obj_add_event_cb(cancel_btn, settings_exit_event_cb, LV_EVENT_ALL, (void *)(intptr_t)1);
+        exit_cancel_btn = cancel_btn;
 
         lv_obj_t *cancel_label = lv_label_create(cancel_btn);
         lv_label_set_text(cancel_label, "CANCEL");
@@ -352,8 +782,12 @@ void switch_to_settings_screen() {
         lv_obj_set_size(save_btn, 100, 50);
         lv_obj_align(save_btn, LV_ALIGN_CENTER, 60, 40);
         lv_obj_set_style_bg_color(save_btn, lv_color_hex(0x666666), LV_PART_MAIN);
-        lv_obj_set_style_border_width(save_btn, exit_selection_cancel ? 1 : 3, LV_PART_MAIN);
-        lv_obj_set_style_border_color(save_btn, !exit_selection_cancel ? lv_color_hex(0x00FF00) : lv_color_hex(0xFF6B35), LV_PART_MAIN);
+        lv_obj_set_style_border_width(save_btn, 1, LV_PART_MAIN);
+        lv_obj_set_style_border_width(save_btn, 3, LV_PART_MAIN | LV_STATE_FOCUSED);
+        lv_obj_set_style_border_color(save_btn, lv_color_hex(0xFF6B35), LV_PART_MAIN);
+        lv_obj_set_style_border_color(save_btn, lv_color_hex(0x00FF00), LV_PART_MAIN | LV_STATE_FOCUSED);
+        lv_obj_add_event_cb(save_btn, settings_exit_event_cb, LV_EVENT_ALL, (void *)(intptr_t)0);
+        exit_save_btn = save_btn;
 
         lv_obj_t *save_label = lv_label_create(save_btn);
         lv_label_set_text(save_label, "SAVE");
@@ -371,9 +805,46 @@ void switch_to_settings_screen() {
     lv_obj_t *control_indicator = lv_label_create(settings_screen);
     lv_label_set_text(control_indicator, "Btn1: Navigate    Btn2: Back    Key: Select");
     lv_obj_set_style_text_color(control_indicator, lv_color_hex(0xCCCCCC), 0);
-    lv_obj_set_style_text_font(control_indicator, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_text_font(control_indicator, UI_FONT_12, 0);
     lv_obj_align(control_indicator, LV_ALIGN_BOTTOM_MID, 0, -12);
+
+    fill_settings_group();
+  }
+}
+
+// Put the selectable widgets of the page into settings_group, focusing the current choice
+static void fill_settings_group() {
+  lv_obj_t *objs[SETTINGS_MENU_ITEMS];
+  int count = 0;
+  int focused = 0;
+  bool wrap = false;
+
+  switch (current_settings_screen) {
+    case SETTINGS_MENU:
+      for (int i = 0; i < SETTINGS_MENU_ITEMS; i++) objs[count++] = settings_menu_btns[i];
+      focused = current_settings_selection;
+      wrap = true;
+      break;
+    case SETTINGS_UNITS:
+      objs[count++] = units_celsius_btn;
+      objs[count++] = units_fahrenheit_btn;
+      focused = use_celsius ? 0 : 1;
+      break;
+    case SETTINGS_EXIT:
+      objs[count++] = exit_cancel_btn;
+      objs[count++] = exit_save_btn;
+      focused = exit_selection_cancel ? 0 : 1;
+      break;
+    default:
+      break;
   }
+
+  settings_group_filling = true;
+  lv_group_remove_all_objs(settings_group);
+  lv_group_set_wrap(settings_group, wrap);
+  for (int i = 0; i < count; i++) lv_group_add_obj(settings_group, objs[i]);
+  if (count) lv_group_focus_obj(objs[focused]);
+  settings_group_filling = false;
 }
 
 // LVGL tick task from CoreS3 User Demo (modified for compatibility)
@@ -381,375 +852,1309 @@ static void lvgl_tick_task(void *arg) {
   (void)arg;
   // Use lv_tick_get instead of lv_tick_inc which is not available in this LVGL version
   static uint32_t last_tick = 0;
-  uint32_t current_tick = millis();
+  uint32_t current_tick = hal_millis();
   if (current_tick - last_tick > LV_TICK_PERIOD_MS) {
       last_tick = current_tick;
-      lv_task_handler(); // Process LVGL tasks
+      uint32_t start = hal_micros();
+      lvgl_idle_ms = lv_task_handler(); // Process LVGL tasks
+      telemetry_profile(PROFILE_LVGL_HANDLER, hal_micros() - start);
   }
 }
 
 // LVGL task (removed - using main loop refresh instead)
 
+// Benchmark output. Every row has the same CSV columns, so a run can be redirected
+// straight into a .csv:
+//   bench,<name>,<draw_units>,<min>,<value>,<max>,<objects>,<pixels>
+// Timed render steps fill all of them (min/avg/max in us). Single measurements only
+// fill <value>, in the unit their name ends with (_us, _ms, _pct, _bytes) or in CPU
+// cycles per call for the device kernel benchmarks.
+void bench_print_value(const char *name, double value) {
+  Serial.printf("bench,%s,%d,,%.10g,,,\n", name, LV_DRAW_SW_DRAW_UNIT_CNT, value);
+}
+
+#ifdef NCIR_RENDER_BENCHMARK
+// Per-screen render benchmark, on the device (env:m5stack-cores3-bench) or headless on
+// the host framebuffer (env:native-bench). Every screen is timed three ways, each up to
+// the end of a forced redraw:
+//   <screen>          entering it: widget rebuild when evicted + SW render + flush
+//   redraw_<screen>   the whole built screen invalidated: render + flush only
+//   update_<screen>   one loop() update cycle with a new reading: partial render
+// Build once with the default NCIR_DRAW_UNIT_CNT=2 and once with -DNCIR_DRAW_UNIT_CNT=1
+// (see the bench envs in platformio.ini) and compare the avg columns.
+#define RENDER_BENCH_ITERATIONS 20
+
+struct RenderBenchTiming {
+  uint32_t min_us;
+  uint32_t max_us;
+  uint64_t total_us;
+  uint32_t pixels;    // Flushed by the last iteration
+};
+
+struct RenderBenchStep {
+  const char *name;
+  ScreenState screen;
+  SettingsScreen settings_page; // Only used when screen == SCREEN_SETTINGS
+};
+
+struct RenderBenchResult {
+  uint32_t objects;             // Widgets on the screen, including the screen itself
+  RenderBenchTiming enter;
+  RenderBenchTiming redraw;
+  RenderBenchTiming update;
+};
+
+static uint32_t count_objects(lv_obj_t *obj) {
+  uint32_t count = 1;
+  uint32_t children = lv_obj_get_child_count(obj);
+  for (uint32_t i = 0; i < children; i++) count += count_objects(lv_obj_get_child(obj, i));
+  return count;
+}
+
+// Run one step to the end of a forced redraw and add its time and flushed pixels
+template <typename Step>
+static void render_bench_time(RenderBenchTiming *timing, Step step) {
+  M5gfxLvglStats before, after;
+  m5gfx_lvgl_get_stats(&before);
+  uint32_t start = hal_micros();
+
+  step();
+  lv_refr_now(NULL);
+
+  uint32_t elapsed = hal_micros() - start;
+  m5gfx_lvgl_get_stats(&after);
+  if (elapsed < timing->min_us) timing->min_us = elapsed;
+  if (elapsed > timing->max_us) timing->max_us = elapsed;
+  timing->total_us += elapsed;
+  timing->pixels = after.pixels - before.pixels;
+}
+
+static void render_bench_print(const char *prefix, const char *name, uint32_t objects,
+                               const RenderBenchTiming &timing) {
+  Serial.printf("bench,%s%s,%d,%u,%u,%u,%u,%u\n", prefix, name, LV_DRAW_SW_DRAW_UNIT_CNT,
+                timing.min_us, (uint32_t)(timing.total_us / RENDER_BENCH_ITERATIONS), timing.max_us,
+                objects, timing.pixels);
+}
+
+void run_render_benchmark() {
+  static const RenderBenchStep steps[] = {
+    {"temp_display", SCREEN_TEMP_DISPLAY, SETTINGS_MENU},
+    {"temp_gauge", SCREEN_TEMP_GAUGE, SETTINGS_MENU},
+    {"trend", SCREEN_TREND, SETTINGS_MENU},
+    {"settings_menu", SCREEN_SETTINGS, SETTINGS_MENU},
+    {"settings_units", SCREEN_SETTINGS, SETTINGS_UNITS},
+    {"settings_audio", SCREEN_SETTINGS, SETTINGS_AUDIO},
+    {"settings_alerts", SCREEN_SETTINGS, SETTINGS_ALERTS},
+    {"settings_exit", SCREEN_SETTINGS, SETTINGS_EXIT},
+    {"diagnostics", SCREEN_DIAGNOSTICS, SETTINGS_MENU},
+    {"main_menu", SCREEN_MAIN_MENU, SETTINGS_MENU},
+  };
+  const int step_count = sizeof(steps) / sizeof(steps[0]);
+  const RenderBenchTiming empty = {UINT32_MAX, 0, 0, 0};
+  RenderBenchResult results[step_count];
+  for (int i = 0; i < step_count; i++) {
+    results[i].objects = 0;
+    results[i].enter = results[i].redraw = results[i].update = empty;
+  }
+
+  Serial.printf("Render benchmark: %d draw unit(s), %d iterations\n",
+                LV_DRAW_SW_DRAW_UNIT_CNT, RENDER_BENCH_ITERATIONS);
+  sensor_max_period_ms = 0;
+
+  for (int iter = 0; iter < RENDER_BENCH_ITERATIONS; iter++) {
+    for (int i = 0; i < step_count; i++) {
+      const RenderBenchStep &step = steps[i];
+      RenderBenchResult &result = results[i];
+
+      render_bench_time(&result.enter, [&step]() {
+        if (step.screen == SCREEN_SETTINGS && current_screen == SCREEN_SETTINGS) {
+          current_settings_screen = step.settings_page;
+          switch_to_settings_screen();
+        } else {
+          switch_to_screen(step.screen);
+        }
+      });
+      result.objects = count_objects(lv_screen_active());
+
+      render_bench_time(&result.redraw, []() { lv_obj_invalidate(lv_screen_active()); });
+
+      update_temperature_reading(); // Keep draining samples like loop() would
+
+      // A reading that changes every displayed digit and moves the needle
+      float object_c = 20.0f + (iter % 10) * 11.1f + i;
+      render_bench_time(&result.update, [object_c]() {
+        current_object_temp = object_c;
+        current_ambient_temp = 22.0f + (object_c - 20.0f) / 50.0f;
+        trend_history_add(&trend_history, hal_millis(), object_c);
+        temp_stats_add(&temp_stats, object_c);
+        update_current_screen();
+      });
+    }
+  }
+
+  // One CSV line per step: bench,<step>,<units>,<min_us>,<avg_us>,<max_us>,<objects>,<pixels>
+  for (int i = 0; i < step_count; i++) {
+    render_bench_print("", steps[i].name, results[i].objects, results[i].enter);
+    render_bench_print("redraw_", steps[i].name, results[i].objects, results[i].redraw);
+    render_bench_print("update_", steps[i].name, results[i].objects, results[i].update);
+  }
+
+  // Settings menu navigation: a focus move through the keypad input device against
+  // rebuilding the page for the new selection (how the buttons used to show it)
+  RenderBenchTiming nav_focus = empty;
+  RenderBenchTiming nav_rebuild = empty;
+  switch_to_screen(SCREEN_SETTINGS);
+  lv_refr_now(NULL);
+  for (int iter = 0; iter < RENDER_BENCH_ITERATIONS; iter++) {
+    render_bench_time(&nav_focus, []() {
+      input_key(LV_KEY_NEXT);
+      lv_indev_read(keypad_indev);
+    });
+    render_bench_time(&nav_rebuild, []() {
+      current_settings_selection = (current_settings_selection + 1) % SETTINGS_MENU_ITEMS;
+      switch_to_settings_screen();
+    });
+  }
+  uint32_t nav_objects = count_objects(lv_screen_active());
+  render_bench_print("nav_focus_", "settings_menu", nav_objects, nav_focus);
+  render_bench_print("nav_rebuild_", "settings_menu", nav_objects, nav_rebuild);
+  bench_print_value("sensor_max_period_ms", sensor_max_period_ms);
+  bench_print_value("sensor_update_rate_ms", update_rate);
+  bench_print_value("sensor_overruns", sensor_overruns);
+
+  // Label render time per UI font - compare builds with custom_subset_fonts = yes / no
+  struct {
+    const char *name;
+    const lv_font_t *font;
+  } fonts[] = {
+    {"font_12", UI_FONT_12}, {"font_16", UI_FONT_16}, {"font_20", UI_FONT_20},
+    {"font_24", UI_FONT_24}, {"font_digits", UI_FONT_DIGITS},
+  };
+  lv_obj_t *label = lv_label_create(lv_screen_active());
+  lv_label_set_text(label, "-0123456789.C");
+  for (size_t i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++) {
+    lv_obj_set_style_text_font(label, fonts[i].font, 0);
+    lv_refr_now(NULL);
+
+    uint32_t start = hal_micros();
+    for (int iter = 0; iter < RENDER_BENCH_ITERATIONS; iter++) {
+      lv_obj_invalidate(label);
+      lv_refr_now(NULL);
+    }
+    uint32_t avg = (hal_micros() - start) / RENDER_BENCH_ITERATIONS;
+    char name[40];
+    snprintf(name, sizeof(name), "label_render_%s_us", fonts[i].name);
+    bench_print_value(name, avg);
+  }
+  lv_obj_delete(label);
+
+  // Flush totals over the whole run, to separate panel transfer from rendering
+  M5gfxLvglStats flush;
+  m5gfx_lvgl_get_stats(&flush);
+  bench_print_value("flush_total_count", flush.flushes);
+  bench_print_value("flush_total_pixels", flush.pixels);
+  bench_print_value("flush_total_us", flush.flush_us);
+}
+#endif
+
+#ifdef NCIR_FORMAT_BENCHMARK
+// Cycle counts for temp_format() against the snprintf("%.0f") calls it replaced, and for
+// an unchanged label update with and without the set_label_text_if_changed() check
+#define FORMAT_BENCH_ITERATIONS 1000
+
+void run_format_benchmark() {
+  static const float samples[] = {-12.4f, 0.0f, 21.6f, 36.9f, 99.5f, 250.2f, 379.9f};
+  const int sample_count = sizeof(samples) / sizeof(samples[0]);
+  const TempFormat fmt = {0, false, "C"};
+  char buf[32];
+  volatile size_t sink = 0;
+
+  uint32_t start = ESP.getCycleCount();
+  for (int i = 0; i < FORMAT_BENCH_ITERATIONS; i++) {
+    sink += snprintf(buf, sizeof(buf), "Object: %.0f%c", samples[i % sample_count], 'C');
+  }
+  uint32_t snprintf_cycles = ESP.getCycleCount() - start;
+
+  start = ESP.getCycleCount();
+  for (int i = 0; i < FORMAT_BENCH_ITERATIONS; i++) {
+    sink += temp_format(buf, sizeof(buf), "Object: ", samples[i % sample_count], fmt);
+  }
+  uint32_t temp_format_cycles = ESP.getCycleCount() - start;
+
+  lv_obj_t *label = lv_label_create(lv_screen_active());
+  lv_label_set_text(label, "Object: 22C");
+
+  start = ESP.getCycleCount();
+  for (int i = 0; i < FORMAT_BENCH_ITERATIONS; i++) {
+    lv_label_set_text(label, "Object: 22C");
+  }
+  uint32_t set_text_cycles = ESP.getCycleCount() - start;
+
+  start = ESP.getCycleCount();
+  for (int i = 0; i < FORMAT_BENCH_ITERATIONS; i++) {
+    set_label_text_if_changed(label, "Object: 22C");
+  }
+  uint32_t skip_cycles = ESP.getCycleCount() - start;
+
+  lv_obj_delete(label);
+  (void)sink;
+
+  // One row per case, in cycles per call
+  bench_print_value("format_snprintf", snprintf_cycles / FORMAT_BENCH_ITERATIONS);
+  bench_print_value("format_temp_format", temp_format_cycles / FORMAT_BENCH_ITERATIONS);
+  bench_print_value("label_set_text_same", set_text_cycles / FORMAT_BENCH_ITERATIONS);
+  bench_print_value("label_set_if_changed_same", skip_cycles / FORMAT_BENCH_ITERATIONS);
+}
+#endif
+
+#ifdef NCIR_STATS_BENCHMARK
+// Cycle counts for temp_stats_add() on a noisy signal, and the worst single call: a
+// long rising ramp followed by a drop collapses the whole max deque in one step
+#define STATS_BENCH_ITERATIONS 5000
+
+void run_stats_benchmark() {
+  static TempStats bench_stats;  // Too large for the loop task stack
+  temp_stats_init(&bench_stats, temp_stats_windows);
+
+  uint32_t start = ESP.getCycleCount();
+  for (int i = 0; i < STATS_BENCH_ITERATIONS; i++) {
+    temp_stats_add(&bench_stats, 25.0f + (float)((i * 7919) % 200) * 0.01f);
+  }
+  uint32_t noisy_cycles = ESP.getCycleCount() - start;
+
+  for (int i = 0; i < TEMP_STATS_WINDOW_CAPACITY; i++) {
+    temp_stats_add(&bench_stats, 20.0f - i * 0.1f);
+  }
+  start = ESP.getCycleCount();
+  temp_stats_add(&bench_stats, 100.0f);
+  uint32_t collapse_cycles = ESP.getCycleCount() - start;
+
+  TempStatsSummary summary;
+  start = ESP.getCycleCount();
+  for (int i = 0; i < STATS_BENCH_ITERATIONS; i++) {
+    temp_stats_window(&bench_stats, i % TEMP_STATS_WINDOWS, &summary);
+  }
+  uint32_t query_cycles = ESP.getCycleCount() - start;
+
+  // One row per case, in cycles per call
+  bench_print_value("stats_add", noisy_cycles / STATS_BENCH_ITERATIONS);
+  bench_print_value("stats_add_deque_collapse", collapse_cycles);
+  bench_print_value("stats_window_query", query_cycles / STATS_BENCH_ITERATIONS);
+  bench_print_value("stats_footprint_bytes", sizeof(TempStats));
+}
+#endif
+
+#ifdef NCIR_SOUND_BENCHMARK
+// CPU load of alert sound playback: a spinner task per core counts iterations for a
+// fixed window while idle and while a readout cue plays. The lost iterations are the
+// share of that core taken by the sound task plus the M5.Speaker mixer and I2S.
+#define SOUND_BENCH_WINDOW_MS 1000
+
+static volatile bool sound_bench_spinning = false;
+static volatile uint32_t sound_bench_counts[2];
+
+static void sound_bench_spinner(void *arg) {
+  int core = (int)arg;
+  while (sound_bench_spinning) {
+    sound_bench_counts[core]++;
+  }
+  vTaskDelete(NULL);
+}
+
+static void sound_bench_measure(uint32_t counts[2]) {
+  sound_bench_counts[0] = sound_bench_counts[1] = 0;
+  sound_bench_spinning = true;
+  for (int core = 0; core < 2; core++) {
+    xTaskCreatePinnedToCore(sound_bench_spinner, "spin", 2048, (void *)core, 1, NULL, core);
+  }
+  hal_delay(SOUND_BENCH_WINDOW_MS);
+  counts[0] = sound_bench_counts[0];
+  counts[1] = sound_bench_counts[1];
+  sound_bench_spinning = false;
+  hal_delay(20);
+}
+
+void run_sound_benchmark() {
+  bool was_enabled = sound_enabled;
+  sound_enabled = true;
+
+  uint32_t idle[2], busy[2];
+  sound_bench_measure(idle);
+
+  // Readout of 88 degrees keeps the speaker busy for the whole window
+  AlertRule rule = default_alert_rules.rules[ALERT_RULE_HIGH];
+  float saved_temp = current_object_temp;
+  current_object_temp = use_celsius ? 88.0f : (88.0f - 32.0f) * 5.0f / 9.0f;
+  play_alert_sound(rule);
+  current_object_temp = saved_temp;
+  hal_delay(50);
+  sound_bench_measure(busy);
+  while (sound_player_busy()) hal_delay(10);
+  sound_enabled = was_enabled;
+
+  SoundPlayerStats stats;
+  sound_player_get_stats(&stats);
+  for (int core = 0; core < 2; core++) {
+    uint32_t load = idle[core] ? (uint32_t)(100ULL * (idle[core] - min(idle[core], busy[core])) / idle[core]) : 0;
+    char name[24];
+    snprintf(name, sizeof(name), "sound_cpu_core%d_pct", core);
+    bench_print_value(name, load);
+  }
+  uint32_t pcm_bytes = 0;
+  for (int i = 0; i < ALERT_CLIP_COUNT; i++) pcm_bytes += alert_sound_clips[i].length;
+  bench_print_value("sound_cue_ms", stats.last_cue_ms);
+  bench_print_value("sound_pcm_bytes", pcm_bytes);
+}
+#endif
+
+#ifdef NCIR_HISTORY_BENCHMARK
+// History viewer latency on a full 7-day ring: a synthetic index of SAMPLE_LOG_BLOCKS
+// blocks (about 154 s each at 1 Hz) with a daily cycle. Cold open is the first entry
+// into the history screen (build + query + render + flush); zoom steps are timed the
+// same way from 7 d down to 1 min. The 5 min / 1 min windows try the raw blocks first,
+// so they include the sample log journal reads (sample_log_read_block on raw flash).
+#define HISTORY_BENCH_BLOCK_S 154
+#define HISTORY_BENCH_QUERIES 20
+
+void run_history_benchmark() {
+  static LogIndex bench_index;
+  uint32_t start = hal_micros();
+  if (!log_index_init(&bench_index, SAMPLE_LOG_BLOCKS)) {
+    bench_print_value("history_index_alloc_failed", 1);
+    return;
+  }
+  for (uint32_t seq = 0; seq < SAMPLE_LOG_BLOCKS; seq++) {
+    uint32_t start_s = seq * HISTORY_BENCH_BLOCK_S;
+    int16_t mean = (int16_t)(250 + 50 * sinf(start_s * 2.0f * PI / 86400.0f));
+    LogSummary summary = {seq, start_s, start_s + HISTORY_BENCH_BLOCK_S - 1,
+                          (int16_t)(mean - 8), (int16_t)(mean + 8), (int64_t)mean * 154, 154};
+    log_index_add(&bench_index, &summary);
+  }
+  bench_print_value("history_index_build_us", hal_micros() - start);
+
+  LogIndex *saved_index = history_index;
+  ScreenState saved_screen = current_screen;
+  history_index = &bench_index;
+  history_zoom = 0;
+  history_offset_s = 0;
+
+  start = hal_micros();
+  switch_to_screen(SCREEN_HISTORY);
+  lv_refr_now(NULL);
+  bench_print_value("history_cold_open_us", hal_micros() - start);
+
+  static const char *zoom_names[HISTORY_ZOOMS] = {"7d", "24h", "6h", "1h", "15m", "5m", "1m"};
+  static LogColumn columns[HISTORY_COLUMNS];
+  uint32_t first_s, last_s;
+  log_index_range(&bench_index, &first_s, &last_s);
+  for (int zoom = 0; zoom < HISTORY_ZOOMS; zoom++) {
+    history_zoom = zoom;
+    start = hal_micros();
+    reload_history_chart();
+    lv_refr_now(NULL);
+    uint32_t zoom_us = hal_micros() - start;
+    char name[32];
+    snprintf(name, sizeof(name), "history_zoom_%s_us", zoom_names[zoom]);
+    bench_print_value(name, zoom_us);
+
+    // Index query alone, without the raw path or rendering
+    start = hal_micros();
+    for (int i = 0; i < HISTORY_BENCH_QUERIES; i++) {
+      log_index_query(&bench_index, last_s + 1 - history_spans_s[zoom], last_s + 1, columns, HISTORY_COLUMNS);
+    }
+    snprintf(name, sizeof(name), "history_query_%s_us", zoom_names[zoom]);
+    bench_print_value(name, (hal_micros() - start) / HISTORY_BENCH_QUERIES);
+  }
+
+  switch_to_screen(saved_screen);
+  history_index = saved_index;
+  history_zoom = 1;
+  history_generation = 0;
+
+  // Tail recovery of the real log and the ring scan that rebuilds the index
+  SampleLogStats stats;
+  for (int wait = 0; wait < 200; wait++) {
+    sample_log_get_stats(&stats);
+    if (stats.scan_ms) break;
+    hal_delay(50);
+  }
+  bench_print_value("history_log_recovery_ms", stats.recovery_ms);
+  bench_print_value("history_ring_scan_ms", stats.scan_ms);
+}
+#endif
+
 void setup() {
   Serial.begin(115200);
+  debug_log_start(&Serial, DEBUG_LOG_TASK_PRIORITY, DEBUG_LOG_TASK_CORE);
   // Initialize M5Stack
-  auto cfg = M5.config();
-  M5.begin(cfg);
-  Serial.println("M5Stack CoreS3 initialized");
+  hal_begin();
+  DLOG_I("M5Stack CoreS3 initialized");
+  power_mode = hal_power_begin(NCIR_POWER_MAX_MHZ, NCIR_POWER_MIN_MHZ, NCIR_LIGHT_SLEEP);
+  loop_task = xTaskGetCurrentTaskHandle();
+  DLOG_I("Power management: %s", power_mode_name());
+#ifdef NCIR_TELEMETRY
+  if (!telemetry_start(&Serial, TELEMETRY_TASK_PRIORITY, TELEMETRY_TASK_CORE)) {
+    DLOG_E("Failed to start telemetry task");
+  }
+#endif
 
   // Initialize NCIR sensor
-  if (!mlx.begin()) {
-    Serial.println("Error initializing MLX90614 sensor!");
+  if (!hal_sensor_begin()) {
+    DLOG_E("Error initializing MLX90614 sensor!");
+    debug_log_flush(1000);
     while (1);
   }
-  Serial.println("NCIR sensor initialized");
+  DLOG_I("NCIR sensor initialized");
   
   // Test sensor reading
-  float test_obj = mlx.readObjectTempC();
-  float test_amb = mlx.readAmbientTempC();
-  Serial.printf("Sensor test - Object: %.1f°C, Ambient: %.1f°C\n", test_obj, test_amb);
+  float test_obj = hal_sensor_object_c();
+  float test_amb = hal_sensor_ambient_c();
+  DLOG_I("Sensor test - Object: %.1f°C, Ambient: %.1f°C", test_obj, test_amb);
 
   // Initialize LVGL
-  Serial.println("Before LVGL init");
+  DLOG_D("Before LVGL init");
   lv_init();
-  Serial.println("After LVGL init");
-  Serial.println("Before m5gfx_lvgl_init");
+  DLOG_D("After LVGL init");
+  DLOG_D("Before m5gfx_lvgl_init");
   m5gfx_lvgl_init();
-  Serial.println("After m5gfx_lvgl_init");
-  Serial.println("LVGL setup complete");
+  DLOG_D("After m5gfx_lvgl_init");
+  DLOG_I("LVGL setup complete");
 
   // LVGL task creation removed - using main loop refresh instead
-  Serial.println("LVGL refresh will be handled in main loop");
+  DLOG_D("LVGL refresh will be handled in main loop");
 
   // Setup hardware (buttons, interrupts, preferences)
   setup_hardware();
   load_preferences();
+  sound_player_set_volume(sound_volume);
+  set_brightness(brightness_level);
+  if (!log_index_init(&log_index, SAMPLE_LOG_BLOCKS)) {
+    DLOG_E("Failed to allocate log index");
+  }
+  if (!flash_ready || !sample_log_start(boot_id, &flash_io, SAMPLE_LOG_FLASH_BASE, SAMPLE_LOG_TASK_PRIORITY,
+                                        SAMPLE_LOG_TASK_CORE, index_log_block)) {
+    DLOG_E("Failed to start sample log");
+  }
+  trend_history_init(&trend_history, trend_periods_ms, update_rate);
+  for (int i = 0; i < TREND_LEVELS; i++) {
+    format_trend_span(trend_history.levels[i].period_ms * TREND_COLUMNS, trend_span_names[i], sizeof(trend_span_names[i]));
+  }
+  temp_stats_init(&temp_stats, temp_stats_windows);
+  mem_monitor_init(&mem_monitor);
+  start_sensor_task();
 
-  // Create UI screens
+  // Create the main menu only - other screens are built on first entry by switch_to_screen()
   create_main_menu_ui();
-  Serial.println("Main menu UI created");
-
-  create_temp_display_ui();
-  Serial.println("Temp display UI created");
-
-  create_temp_gauge_ui();
-  Serial.println("Temp gauge UI created");
-
-  create_settings_ui();
-  Serial.println("Settings UI created");
+  DLOG_I("Main menu UI created");
 
   // Load the initial main menu screen
   lv_screen_load(main_menu_screen);
 
   // Force a refresh to ensure display updates
   lv_refr_now(NULL);
-  Serial.println("Display refreshed");
+  DLOG_I("Display refreshed - boot to first frame: %lu ms", hal_millis());
+
+  lvgl_heap_log_stats();
+  DLOG_I("M5Stack CoreS3 NCIR UI Ready!");
+
+#ifdef NCIR_RENDER_BENCHMARK
+  run_render_benchmark();
+#endif
+#ifdef NCIR_FORMAT_BENCHMARK
+  run_format_benchmark();
+#endif
+#ifdef NCIR_STATS_BENCHMARK
+  run_stats_benchmark();
+#endif
+#ifdef NCIR_SOUND_BENCHMARK
+  run_sound_benchmark();
+#endif
+#ifdef NCIR_HISTORY_BENCHMARK
+  run_history_benchmark();
+#endif
+}
+
+// Touch panel reads since the last report: the CPU and I2C time the touch mode costs
+void log_touch_stats() {
+  static const char *const mode_names[] = {"off", "polled", "interrupt"};
+  static M5gfxLvglStats last = {};
+  M5gfxLvglStats stats;
+  m5gfx_lvgl_get_stats(&stats);
+  DLOG_I("Touch (%s, %d ms): %u reads, %u us", mode_names[m5gfx_lvgl_get_touch_mode()], NCIR_TOUCH_POLL_MS,
+         stats.touch_reads - last.touch_reads, stats.touch_us - last.touch_us);
+  last = stats;
+}
+
+const char *power_mode_name() {
+  switch (power_mode) {
+    case HAL_POWER_DFS: return "DFS";
+    case HAL_POWER_DFS_SLEEP: return "DFS + light sleep";
+    default: return "full speed";
+  }
+}
+
+// Attribute one battery current reading to the screen on display
+void sample_battery_current() {
+  int32_t ma;
+  if (!hal_battery_current_ma(&ma)) return;
+  screen_current_sum_ma[current_screen] += ma;
+  screen_current_samples[current_screen]++;
+}
+
+// Average battery current per screen since boot
+void log_battery_current() {
+  static const char *const screen_names[SCREEN_COUNT] = {
+    "menu", "temp", "gauge", "settings", "trend", "history", "diagnostics"
+  };
+  char text[160];
+  size_t length = 0;
+  for (int i = 0; i < SCREEN_COUNT && length < sizeof(text); i++) {
+    if (!screen_current_samples[i]) continue;
+    length += snprintf(text + length, sizeof(text) - length, " %s %ld mA (%us)", screen_names[i],
+                       (long)(screen_current_sum_ma[i] / screen_current_samples[i]), screen_current_samples[i]);
+  }
+  if (length) DLOG_I("Battery current (%s):%s", power_mode_name(), text);
+}
+
+// Mode indicator: power mode and CPU clock, on the diagnostics screen with the current
+// measured there
+void update_power_labels() {
+  static const char *const mode_tags[] = {"FULL", "DFS", "DFS+SLP"};
+  char text[64];
+  uint32_t mhz = hal_cpu_mhz();
+  int length = snprintf(text, sizeof(text), "%s", mode_tags[power_mode]);
+  if (mhz) snprintf(text + length, sizeof(text) - length, " %luMHz", (unsigned long)mhz);
+  if (current_screen == SCREEN_MAIN_MENU) set_label_text_if_changed(menu_power_label, text);
+
+  if (current_screen == SCREEN_DIAGNOSTICS && diag_power_label) {
+    char line[96];
+    uint32_t samples = screen_current_samples[SCREEN_DIAGNOSTICS];
+    if (samples) {
+      snprintf(line, sizeof(line), "Power: %s, %ld mA", text, (long)(screen_current_sum_ma[SCREEN_DIAGNOSTICS] / samples));
+    } else {
+      snprintf(line, sizeof(line), "Power: %s", text);
+    }
+    set_label_text_if_changed(diag_power_label, line);
+  }
+}
 
-  Serial.println("Multi-screen UI created");
-  Serial.println("M5Stack CoreS3 NCIR UI Ready!");
+// Backlight level for display_state at the brightness setting
+void apply_backlight() {
+  int level = brightness_level;
+  if (display_state == DISPLAY_DIMMED && level > NCIR_DIM_LEVEL) level = NCIR_DIM_LEVEL;
+  if (display_state == DISPLAY_OFF) level = 0;
+  hal_display_set_brightness(level);
 }
 
-// Touch input is handled automatically by LVGL event system
-// No additional touch handling needed - LVGL manages all touch events through button callbacks
+// Brightness setting from the slider or Btn1, applied unless the display is dimmed or off
+void set_brightness(int level) {
+  if (level < BRIGHTNESS_MIN) level = BRIGHTNESS_MIN;
+  if (level > 255) level = 255;
+  brightness_level = level;
+  apply_backlight();
+
+  if (brightness_slider) lv_slider_set_value(brightness_slider, level, LV_ANIM_OFF);
+  if (brightness_label) {
+    char text[8];
+    snprintf(text, sizeof(text), "%d", level);
+    set_label_text_if_changed(brightness_label, text);
+  }
+}
+
+// Full brightness and rendering again, and a fresh idle period. Returns the state the
+// display was in.
+DisplayState display_wake() {
+  DisplayState previous = display_state;
+  lv_display_trigger_activity(NULL);
+  if (previous == DISPLAY_ACTIVE) return previous;
+
+  display_state = DISPLAY_ACTIVE;
+  if (previous == DISPLAY_OFF) {
+    // Screen updates were skipped while off
+    update_current_screen();
+    lv_obj_invalidate(lv_screen_active());
+    lv_refr_now(NULL);
+  }
+  apply_backlight();
+  DLOG_I("Display on");
+  return previous;
+}
+
+// Dim and switch off on LVGL's inactivity time: touch and keypad input reset it,
+// buttons and alerts through display_wake(). Off stays off until display_wake(), from a
+// button, an alert or a touch (m5gfx_lvgl_touch_wake).
+void update_display_idle() {
+  if (display_state == DISPLAY_OFF) return;
+
+  uint32_t idle_ms = lv_display_get_inactive_time(NULL);
+  DisplayState state = DISPLAY_ACTIVE;
+  if (NCIR_OFF_AFTER_S && idle_ms >= NCIR_OFF_AFTER_S * 1000UL) {
+    state = DISPLAY_OFF;
+  } else if (NCIR_DIM_AFTER_S && idle_ms >= NCIR_DIM_AFTER_S * 1000UL) {
+    state = DISPLAY_DIMMED;
+  }
+  if (state == display_state) return;
+
+  display_state = state;
+  apply_backlight();
+  DLOG_I("Display %s after %lu s idle", state == DISPLAY_OFF ? "off" : state == DISPLAY_DIMMED ? "dimmed" : "on",
+         (unsigned long)(idle_ms / 1000));
+}
 
-// Touch input is handled automatically by LVGL event system
-// No additional touch handling needed - LVGL manages all touch events through button callbacks
+static void loop_idle_wait();
 
 void loop() {
-  M5.update();
+  // The panel is read by the touch indev as the touch mode says, not on every pass.
+  // While the display is off LVGL is paused and a touch only wakes it
+  if (display_state != DISPLAY_OFF) {
+    m5gfx_lvgl_touch_service();
+  } else if (m5gfx_lvgl_touch_wake()) {
+    display_wake();
+  }
+#ifdef NCIR_TELEMETRY
+  capture_button_edges();
+#endif
 
-  // Improved LVGL refresh timing
-  uint32_t current_time = millis();
-  if (current_time - lastLvglTick >= screenTickPeriod) {
+  // Improved LVGL refresh timing, suspended while the display is off
+  uint32_t current_time = hal_millis();
+  if (display_state != DISPLAY_OFF && current_time - lastLvglTick >= screenTickPeriod) {
     lvgl_tick_task(NULL);
     lastLvglTick = current_time;
   }
 
-  // Handle button polling for main menu navigation
-  if (current_screen == SCREEN_MAIN_MENU) {
-    static bool last_key_state = HIGH;
-    unsigned long current_time = millis();
+  // The touch indev refreshes M5 state on each panel read, but touch may be off or the
+  // display asleep, so the power button and PMIC are also polled at a fixed rate
+  static unsigned long last_hal_update = 0;
+  if (current_time - last_hal_update >= HAL_UPDATE_PERIOD_MS) {
+    hal_update();
+    last_hal_update = current_time;
+  }
 
-    // Read current key button state
-    bool current_key_state = digitalRead(KEY_PIN);
+  // Buttons: press events dispatched through input_table
+  poll_buttons();
 
-    // Check Key (GPIO8) - Go to settings menu
-    if (current_key_state == LOW && last_key_state == HIGH && current_time - last_button_time[2] >= DEBOUNCE_DELAY) {
-      Serial.println("Key pressed (Main menu - go to settings)");
-      switch_to_screen(SCREEN_SETTINGS); // Go to settings menu
-      last_button_time[2] = current_time;
-    }
+  // Consume samples published by the sensor task
+  if (update_temperature_reading()) {
+    // Update current screen display immediately
+    if (display_state != DISPLAY_OFF) update_current_screen();
+    check_temp_alerts();
+  }
 
-    // Update last state
-    last_key_state = current_key_state;
-  }
-
-  // Handle button polling for settings navigation
-  if (current_screen == SCREEN_SETTINGS) {
-    static bool last_button1_state = HIGH;
-    static bool last_button2_state = HIGH;
-    static bool last_key_state = HIGH;
-    unsigned long current_time = millis();
-
-    // Read current button states
-    bool current_button1_state = digitalRead(BUTTON1_PIN);
-    bool current_button2_state = digitalRead(BUTTON2_PIN);
-    bool current_key_state = digitalRead(KEY_PIN);
-
-    // Check Button 1 (GPIO17) - Navigate forward/Select Cancel/Select Celsius
-    if (current_button1_state == LOW && last_button1_state == HIGH && current_time - last_button_time[0] >= DEBOUNCE_DELAY) {
-      Serial.println("Button 1 pressed (Settings navigation)");
-      if (current_settings_screen == SETTINGS_MENU) {
-        // Navigate forward through menu items (0-3)
-        current_settings_selection = (current_settings_selection + 1) % 4;
-        switch_to_settings_screen(); // Refresh UI to show new selection
-      } else if (current_settings_screen == SETTINGS_UNITS) {
-        // In units page, select Celsius
-        use_celsius = true;
-        Serial.printf("Temperature units set to: %s\n", use_celsius ? "Celsius" : "Fahrenheit");
-        save_preferences();
-        switch_to_settings_screen(); // Refresh UI to show selection
-      } else if (current_settings_screen == SETTINGS_EXIT) {
-        // In exit tab, select Cancel
-        exit_selection_cancel = true;
-        switch_to_settings_screen(); // Refresh UI to show selection
-      }
-      last_button_time[0] = current_time;
-    }
+  update_display_idle();
 
-    // Check Button 2 (GPIO18) - Navigate backward/Select Save/Select Fahrenheit
-    if (current_button2_state == LOW && last_button2_state == HIGH && current_time - last_button_time[1] >= DEBOUNCE_DELAY) {
-      Serial.println("Button 2 pressed (Settings navigation)");
-      if (current_settings_screen == SETTINGS_MENU) {
-        // Navigate backward through menu items (0-3)
-        current_settings_selection = (current_settings_selection - 1 + 4) % 4;
-        switch_to_settings_screen(); // Refresh UI to show new selection
-      } else if (current_settings_screen == SETTINGS_UNITS) {
-        // In units page, select Fahrenheit
-        use_celsius = false;
-        Serial.printf("Temperature units set to: %s\n", use_celsius ? "Celsius" : "Fahrenheit");
-        save_preferences();
-        switch_to_settings_screen(); // Refresh UI to show selection
-      } else if (current_settings_screen == SETTINGS_EXIT) {
-        // In exit tab, select Save
-        exit_selection_cancel = false;
-        switch_to_settings_screen(); // Refresh UI to show selection
-      }
-      last_button_time[1] = current_time;
-    }
+  // Battery current of the screen on display, and the CPU clock on the indicators
+  static unsigned long last_current_sample = 0;
+  if (hal_millis() - last_current_sample >= POWER_CURRENT_PERIOD_MS) {
+    sample_battery_current();
+    update_power_labels();
+    last_current_sample = hal_millis();
+  }
 
-    // Check Key (GPIO8) - Accept/Confirm selection and return to main menu
-    if (current_key_state == LOW && last_key_state == HIGH && current_time - last_button_time[2] >= DEBOUNCE_DELAY) {
-      Serial.println("Key pressed (Settings confirm & return)");
-      if (current_settings_screen == SETTINGS_MENU) {
-        // Enter selected menu item
-        SettingsScreen selected_screen;
-        switch (current_settings_selection) {
-          case 0: selected_screen = SETTINGS_UNITS; break;
-          case 1: selected_screen = SETTINGS_AUDIO; break;
-          case 2: selected_screen = SETTINGS_ALERTS; break;
-          case 3: selected_screen = SETTINGS_EXIT; break;
-        }
-        current_settings_screen = selected_screen;
-        switch_to_settings_screen(); // Show the selected settings page
-      } else if (current_settings_screen == SETTINGS_UNITS) {
-        // Unit is already selected by Button 1/2, just return to main menu
-        Serial.printf("Temperature units confirmed: %s - returning to main menu\n", use_celsius ? "Celsius" : "Fahrenheit");
-        save_preferences(); // Save the current selection
-        switch_to_screen(SCREEN_MAIN_MENU); // Return to main menu
-      } else if (current_settings_screen == SETTINGS_AUDIO) {
-        // Toggle sound alerts and return
-        sound_enabled = !sound_enabled;
-        Serial.printf("Sound alerts toggled to: %s - returning to main menu\n", sound_enabled ? "ON" : "OFF");
-        save_preferences();
-        switch_to_screen(SCREEN_MAIN_MENU); // Return to main menu
-      } else if (current_settings_screen == SETTINGS_ALERTS) {
-        // Toggle alerts and return
-        alerts_enabled = !alerts_enabled;
-        Serial.printf("Temperature alerts toggled to: %s - returning to main menu\n", alerts_enabled ? "ON" : "OFF");
-        save_preferences();
-        switch_to_screen(SCREEN_MAIN_MENU); // Return to main menu
-      } else if (current_settings_screen == SETTINGS_EXIT) {
-        // Execute exit action based on selection
-        if (exit_selection_cancel) {
-          Serial.println("Exit cancelled - returning to main menu without saving");
-          // Return to main menu without saving changes (already have current settings)
-          switch_to_screen(SCREEN_MAIN_MENU);
-        } else {
-          Serial.println("Exit with save - saving preferences and returning to main menu");
-          save_preferences();
-          switch_to_screen(SCREEN_MAIN_MENU);
-        }
-      }
-      last_button_time[2] = current_time;
-    }
+  // Heap and stack watermarks: telemetry, warnings and the diagnostics screen
+  static unsigned long last_memory_snapshot = 0;
+  if (hal_millis() - last_memory_snapshot >= MEM_MONITOR_PERIOD_MS) {
+    collect_memory_snapshot();
+    report_memory_snapshot();
+    update_diagnostics_screen();
+    last_memory_snapshot = hal_millis();
+  }
 
-    // Update last states
-    last_button1_state = current_button1_state;
-    last_button2_state = current_button2_state;
-    last_key_state = current_key_state;
+  // Periodic LVGL heap telemetry to catch fragmentation on long-running devices
+  static unsigned long last_heap_report = 0;
+  if (hal_millis() - last_heap_report >= 60000) {
+    lvgl_heap_log_stats();
+    DLOG_I("System heap: free %u min_free %u", hal_free_heap(), hal_min_free_heap());
+    log_sample_log_stats();
+    TelemetryStats telemetry;
+    telemetry_get_stats(&telemetry);
+    DLOG_I("Telemetry: %u frames, %u dropped, %u bytes, ring high water %u",
+                  telemetry.frames, telemetry.dropped, telemetry.bytes, telemetry.high_water);
+    log_touch_stats();
+    log_battery_current();
+    last_heap_report = hal_millis();
   }
 
-  // Update temperature at specified rate
-  if (millis() - last_update >= update_rate) {
-    update_temperature_reading();
+  loop_idle_wait();
+}
 
-    // Update current screen display immediately
-    if (current_screen == SCREEN_TEMP_DISPLAY) {
-      update_temp_display_screen();
-    } else if (current_screen == SCREEN_TEMP_GAUGE) {
-      update_temp_gauge_screen();
-    }
+// Block until loop() has something to do, or a sensor sample arrives
+static void loop_idle_wait() {
+  uint32_t wait_ms = POWER_IDLE_MAX_MS;
+  if (button_input_any_pressed(&button_input)) wait_ms = POWER_HELD_WAIT_MS;
+  if (display_state != DISPLAY_OFF && lvgl_idle_ms < wait_ms) wait_ms = lvgl_idle_ms;
+  if (wait_ms < screenTickPeriod) wait_ms = screenTickPeriod;
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
+}
 
-    check_temp_alerts();
-    last_update = millis();
+
+// Button presses and releases as telemetry frames, so a capture holds everything a
+// trace replay needs (tools/telemetry_decode.py --trace)
+void capture_button_edges() {
+  static int last_levels[HAL_BUTTON_COUNT] = {HIGH, HIGH, HIGH};
+  for (int i = 0; i < HAL_BUTTON_COUNT; i++) {
+    int level = hal_button_read((HalButton)i);
+    if (level != last_levels[i]) {
+      telemetry_button(i, level == LOW);
+      last_levels[i] = level;
+    }
   }
+}
 
-  // Small delay to prevent watchdog issues but allow button polling
-  delay(10);
+// Button actions (arg from the binding)
+static void input_show_screen(int screen) {
+  switch_to_screen((ScreenState)screen);
 }
 
+static void input_reset_hold(int) {
+  temp_stats_reset(&temp_stats);
+  update_temp_display_screen();
+  DLOG_I("Temperature hold reset");
+}
 
-// Hardware interrupt service routines
-void IRAM_ATTR button1_ISR() {
-  button1_pressed = true;
+static void input_cycle_trend_span(int) {
+  cycle_trend_span();
+  DLOG_I("Trend span: %s", trend_span_names[trend_span]);
 }
 
-void IRAM_ATTR button2_ISR() {
-  button2_pressed = true;
+static void input_refresh_diagnostics(int) {
+  collect_memory_snapshot();
+  update_diagnostics_screen();
 }
 
-void IRAM_ATTR key_ISR() {
-  key_pressed = true;
+static void input_settings_page(int page) {
+  current_settings_screen = (SettingsScreen)page;
+  switch_to_settings_screen();
 }
 
-// Setup hardware pins and button polling
-void setup_hardware() {
-  // Configure LED pin as output
-  pinMode(LED_PIN, OUTPUT);
-  digitalWrite(LED_PIN, LOW); // Start with LED off
+// Tap an LVGL key on the keypad input device
+void input_key(int key) {
+  if (keypad_count + 2 > KEYPAD_QUEUE_SIZE) return;
+  for (int i = 0; i < 2; i++) {
+    KeypadEvent &event = keypad_queue[(keypad_head + keypad_count++) % KEYPAD_QUEUE_SIZE];
+    event.key = (uint32_t)key;
+    event.pressed = i == 0;
+  }
+}
 
-  // Configure button pins for digital read polling
-  pinMode(BUTTON1_PIN, INPUT_PULLUP);
-  pinMode(BUTTON2_PIN, INPUT_PULLUP);
-  pinMode(KEY_PIN, INPUT_PULLUP);
+static void input_toggle_sound(int) {
+  sound_enabled = !sound_enabled;
+  DLOG_I("Sound alerts toggled to: %s - returning to main menu", sound_enabled ? "ON" : "OFF");
+  save_preferences();
+  switch_to_screen(SCREEN_MAIN_MENU);
+}
 
-  // Initialize speaker
-  M5.Speaker.begin();
-  Serial.println("Speaker initialized");
-  Serial.println("Hardware button pins configured for polling");
+// Brightness up by step, from the top back to the minimum (saved on the release)
+static void input_step_brightness(int step) {
+  set_brightness(brightness_level >= 255 ? BRIGHTNESS_MIN : brightness_level + step);
 }
 
-// Load settings from persistent storage
-void load_preferences() {
-  preferences.begin("ncir_monitor", false);
+static void input_save_settings(int) {
+  save_preferences();
+}
 
-  use_celsius = preferences.getBool("use_celsius", true);
-  update_rate = preferences.getInt("update_rate", 1000);
-  brightness_level = preferences.getInt("brightness", 128);
-  sound_enabled = preferences.getBool("sound_enabled", true);
-  sound_volume = preferences.getInt("sound_volume", 70);
-  alerts_enabled = preferences.getBool("alerts_enabled", true);
-  low_temp_threshold = preferences.getFloat("low_temp_threshold", 10.0);
-  high_temp_threshold = preferences.getFloat("high_temp_threshold", 40.0);
+static void input_toggle_alerts(int) {
+  alerts_enabled = !alerts_enabled;
+  DLOG_I("Temperature alerts toggled to: %s - returning to main menu", alerts_enabled ? "ON" : "OFF");
+  save_preferences();
+  switch_to_screen(SCREEN_MAIN_MENU);
+}
+
+// What every button does, per screen and settings page (first match wins)
+static const InputBinding input_bindings[] = {
+  {SCREEN_MAIN_MENU, INPUT_ANY_PAGE, HAL_BUTTON_1, PRESS_SHORT, input_show_screen, SCREEN_DIAGNOSTICS},
+  {SCREEN_MAIN_MENU, INPUT_ANY_PAGE, HAL_BUTTON_KEY, PRESS_SHORT, input_show_screen, SCREEN_SETTINGS},
+
+  {SCREEN_TEMP_DISPLAY, INPUT_ANY_PAGE, HAL_BUTTON_1, PRESS_SHORT, input_reset_hold, 0},
+  {SCREEN_TEMP_DISPLAY, INPUT_ANY_PAGE, HAL_BUTTON_2, PRESS_SHORT, input_show_screen, SCREEN_MAIN_MENU},
+
+  {SCREEN_TEMP_GAUGE, INPUT_ANY_PAGE, HAL_BUTTON_2, PRESS_SHORT, input_show_screen, SCREEN_MAIN_MENU},
+
+  {SCREEN_TREND, INPUT_ANY_PAGE, HAL_BUTTON_1, PRESS_SHORT, input_cycle_trend_span, 0},
+  {SCREEN_TREND, INPUT_ANY_PAGE, HAL_BUTTON_2, PRESS_SHORT, input_show_screen, SCREEN_MAIN_MENU},
+  {SCREEN_TREND, INPUT_ANY_PAGE, HAL_BUTTON_KEY, PRESS_SHORT, input_show_screen, SCREEN_HISTORY},
+
+  // History: tap to zoom, hold to pan (repeating while held)
+  {SCREEN_HISTORY, INPUT_ANY_PAGE, HAL_BUTTON_1, PRESS_SHORT, zoom_history, 1},
+  {SCREEN_HISTORY, INPUT_ANY_PAGE, HAL_BUTTON_1, PRESS_LONG, pan_history, 1},
+  {SCREEN_HISTORY, INPUT_ANY_PAGE, HAL_BUTTON_1, PRESS_REPEAT, pan_history, 1},
+  {SCREEN_HISTORY, INPUT_ANY_PAGE, HAL_BUTTON_2, PRESS_SHORT, zoom_history, -1},
+  {SCREEN_HISTORY, INPUT_ANY_PAGE, HAL_BUTTON_2, PRESS_LONG, pan_history, -1},
+  {SCREEN_HISTORY, INPUT_ANY_PAGE, HAL_BUTTON_2, PRESS_REPEAT, pan_history, -1},
+  {SCREEN_HISTORY, INPUT_ANY_PAGE, HAL_BUTTON_KEY, PRESS_SHORT, input_show_screen, SCREEN_TREND},
+
+  {SCREEN_DIAGNOSTICS, INPUT_ANY_PAGE, HAL_BUTTON_1, PRESS_SHORT, input_refresh_diagnostics, 0},
+  {SCREEN_DIAGNOSTICS, INPUT_ANY_PAGE, HAL_BUTTON_2, PRESS_SHORT, input_show_screen, SCREEN_MAIN_MENU},
+
+  // Settings menu: the focus keeps moving while a button is held
+  {SCREEN_SETTINGS, SETTINGS_MENU, HAL_BUTTON_1, PRESS_REPEAT, input_key, LV_KEY_NEXT},
+  {SCREEN_SETTINGS, SETTINGS_MENU, HAL_BUTTON_2, PRESS_REPEAT, input_key, LV_KEY_PREV},
+  {SCREEN_SETTINGS, SETTINGS_MENU, HAL_BUTTON_KEY, PRESS_SHORT, input_key, LV_KEY_ENTER},
+
+  // Two-choice pages (no wrap): Btn1 the left choice, Btn2 the right one
+  {SCREEN_SETTINGS, SETTINGS_UNITS, HAL_BUTTON_1, PRESS_SHORT, input_key, LV_KEY_PREV},
+  {SCREEN_SETTINGS, SETTINGS_UNITS, HAL_BUTTON_2, PRESS_SHORT, input_key, LV_KEY_NEXT},
+  {SCREEN_SETTINGS, SETTINGS_UNITS, HAL_BUTTON_KEY, PRESS_SHORT, input_key, LV_KEY_ENTER},
+
+  {SCREEN_SETTINGS, SETTINGS_AUDIO, HAL_BUTTON_1, PRESS_REPEAT, input_step_brightness, BRIGHTNESS_STEP},
+  {SCREEN_SETTINGS, SETTINGS_AUDIO, HAL_BUTTON_1, PRESS_RELEASE, input_save_settings, 0},
+  {SCREEN_SETTINGS, SETTINGS_AUDIO, HAL_BUTTON_KEY, PRESS_SHORT, input_toggle_sound, 0},
+  {SCREEN_SETTINGS, SETTINGS_ALERTS, HAL_BUTTON_KEY, PRESS_SHORT, input_toggle_alerts, 0},
+
+  {SCREEN_SETTINGS, SETTINGS_EXIT, HAL_BUTTON_1, PRESS_SHORT, input_key, LV_KEY_PREV},
+  {SCREEN_SETTINGS, SETTINGS_EXIT, HAL_BUTTON_2, PRESS_SHORT, input_key, LV_KEY_NEXT},
+  {SCREEN_SETTINGS, SETTINGS_EXIT, HAL_BUTTON_KEY, PRESS_SHORT, input_key, LV_KEY_ENTER},
+
+  // Btn2 leaves the other settings pages for the menu
+  {SCREEN_SETTINGS, INPUT_ANY_PAGE, HAL_BUTTON_2, PRESS_SHORT, input_settings_page, SETTINGS_MENU},
+};
 
-  preferences.end();
+#define INPUT_BINDING_COUNT (sizeof(input_bindings) / sizeof(input_bindings[0]))
+
+// Row of input_table for what is on screen now
+static int input_context() {
+  if (current_screen == SCREEN_SETTINGS) return SCREEN_COUNT + current_settings_screen;
+  return current_screen;
 }
 
-// Save settings to persistent storage
-void save_preferences() {
-  preferences.begin("ncir_monitor", false);
+static void bind_input(int context, const InputBinding &binding) {
+  const InputBinding **slot = &input_table[context][binding.button][binding.press];
+  if (!*slot) *slot = &binding;
+}
 
-  preferences.putBool("use_celsius", use_celsius);
-  preferences.putInt("update_rate", update_rate);
-  preferences.putInt("brightness", brightness_level);
-  preferences.putBool("sound_enabled", sound_enabled);
-  preferences.putInt("sound_volume", sound_volume);
-  preferences.putBool("alerts_enabled", alerts_enabled);
-  preferences.putFloat("low_temp_threshold", low_temp_threshold);
-  preferences.putFloat("high_temp_threshold", high_temp_threshold);
+// Expand input_bindings into the dense lookup table used for dispatch
+void build_input_table() {
+  memset(input_table, 0, sizeof(input_table));
+  for (size_t i = 0; i < INPUT_BINDING_COUNT; i++) {
+    const InputBinding &binding = input_bindings[i];
+    if (binding.screen != SCREEN_SETTINGS) {
+      bind_input(binding.screen, binding);
+    } else if (binding.page != INPUT_ANY_PAGE) {
+      bind_input(SCREEN_COUNT + binding.page, binding);
+    } else {
+      for (int page = 0; page < SETTINGS_PAGE_COUNT; page++) bind_input(SCREEN_COUNT + page, binding);
+    }
+  }
+}
 
-  preferences.end();
+static bool fire_input(int context, uint8_t button, uint8_t press) {
+  const InputBinding *binding = input_table[context][button][press];
+  if (!binding) return false;
+  binding->action(binding->arg);
+  return true;
 }
 
-// Switch between screens instantly (no animation)
-void switch_to_screen(ScreenState new_screen) {
-  if (current_screen == new_screen) return;
+// Map one press event to the bindings of the context the press started in
+static void handle_button_event(const ButtonEvent &event) {
+  int context = input_context();
+  const InputBinding *const *bindings = input_table[context][event.button];
 
-  current_screen = new_screen;
+  if (event.type == BUTTON_EVENT_DOWN) {
+    // The press that turns the display back on is not acted on (-1 matches no context)
+    if (display_wake() == DISPLAY_OFF) {
+      input_press_context[event.button] = -1;
+      return;
+    }
+    input_press_context[event.button] = context;
+    // With a long binding the short one has to wait for the release
+    if (!bindings[PRESS_LONG] && !fire_input(context, event.button, PRESS_SHORT)) {
+      fire_input(context, event.button, PRESS_REPEAT);
+    }
+    return;
+  }
 
-  switch (new_screen) {
-    case SCREEN_MAIN_MENU:
-      lv_screen_load(main_menu_screen);
-      break;
-    case SCREEN_TEMP_DISPLAY:
-      lv_screen_load(temp_display_screen);
-      update_temp_display_screen();
+  // The press switched screens or pages: the rest of it belongs to the old one
+  if (input_press_context[event.button] != context) return;
+
+  switch (event.type) {
+    case BUTTON_EVENT_LONG:
+      fire_input(context, event.button, PRESS_LONG);
       break;
-    case SCREEN_TEMP_GAUGE:
-      lv_screen_load(temp_gauge_screen);
-      update_temp_gauge_screen();
+    case BUTTON_EVENT_REPEAT:
+      fire_input(context, event.button, PRESS_REPEAT);
       break;
-    case SCREEN_SETTINGS:
-      lv_screen_load(settings_screen);
-      current_settings_screen = SETTINGS_MENU; // Reset to menu when entering settings
-      switch_to_settings_screen(); // Populate settings screen with menu
+    case BUTTON_EVENT_UP:
+      if (!event.long_press && bindings[PRESS_LONG]) fire_input(context, event.button, PRESS_SHORT);
+      fire_input(context, event.button, PRESS_RELEASE);
       break;
   }
 }
 
-// Create main menu screen with alternative orange/blue theme
-void create_main_menu_ui() {
-  main_menu_screen = lv_obj_create(NULL);
-  lv_obj_set_style_bg_color(main_menu_screen, lv_color_hex(0x1a1a40), 0); // Dark blue-purple background
+// Poll the button levels and dispatch their press events
+void poll_buttons() {
+  bool pressed[HAL_BUTTON_COUNT];
+  for (int i = 0; i < HAL_BUTTON_COUNT; i++) {
+    pressed[i] = hal_button_read((HalButton)i) == LOW;
+  }
 
-  // Title with custom styling
-  menu_title = lv_label_create(main_menu_screen);
-  lv_label_set_text(menu_title, "NCIR Monitor");
-  lv_obj_set_style_text_font(menu_title, &lv_font_montserrat_24, 0);
-  lv_obj_set_style_text_color(menu_title, lv_color_hex(0xFF6B35), 0); // Orange accent
-  lv_obj_align(menu_title, LV_ALIGN_TOP_MID, 0, 15);
+  ButtonEvent events[HAL_BUTTON_COUNT];
+  int count = button_input_update(&button_input, hal_millis(), pressed, events, HAL_BUTTON_COUNT);
+  for (int i = 0; i < count; i++) {
+    handle_button_event(events[i]);
+  }
 
-  // Decorative underline
-  lv_obj_t *title_underline = lv_label_create(main_menu_screen);
-  lv_label_set_text(title_underline, "━━━━━━━━━━━━━━━━━━━━━━━━");
-  lv_obj_set_style_text_color(title_underline, lv_color_hex(0x4285F4), 0); // Blue accent
-  lv_obj_align(title_underline, LV_ALIGN_TOP_MID, 0, 45);
+  // Let LVGL act on queued keys now instead of at its next read period
+  if (keypad_count) lv_indev_read(keypad_indev);
+}
 
-  // Temperature Display button with enhanced styling
-  temp_display_btn = lv_btn_create(main_menu_screen);
-  lv_obj_set_size(temp_display_btn, 200, 60);
-  lv_obj_align(temp_display_btn, LV_ALIGN_CENTER, 0, -55);
-  lv_obj_set_style_bg_color(temp_display_btn, lv_color_hex(0x2c3e50), LV_PART_MAIN); // Dark blue-gray
-  lv_obj_set_style_border_width(temp_display_btn, 2, LV_PART_MAIN);
-  lv_obj_set_style_border_color(temp_display_btn, lv_color_hex(0xFF6B35), LV_PART_MAIN); // Orange border
-  lv_obj_add_event_cb(temp_display_btn, main_menu_event_cb, LV_EVENT_CLICKED, (void*)SCREEN_TEMP_DISPLAY);
+// Feed queued key taps to LVGL, one event per read
+static void keypad_read(lv_indev_t *indev, lv_indev_data_t *data) {
+  static uint32_t last_key = LV_KEY_ENTER;
+  if (!keypad_count) {
+    data->key = last_key;
+    data->state = LV_INDEV_STATE_RELEASED;
+    return;
+  }
 
-  lv_obj_t *temp_display_label = lv_label_create(temp_display_btn);
-  lv_label_set_text(temp_display_label, "Temperature Display");
-  lv_obj_set_style_text_font(temp_display_label, &lv_font_montserrat_16, 0);
-  lv_obj_set_style_text_color(temp_display_label, lv_color_hex(0xFFFFFF), 0);
-  lv_obj_center(temp_display_label);
+  const KeypadEvent &event = keypad_queue[keypad_head];
+  keypad_head = (keypad_head + 1) % KEYPAD_QUEUE_SIZE;
+  keypad_count--;
+  last_key = event.key;
+  data->key = event.key;
+  data->state = event.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+  data->continue_reading = keypad_count > 0;
+}
 
-  // Temperature Gauge button with enhanced styling
-  temp_gauge_btn = lv_btn_create(main_menu_screen);
-  lv_obj_set_size(temp_gauge_btn, 200, 60);
-  lv_obj_align(temp_gauge_btn, LV_ALIGN_CENTER, 0, 10);
-  lv_obj_set_style_bg_color(temp_gauge_btn, lv_color_hex(0x2c3e50), LV_PART_MAIN); // Dark blue-gray
-  lv_obj_set_style_border_width(temp_gauge_btn, 2, LV_PART_MAIN);
-  lv_obj_set_style_border_color(temp_gauge_btn, lv_color_hex(0x4285F4), LV_PART_MAIN); // Blue border
+// Keypad input device and the focus group it drives
+void keypad_begin() {
+  settings_group = lv_group_create();
+  keypad_indev = lv_indev_create();
+  lv_indev_set_type(keypad_indev, LV_INDEV_TYPE_KEYPAD);
+  lv_indev_set_read_cb(keypad_indev, keypad_read);
+  lv_indev_set_group(keypad_indev, settings_group);
+}
+
+// Setup hardware pins and button polling
+void setup_hardware() {
+  // LED is driven by the pattern driver (PWM + transition timer), starts off
+  if (!led_pattern_init()) {
+    DLOG_E("LED pattern driver init failed");
+  }
+
+  // Configure button pins for digital read polling
+  hal_buttons_begin();
+  button_input_init(&button_input, HAL_BUTTON_COUNT);
+  build_input_table();
+  keypad_begin();
+
+  // Initialize speaker and the alert sound task
+  hal_speaker_begin();
+  if (!sound_player_start(alert_sound_clips, ALERT_CLIP_COUNT, ALERT_SOUND_RATE,
+                          SOUND_TASK_PRIORITY, SOUND_TASK_CORE)) {
+    DLOG_E("Failed to start sound task");
+  }
+  DLOG_I("Speaker initialized");
+  DLOG_D("Hardware button pins configured for polling");
+}
+
+// Start sensor acquisition on core 0 so rendering on core 1 cannot stall it
+void start_sensor_task() {
+  sensor_queue = xQueueCreate(SENSOR_QUEUE_LENGTH, sizeof(TempSample));
+  if (!sensor_queue) {
+    DLOG_E("Failed to create sensor queue");
+    return;
+  }
+  if (!sensor_task_enabled) {
+    DLOG_I("Sensor task disabled - samples are replayed");
+    return;
+  }
+  xTaskCreatePinnedToCore(sensor_task, "sensor", SENSOR_STACK_SIZE, NULL,
+                          SENSOR_TASK_PRIORITY, NULL, SENSOR_TASK_CORE);
+  DLOG_I("Sensor task started");
+}
+
+// Queue a reading for update_temperature_reading(), waiting up to wait ticks for room
+bool publish_sensor_sample(uint32_t timestamp_ms, float object_c, float ambient_c, TickType_t wait) {
+  if (!sensor_queue) return false;
+  TempSample sample;
+  sample.timestamp_ms = timestamp_ms;
+  sample.object_temp = object_c;
+  sample.ambient_temp = ambient_c;
+  sample.queued_us = hal_micros();
+  if (xQueueSend(sensor_queue, &sample, wait) != pdTRUE) return false;
+  if (loop_task) xTaskNotifyGive(loop_task);
+  return true;
+}
+
+// Sample the MLX90614 at update_rate and publish to sensor_queue
+void sensor_task(void *arg) {
+  (void)arg;
+  TickType_t last_wake = xTaskGetTickCount();
+  uint32_t last_sample_ms = hal_millis();
+
+  for (;;) {
+    uint32_t timestamp_ms = hal_millis();
+    uint32_t read_start = hal_micros();
+    float object_c = hal_sensor_object_c();
+    float ambient_c = hal_sensor_ambient_c();
+    telemetry_profile(PROFILE_SENSOR_READ, hal_micros() - read_start);
+
+    uint32_t period = timestamp_ms - last_sample_ms;
+    if (period > sensor_max_period_ms) sensor_max_period_ms = period;
+    last_sample_ms = timestamp_ms;
+
+    if (!publish_sensor_sample(timestamp_ms, object_c, ambient_c, 0)) {
+      sensor_overruns++;
+    }
+
+    vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(update_rate));
+  }
+}
+
+// Load settings from the newest settings journal record and count this boot
+void load_preferences() {
+  flash_ready = hal_storage_open(&flash_io) >= SAMPLE_LOG_FLASH_BASE + SAMPLE_LOG_FLASH_SIZE &&
+                flash_journal_open(&settings_journal, &flash_io, 0, SETTINGS_JOURNAL_SECTORS, SETTINGS_SLOT_SIZE);
+  if (!flash_ready) {
+    DLOG_W("No usable data partition - settings and samples will not persist");
+  }
+
+  StoredSettings stored;
+  bool found = flash_ready && settings_journal.last_seq != FLASH_JOURNAL_NO_SEQ &&
+               flash_journal_read(&settings_journal, settings_journal.last_seq, &stored, sizeof(stored)) == sizeof(stored) &&
+               stored.version == SETTINGS_VERSION;
+  if (found) {
+    saved_settings = stored;
+    settings_saved = true;
+    use_celsius = stored.use_celsius;
+    update_rate = stored.update_rate;
+    brightness_level = stored.brightness;
+    sound_enabled = stored.sound_enabled;
+    sound_volume = stored.sound_volume;
+    alerts_enabled = stored.alerts_enabled;
+    low_temp_threshold = stored.low_temp_threshold;
+    high_temp_threshold = stored.high_temp_threshold;
+    boot_id = stored.boot_id;
+    if (!alert_engine_set_table(&alert_engine, &stored.alert_rules)) {
+      alert_engine_set_table(&alert_engine, &default_alert_rules);
+    }
+    apply_alert_thresholds();
+  } else {
+    load_legacy_preferences();
+  }
+  DLOG_I("Settings %s (journal open: %u reads)", found ? "restored" : "migrated from NVS",
+                settings_journal.open_reads);
+
+  boot_id++;
+  save_preferences();
+}
+
+// Settings from NVS as saved by older firmware (defaults on a new device)
+void load_legacy_preferences() {
+  hal_kv_open("ncir_monitor");
+
+  use_celsius = hal_kv_get_bool("use_celsius", true);
+  update_rate = hal_kv_get_int("update_rate", 1000);
+  brightness_level = hal_kv_get_int("brightness", 128);
+  sound_enabled = hal_kv_get_bool("sound_enabled", true);
+  sound_volume = hal_kv_get_int("sound_volume", 70);
+  alerts_enabled = hal_kv_get_bool("alerts_enabled", true);
+  low_temp_threshold = hal_kv_get_float("low_temp_threshold", 10.0);
+  high_temp_threshold = hal_kv_get_float("high_temp_threshold", 40.0);
+  boot_id = hal_kv_get_ushort("boot_id", 0);
+
+  AlertRuleTable rules;
+  if (hal_kv_get_bytes("alert_rules", &rules, sizeof(rules)) != sizeof(rules) ||
+      !alert_engine_set_table(&alert_engine, &rules)) {
+    alert_engine_set_table(&alert_engine, &default_alert_rules);
+  }
+  apply_alert_thresholds();
+
+  hal_kv_close();
+}
+
+// Save settings as one settings journal record
+void save_preferences() {
+  apply_alert_thresholds();
+  if (!flash_ready) return;
+
+  StoredSettings stored;
+  memset(&stored, 0, sizeof(stored));
+  stored.version = SETTINGS_VERSION;
+  stored.boot_id = boot_id;
+  stored.use_celsius = use_celsius;
+  stored.sound_enabled = sound_enabled;
+  stored.alerts_enabled = alerts_enabled;
+  stored.update_rate = update_rate;
+  stored.brightness = brightness_level;
+  stored.sound_volume = sound_volume;
+  stored.low_temp_threshold = low_temp_threshold;
+  stored.high_temp_threshold = high_temp_threshold;
+  stored.alert_rules = alert_engine.table;
+  if (settings_saved && memcmp(&stored, &saved_settings, sizeof(stored)) == 0) return;
+
+  if (!flash_journal_append(&settings_journal, &stored, sizeof(stored), NULL)) {
+    DLOG_E("Failed to save settings");
+    return;
+  }
+  saved_settings = stored;
+  settings_saved = true;
+}
+
+// Copy the slider thresholds into the low/high rules (rule state is kept)
+void apply_alert_thresholds() {
+  alert_engine.table.rules[ALERT_RULE_LOW].threshold = (int16_t)(low_temp_threshold * 10.0f);
+  alert_engine.table.rules[ALERT_RULE_HIGH].threshold = (int16_t)(high_temp_threshold * 10.0f);
+}
+
+// Lazily built screens, indexed by ScreenState
+struct ScreenSlot {
+  lv_obj_t **root;
+  void (*create)();
+  void (*release)(); // Clears widget pointers owned by the screen (may be NULL)
+  bool evictable;
+};
+
+static const ScreenSlot screen_slots[] = {
+  {&main_menu_screen, create_main_menu_ui, NULL, false},
+  {&temp_display_screen, create_temp_display_ui, release_temp_display_ui, true},
+  {&temp_gauge_screen, create_temp_gauge_ui, release_temp_gauge_ui, true},
+  {&settings_screen, create_settings_ui, release_settings_ui, true},
+  {&trend_screen, create_trend_ui, release_trend_ui, true},
+  {&history_screen, create_history_ui, release_history_ui, true},
+  {&diagnostics_screen, create_diagnostics_ui, release_diagnostics_ui, true},
+};
+
+// Evict the screen being left only while LVGL is over its memory budget
+static bool screen_should_evict(ScreenState screen) {
+  if (SCREEN_MEM_BUDGET == 0 || !screen_slots[screen].evictable) return false;
+
+  LvglHeapStats stats;
+  lvgl_heap_get_stats(&stats);
+  return stats.internal.used + stats.psram.used > SCREEN_MEM_BUDGET;
+}
+
+// Switch between screens instantly (no animation)
+void switch_to_screen(ScreenState new_screen) {
+  if (current_screen == new_screen) return;
+
+  const ScreenSlot &old_slot = screen_slots[current_screen];
+  const ScreenSlot &new_slot = screen_slots[new_screen];
+  bool evict = screen_should_evict(current_screen);
+
+  if (!*new_slot.root) {
+    uint32_t build_start = hal_millis();
+    uint32_t build_start_us = hal_micros();
+    new_slot.create();
+    telemetry_profile(PROFILE_SCREEN_BUILD, hal_micros() - build_start_us);
+    DLOG_I("Screen %d built in %lu ms", new_screen, hal_millis() - build_start);
+  }
+
+  // With auto_del LVGL deletes the old screen right after the new one is active
+  lv_screen_load_anim(*new_slot.root, LV_SCREEN_LOAD_ANIM_NONE, 0, 0, evict);
+  if (evict) {
+    *old_slot.root = NULL;
+    if (old_slot.release) old_slot.release();
+    DLOG_I("Screen %d released (over %d byte budget)", current_screen, SCREEN_MEM_BUDGET);
+  }
+
+  current_screen = new_screen;
+
+  switch (new_screen) {
+    case SCREEN_MAIN_MENU:
+      update_power_labels();
+      break;
+    case SCREEN_TEMP_DISPLAY:
+      update_temp_display_screen();
+      break;
+    case SCREEN_TEMP_GAUGE:
+      update_temp_gauge_screen();
+      break;
+    case SCREEN_SETTINGS:
+      current_settings_screen = SETTINGS_MENU; // Reset to menu when entering settings
+      switch_to_settings_screen(); // Populate settings screen with menu
+      break;
+    case SCREEN_TREND:
+      reload_trend_chart(); // Span or units may have changed since the last visit
+      update_trend_screen();
+      break;
+    case SCREEN_HISTORY:
+      reload_history_chart();
+      break;
+    case SCREEN_DIAGNOSTICS:
+      collect_memory_snapshot();
+      update_diagnostics_screen();
+      update_power_labels();
+      break;
+  }
+}
+
+// Create main menu screen with alternative orange/blue theme
+void create_main_menu_ui() {
+  main_menu_screen = lv_obj_create(NULL);
+  lv_obj_set_style_bg_color(main_menu_screen, lv_color_hex(0x1a1a40), 0); // Dark blue-purple background
+
+  // Title with custom styling
+  menu_title = lv_label_create(main_menu_screen);
+  lv_label_set_text(menu_title, "NCIR Monitor");
+  lv_obj_set_style_text_font(menu_title, UI_FONT_24, 0);
+  lv_obj_set_style_text_color(menu_title, lv_color_hex(0xFF6B35), 0); // Orange accent
+  lv_obj_align(menu_title, LV_ALIGN_TOP_MID, 0, 15);
+
+  // Power mode indicator
+  menu_power_label = lv_label_create(main_menu_screen);
+  lv_label_set_text(menu_power_label, "");
+  lv_obj_set_style_text_color(menu_power_label, lv_color_hex(0x607D8B), 0);
+  lv_obj_set_style_text_font(menu_power_label, UI_FONT_12, 0);
+  lv_obj_align(menu_power_label, LV_ALIGN_TOP_RIGHT, -6, 4);
+
+  // Decorative underline
+  lv_obj_t *title_underline = lv_obj_create(main_menu_screen);
+  lv_obj_set_size(title_underline, 280, 3);
+  lv_obj_align(title_underline, LV_ALIGN_TOP_MID, 0, 52);
+  lv_obj_set_style_bg_color(title_underline, lv_color_hex(0x4285F4), 0); // Blue accent
+
+  // Temperature Display button with enhanced styling (2x2 grid: display, gauge / trend, settings)
+  temp_display_btn = lv_btn_create(main_menu_screen);
+  lv_obj_set_size(temp_display_btn, 145, 60);
+  lv_obj_align(temp_display_btn, LV_ALIGN_CENTER, -78, -22);
+  lv_obj_set_style_bg_color(temp_display_btn, lv_color_hex(0x2c3e50), LV_PART_MAIN); // Dark blue-gray
+  lv_obj_set_style_border_width(temp_display_btn, 2, LV_PART_MAIN);
+  lv_obj_set_style_border_color(temp_display_btn, lv_color_hex(0xFF6B35), LV_PART_MAIN); // Orange border
+  lv_obj_add_event_cb(temp_display_btn, main_menu_event_cb, LV_EVENT_CLICKED, (void*)SCREEN_TEMP_DISPLAY);
+
+  lv_obj_t *temp_display_label = lv_label_create(temp_display_btn);
+  lv_label_set_text(temp_display_label, "Temperature\nDisplay");
+  lv_obj_set_style_text_font(temp_display_label, UI_FONT_16, 0);
+  lv_obj_set_style_text_align(temp_display_label, LV_TEXT_ALIGN_CENTER, 0);
+  lv_obj_set_style_text_color(temp_display_label, lv_color_hex(0xFFFFFF), 0);
+  lv_obj_center(temp_display_label);
+
+  // Temperature Gauge button with enhanced styling
+  temp_gauge_btn = lv_btn_create(main_menu_screen);
+  lv_obj_set_size(temp_gauge_btn, 145, 60);
+  lv_obj_align(temp_gauge_btn, LV_ALIGN_CENTER, 78, -22);
+  lv_obj_set_style_bg_color(temp_gauge_btn, lv_color_hex(0x2c3e50), LV_PART_MAIN); // Dark blue-gray
+  lv_obj_set_style_border_width(temp_gauge_btn, 2, LV_PART_MAIN);
+  lv_obj_set_style_border_color(temp_gauge_btn, lv_color_hex(0x4285F4), LV_PART_MAIN); // Blue border
   lv_obj_add_event_cb(temp_gauge_btn, main_menu_event_cb, LV_EVENT_CLICKED, (void*)SCREEN_TEMP_GAUGE);
 
   lv_obj_t *temp_gauge_label = lv_label_create(temp_gauge_btn);
-  lv_label_set_text(temp_gauge_label, "Temperature Gauge");
-  lv_obj_set_style_text_font(temp_gauge_label, &lv_font_montserrat_16, 0);
+  lv_label_set_text(temp_gauge_label, "Temperature\nGauge");
+  lv_obj_set_style_text_font(temp_gauge_label, UI_FONT_16, 0);
+  lv_obj_set_style_text_align(temp_gauge_label, LV_TEXT_ALIGN_CENTER, 0);
   lv_obj_set_style_text_color(temp_gauge_label, lv_color_hex(0xFFFFFF), 0);
   lv_obj_center(temp_gauge_label);
 
+  // Temperature Trend button
+  trend_menu_btn = lv_btn_create(main_menu_screen);
+  lv_obj_set_size(trend_menu_btn, 145, 60);
+  lv_obj_align(trend_menu_btn, LV_ALIGN_CENTER, -78, 46);
+  lv_obj_set_style_bg_color(trend_menu_btn, lv_color_hex(0x2c3e50), LV_PART_MAIN); // Dark blue-gray
+  lv_obj_set_style_border_width(trend_menu_btn, 2, LV_PART_MAIN);
+  lv_obj_set_style_border_color(trend_menu_btn, lv_color_hex(0x2ecc71), LV_PART_MAIN); // Green border
+  lv_obj_add_event_cb(trend_menu_btn, main_menu_event_cb, LV_EVENT_CLICKED, (void*)SCREEN_TREND);
+
+  lv_obj_t *trend_label = lv_label_create(trend_menu_btn);
+  lv_label_set_text(trend_label, "Temperature\nTrend");
+  lv_obj_set_style_text_font(trend_label, UI_FONT_16, 0);
+  lv_obj_set_style_text_color(trend_label, lv_color_hex(0xFFFFFF), 0);
+  lv_obj_set_style_text_align(trend_label, LV_TEXT_ALIGN_CENTER, 0);
+  lv_obj_center(trend_label);
+
   // Settings button
   settings_menu_btn = lv_btn_create(main_menu_screen);
-  lv_obj_set_size(settings_menu_btn, 200, 60);
-  lv_obj_align(settings_menu_btn, LV_ALIGN_BOTTOM_MID, 0, -25);
+  lv_obj_set_size(settings_menu_btn, 145, 60);
+  lv_obj_align(settings_menu_btn, LV_ALIGN_CENTER, 78, 46);
   lv_obj_set_style_bg_color(settings_menu_btn, lv_color_hex(0x34495e), LV_PART_MAIN); // Dark gray-blue
   lv_obj_set_style_border_width(settings_menu_btn, 2, LV_PART_MAIN);
   lv_obj_set_style_border_color(settings_menu_btn, lv_color_hex(0x9b59b6), LV_PART_MAIN); // Purple border
@@ -757,27 +2162,27 @@ void create_main_menu_ui() {
 
   lv_obj_t *settings_label = lv_label_create(settings_menu_btn);
   lv_label_set_text(settings_label, "Settings");
-  lv_obj_set_style_text_font(settings_label, &lv_font_montserrat_16, 0);
+  lv_obj_set_style_text_font(settings_label, UI_FONT_16, 0);
   lv_obj_set_style_text_color(settings_label, lv_color_hex(0xFFFFFF), 0);
   lv_obj_center(settings_label);
 
   // Hardware control indicators with modern styling
   lv_obj_t *btn1_indicator = lv_label_create(main_menu_screen);
-  lv_label_set_text(btn1_indicator, "Btn1: ---");
+  lv_label_set_text(btn1_indicator, "Btn1: Diagnostics");
   lv_obj_set_style_text_color(btn1_indicator, lv_color_hex(0x99aab5), 0);
-  lv_obj_set_style_text_font(btn1_indicator, &lv_font_montserrat_12, 0);
+  lv_obj_set_style_text_font(btn1_indicator, UI_FONT_12, 0);
   lv_obj_align(btn1_indicator, LV_ALIGN_BOTTOM_LEFT, 10, -8);
 
   lv_obj_t *btn2_indicator = lv_label_create(main_menu_screen);
   lv_label_set_text(btn2_indicator, "Btn2: ---");
   lv_obj_set_style_text_color(btn2_indicator, lv_color_hex(0x99aab5), 0);
-  lv_obj_set_style_text_font(btn2_indicator, &lv_font_montserrat_12, 0);
+  lv_obj_set_style_text_font(btn2_indicator, UI_FONT_12, 0);
   lv_obj_align(btn2_indicator, LV_ALIGN_BOTTOM_MID, 0, -8);
 
   lv_obj_t *key_indicator = lv_label_create(main_menu_screen);
   lv_label_set_text(key_indicator, "Key: Settings");
   lv_obj_set_style_text_color(key_indicator, lv_color_hex(0xFF6B35), 0); // Orange highlight
-  lv_obj_set_style_text_font(key_indicator, &lv_font_montserrat_12, 0);
+  lv_obj_set_style_text_font(key_indicator, UI_FONT_12, 0);
   lv_obj_align(key_indicator, LV_ALIGN_BOTTOM_RIGHT, -10, -8);
 }
 
@@ -800,7 +2205,7 @@ void create_temp_display_ui() {
   lv_obj_t *title = lv_label_create(header_bg);
   lv_label_set_text(title, "Temperature Reading");
   lv_obj_set_style_text_color(title, lv_color_hex(0xFFFFFF), 0);
-  lv_obj_set_style_text_font(title, &lv_font_montserrat_18, 0);
+  lv_obj_set_style_text_font(title, UI_FONT_18, 0);
   lv_obj_align(title, LV_ALIGN_CENTER, 10, 0);
 
   // Main temperature display - large, prominent
@@ -812,34 +2217,47 @@ void create_temp_display_ui() {
   lv_obj_set_style_border_color(temp_container, lv_color_hex(0x4285F4), 0); // Blue border
   lv_obj_set_style_radius(temp_container, 15, 0);
 
-  // Object temperature (primary reading)
+  // Object temperature (primary reading) - large digit-only font, caption drawn separately
+  lv_obj_t *object_caption = lv_label_create(temp_container);
+  lv_label_set_text(object_caption, "Object");
+  lv_obj_set_style_text_color(object_caption, lv_color_hex(0x99AAB5), 0);
+  lv_obj_set_style_text_font(object_caption, UI_FONT_12, 0);
+  lv_obj_align(object_caption, LV_ALIGN_TOP_LEFT, 0, -8);
+
   object_temp_label = lv_label_create(temp_container);
-  lv_label_set_text(object_temp_label, "Object: --C");
+  lv_label_set_text(object_temp_label, "--C");
   lv_obj_set_style_text_color(object_temp_label, lv_color_hex(0xFF6B35), 0); // Orange text for object temp
-  lv_obj_set_style_text_font(object_temp_label, &lv_font_montserrat_24, 0);
-  lv_obj_align(object_temp_label, LV_ALIGN_CENTER, 0, -15);
+  lv_obj_set_style_text_font(object_temp_label, UI_FONT_DIGITS, 0);
+  lv_obj_align(object_temp_label, LV_ALIGN_CENTER, 0, -12);
 
   // Ambient temperature (secondary reading)
   ambient_temp_label = lv_label_create(temp_container);
   lv_label_set_text(ambient_temp_label, "Ambient: --C");
   lv_obj_set_style_text_color(ambient_temp_label, lv_color_hex(0x99AAB5), 0); // Light gray for ambient
-  lv_obj_set_style_text_font(ambient_temp_label, &lv_font_montserrat_16, 0);
-  lv_obj_align(ambient_temp_label, LV_ALIGN_CENTER, 0, 20);
+  lv_obj_set_style_text_font(ambient_temp_label, UI_FONT_16, 0);
+  lv_obj_align(ambient_temp_label, LV_ALIGN_CENTER, 0, 28);
 
-  // Status indicator with modern styling
+  // Status indicator with modern styling - stability on top, MIN/AVG/MAX hold below
   lv_obj_t *status_container = lv_obj_create(temp_display_screen);
-  lv_obj_set_size(status_container, 200, 40);
+  lv_obj_set_size(status_container, 220, 48);
   lv_obj_align(status_container, LV_ALIGN_CENTER, 0, 70);
   lv_obj_set_style_bg_color(status_container, lv_color_hex(0x2c3e50), 0);
   lv_obj_set_style_border_width(status_container, 2, 0);
   lv_obj_set_style_border_color(status_container, lv_color_hex(0x9b59b6), 0); // Purple border
   lv_obj_set_style_radius(status_container, 10, 0);
+  lv_obj_set_style_pad_all(status_container, 3, 0);
 
   temp_status_label = lv_label_create(status_container);
   lv_label_set_text(temp_status_label, "Status: Ready");
   lv_obj_set_style_text_color(temp_status_label, lv_color_hex(0x00FF00), 0);
-  lv_obj_set_style_text_font(temp_status_label, &lv_font_montserrat_14, 0);
-  lv_obj_center(temp_status_label);
+  lv_obj_set_style_text_font(temp_status_label, UI_FONT_14, 0);
+  lv_obj_align(temp_status_label, LV_ALIGN_TOP_MID, 0, 0);
+
+  temp_hold_label = lv_label_create(status_container);
+  lv_label_set_text(temp_hold_label, "Min --  Avg --  Max --");
+  lv_obj_set_style_text_color(temp_hold_label, lv_color_hex(0x99AAB5), 0);
+  lv_obj_set_style_text_font(temp_hold_label, UI_FONT_12, 0);
+  lv_obj_align(temp_hold_label, LV_ALIGN_BOTTOM_MID, 0, 0);
 
   // Enhanced back button
   temp_display_back_btn = lv_btn_create(temp_display_screen);
@@ -852,17 +2270,26 @@ void create_temp_display_ui() {
 
   lv_obj_t *back_label = lv_label_create(temp_display_back_btn);
   lv_label_set_text(back_label, "Back");
-  lv_obj_set_style_text_font(back_label, &lv_font_montserrat_14, 0);
+  lv_obj_set_style_text_font(back_label, UI_FONT_14, 0);
   lv_obj_center(back_label);
 
   // Hardware control indicator for this screen
   lv_obj_t *control_indicator = lv_label_create(temp_display_screen);
-  lv_label_set_text(control_indicator, "Btn1: ---     Btn2: Menu     Key: ---");
+  lv_label_set_text(control_indicator, "Btn1: Reset     Btn2: Menu     Key: ---");
   lv_obj_set_style_text_color(control_indicator, lv_color_hex(0x607D8B), 0);
-  lv_obj_set_style_text_font(control_indicator, &lv_font_montserrat_12, 0);
+  lv_obj_set_style_text_font(control_indicator, UI_FONT_12, 0);
   lv_obj_align(control_indicator, LV_ALIGN_BOTTOM_MID, 0, -10);
 }
 
+// Forget widgets deleted together with the temperature display screen
+void release_temp_display_ui() {
+  temp_display_back_btn = NULL;
+  object_temp_label = NULL;
+  ambient_temp_label = NULL;
+  temp_status_label = NULL;
+  temp_hold_label = NULL;
+}
+
 // Create modernized temperature gauge screen with alternative orange/blue theme
 void create_temp_gauge_ui() {
   temp_gauge_screen = lv_obj_create(NULL);
@@ -882,7 +2309,7 @@ void create_temp_gauge_ui() {
   lv_obj_t *title = lv_label_create(header_bg);
   lv_label_set_text(title, "Temperature Gauge");
   lv_obj_set_style_text_color(title, lv_color_hex(0xFFFFFF), 0);
-  lv_obj_set_style_text_font(title, &lv_font_montserrat_18, 0);
+  lv_obj_set_style_text_font(title, UI_FONT_18, 0);
   lv_obj_align(title, LV_ALIGN_CENTER, 10, 0);
 
   // Modern gauge container with alternative styling
@@ -941,7 +2368,7 @@ void create_temp_gauge_ui() {
   temp_gauge_value_label = lv_label_create(value_container);
   lv_label_set_text(temp_gauge_value_label, "0C");
   lv_obj_set_style_text_color(temp_gauge_value_label, lv_color_hex(0xFF6B35), 0); // Orange text
-  lv_obj_set_style_text_font(temp_gauge_value_label, &lv_font_montserrat_20, 0);
+  lv_obj_set_style_text_font(temp_gauge_value_label, UI_FONT_20, 0);
   lv_obj_center(temp_gauge_value_label);
 
   // Modernized back button
@@ -955,33 +2382,522 @@ void create_temp_gauge_ui() {
 
   lv_obj_t *back_label = lv_label_create(temp_gauge_back_btn);
   lv_label_set_text(back_label, "Back");
-  lv_obj_set_style_text_font(back_label, &lv_font_montserrat_14, 0);
+  lv_obj_set_style_text_font(back_label, UI_FONT_14, 0);
   lv_obj_center(back_label);
 
   // Hardware control indicator for gauge screen
   lv_obj_t *control_indicator = lv_label_create(temp_gauge_screen);
   lv_label_set_text(control_indicator, "Btn1: ---     Btn2: Menu     Key: ---");
   lv_obj_set_style_text_color(control_indicator, lv_color_hex(0x607D8B), 0);
-  lv_obj_set_style_text_font(control_indicator, &lv_font_montserrat_12, 0);
+  lv_obj_set_style_text_font(control_indicator, UI_FONT_12, 0);
   lv_obj_align(control_indicator, LV_ALIGN_BOTTOM_MID, 0, -10);
 }
 
+// Forget widgets deleted together with the temperature gauge screen
+void release_temp_gauge_ui() {
+  temp_gauge_back_btn = NULL;
+  temp_scale = NULL;
+  temp_gauge_needle = NULL;
+  temp_gauge_value_label = NULL;
+}
+
+// Create temperature trend screen (min/max band plus last value per column)
+void create_trend_ui() {
+  trend_screen = lv_obj_create(NULL);
+  lv_obj_set_style_bg_color(trend_screen, lv_color_hex(0x0d1117), 0);
+
+  // Decorative header
+  lv_obj_t *header_bg = lv_obj_create(trend_screen);
+  lv_obj_set_size(header_bg, 320, 50);
+  lv_obj_align(header_bg, LV_ALIGN_TOP_MID, 0, 0);
+  lv_obj_set_style_bg_color(header_bg, lv_color_hex(0x161b22), 0);
+
+  lv_obj_t *header_border = lv_obj_create(trend_screen);
+  lv_obj_set_size(header_border, 320, 2);
+  lv_obj_align(header_border, LV_ALIGN_TOP_MID, 0, 48);
+  lv_obj_set_style_bg_color(header_border, lv_color_hex(0x2ecc71), 0); // Green accent line
+
+  lv_obj_t *title = lv_label_create(header_bg);
+  lv_label_set_text(title, "Temperature Trend");
+  lv_obj_set_style_text_color(title, lv_color_hex(0xFFFFFF), 0);
+  lv_obj_set_style_text_font(title, UI_FONT_18, 0);
+  lv_obj_align(title, LV_ALIGN_CENTER, 10, 0);
+
+  // Circular update mode: a new column only invalidates its own neighbourhood
+  // instead of shifting (and redrawing) the whole plot area
+  trend_chart = lv_chart_create(trend_screen);
+  lv_obj_set_size(trend_chart, 300, 120);
+  lv_obj_align(trend_chart, LV_ALIGN_TOP_MID, 0, 56);
+  lv_chart_set_type(trend_chart, LV_CHART_TYPE_LINE);
+  lv_chart_set_point_count(trend_chart, TREND_COLUMNS);
+  lv_chart_set_update_mode(trend_chart, LV_CHART_UPDATE_MODE_CIRCULAR);
+  lv_chart_set_div_line_count(trend_chart, 4, 6);
+  lv_obj_set_style_bg_color(trend_chart, lv_color_hex(0x1e2936), LV_PART_MAIN);
+  lv_obj_set_style_border_color(trend_chart, lv_color_hex(0x2c3e50), LV_PART_MAIN);
+  lv_obj_set_style_size(trend_chart, 0, 0, LV_PART_INDICATOR); // Lines only, no point markers
+  lv_obj_set_style_line_width(trend_chart, 1, LV_PART_ITEMS);
+
+  trend_max_series = lv_chart_add_series(trend_chart, lv_color_hex(0xFF6600), LV_CHART_AXIS_PRIMARY_Y);
+  trend_min_series = lv_chart_add_series(trend_chart, lv_color_hex(0x0099FF), LV_CHART_AXIS_PRIMARY_Y);
+  trend_last_series = lv_chart_add_series(trend_chart, lv_color_hex(0xFFFFFF), LV_CHART_AXIS_PRIMARY_Y);
+
+  trend_span_label = lv_label_create(trend_screen);
+  lv_obj_set_style_text_color(trend_span_label, lv_color_hex(0x2ecc71), 0);
+  lv_obj_set_style_text_font(trend_span_label, UI_FONT_14, 0);
+  lv_obj_align(trend_span_label, LV_ALIGN_TOP_LEFT, 12, 180);
+
+  trend_value_label = lv_label_create(trend_screen);
+  lv_label_set_text(trend_value_label, "--");
+  lv_obj_set_style_text_color(trend_value_label, lv_color_hex(0xFF6B35), 0);
+  lv_obj_set_style_text_font(trend_value_label, UI_FONT_14, 0);
+  lv_obj_align(trend_value_label, LV_ALIGN_TOP_RIGHT, -12, 180);
+
+  // Back button
+  trend_back_btn = lv_btn_create(trend_screen);
+  lv_obj_set_size(trend_back_btn, 70, 30);
+  lv_obj_align(trend_back_btn, LV_ALIGN_BOTTOM_LEFT, 10, -22);
+  lv_obj_set_style_bg_color(trend_back_btn, lv_color_hex(0x34495e), LV_PART_MAIN);
+  lv_obj_set_style_border_width(trend_back_btn, 2, LV_PART_MAIN);
+  lv_obj_set_style_border_color(trend_back_btn, lv_color_hex(0xFF6B35), LV_PART_MAIN);
+  lv_obj_add_event_cb(trend_back_btn, trend_back_event_cb, LV_EVENT_CLICKED, NULL);
+
+  lv_obj_t *back_label = lv_label_create(trend_back_btn);
+  lv_label_set_text(back_label, "Back");
+  lv_obj_set_style_text_font(back_label, UI_FONT_14, 0);
+  lv_obj_center(back_label);
+
+  // Span button
+  lv_obj_t *span_btn = lv_btn_create(trend_screen);
+  lv_obj_set_size(span_btn, 70, 30);
+  lv_obj_align(span_btn, LV_ALIGN_BOTTOM_RIGHT, -10, -22);
+  lv_obj_set_style_bg_color(span_btn, lv_color_hex(0x34495e), LV_PART_MAIN);
+  lv_obj_set_style_border_width(span_btn, 2, LV_PART_MAIN);
+  lv_obj_set_style_border_color(span_btn, lv_color_hex(0x2ecc71), LV_PART_MAIN);
+  lv_obj_add_event_cb(span_btn, trend_span_event_cb, LV_EVENT_CLICKED, NULL);
+
+  lv_obj_t *span_label = lv_label_create(span_btn);
+  lv_label_set_text(span_label, "Span");
+  lv_obj_set_style_text_font(span_label, UI_FONT_14, 0);
+  lv_obj_center(span_label);
+
+  // Hardware control indicator for trend screen
+  lv_obj_t *control_indicator = lv_label_create(trend_screen);
+  lv_label_set_text(control_indicator, "Btn1: Span     Btn2: Menu     Key: History");
+  lv_obj_set_style_text_color(control_indicator, lv_color_hex(0x607D8B), 0);
+  lv_obj_set_style_text_font(control_indicator, UI_FONT_12, 0);
+  lv_obj_align(control_indicator, LV_ALIGN_BOTTOM_MID, 0, -4);
+}
+
+// Forget widgets deleted together with the trend screen
+void release_trend_ui() {
+  trend_back_btn = NULL;
+  trend_chart = NULL;
+  trend_max_series = NULL;
+  trend_min_series = NULL;
+  trend_last_series = NULL;
+  trend_span_label = NULL;
+  trend_value_label = NULL;
+}
+
+// Create log history screen (min/max band plus mean per column over the sample log)
+void create_history_ui() {
+  history_screen = lv_obj_create(NULL);
+  lv_obj_set_style_bg_color(history_screen, lv_color_hex(0x0d1117), 0);
+
+  // Decorative header
+  lv_obj_t *header_bg = lv_obj_create(history_screen);
+  lv_obj_set_size(header_bg, 320, 50);
+  lv_obj_align(header_bg, LV_ALIGN_TOP_MID, 0, 0);
+  lv_obj_set_style_bg_color(header_bg, lv_color_hex(0x161b22), 0);
+
+  lv_obj_t *header_border = lv_obj_create(history_screen);
+  lv_obj_set_size(header_border, 320, 2);
+  lv_obj_align(header_border, LV_ALIGN_TOP_MID, 0, 48);
+  lv_obj_set_style_bg_color(header_border, lv_color_hex(0x9b59b6), 0); // Purple accent line
+
+  lv_obj_t *title = lv_label_create(header_bg);
+  lv_label_set_text(title, "Logged History");
+  lv_obj_set_style_text_color(title, lv_color_hex(0xFFFFFF), 0);
+  lv_obj_set_style_text_font(title, UI_FONT_18, 0);
+  lv_obj_align(title, LV_ALIGN_CENTER, 10, 0);
+
+  // Every zoom or pan rewrites all columns, so the series arrays are filled directly
+  history_chart = lv_chart_create(history_screen);
+  lv_obj_set_size(history_chart, 300, 120);
+  lv_obj_align(history_chart, LV_ALIGN_TOP_MID, 0, 56);
+  lv_chart_set_type(history_chart, LV_CHART_TYPE_LINE);
+  lv_chart_set_point_count(history_chart, HISTORY_COLUMNS);
+  lv_chart_set_div_line_count(history_chart, 4, 6);
+  lv_obj_set_style_bg_color(history_chart, lv_color_hex(0x1e2936), LV_PART_MAIN);
+  lv_obj_set_style_border_color(history_chart, lv_color_hex(0x2c3e50), LV_PART_MAIN);
+  lv_obj_set_style_size(history_chart, 0, 0, LV_PART_INDICATOR); // Lines only, no point markers
+  lv_obj_set_style_line_width(history_chart, 1, LV_PART_ITEMS);
+
+  history_max_series = lv_chart_add_series(history_chart, lv_color_hex(0xFF6600), LV_CHART_AXIS_PRIMARY_Y);
+  history_min_series = lv_chart_add_series(history_chart, lv_color_hex(0x0099FF), LV_CHART_AXIS_PRIMARY_Y);
+  history_mean_series = lv_chart_add_series(history_chart, lv_color_hex(0xFFFFFF), LV_CHART_AXIS_PRIMARY_Y);
+
+  history_span_label = lv_label_create(history_screen);
+  lv_obj_set_style_text_color(history_span_label, lv_color_hex(0x9b59b6), 0);
+  lv_obj_set_style_text_font(history_span_label, UI_FONT_14, 0);
+  lv_obj_align(history_span_label, LV_ALIGN_TOP_LEFT, 12, 180);
+
+  history_range_label = lv_label_create(history_screen);
+  lv_label_set_text(history_range_label, "--");
+  lv_obj_set_style_text_color(history_range_label, lv_color_hex(0xFF6B35), 0);
+  lv_obj_set_style_text_font(history_range_label, UI_FONT_14, 0);
+  lv_obj_align(history_range_label, LV_ALIGN_TOP_RIGHT, -12, 180);
+
+  // Back button
+  lv_obj_t *back_btn = lv_btn_create(history_screen);
+  lv_obj_set_size(back_btn, 70, 30);
+  lv_obj_align(back_btn, LV_ALIGN_BOTTOM_LEFT, 10, -22);
+  lv_obj_set_style_bg_color(back_btn, lv_color_hex(0x34495e), LV_PART_MAIN);
+  lv_obj_set_style_border_width(back_btn, 2, LV_PART_MAIN);
+  lv_obj_set_style_border_color(back_btn, lv_color_hex(0xFF6B35), LV_PART_MAIN);
+  lv_obj_add_event_cb(back_btn, history_back_event_cb, LV_EVENT_CLICKED, NULL);
+
+  lv_obj_t *back_label = lv_label_create(back_btn);
+  lv_label_set_text(back_label, "Back");
+  lv_obj_set_style_text_font(back_label, UI_FONT_14, 0);
+  lv_obj_center(back_label);
+
+  // Pan buttons: older / newer by half a window
+  static const char *pan_texts[2] = {"<", ">"};
+  for (int i = 0; i < 2; i++) {
+    lv_obj_t *pan_btn = lv_btn_create(history_screen);
+    lv_obj_set_size(pan_btn, 50, 30);
+    lv_obj_align(pan_btn, LV_ALIGN_BOTTOM_RIGHT, i ? -10 : -70, -22);
+    lv_obj_set_style_bg_color(pan_btn, lv_color_hex(0x34495e), LV_PART_MAIN);
+    lv_obj_set_style_border_width(pan_btn, 2, LV_PART_MAIN);
+    lv_obj_set_style_border_color(pan_btn, lv_color_hex(0x9b59b6), LV_PART_MAIN);
+    lv_obj_add_event_cb(pan_btn, history_pan_event_cb, LV_EVENT_CLICKED, (void *)(intptr_t)(i ? -1 : 1));
+
+    lv_obj_t *pan_label = lv_label_create(pan_btn);
+    lv_label_set_text(pan_label, pan_texts[i]);
+    lv_obj_set_style_text_font(pan_label, UI_FONT_14, 0);
+    lv_obj_center(pan_label);
+  }
+
+  // Hardware control indicator for history screen
+  lv_obj_t *control_indicator = lv_label_create(history_screen);
+  lv_label_set_text(control_indicator, "Btn1/2: Zoom in/out, hold to pan     Key: Back");
+  lv_obj_set_style_text_color(control_indicator, lv_color_hex(0x607D8B), 0);
+  lv_obj_set_style_text_font(control_indicator, UI_FONT_12, 0);
+  lv_obj_align(control_indicator, LV_ALIGN_BOTTOM_MID, 0, -4);
+}
+
+// Forget widgets deleted together with the history screen
+void release_history_ui() {
+  history_chart = NULL;
+  history_max_series = NULL;
+  history_min_series = NULL;
+  history_mean_series = NULL;
+  history_span_label = NULL;
+  history_range_label = NULL;
+}
+
+// Create memory diagnostics screen (heap regions, LVGL heap, task stack watermarks)
+void create_diagnostics_ui() {
+  diagnostics_screen = lv_obj_create(NULL);
+  lv_obj_set_style_bg_color(diagnostics_screen, lv_color_hex(0x0d1117), 0);
+
+  // Decorative header
+  lv_obj_t *header_bg = lv_obj_create(diagnostics_screen);
+  lv_obj_set_size(header_bg, 320, 50);
+  lv_obj_align(header_bg, LV_ALIGN_TOP_MID, 0, 0);
+  lv_obj_set_style_bg_color(header_bg, lv_color_hex(0x161b22), 0);
+
+  lv_obj_t *header_border = lv_obj_create(diagnostics_screen);
+  lv_obj_set_size(header_border, 320, 2);
+  lv_obj_align(header_border, LV_ALIGN_TOP_MID, 0, 48);
+  lv_obj_set_style_bg_color(header_border, lv_color_hex(0x2ecc71), 0); // Green accent line
+
+  lv_obj_t *title = lv_label_create(header_bg);
+  lv_label_set_text(title, "Diagnostics");
+  lv_obj_set_style_text_color(title, lv_color_hex(0xFFFFFF), 0);
+  lv_obj_set_style_text_font(title, UI_FONT_18, 0);
+  lv_obj_align(title, LV_ALIGN_CENTER, 10, 0);
+
+  // One row per heap region, then the LVGL heap
+  for (int i = 0; i <= MEM_REGION_COUNT; i++) {
+    diag_heap_labels[i] = lv_label_create(diagnostics_screen);
+    lv_label_set_text(diag_heap_labels[i], "--");
+    lv_obj_set_style_text_color(diag_heap_labels[i], lv_color_hex(0xFFFFFF), 0);
+    lv_obj_set_style_text_font(diag_heap_labels[i], UI_FONT_12, 0);
+    lv_obj_align(diag_heap_labels[i], LV_ALIGN_TOP_LEFT, 12, 58 + i * 16);
+  }
+
+  // Stack watermarks in two columns
+  for (size_t i = 0; i < MONITORED_TASK_COUNT; i++) {
+    diag_stack_labels[i] = lv_label_create(diagnostics_screen);
+    lv_label_set_text(diag_stack_labels[i], "--");
+    lv_obj_set_style_text_color(diag_stack_labels[i], lv_color_hex(0x99aab5), 0);
+    lv_obj_set_style_text_font(diag_stack_labels[i], UI_FONT_12, 0);
+    lv_obj_align(diag_stack_labels[i], LV_ALIGN_TOP_LEFT, i % 2 ? 166 : 12, 122 + (i / 2) * 14);
+  }
+
+  diag_power_label = lv_label_create(diagnostics_screen);
+  lv_label_set_text(diag_power_label, "Power: --");
+  lv_obj_set_style_text_color(diag_power_label, lv_color_hex(0xFFFFFF), 0);
+  lv_obj_set_style_text_font(diag_power_label, UI_FONT_12, 0);
+  lv_obj_align(diag_power_label, LV_ALIGN_BOTTOM_RIGHT, -10, -45);
+
+  // Back button
+  lv_obj_t *back_btn = lv_btn_create(diagnostics_screen);
+  lv_obj_set_size(back_btn, 70, 30);
+  lv_obj_align(back_btn, LV_ALIGN_BOTTOM_LEFT, 10, -22);
+  lv_obj_set_style_bg_color(back_btn, lv_color_hex(0x34495e), LV_PART_MAIN);
+  lv_obj_set_style_border_width(back_btn, 2, LV_PART_MAIN);
+  lv_obj_set_style_border_color(back_btn, lv_color_hex(0xFF6B35), LV_PART_MAIN);
+  lv_obj_add_event_cb(back_btn, diagnostics_back_event_cb, LV_EVENT_CLICKED, NULL);
+
+  lv_obj_t *back_label = lv_label_create(back_btn);
+  lv_label_set_text(back_label, "Back");
+  lv_obj_set_style_text_font(back_label, UI_FONT_14, 0);
+  lv_obj_center(back_label);
+
+  diag_warning_label = lv_label_create(diagnostics_screen);
+  lv_label_set_text(diag_warning_label, "--");
+  lv_label_set_long_mode(diag_warning_label, LV_LABEL_LONG_DOT);
+  lv_obj_set_width(diag_warning_label, 220);
+  lv_obj_set_style_text_font(diag_warning_label, UI_FONT_14, 0);
+  lv_obj_set_style_text_align(diag_warning_label, LV_TEXT_ALIGN_RIGHT, 0);
+  lv_obj_align(diag_warning_label, LV_ALIGN_BOTTOM_RIGHT, -10, -29);
+
+  // Hardware control indicator for diagnostics screen
+  lv_obj_t *control_indicator = lv_label_create(diagnostics_screen);
+  lv_label_set_text(control_indicator, "Btn1: Refresh     Btn2: Back");
+  lv_obj_set_style_text_color(control_indicator, lv_color_hex(0x607D8B), 0);
+  lv_obj_set_style_text_font(control_indicator, UI_FONT_12, 0);
+  lv_obj_align(control_indicator, LV_ALIGN_BOTTOM_MID, 0, -4);
+}
+
+// Forget widgets deleted together with the diagnostics screen
+void release_diagnostics_ui() {
+  memset(diag_heap_labels, 0, sizeof(diag_heap_labels));
+  memset(diag_stack_labels, 0, sizeof(diag_stack_labels));
+  diag_warning_label = NULL;
+  diag_power_label = NULL;
+}
+
 // Create settings screen (replaced with page-based navigation - removed old LVGL tabview)
 void create_settings_ui() {
   // Only create the base screen object - UI will be populated dynamically by switch_to_settings_screen()
   settings_screen = lv_obj_create(NULL);
 }
 
-// Read temperature from sensor (using Celsius directly - no conversion needed)
-void update_temperature_reading() {
-  current_object_temp = mlx.readObjectTempC();    // Use Celsius reading directly
-  current_ambient_temp = mlx.readAmbientTempC();  // Use Celsius reading directly
+// Forget the page widgets (deleted with the screen or by the next page)
+void release_settings_ui() {
+  memset(settings_menu_btns, 0, sizeof(settings_menu_btns));
+  units_celsius_btn = NULL;
+  units_fahrenheit_btn = NULL;
+  units_current_label = NULL;
+  exit_cancel_btn = NULL;
+  exit_save_btn = NULL;
+  brightness_slider = NULL;
+  brightness_label = NULL;
+}
+
+// Drain samples published by the sensor task (returns true if a new reading arrived)
+bool update_temperature_reading() {
+  if (!sensor_queue) return false;
+
+  TempSample sample;
+  bool updated = false;
+  while (xQueueReceive(sensor_queue, &sample, 0) == pdTRUE) {
+    uint32_t latency = hal_micros() - sample.queued_us;
+    if (latency > sensor_max_latency_us) sensor_max_latency_us = latency;
+    sensor_total_latency_us += latency;
+    sensor_samples_consumed++;
+
+    current_object_temp = sample.object_temp;    // Celsius reading from sensor
+    current_ambient_temp = sample.ambient_temp;  // Celsius reading from sensor
+    trend_history_add(&trend_history, sample.timestamp_ms, sample.object_temp);
+    temp_stats_add(&temp_stats, sample.object_temp);
+    sample_log_append(sample.timestamp_ms, sample.object_temp, sample.ambient_temp);
+    telemetry_sample(sample.timestamp_ms, sample.object_temp, sample.ambient_temp);
+
+    // Threshold rules see the raw reading so a step fires on the sample that crosses
+    // (a window mean would lag it by seconds at 1 Hz); their hysteresis band and
+    // sustain time reject noise. Rate rules filter the raw samples themselves
+    alert_fired_mask |= alert_engine_update(&alert_engine, sample.timestamp_ms, sample.object_temp,
+                                            sample.object_temp);
+    updated = true;
+  }
 
   // Debug output every 5 seconds
   static unsigned long last_debug = 0;
-  if (millis() - last_debug >= 5000) {
-    Serial.printf("Temps - Object: %.1f°C, Ambient: %.1f°C\n", current_object_temp, current_ambient_temp);
-    last_debug = millis();
+  if (updated && hal_millis() - last_debug >= 5000) {
+    DLOG_D("Temps - Object: %.1f°C, Ambient: %.1f°C", current_object_temp, current_ambient_temp);
+    last_debug = hal_millis();
+  }
+  return updated;
+}
+
+// Sustained logging rate and flash wear of the sample log since boot
+void log_sample_log_stats() {
+  SampleLogStats stats;
+  sample_log_get_stats(&stats);
+  uint32_t elapsed_ms = hal_millis() - stats.started_ms;
+  if (!elapsed_ms) return;
+
+  DLOG_I("Sample log: %.2f samples/s, %lu flash bytes/h, %u blocks (next %u), %u dropped, max write %u us",
+                stats.samples * 1000.0f / elapsed_ms,
+                (unsigned long)((uint64_t)stats.bytes_written * 3600000ULL / elapsed_ms),
+                stats.blocks_written, stats.next_seq, stats.dropped, stats.max_write_us);
+}
+
+// Fill mem_snapshot from the heap regions, the LVGL heap and the task stacks (loop task)
+void collect_memory_snapshot() {
+  mem_snapshot.timestamp_ms = hal_millis();
+  for (int i = 0; i < MEM_REGION_COUNT; i++) {
+    hal_heap_info((MemRegion)i, &mem_snapshot.regions[i]);
+  }
+
+  LvglHeapStats lvgl;
+  lvgl_heap_get_stats(&lvgl);
+  mem_snapshot.lvgl_total = lvgl.internal.total + lvgl.psram.total;
+  mem_snapshot.lvgl_used = lvgl.internal.used + lvgl.psram.used;
+  mem_snapshot.lvgl_largest_free = max(lvgl.internal.largest_free, lvgl.psram.largest_free);
+
+  mem_snapshot.task_count = MONITORED_TASK_COUNT;
+  for (size_t i = 0; i < MONITORED_TASK_COUNT; i++) {
+    MemTaskInfo &task = mem_snapshot.tasks[i];
+    task.name = monitored_tasks[i].name;
+    task.stack_size = monitored_tasks[i].stack_size;
+    if (monitored_tasks[i].draw_unit >= 0) {
+      task.present = hal_task_handle_stack_free(m5gfx_lvgl_draw_thread(monitored_tasks[i].draw_unit), &task.stack_free);
+    } else {
+      task.present = hal_task_stack_free(monitored_tasks[i].task_name, &task.stack_free);
+    }
+  }
+}
+
+// Stream mem_snapshot and log the warnings it raises
+void report_memory_snapshot() {
+  uint32_t raised = mem_monitor_check(&mem_monitor, &mem_snapshot);
+  for (uint32_t bits = raised; bits; bits &= bits - 1) {
+    uint32_t bit = bits & -bits;
+    if (bit >= MEM_WARN_TASK(0)) {
+      const MemTaskInfo &task = mem_snapshot.tasks[__builtin_ctz(bit) - MEM_WARN_TASK_SHIFT];
+      DLOG_W("Stack low: %s has %u of %u bytes left", task.name, task.stack_free, task.stack_size);
+    } else {
+      DLOG_W("%s", mem_warning_name(bit));
+    }
+  }
+
+  const MemRegionInfo *regions = mem_snapshot.regions;
+  TelemetryMemory memory;
+  memory.timestamp_ms = mem_snapshot.timestamp_ms;
+  memory.internal_free = regions[MEM_REGION_INTERNAL].free;
+  memory.internal_largest = regions[MEM_REGION_INTERNAL].largest_free;
+  memory.internal_min_free = regions[MEM_REGION_INTERNAL].min_free;
+  memory.dma_free = regions[MEM_REGION_DMA].free;
+  memory.dma_largest = regions[MEM_REGION_DMA].largest_free;
+  memory.psram_free = regions[MEM_REGION_PSRAM].free;
+  memory.psram_largest = regions[MEM_REGION_PSRAM].largest_free;
+  memory.lvgl_used = mem_snapshot.lvgl_used;
+  memory.lvgl_free = mem_snapshot.lvgl_total - mem_snapshot.lvgl_used;
+  memory.lvgl_largest = mem_snapshot.lvgl_largest_free;
+  memory.warnings = mem_monitor.active;
+  telemetry_memory(&memory);
+  for (int i = 0; i < mem_snapshot.task_count; i++) {
+    const MemTaskInfo &task = mem_snapshot.tasks[i];
+    if (task.present) telemetry_stack(task.name, task.stack_size, task.stack_free);
+  }
+}
+
+// "123.4K", or plain bytes below 1 KiB
+static void format_bytes(char *buf, size_t size, uint32_t bytes) {
+  if (bytes < 1024) {
+    snprintf(buf, size, "%luB", (unsigned long)bytes);
+  } else {
+    snprintf(buf, size, "%lu.%luK", (unsigned long)(bytes / 1024), (unsigned long)(bytes % 1024 * 10 / 1024));
+  }
+}
+
+// Show mem_snapshot on the diagnostics screen
+void update_diagnostics_screen() {
+  if (current_screen != SCREEN_DIAGNOSTICS || !diag_warning_label) return;
+
+  static const char *region_names[MEM_REGION_COUNT] = {"Internal", "DMA", "PSRAM"};
+  static const uint32_t region_warnings[MEM_REGION_COUNT] = {
+    MEM_WARN_INTERNAL_FREE | MEM_WARN_INTERNAL_BLOCK, MEM_WARN_DMA_FREE, MEM_WARN_PSRAM_FREE
+  };
+  char text[64], free_text[12], block_text[12], min_text[12];
+  for (int i = 0; i < MEM_REGION_COUNT; i++) {
+    const MemRegionInfo &region = mem_snapshot.regions[i];
+    if (!region.present) {
+      snprintf(text, sizeof(text), "%s: n/a", region_names[i]);
+    } else {
+      format_bytes(free_text, sizeof(free_text), region.free);
+      format_bytes(block_text, sizeof(block_text), region.largest_free);
+      format_bytes(min_text, sizeof(min_text), region.min_free);
+      snprintf(text, sizeof(text), "%s: %s free, %s block, min %s", region_names[i], free_text, block_text, min_text);
+    }
+    set_label_text_if_changed(diag_heap_labels[i], text);
+    lv_obj_set_style_text_color(diag_heap_labels[i],
+                                lv_color_hex(mem_monitor.active & region_warnings[i] ? 0xe74c3c : 0xFFFFFF), 0);
+  }
+
+  format_bytes(free_text, sizeof(free_text), mem_snapshot.lvgl_used);
+  format_bytes(block_text, sizeof(block_text), mem_snapshot.lvgl_total);
+  format_bytes(min_text, sizeof(min_text), mem_snapshot.lvgl_largest_free);
+  snprintf(text, sizeof(text), "LVGL: %s of %s used, %s block", free_text, block_text, min_text);
+  set_label_text_if_changed(diag_heap_labels[MEM_REGION_COUNT], text);
+  lv_obj_set_style_text_color(diag_heap_labels[MEM_REGION_COUNT],
+                              lv_color_hex(mem_monitor.active & MEM_WARN_LVGL_FREE ? 0xe74c3c : 0xFFFFFF), 0);
+
+  // Stack bytes never used, of the stack size
+  for (int i = 0; i < mem_snapshot.task_count; i++) {
+    const MemTaskInfo &task = mem_snapshot.tasks[i];
+    if (!task.present) {
+      snprintf(text, sizeof(text), "%s: --", task.name);
+    } else {
+      format_bytes(free_text, sizeof(free_text), task.stack_free);
+      format_bytes(block_text, sizeof(block_text), task.stack_size);
+      snprintf(text, sizeof(text), "%s: %s / %s", task.name, free_text, block_text);
+    }
+    set_label_text_if_changed(diag_stack_labels[i], text);
+    lv_obj_set_style_text_color(diag_stack_labels[i],
+                                lv_color_hex(mem_monitor.active & MEM_WARN_TASK(i) ? 0xe74c3c : 0x99aab5), 0);
+  }
+
+  int warnings = __builtin_popcount(mem_monitor.active);
+  if (!warnings) {
+    set_label_text_if_changed(diag_warning_label, "Memory OK");
+  } else {
+    uint32_t first = mem_monitor.active & -mem_monitor.active;
+    snprintf(text, sizeof(text), warnings > 1 ? "%s (+%d)" : "%s", mem_warning_name(first), warnings - 1);
+    set_label_text_if_changed(diag_warning_label, text);
+  }
+  lv_obj_set_style_text_color(diag_warning_label, lv_color_hex(warnings ? 0xe74c3c : 0x2ecc71), 0);
+}
+
+// Sample log hook (log task): index each block written or found on flash at boot
+void index_log_block(const SampleLogBlockHeader *header) {
+  LogSummary summary;
+  summary.seq = header->seq;
+  summary.start_s = header->log_s;
+  summary.end_s = header->log_s + header->span_cs / 100;
+  summary.min = header->summary_count ? header->min_object : LOG_INDEX_NO_DATA;
+  summary.max = header->summary_count ? header->max_object : LOG_INDEX_NO_DATA;
+  summary.sum = (int64_t)header->mean_object * header->summary_count;
+  summary.samples = header->summary_count;
+  log_index_add(&log_index, &summary);
+}
+
+// Show a new reading on whichever screen displays live values
+void update_current_screen() {
+  if (current_screen == SCREEN_TEMP_DISPLAY) {
+    update_temp_display_screen();
+  } else if (current_screen == SCREEN_TEMP_GAUGE) {
+    update_temp_gauge_screen();
+  } else if (current_screen == SCREEN_TREND) {
+    update_trend_screen();
+  } else if (current_screen == SCREEN_HISTORY) {
+    update_history_screen();
   }
 }
 
@@ -996,19 +2912,58 @@ void update_temp_display_screen() {
     display_obj_temp = current_object_temp;    // Already in Celsius from sensor
     display_amb_temp = current_ambient_temp;   // Already in Celsius from sensor
   } else {
-    display_obj_temp = mlx.readObjectTempF();   // Read Fahrenheit directly from sensor
-    display_amb_temp = mlx.readAmbientTempF();  // Read Fahrenheit directly from sensor
+    display_obj_temp = celsius_to_fahrenheit(current_object_temp);
+    display_amb_temp = celsius_to_fahrenheit(current_ambient_temp);
   }
 
-  // Update labels with whole number temperatures
+  // Update labels with whole number temperatures (unchanged text is not redrawn)
+  const TempFormat fmt = {0, false, use_celsius ? "C" : "F"};
   char temp_str[32];
-  snprintf(temp_str, sizeof(temp_str), "Object: %.0f%c", display_obj_temp, use_celsius ? 'C' : 'F');
-  lv_label_set_text(object_temp_label, temp_str);
+  temp_format(temp_str, sizeof(temp_str), NULL, display_obj_temp, fmt);
+  set_label_text_if_changed(object_temp_label, temp_str);
+
+  temp_format(temp_str, sizeof(temp_str), "Ambient: ", display_amb_temp, fmt);
+  set_label_text_if_changed(ambient_temp_label, temp_str);
 
-  snprintf(temp_str, sizeof(temp_str), "Ambient: %.0f%c", display_amb_temp, use_celsius ? 'C' : 'F');
-  lv_label_set_text(ambient_temp_label, temp_str);
+  update_temp_stats_labels();
+}
+
+// Stability indicator (fast window spread) and MIN/AVG/MAX hold since the last reset
+void update_temp_stats_labels() {
+  TempStatsSummary fast, hold;
+  temp_stats_window(&temp_stats, TEMP_STATS_FAST, &fast);
+  temp_stats_session(&temp_stats, &hold);
+  if (!hold.count) {
+    set_label_text_if_changed(temp_status_label, "Status: Waiting");
+    set_label_text_if_changed(temp_hold_label, "Min --  Avg --  Max --");
+    return;
+  }
+
+  // Spread is a difference, so Fahrenheit only scales it
+  const char *unit = use_celsius ? "C" : "F";
+  float spread = use_celsius ? fast.stddev : fast.stddev * 9.0f / 5.0f;
+  bool stable = fast.count == temp_stats.windows[TEMP_STATS_FAST].length && fast.stddev < TEMP_STABLE_STDDEV_C;
+  static int shown_stable = -1;
+  if (shown_stable != (int)stable) {
+    lv_obj_set_style_text_color(temp_status_label, lv_color_hex(stable ? 0x00FF00 : 0xFFCC00), 0);
+    shown_stable = stable;
+  }
 
-  lv_label_set_text(temp_status_label, "Status: Active");
+  const TempFormat spread_fmt = {1, false, unit};
+  char stats_str[40];
+  temp_format(stats_str, sizeof(stats_str), stable ? "Stable  sd " : "Settling  sd ", spread, spread_fmt);
+  set_label_text_if_changed(temp_status_label, stats_str);
+
+  // Whole-degree hold values: "Min 21  Avg 23  Max 25C"
+  const TempFormat whole = {0, false, NULL};
+  const TempFormat whole_unit = {0, false, unit};
+  float hold_min = use_celsius ? hold.min : celsius_to_fahrenheit(hold.min);
+  float hold_avg = use_celsius ? hold.mean : celsius_to_fahrenheit(hold.mean);
+  float hold_max = use_celsius ? hold.max : celsius_to_fahrenheit(hold.max);
+  size_t len = temp_format(stats_str, sizeof(stats_str), "Min ", hold_min, whole);
+  len += temp_format(stats_str + len, sizeof(stats_str) - len, "  Avg ", hold_avg, whole);
+  temp_format(stats_str + len, sizeof(stats_str) - len, "  Max ", hold_max, whole_unit);
+  set_label_text_if_changed(temp_hold_label, stats_str);
 }
 
 // Update temperature gauge screen
@@ -1021,82 +2976,360 @@ void update_temp_gauge_screen() {
   if (use_celsius) {
     display_temp = current_object_temp;    // Already in Celsius from sensor
   } else {
-    display_temp = mlx.readObjectTempF();   // Read Fahrenheit directly from sensor
+    display_temp = celsius_to_fahrenheit(current_object_temp);
   }
 
   // Update needle position for the gauge
   if (temp_gauge_needle) {
-    // Map temperature range (0 to 400°C) to angle range (135° to 405° for 270° arc)
-    float temp_range = 400.0 - 0.0; // 400 degree temperature range (0-400°C)
-    float normalized_temp = max(0.0f, min(display_temp, 400.0f)) / temp_range; // Clamp to 0.0 to 1.0
-    float angle_range = 270.0; // degrees of arc
-    float angle_offset = 135.0; // starting angle (bottom-left of circle)
-    float needle_angle = angle_offset + (normalized_temp * angle_range);
-
-    // Clamp to range
-    needle_angle = max(135.0f, min(405.0f, needle_angle));
-
-    // Calculate needle endpoint from center
     int center_x = 160; // Gauge center X (320/2)
     int center_y = 100; // Adjusted center Y for new gauge container
     int needle_length = 70; // Shorter needle for new container
 
+    int32_t tip_x, tip_y;
+    gauge_needle_tip(gauge_needle_angle(display_temp), center_x, center_y, needle_length, &tip_x, &tip_y);
+
     lv_point_precise_t points[2];
     points[0].x = center_x;
     points[0].y = center_y;
-
-    float angle_rad = (needle_angle - 90.0) * PI / 180.0; // Convert to radians, adjust for 0°=up
-    points[1].x = center_x + (needle_length * cos(angle_rad));
-    points[1].y = center_y + (needle_length * sin(angle_rad));
+    points[1].x = tip_x;
+    points[1].y = tip_y;
 
     lv_line_set_points(temp_gauge_needle, points, 2);
   }
 
   // Update temperature value label with whole number
+  const TempFormat fmt = {0, false, use_celsius ? "C" : "F"};
   char temp_str[32];
-  snprintf(temp_str, sizeof(temp_str), "%.0f%c", display_temp, use_celsius ? 'C' : 'F');
-  lv_label_set_text(temp_gauge_value_label, temp_str);
+  temp_format(temp_str, sizeof(temp_str), NULL, display_temp, fmt);
+  set_label_text_if_changed(temp_gauge_value_label, temp_str);
+}
+
+// Trend chart values are tenths of the display unit
+static int32_t trend_chart_value(int16_t tenths_c) {
+  if (tenths_c == TREND_NO_DATA) return LV_CHART_POINT_NONE;
+  return use_celsius ? tenths_c : (int32_t)tenths_c * 9 / 5 + 320;
 }
 
-// Play beep sound using built-in speaker
-void play_beep(int frequency, int duration) {
+// Round a chart Y range outwards to whole 5 degree steps with a one-step margin
+static void chart_round_range(int32_t *low, int32_t *high) {
+  *low = (*low / 50 - (*low < 0 ? 2 : 1)) * 50;
+  *high = (*high / 50 + (*high < 0 ? 0 : 1)) * 50;
+}
+
+// Widen the Y range (full chart redraw) only when a value falls outside it
+static void trend_fit_range(int32_t low, int32_t high) {
+  if (low == LV_CHART_POINT_NONE) return;
+  if (low >= trend_range_min && high <= trend_range_max) return;
+
+  // Round outwards to whole 5 degree steps with a one-step margin
+  if (low < trend_range_min) trend_range_min = (low / 50 - (low < 0 ? 2 : 1)) * 50;
+  if (high > trend_range_max) trend_range_max = (high / 50 + (high < 0 ? 0 : 1)) * 50;
+  lv_chart_set_axis_range(trend_chart, LV_CHART_AXIS_PRIMARY_Y, trend_range_min, trend_range_max);
+}
+
+// Append one closed column - O(1), only the new column's area is invalidated
+static void trend_chart_push(const TrendBucket *bucket) {
+  int32_t low = trend_chart_value(bucket->min);
+  int32_t high = trend_chart_value(bucket->max);
+  trend_fit_range(low, high);
+  lv_chart_set_next_value(trend_chart, trend_max_series, high);
+  lv_chart_set_next_value(trend_chart, trend_min_series, low);
+  lv_chart_set_next_value(trend_chart, trend_last_series, trend_chart_value(bucket->last));
+}
+
+// Rebuild the chart from the selected history level (screen entry / span change)
+void reload_trend_chart() {
+  if (!trend_chart) return;
+
+  const TrendLevel &level = trend_history.levels[trend_span];
+  trend_range_min = INT32_MAX;
+  trend_range_max = INT32_MIN;
+  for (int age = 0; age < level.count; age++) {
+    const TrendBucket *bucket = trend_history_column(&level, age);
+    if (bucket->min == TREND_NO_DATA) continue;
+    trend_range_min = min(trend_range_min, trend_chart_value(bucket->min));
+    trend_range_max = max(trend_range_max, trend_chart_value(bucket->max));
+  }
+  if (trend_range_min > trend_range_max) {
+    trend_range_min = 0;    // No history yet
+    trend_range_max = 500;
+  }
+  chart_round_range(&trend_range_min, &trend_range_max);
+  lv_chart_set_axis_range(trend_chart, LV_CHART_AXIS_PRIMARY_Y, trend_range_min, trend_range_max);
+
+  lv_chart_set_all_value(trend_chart, trend_max_series, LV_CHART_POINT_NONE);
+  lv_chart_set_all_value(trend_chart, trend_min_series, LV_CHART_POINT_NONE);
+  lv_chart_set_all_value(trend_chart, trend_last_series, LV_CHART_POINT_NONE);
+  for (int age = level.count - 1; age >= 0; age--) {
+    trend_chart_push(trend_history_column(&level, age));
+  }
+  trend_chart_closed = level.closed_total;
+
+  char span_str[24];
+  snprintf(span_str, sizeof(span_str), "Span: %s", trend_span_names[trend_span]);
+  set_label_text_if_changed(trend_span_label, span_str);
+}
+
+// Push columns closed since the last update to the chart
+void update_trend_screen() {
+  if (current_screen != SCREEN_TREND || !trend_chart) return;
+
+  const TrendLevel &level = trend_history.levels[trend_span];
+  uint32_t fresh = level.closed_total - trend_chart_closed;
+  if (fresh > level.count) {
+    reload_trend_chart();
+  } else {
+    for (int age = (int)fresh - 1; age >= 0; age--) {
+      trend_chart_push(trend_history_column(&level, age));
+    }
+    trend_chart_closed = level.closed_total;
+  }
+
+  const TempFormat fmt = {1, false, use_celsius ? "C" : "F"};
+  char value_str[24];
+  float display_temp = use_celsius ? current_object_temp : celsius_to_fahrenheit(current_object_temp);
+  temp_format(value_str, sizeof(value_str), "Now: ", display_temp, fmt);
+  set_label_text_if_changed(trend_value_label, value_str);
+}
+
+// Select the next trend span (1 min -> 10 min -> 1 h)
+void cycle_trend_span() {
+  trend_span = (trend_span + 1) % TREND_LEVELS;
+  reload_trend_chart();
+  update_trend_screen();
+}
+
+// Merge the raw records of blocks first..last that fall into [start_s, end_s) into the
+// columns. Returns false if none of them could be read.
+static bool history_read_raw(uint32_t start_s, uint32_t end_s, uint32_t first, uint32_t last, LogColumn *columns) {
+  static uint8_t block[SAMPLE_LOG_BLOCK_SIZE];
+  static SampleLogRecord records[SAMPLE_LOG_PAYLOAD_SIZE / 3 + 1];  // Smallest record is 3 bytes
+
+  uint64_t window_ms = (uint64_t)(end_s - start_s) * 1000;
+  bool any = false;
+  for (uint32_t seq = first; seq <= last; seq++) {
+    if (!sample_log_read_block(seq, block)) continue;
+    const SampleLogBlockHeader *header = (const SampleLogBlockHeader *)block;
+    int n = sample_log_decode(block, records, sizeof(records) / sizeof(records[0]));
+    for (int i = 0; i < n; i++) {
+      int64_t t_ms = ((int64_t)header->log_s - start_s) * 1000 + records[i].offset_ms;
+      if (t_ms < 0 || (uint64_t)t_ms >= window_ms) continue;
+      log_column_add(&columns[(uint64_t)t_ms * HISTORY_COLUMNS / window_ms], records[i].object);
+      any = true;
+    }
+  }
+  log_columns_finish(columns, HISTORY_COLUMNS);
+  return any;
+}
+
+// Redraw the history chart for the current zoom and pan. Reads at most
+// HISTORY_COLUMNS * LOG_INDEX_OVERSAMPLE index entries or HISTORY_RAW_BLOCKS blocks.
+void reload_history_chart() {
+  if (!history_chart) return;
+
+  static LogColumn columns[HISTORY_COLUMNS];
+  history_generation = history_index->generation;
+  uint32_t first_s, last_s;
+  int level = -1;
+  int32_t low = INT32_MAX, high = INT32_MIN;
+  if (log_index_range(history_index, &first_s, &last_s)) {
+    uint32_t span = history_spans_s[history_zoom];
+    if (history_offset_s > last_s - first_s) history_offset_s = last_s - first_s;
+    uint32_t end_s = last_s + 1 - history_offset_s;
+    uint32_t start_s = end_s > span ? end_s - span : 0;
+
+    uint32_t first, last;
+    bool raw = log_index_find_blocks(history_index, start_s, end_s, &first, &last) &&
+               last - first < HISTORY_RAW_BLOCKS;
+    if (raw) {
+      log_columns_clear(columns, HISTORY_COLUMNS);
+      raw = history_read_raw(start_s, end_s, first, last, columns);
+    }
+    level = raw ? LOG_INDEX_MAX_LEVELS : log_index_query(history_index, start_s, end_s, columns, HISTORY_COLUMNS);
+  }
+
+  // Series arrays are written in place, one chart refresh for all three
+  int32_t *max_y = lv_chart_get_y_array(history_chart, history_max_series);
+  int32_t *min_y = lv_chart_get_y_array(history_chart, history_min_series);
+  int32_t *mean_y = lv_chart_get_y_array(history_chart, history_mean_series);
+  for (int c = 0; c < HISTORY_COLUMNS; c++) {
+    bool valid = level >= 0 && columns[c].samples;
+    max_y[c] = valid ? trend_chart_value(columns[c].max) : LV_CHART_POINT_NONE;
+    min_y[c] = valid ? trend_chart_value(columns[c].min) : LV_CHART_POINT_NONE;
+    mean_y[c] = valid ? trend_chart_value(columns[c].mean) : LV_CHART_POINT_NONE;
+    if (!valid) continue;
+    low = min(low, min_y[c]);
+    high = max(high, max_y[c]);
+  }
+  if (low > high) {
+    low = 0;    // Nothing logged in the window
+    high = 500;
+  }
+  int32_t range_low = low, range_high = high;
+  chart_round_range(&range_low, &range_high);
+  lv_chart_set_axis_range(history_chart, LV_CHART_AXIS_PRIMARY_Y, range_low, range_high);
+  lv_chart_refresh(history_chart);
+
+  // "24 h  -3 h" plus where the data came from (index level or raw blocks)
+  char text[32];
+  uint32_t back_min = history_offset_s / 60;
+  if (back_min >= 120) {
+    snprintf(text, sizeof(text), "%s  -%lu h", history_span_names[history_zoom], (unsigned long)(back_min / 60));
+  } else if (back_min) {
+    snprintf(text, sizeof(text), "%s  -%lu min", history_span_names[history_zoom], (unsigned long)back_min);
+  } else {
+    snprintf(text, sizeof(text), "%s  now", history_span_names[history_zoom]);
+  }
+  set_label_text_if_changed(history_span_label, text);
+
+  if (level < 0) {
+    set_label_text_if_changed(history_range_label, "No data");
+    return;
+  }
+  const TempFormat whole = {0, false, NULL};
+  const TempFormat whole_unit = {0, false, use_celsius ? "C" : "F"};
+  size_t len = temp_format(text, sizeof(text), level == LOG_INDEX_MAX_LEVELS ? "Raw " : "", low / 10.0f, whole);
+  len += temp_format(text + len, sizeof(text) - len, "..", high / 10.0f, whole_unit);
+  if (level != LOG_INDEX_MAX_LEVELS) snprintf(text + len, sizeof(text) - len, " L%d", level);
+  set_label_text_if_changed(history_range_label, text);
+}
+
+// Follow new blocks while the window ends at the newest data
+void update_history_screen() {
+  if (current_screen != SCREEN_HISTORY || !history_chart) return;
+  if (history_offset_s == 0 && history_index->generation != history_generation) {
+    reload_history_chart();
+  }
+}
+
+// Step through history_spans_s (positive zooms in), keeping the window end
+void zoom_history(int step) {
+  int zoom = history_zoom + step;
+  if (zoom < 0 || zoom >= HISTORY_ZOOMS) return;
+  history_zoom = zoom;
+
+  uint32_t start = hal_micros();
+  reload_history_chart();
+  DLOG_I("History zoom %s: %lu us", history_span_names[history_zoom], hal_micros() - start);
+}
+
+// Move the window by half its span (positive goes back in time)
+void pan_history(int step) {
+  uint32_t half = history_spans_s[history_zoom] / 2;
+  if (step > 0) {
+    history_offset_s += half;
+  } else {
+    history_offset_s = history_offset_s > half ? history_offset_s - half : 0;
+  }
+  reload_history_chart();
+}
+
+// Skip lv_label_set_text() when the text is unchanged - it would otherwise
+// reallocate the string and invalidate the label even for identical readings
+void set_label_text_if_changed(lv_obj_t *label, const char *text) {
+  if (!label) return;
+  const char *current = lv_label_get_text(label);
+  if (current && strcmp(current, text) == 0) return;
+  lv_label_set_text(label, text);
+}
+
+// Temperature readout as pip counts: one pip per unit of each digit, a long low tone
+// for 0 and a lower tone for a minus sign, digits separated by a pause
+void append_readout(SoundCue *cue, float temperature) {
+  int value = (int)(temperature < 0 ? temperature - 0.5f : temperature + 0.5f);
+  if (value < 0) {
+    sound_cue_add(cue, ALERT_CLIP_MINUS);
+    value = -value;
+  }
+
+  char digits[8];
+  snprintf(digits, sizeof(digits), "%d", value);
+  for (const char *digit = digits; *digit; digit++) {
+    sound_cue_add(cue, SOUND_CUE_GAP);
+    int pips = *digit - '0';
+    if (pips == 0) sound_cue_add(cue, ALERT_CLIP_ZERO);
+    for (int i = 0; i < pips; i++) sound_cue_add(cue, ALERT_CLIP_PIP);
+  }
+}
+
+// Queue the sound of a fired rule (never blocks, the sound task plays it)
+void play_alert_sound(const AlertRule &rule) {
   if (!sound_enabled) return;
 
-  // Use M5 Speaker instead of raw PWM
-  M5.Speaker.tone(frequency, duration, 0, true);
+  SoundCue cue;
+  cue.count = 0;
+  switch (rule.sound) {
+    case ALERT_CUE_LOW:
+      sound_cue_add(&cue, ALERT_CLIP_LOW);
+      sound_cue_add(&cue, ALERT_CLIP_LOW);
+      break;
+    case ALERT_CUE_HIGH:
+      sound_cue_add(&cue, ALERT_CLIP_HIGH);
+      sound_cue_add(&cue, ALERT_CLIP_HIGH);
+      break;
+    case ALERT_CUE_RISE:
+      sound_cue_add(&cue, ALERT_CLIP_CHIRP_UP);
+      sound_cue_add(&cue, ALERT_CLIP_CHIRP_UP);
+      break;
+    case ALERT_CUE_FALL:
+      sound_cue_add(&cue, ALERT_CLIP_CHIRP_DOWN);
+      sound_cue_add(&cue, ALERT_CLIP_CHIRP_DOWN);
+      break;
+  }
+  if (rule.actions & ALERT_ACTION_READOUT) {
+    append_readout(&cue, use_celsius ? current_object_temp : celsius_to_fahrenheit(current_object_temp));
+  }
+  sound_player_play(cue);
 }
 
-// Check for temperature alerts
+// Carry out the actions of alert rules fired since the last call
 void check_temp_alerts() {
-  if (!alerts_enabled) return;
-
-  static bool low_alert_triggered = false;
-  static bool high_alert_triggered = false;
-
-  // Check low temperature alert
-  if (current_object_temp <= low_temp_threshold && !low_alert_triggered) {
-    play_beep(800, 300); // Low frequency beep
-    delay(100);
-    play_beep(800, 300); // Repeat beep
-    low_alert_triggered = true;
-    digitalWrite(LED_PIN, HIGH); // Turn on LED
-    Serial.printf("Low temperature alert: %.1f°C <= %.1f°C\n", current_object_temp, low_temp_threshold);
-  } else if (current_object_temp > low_temp_threshold + 2.0) { // Hysteresis
-    low_alert_triggered = false;
-    digitalWrite(LED_PIN, LOW);
-  }
-
-  // Check high temperature alert
-  if (current_object_temp >= high_temp_threshold && !high_alert_triggered) {
-    play_beep(1200, 500); // High frequency beep
-    delay(100);
-    play_beep(1200, 500); // Repeat beep
-    high_alert_triggered = true;
-    digitalWrite(LED_PIN, HIGH); // Turn on LED
-    Serial.printf("High temperature alert: %.1f°C >= %.1f°C\n", current_object_temp, high_temp_threshold);
-  } else if (current_object_temp < high_temp_threshold - 2.0) { // Hysteresis
-    high_alert_triggered = false;
-    digitalWrite(LED_PIN, LOW);
+  uint32_t fired = alert_fired_mask;
+  alert_fired_mask = 0;
+
+  // Stream every rule transition, whether or not alerts are enabled
+  static uint32_t last_active = 0;
+  uint32_t cleared = last_active & ~alert_engine.active_mask;
+  last_active = alert_engine.active_mask;
+  for (int i = 0; i < alert_engine.table.count; i++) {
+    uint32_t bit = 1UL << i;
+    if (!((fired | cleared) & bit)) continue;
+    const AlertRule &rule = alert_engine.table.rules[i];
+    telemetry_alert(i, rule.kind, (fired & bit) != 0, current_object_temp, alert_engine.rate_c_per_s,
+                    rule.threshold / 10.0f);
+  }
+
+  if (!alerts_enabled) {
+    for (int i = 0; i < ALERT_MAX_RULES; i++) led_pattern_release(i);
+    return;
+  }
+
+  // A firing alert is shown whatever its actions
+  if (fired) display_wake();
+
+  for (int i = 0; i < alert_engine.table.count; i++) {
+    if (!(fired & (1UL << i))) continue;
+    const AlertRule &rule = alert_engine.table.rules[i];
+
+    if (rule.actions & ALERT_ACTION_LOG) {
+      DLOG_W("%s alert (rule %d): %.1f°C, %.2f°C/s, threshold %.1f", alert_rule_kind_name(rule.kind), i,
+                    current_object_temp, alert_engine.rate_c_per_s, rule.threshold / 10.0f);
+    }
+    if (rule.actions & ALERT_ACTION_SOUND) {
+      play_alert_sound(rule);
+    }
+  }
+
+  // Every active LED rule requests its pattern; the driver shows the highest priority
+  for (int i = 0; i < alert_engine.table.count; i++) {
+    const AlertRule &rule = alert_engine.table.rules[i];
+    bool wants_led = (alert_engine.active_mask & (1UL << i)) && (rule.actions & ALERT_ACTION_LED) &&
+                     rule.led_pattern < sizeof(alert_led_patterns) / sizeof(alert_led_patterns[0]);
+    if (wants_led) {
+      led_pattern_request(i, alert_led_patterns[rule.led_pattern], rule.led_priority);
+    } else {
+      led_pattern_release(i);
+    }
   }
 }
 
@@ -1104,7 +3337,7 @@ void check_temp_alerts() {
 void main_menu_event_cb(lv_event_t *e) {
   lv_event_code_t code = lv_event_get_code(e);
   if (code == LV_EVENT_CLICKED) {
-    int screen_int = (int)lv_event_get_user_data(e);
+    int screen_int = (int)(intptr_t)lv_event_get_user_data(e);
     ScreenState screen = (ScreenState)screen_int;
     switch_to_screen(screen);
   }
@@ -1124,6 +3357,41 @@ void temp_gauge_back_event_cb(lv_event_t *e) {
   }
 }
 
+void trend_back_event_cb(lv_event_t *e) {
+  lv_event_code_t code = lv_event_get_code(e);
+  if (code == LV_EVENT_CLICKED) {
+    switch_to_screen(SCREEN_MAIN_MENU);
+  }
+}
+
+void trend_span_event_cb(lv_event_t *e) {
+  lv_event_code_t code = lv_event_get_code(e);
+  if (code == LV_EVENT_CLICKED) {
+    cycle_trend_span();
+  }
+}
+
+void history_back_event_cb(lv_event_t *e) {
+  lv_event_code_t code = lv_event_get_code(e);
+  if (code == LV_EVENT_CLICKED) {
+    switch_to_screen(SCREEN_TREND);
+  }
+}
+
+void diagnostics_back_event_cb(lv_event_t *e) {
+  lv_event_code_t code = lv_event_get_code(e);
+  if (code == LV_EVENT_CLICKED) {
+    switch_to_screen(SCREEN_MAIN_MENU);
+  }
+}
+
+void history_pan_event_cb(lv_event_t *e) {
+  lv_event_code_t code = lv_event_get_code(e);
+  if (code == LV_EVENT_CLICKED) {
+    pan_history((int)(intptr_t)lv_event_get_user_data(e));
+  }
+}
+
 void settings_back_event_cb(lv_event_t *e) {
   lv_event_code_t code = lv_event_get_code(e);
   if (code == LV_EVENT_CLICKED) {
@@ -1132,6 +3400,54 @@ void settings_back_event_cb(lv_event_t *e) {
   }
 }
 
+// Settings menu item: focus selects it, a click (Key or touch) opens its page
+void settings_menu_item_event_cb(lv_event_t *e) {
+  lv_event_code_t code = lv_event_get_code(e);
+  int item = (int)(intptr_t)lv_event_get_user_data(e);
+  if (code == LV_EVENT_FOCUSED && !settings_group_filling) {
+    current_settings_selection = item;
+  } else if (code == LV_EVENT_CLICKED) {
+    current_settings_selection = item;
+    current_settings_screen = (SettingsScreen)(SETTINGS_MENU + 1 + item);
+    switch_to_settings_screen();
+  }
+}
+
+// Units page: focus applies the unit, a click confirms it and returns to the main menu
+void settings_units_event_cb(lv_event_t *e) {
+  lv_event_code_t code = lv_event_get_code(e);
+  bool celsius = (intptr_t)lv_event_get_user_data(e) != 0;
+  if (code == LV_EVENT_FOCUSED && !settings_group_filling && use_celsius != celsius) {
+    use_celsius = celsius;
+    DLOG_I("Temperature units set to: %s", use_celsius ? "Celsius" : "Fahrenheit");
+    save_preferences();
+    set_label_text_if_changed(units_current_label, use_celsius ? "< Current: Celsius (C)" : "Current: Fahrenheit (F) >");
+  } else if (code == LV_EVENT_CLICKED) {
+    use_celsius = celsius;
+    DLOG_I("Temperature units confirmed: %s - returning to main menu", use_celsius ? "Celsius" : "Fahrenheit");
+    save_preferences();
+    switch_to_screen(SCREEN_MAIN_MENU);
+  }
+}
+
+// Exit page: focus picks Cancel or Save, a click carries it out
+void settings_exit_event_cb(lv_event_t *e) {
+  lv_event_code_t code = lv_event_get_code(e);
+  bool cancel = (intptr_t)lv_event_get_user_data(e) != 0;
+  if (code == LV_EVENT_FOCUSED && !settings_group_filling) {
+    exit_selection_cancel = cancel;
+  } else if (code == LV_EVENT_CLICKED) {
+    exit_selection_cancel = cancel;
+    if (exit_selection_cancel) {
+      DLOG_I("Exit cancelled - returning to main menu without saving");
+    } else {
+      DLOG_I("Exit with save - saving preferences and returning to main menu");
+      save_preferences();
+    }
+    switch_to_screen(SCREEN_MAIN_MENU);
+  }
+}
+
 void temp_unit_switch_event_cb(lv_event_t *e) {
   // Simple unit toggle (since we now use separate buttons)
   use_celsius = !use_celsius;
@@ -1141,27 +3457,27 @@ void temp_unit_switch_event_cb(lv_event_t *e) {
 }
 
 void brightness_slider_event_cb(lv_event_t *e) {
+  if (lv_event_get_code(e) == LV_EVENT_RELEASED) {
+    save_preferences();
+    return;
+  }
   lv_obj_t *slider = (lv_obj_t*)lv_event_get_target(e);
-  brightness_level = lv_slider_get_value(slider);
-
-  // Update brightness value label
-  lv_obj_t *brightness_value_label = lv_obj_get_child(slider, 0); // Assuming it's the next sibling
-  char brightness_str[10];
-  snprintf(brightness_str, sizeof(brightness_str), "%d", brightness_level);
-  lv_label_set_text(brightness_value_label, brightness_str);
-
-  // TODO: Apply brightness to display if supported
-  save_preferences();
+  set_brightness(lv_slider_get_value(slider));
 }
 
 void sound_enable_switch_event_cb(lv_event_t *e) {
   // Check which button was pressed by the user data
-  int enable_sound = (int)lv_event_get_user_data(e);
+  int enable_sound = (int)(intptr_t)lv_event_get_user_data(e);
   sound_enabled = (enable_sound == 1);
   save_preferences();
 }
 
+// Sliders apply every step and save once the slider is let go (one journal record per drag)
 void volume_slider_event_cb(lv_event_t *e) {
+  if (lv_event_get_code(e) == LV_EVENT_RELEASED) {
+    save_preferences();
+    return;
+  }
   lv_obj_t *slider = (lv_obj_t*)lv_event_get_target(e);
   sound_volume = lv_slider_get_value(slider);
 
@@ -1170,31 +3486,33 @@ void volume_slider_event_cb(lv_event_t *e) {
   char volume_str[10];
   snprintf(volume_str, sizeof(volume_str), "%d", sound_volume);
   lv_label_set_text(volume_value_label, volume_str);
-
-  save_preferences();
+  sound_player_set_volume(sound_volume);
 }
 
 void alerts_enable_switch_event_cb(lv_event_t *e) {
   // Check which button was pressed by the user data
-  int enable_alerts = (int)lv_event_get_user_data(e);
+  int enable_alerts = (int)(intptr_t)lv_event_get_user_data(e);
   alerts_enabled = (enable_alerts == 1);
   save_preferences();
 }
 
 void temp_alert_slider_event_cb(lv_event_t *e) {
+  if (lv_event_get_code(e) == LV_EVENT_RELEASED) {
+    save_preferences();
+    return;
+  }
   lv_obj_t *slider = (lv_obj_t*)lv_event_get_target(e);
+  const TempFormat threshold_fmt = {0, false, " C"};
 
   if (slider == low_temp_slider) {
     low_temp_threshold = (float)lv_slider_get_value(slider);
     char low_temp_str[10];
-    snprintf(low_temp_str, sizeof(low_temp_str), "%.0f C", low_temp_threshold);
-    lv_label_set_text(low_temp_label, low_temp_str);
+    temp_format(low_temp_str, sizeof(low_temp_str), NULL, low_temp_threshold, threshold_fmt);
+    set_label_text_if_changed(low_temp_label, low_temp_str);
   } else if (slider == high_temp_slider) {
     high_temp_threshold = (float)lv_slider_get_value(slider);
     char high_temp_str[10];
-    snprintf(high_temp_str, sizeof(high_temp_str), "%.0f C", high_temp_threshold);
-    lv_label_set_text(high_temp_label, high_temp_str);
+    temp_format(high_temp_str, sizeof(high_temp_str), NULL, high_temp_threshold, threshold_fmt);
+    set_label_text_if_changed(high_temp_label, high_temp_str);
   }
-
-  save_preferences();
 }
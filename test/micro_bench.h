@@ -0,0 +1,47 @@
+#ifndef __MICRO_BENCH_H__
+#define __MICRO_BENCH_H__
+
+#include <unity.h>
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include "micro_bench_baselines.h"
+
+// Micro-benchmark helper shared by the native kernel tests. A kernel runs in rounds of
+// `calls` calls; the fastest round gives the ns per call, so a busy machine inflates
+// the number far less than an average would. Each result is printed as
+//
+//   bench,<name>,<ns_per_call>,<baseline_ns>
+//
+// next to its stored baseline (micro_bench_baselines.h). The check is report-only
+// unless MICRO_BENCH_TOLERANCE is set, then a result more than that many times its
+// baseline fails the test. Cycle counts on the device come from the NCIR_*_BENCHMARK
+// builds; these host numbers show algorithmic regressions.
+
+#define MICRO_BENCH_ROUNDS 15
+
+// Results are folded into this so the compiler cannot drop the benchmarked calls
+static volatile uint32_t micro_bench_sink;
+
+template <typename Kernel>
+double micro_bench_ns(uint32_t calls, Kernel kernel) {
+  double best = 0;
+  for (int round = 0; round < MICRO_BENCH_ROUNDS; round++) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < calls; i++) kernel(i);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls;
+    if (round == 0 || ns < best) best = ns;
+  }
+  return best;
+}
+
+static void micro_bench_check(const char *name, double ns, double baseline_ns) {
+  char message[96];
+  snprintf(message, sizeof(message), "bench,%s,%.2f,%.2f", name, ns, baseline_ns);
+  TEST_MESSAGE(message);
+  if (MICRO_BENCH_TOLERANCE > 0 && ns > baseline_ns * MICRO_BENCH_TOLERANCE) {
+    TEST_FAIL_MESSAGE("slower than the stored baseline allows");
+  }
+}
+
+#endif  // __MICRO_BENCH_H__
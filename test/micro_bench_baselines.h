@@ -0,0 +1,27 @@
+#ifndef __MICRO_BENCH_BASELINES_H__
+#define __MICRO_BENCH_BASELINES_H__
+
+// Stored ns-per-call baselines for the native kernel micro-benchmarks (micro_bench.h).
+// Measured on an x86-64 development host with the unoptimised test build and rounded
+// up; refresh them from the `bench,` lines of `pio test -e native -v` when a kernel
+// changes on purpose.
+
+// Wall-clock timings vary too much on shared CI machines to gate on, so by default the
+// results are only reported. To fail on regressions on a quiet machine, build with
+// -DMICRO_BENCH_TOLERANCE=5: a result then fails when it is more than that many times
+// its baseline.
+#ifndef MICRO_BENCH_TOLERANCE
+#define MICRO_BENCH_TOLERANCE 0
+#endif
+
+#define BASELINE_CELSIUS_TO_FAHRENHEIT_NS 12.0
+#define BASELINE_GAUGE_NEEDLE_ANGLE_NS 14.0
+#define BASELINE_GAUGE_NEEDLE_TIP_NS 45.0
+#define BASELINE_TEMP_FORMAT_WHOLE_NS 65.0
+#define BASELINE_TEMP_FORMAT_TENTHS_NS 120.0
+#define BASELINE_SNPRINTF_WHOLE_NS 420.0
+#define BASELINE_ALERT_ENGINE_UPDATE_NS 100.0
+#define BASELINE_TEMP_STATS_ADD_NS 240.0
+#define BASELINE_TEMP_STATS_WINDOW_NS 30.0
+
+#endif  // __MICRO_BENCH_BASELINES_H__
@@ -0,0 +1,180 @@
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include "alert_rules.hpp"
+#include "../micro_bench.h"
+
+// Host tests and micro-benchmarks for the threshold, hysteresis, sustain and cooldown
+// logic that check_temp_alerts() acts on, and for the rate-of-change filter.
+
+#define BENCH_CALLS 100000
+#define SAMPLE_MS 500
+
+static AlertRule make_rule(uint8_t kind, int16_t threshold, uint16_t hysteresis, uint16_t sustain_ds,
+                           uint16_t cooldown_s) {
+  AlertRule rule;
+  memset(&rule, 0, sizeof(rule));
+  rule.kind = kind;
+  rule.actions = ALERT_ACTION_LOG;
+  rule.threshold = threshold;
+  rule.hysteresis = hysteresis;
+  rule.sustain_ds = sustain_ds;
+  rule.cooldown_s = cooldown_s;
+  return rule;
+}
+
+static void install(AlertEngine *engine, const AlertRule *rules, uint8_t count) {
+  AlertRuleTable table;
+  memset(&table, 0, sizeof(table));
+  table.version = ALERT_TABLE_VERSION;
+  table.count = count;
+  memcpy(table.rules, rules, count * sizeof(AlertRule));
+  TEST_ASSERT_TRUE(alert_engine_set_table(engine, &table));
+}
+
+// Same value for the rate filter and the threshold level
+static uint32_t feed(AlertEngine *engine, uint32_t timestamp_ms, float value_c) {
+  return alert_engine_update(engine, timestamp_ms, value_c, value_c);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_rejects_bad_tables(void) {
+  AlertEngine engine;
+  AlertRuleTable table;
+  memset(&table, 0, sizeof(table));
+  table.version = ALERT_TABLE_VERSION + 1;
+  TEST_ASSERT_FALSE(alert_engine_set_table(&engine, &table));
+  table.version = ALERT_TABLE_VERSION;
+  table.count = ALERT_MAX_RULES + 1;
+  TEST_ASSERT_FALSE(alert_engine_set_table(&engine, &table));
+}
+
+// 50.0 C high alert, 2 C hysteresis, 1 s sustain, 10 s cooldown
+void test_high_threshold_hysteresis(void) {
+  AlertEngine engine;
+  AlertRule rule = make_rule(ALERT_RULE_ABOVE, 500, 20, 10, 10);
+  install(&engine, &rule, 1);
+
+  uint32_t t = 0;
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t, 49.9f));
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t += SAMPLE_MS, 50.0f));  // Pending
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t += SAMPLE_MS, 50.5f));  // 0.5 s held
+  TEST_ASSERT_EQUAL_UINT32(1, feed(&engine, t += SAMPLE_MS, 50.2f));  // 1 s held: fires
+  TEST_ASSERT_EQUAL_UINT32(1, engine.active_mask);
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t += SAMPLE_MS, 52.0f));  // Fires once
+
+  // Stays active inside the hysteresis band, clears below it
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t += SAMPLE_MS, 48.1f));
+  TEST_ASSERT_EQUAL_UINT32(1, engine.active_mask);
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t += SAMPLE_MS, 47.9f));
+  TEST_ASSERT_EQUAL_UINT32(0, engine.active_mask);
+
+  // Back above: the sustain passes but the cooldown (10 s since firing) holds it off
+  uint32_t fired_at = 3 * SAMPLE_MS;
+  uint32_t fired = 0;
+  while (!fired) {
+    fired = feed(&engine, t += SAMPLE_MS, 55.0f);
+    if (!fired) TEST_ASSERT_TRUE(t - fired_at < 10000);
+  }
+  TEST_ASSERT_EQUAL_UINT32(10000, t - fired_at);
+}
+
+// A dip during the sustain time restarts it
+void test_sustain_restarts(void) {
+  AlertEngine engine;
+  AlertRule rule = make_rule(ALERT_RULE_BELOW, 0, 10, 20, 0);
+  install(&engine, &rule, 1);
+
+  uint32_t t = 0;
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t, -0.5f));
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t += SAMPLE_MS, -0.5f));
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t += SAMPLE_MS, 0.1f));   // Above: restart
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t += SAMPLE_MS, -0.5f));  // Pending again
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t += SAMPLE_MS, -0.5f));
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t += SAMPLE_MS, -0.5f));
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t += SAMPLE_MS, -0.5f));
+  TEST_ASSERT_EQUAL_UINT32(1, feed(&engine, t += SAMPLE_MS, -0.5f));  // 2 s after the restart
+  TEST_ASSERT_EQUAL_UINT32(0, feed(&engine, t += SAMPLE_MS, 0.9f));   // Inside 1 C band
+  TEST_ASSERT_EQUAL_UINT32(1, engine.active_mask);
+  feed(&engine, t += SAMPLE_MS, 1.1f);
+  TEST_ASSERT_EQUAL_UINT32(0, engine.active_mask);
+}
+
+// The level input, not the raw one, drives the threshold rules
+void test_level_input(void) {
+  AlertEngine engine;
+  AlertRule rule = make_rule(ALERT_RULE_ABOVE, 300, 0, 0, 0);
+  install(&engine, &rule, 1);
+  TEST_ASSERT_EQUAL_UINT32(0, alert_engine_update(&engine, 0, 90.0f, 25.0f));
+  TEST_ASSERT_EQUAL_UINT32(1, alert_engine_update(&engine, SAMPLE_MS, 20.0f, 30.0f));
+  // A failed read changes nothing
+  TEST_ASSERT_EQUAL_UINT32(0, alert_engine_update(&engine, 2 * SAMPLE_MS, NAN, NAN));
+  TEST_ASSERT_EQUAL_UINT32(1, engine.active_mask);
+}
+
+// First-order rate filter: a steady 1 C/s ramp converges to 1 C/s with the
+// ALERT_RATE_TAU_MS time constant; one noisy sample barely moves it
+void test_rate_filter(void) {
+  AlertEngine engine;
+  AlertRule rules[2] = {make_rule(ALERT_RULE_RISE_RATE, 5, 2, 0, 0), make_rule(ALERT_RULE_FALL_RATE, 5, 2, 0, 0)};
+  install(&engine, rules, 2);
+
+  uint32_t t = 0;
+  float value = 20.0f;
+  feed(&engine, t, value);
+  uint32_t rise_fired_ms = 0;
+  for (int i = 1; i <= 40; i++) {
+    value += 0.5f;  // 1 C/s at 2 Hz
+    if (feed(&engine, t += SAMPLE_MS, value) & 1) rise_fired_ms = t;
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, engine.rate_c_per_s);
+  // With alpha = dt / (tau + dt) = 0.2 the rate after n samples is 1 - 0.8^n C/s, so
+  // 0.5 C/s is crossed on the 4th sample
+  TEST_ASSERT_EQUAL_UINT32(4 * SAMPLE_MS, rise_fired_ms);
+  TEST_ASSERT_EQUAL_UINT32(1, engine.active_mask);
+
+  // Flat again: the rise rule clears once the rate drops below 0.3 C/s
+  while (engine.active_mask & 1) feed(&engine, t += SAMPLE_MS, value);
+  TEST_ASSERT_TRUE(engine.rate_c_per_s < 0.3f);
+
+  float before = engine.rate_c_per_s;
+  feed(&engine, t += SAMPLE_MS, value - 0.4f);  // One noisy low sample
+  TEST_ASSERT_TRUE(fabsf(engine.rate_c_per_s - before) < 0.25f);  // alpha * (0.8 + rate)
+  TEST_ASSERT_EQUAL_UINT32(0, engine.active_mask & 2);
+
+  // Samples with the same timestamp leave the rate alone
+  before = engine.rate_c_per_s;
+  feed(&engine, t, value + 10.0f);
+  TEST_ASSERT_EQUAL_FLOAT(before, engine.rate_c_per_s);
+}
+
+void test_bench_alert_engine(void) {
+  static AlertEngine engine;
+  AlertRule rules[4] = {
+    make_rule(ALERT_RULE_ABOVE, 500, 20, 10, 10), make_rule(ALERT_RULE_BELOW, 0, 10, 10, 10),
+    make_rule(ALERT_RULE_RISE_RATE, 5, 2, 0, 5), make_rule(ALERT_RULE_FALL_RATE, 5, 2, 0, 5),
+  };
+  install(&engine, rules, 4);
+
+  // Sweeps through every rule's firing and clearing band
+  micro_bench_check("alert_engine_update_4_rules", micro_bench_ns(BENCH_CALLS, [](uint32_t i) {
+    float value = 25.0f + 40.0f * sinf(i * 0.01f);
+    micro_bench_sink += alert_engine_update(&engine, i * SAMPLE_MS, value, value);
+  }), BASELINE_ALERT_ENGINE_UPDATE_NS);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_rejects_bad_tables);
+  RUN_TEST(test_high_threshold_hysteresis);
+  RUN_TEST(test_sustain_restarts);
+  RUN_TEST(test_level_input);
+  RUN_TEST(test_rate_filter);
+  RUN_TEST(test_bench_alert_engine);
+  return UNITY_END();
+}
@@ -0,0 +1,125 @@
+
+#include <unity.h>
+#include <string.h>
+#include "button_input.hpp"
+
+// Host tests for the press classification: debounce, long press and auto-repeat
+
+static ButtonInput input;
+static bool levels[BUTTON_INPUT_MAX];
+static ButtonEvent events[BUTTON_INPUT_MAX];
+
+static int poll(uint32_t now_ms) {
+  return button_input_update(&input, now_ms, levels, events, BUTTON_INPUT_MAX);
+}
+
+void setUp(void) {
+  button_input_init(&input, 3);
+  memset(levels, 0, sizeof(levels));
+  memset(events, 0, sizeof(events));
+}
+
+void tearDown(void) {}
+
+void test_press_and_release(void) {
+  TEST_ASSERT_EQUAL_INT(0, poll(1000));
+
+  levels[1] = true;
+  TEST_ASSERT_EQUAL_INT(1, poll(1010));
+  TEST_ASSERT_EQUAL_UINT8(1, events[0].button);
+  TEST_ASSERT_EQUAL_UINT8(BUTTON_EVENT_DOWN, events[0].type);
+  TEST_ASSERT_TRUE(button_input_any_pressed(&input));
+  TEST_ASSERT_EQUAL_INT(0, poll(1020));
+
+  levels[1] = false;
+  TEST_ASSERT_EQUAL_INT(1, poll(1100));
+  TEST_ASSERT_EQUAL_UINT8(BUTTON_EVENT_UP, events[0].type);
+  TEST_ASSERT_FALSE(events[0].long_press);
+  TEST_ASSERT_FALSE(button_input_any_pressed(&input));
+}
+
+// Bounces within BUTTON_DEBOUNCE_MS of a change are ignored
+void test_debounce_lockout(void) {
+  levels[0] = true;
+  TEST_ASSERT_EQUAL_INT(1, poll(1000));
+
+  levels[0] = false;
+  TEST_ASSERT_EQUAL_INT(0, poll(1005));
+  levels[0] = true;
+  TEST_ASSERT_EQUAL_INT(0, poll(1010));
+  levels[0] = false;
+  TEST_ASSERT_EQUAL_INT(0, poll(1000 + BUTTON_DEBOUNCE_MS - 1));
+  TEST_ASSERT_TRUE(button_input_any_pressed(&input));
+
+  TEST_ASSERT_EQUAL_INT(1, poll(1000 + BUTTON_DEBOUNCE_MS));
+  TEST_ASSERT_EQUAL_UINT8(BUTTON_EVENT_UP, events[0].type);
+}
+
+void test_long_press_and_repeat(void) {
+  const uint32_t down = 1000;
+  levels[2] = true;
+  poll(down);
+  TEST_ASSERT_EQUAL_INT(0, poll(down + BUTTON_LONG_MS - 1));
+
+  TEST_ASSERT_EQUAL_INT(1, poll(down + BUTTON_LONG_MS));
+  TEST_ASSERT_EQUAL_UINT8(BUTTON_EVENT_LONG, events[0].type);
+  TEST_ASSERT_EQUAL_INT(0, poll(down + BUTTON_LONG_MS + BUTTON_REPEAT_MS - 1));
+
+  int repeats = 0;
+  for (uint32_t t = down + BUTTON_LONG_MS + BUTTON_REPEAT_MS; t < down + BUTTON_LONG_MS + 4 * BUTTON_REPEAT_MS; t += 10) {
+    if (poll(t) == 1) {
+      TEST_ASSERT_EQUAL_UINT8(BUTTON_EVENT_REPEAT, events[0].type);
+      repeats++;
+    }
+  }
+  TEST_ASSERT_EQUAL_INT(3, repeats);
+
+  levels[2] = false;
+  TEST_ASSERT_EQUAL_INT(1, poll(down + BUTTON_LONG_MS + 4 * BUTTON_REPEAT_MS));
+  TEST_ASSERT_EQUAL_UINT8(BUTTON_EVENT_UP, events[0].type);
+  TEST_ASSERT_TRUE(events[0].long_press);
+
+  // The next press starts short again
+  levels[2] = true;
+  poll(5000);
+  levels[2] = false;
+  TEST_ASSERT_EQUAL_INT(1, poll(5100));
+  TEST_ASSERT_FALSE(events[0].long_press);
+}
+
+// Due times keep working when millis() wraps around during a press
+void test_millis_wrap(void) {
+  uint32_t start = 0xFFFFFFFFUL - 100;
+  levels[0] = true;
+  poll(start);
+  TEST_ASSERT_EQUAL_INT(0, poll(start + 200));
+  TEST_ASSERT_EQUAL_INT(1, poll(start + BUTTON_LONG_MS));
+  TEST_ASSERT_EQUAL_UINT8(BUTTON_EVENT_LONG, events[0].type);
+}
+
+// One event per button and poll, dropped beyond max
+void test_simultaneous_buttons(void) {
+  levels[0] = true;
+  levels[2] = true;
+  TEST_ASSERT_EQUAL_INT(2, poll(1000));
+  TEST_ASSERT_EQUAL_UINT8(0, events[0].button);
+  TEST_ASSERT_EQUAL_UINT8(2, events[1].button);
+
+  levels[0] = false;
+  levels[2] = false;
+  TEST_ASSERT_EQUAL_INT(1, button_input_update(&input, 1100, levels, events, 1));
+  TEST_ASSERT_EQUAL_UINT8(0, events[0].button);
+  TEST_ASSERT_FALSE(button_input_any_pressed(&input));
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_press_and_release);
+  RUN_TEST(test_debounce_lockout);
+  RUN_TEST(test_long_press_and_repeat);
+  RUN_TEST(test_millis_wrap);
+  RUN_TEST(test_simultaneous_buttons);
+  return UNITY_END();
+}
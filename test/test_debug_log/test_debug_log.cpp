@@ -0,0 +1,125 @@
+
+#include <unity.h>
+#include <string.h>
+#include "debug_log.hpp"
+
+// Host tests for the deferred formatter: arguments are captured the way the DLOG_x
+// macros capture them and formatted later by debug_log_format()
+
+static char line[DEBUG_LOG_LINE_MAX + 1];
+
+// Capture format and args into a record, as debug_log_write() does after the rate limit
+template <typename... Args>
+static void capture(DebugLogRecord *record, const char *format, Args... args) {
+  memset(record, 0, sizeof(*record));
+  record->format = format;
+  record->timestamp_ms = 61234;
+  record->level = DLOG_LEVEL_INFO;
+  int expand[] = {0, (debug_log_put(record, args), 0)...};
+  (void)expand;
+}
+
+// The formatted line without its "61.234 I " prefix
+template <typename... Args>
+static const char *format_line(const char *format, Args... args) {
+  DebugLogRecord record;
+  capture(&record, format, args...);
+  debug_log_format(&record, line, sizeof(line));
+  TEST_ASSERT_EQUAL_INT(0, strncmp(line, "61.234 I ", 9));
+  return line + 9;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// The conversions the firmware's log calls use
+void test_conversions(void) {
+  TEST_ASSERT_EQUAL_STRING("Screen 3 built in 42 ms", format_line("Screen %d built in %lu ms", 3, 42UL));
+  TEST_ASSERT_EQUAL_STRING("Object 36.6, rate -0.25", format_line("Object %.1f, rate %.2f", 36.62f, -0.25));
+  TEST_ASSERT_EQUAL_STRING("Power management: DFS", format_line("Power management: %s", "DFS"));
+  TEST_ASSERT_EQUAL_STRING("100% done", format_line("%d%% done", 100));
+  TEST_ASSERT_EQUAL_STRING("-5 mA", format_line("%ld mA", -5L));
+  TEST_ASSERT_EQUAL_STRING("4294967295", format_line("%u", -1));
+  TEST_ASSERT_EQUAL_STRING("-9000000000 18446744073709551615", format_line("%lld %llu", -9000000000LL, ~0ULL));
+  TEST_ASSERT_EQUAL_STRING("ff 0X1F 017", format_line("%x %#X %03o", 255u, 31u, 15u));
+  TEST_ASSERT_EQUAL_STRING("c=A", format_line("c=%c", 'A'));
+}
+
+void test_flags_and_widths(void) {
+  TEST_ASSERT_EQUAL_STRING("[  7][7  ][007][+7]", format_line("[%3d][%-3d][%03d][%+d]", 7, 7, 7, 7));
+  TEST_ASSERT_EQUAL_STRING("[ 3.14][ab   ][abc]", format_line("[%5.2f][%-5s][%.3s]", 3.14159, "ab", "abcdef"));
+}
+
+// The captured type decides, not the length modifier; mismatches print "?"
+void test_type_mismatch(void) {
+  TEST_ASSERT_EQUAL_STRING("7 7.0", format_line("%lu %.1f", 7, 7));
+  TEST_ASSERT_EQUAL_STRING("12", format_line("%d", 12.9));
+  TEST_ASSERT_EQUAL_STRING("? ?", format_line("%s %d", 5, "text"));
+  TEST_ASSERT_EQUAL_STRING("(null)", format_line("%s", (const char *)NULL));
+}
+
+void test_too_few_arguments(void) {
+  TEST_ASSERT_EQUAL_STRING("a=1 b=? c=?", format_line("a=%d b=%d c=%s", 1));
+  TEST_ASSERT_EQUAL_STRING("no args ?", format_line("no args %lu"));
+}
+
+// Strings are cut to DEBUG_LOG_STRING_MAX when captured
+void test_string_cut(void) {
+  const char *long_name = "0123456789abcdefghijklmnopqrstuvwxyzABCDEF";
+  TEST_ASSERT_EQUAL_STRING_LEN(long_name, format_line("%s", long_name), DEBUG_LOG_STRING_MAX);
+  TEST_ASSERT_EQUAL_INT(DEBUG_LOG_STRING_MAX, strlen(format_line("%s", long_name)));
+}
+
+// Arguments beyond DEBUG_LOG_ARGS_SIZE are left out and the line says so
+void test_args_cut(void) {
+  const char *s = "0123456789012345678901234567890";
+  DebugLogRecord record;
+  capture(&record, "%s %s %s %d", s, s, s, 1);
+  TEST_ASSERT_EQUAL_UINT8(1, record.truncated);
+  debug_log_format(&record, line, sizeof(line));
+  TEST_ASSERT_EQUAL_STRING("61.234 I 0123456789012345678901234567890 0123456789012345678901234567890 ? ? [args cut]",
+                           line);
+}
+
+void test_suppressed_and_levels(void) {
+  DebugLogRecord record;
+  capture(&record, "Sensor read failed");
+  record.level = DLOG_LEVEL_WARN;
+  record.suppressed = 12;
+  debug_log_format(&record, line, sizeof(line));
+  TEST_ASSERT_EQUAL_STRING("61.234 W Sensor read failed [+12 suppressed]", line);
+
+  record.level = 200;  // Out of range levels print '-'
+  record.suppressed = 0;
+  debug_log_format(&record, line, sizeof(line));
+  TEST_ASSERT_EQUAL_STRING("61.234 - Sensor read failed", line);
+}
+
+// The line is cut to the buffer and always terminated
+void test_output_cut(void) {
+  DebugLogRecord record;
+  capture(&record, "value %d and some more text", 123456);
+  char small[16];
+  memset(small, 'x', sizeof(small));
+  TEST_ASSERT_EQUAL(15, debug_log_format(&record, small, sizeof(small)));
+  TEST_ASSERT_EQUAL_STRING("61.234 I value ", small);
+
+  TEST_ASSERT_EQUAL(12, debug_log_format(&record, small, 13));
+  TEST_ASSERT_EQUAL_STRING("61.234 I val", small);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_conversions);
+  RUN_TEST(test_flags_and_widths);
+  RUN_TEST(test_type_mismatch);
+  RUN_TEST(test_too_few_arguments);
+  RUN_TEST(test_string_cut);
+  RUN_TEST(test_args_cut);
+  RUN_TEST(test_suppressed_and_levels);
+  RUN_TEST(test_output_cut);
+  return UNITY_END();
+}
@@ -0,0 +1,104 @@
+
+#include <unity.h>
+#include <math.h>
+#include "display_math.hpp"
+#include "../micro_bench.h"
+
+// Host tests and micro-benchmarks for the unit conversion and the gauge needle mapping
+// of update_temp_gauge_screen().
+
+#define BENCH_CALLS 100000
+
+// Gauge geometry used by update_temp_gauge_screen()
+#define NEEDLE_CENTER_X 160
+#define NEEDLE_CENTER_Y 100
+#define NEEDLE_LENGTH 70
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_unit_conversion(void) {
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 32.0f, celsius_to_fahrenheit(0.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 212.0f, celsius_to_fahrenheit(100.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, -40.0f, celsius_to_fahrenheit(-40.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 98.6f, celsius_to_fahrenheit(37.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, fahrenheit_to_celsius(32.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, -40.0f, fahrenheit_to_celsius(-40.0f));
+
+  // Round trip over the sensor range (-70..380 C) stays well inside display precision
+  for (float c = -70.0f; c <= 380.0f; c += 0.1f) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, c, fahrenheit_to_celsius(celsius_to_fahrenheit(c)));
+  }
+  TEST_ASSERT_TRUE(isnan(celsius_to_fahrenheit(NAN)));
+}
+
+void test_needle_angle(void) {
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 135.0f, gauge_needle_angle(0.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 270.0f, gauge_needle_angle(200.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 405.0f, gauge_needle_angle(400.0f));
+
+  // Off-scale readings and failed reads pin the needle to the ends
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 135.0f, gauge_needle_angle(-50.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 405.0f, gauge_needle_angle(1000.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 135.0f, gauge_needle_angle(NAN));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 405.0f, gauge_needle_angle(INFINITY));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 135.0f, gauge_needle_angle(-INFINITY));
+
+  float last = gauge_needle_angle(-1.0f);
+  for (float t = 0.0f; t <= 401.0f; t += 0.25f) {
+    float angle = gauge_needle_angle(t);
+    TEST_ASSERT_TRUE(angle >= last);
+    last = angle;
+  }
+}
+
+// The tip matches the double-precision formula it replaced to within a pixel
+void test_needle_tip(void) {
+  int32_t x, y;
+  gauge_needle_tip(180.0f, NEEDLE_CENTER_X, NEEDLE_CENTER_Y, NEEDLE_LENGTH, &x, &y);
+  TEST_ASSERT_INT_WITHIN(1, NEEDLE_CENTER_X, x);
+  TEST_ASSERT_INT_WITHIN(1, NEEDLE_CENTER_Y + NEEDLE_LENGTH, y);
+
+  for (float t = -10.0f; t <= 410.0f; t += 0.5f) {
+    float angle = gauge_needle_angle(t);
+    gauge_needle_tip(angle, NEEDLE_CENTER_X, NEEDLE_CENTER_Y, NEEDLE_LENGTH, &x, &y);
+    double rad = (angle - 90.0) * M_PI / 180.0;
+    int32_t ref_x = NEEDLE_CENTER_X + (int32_t)(NEEDLE_LENGTH * cos(rad));
+    int32_t ref_y = NEEDLE_CENTER_Y + (int32_t)(NEEDLE_LENGTH * sin(rad));
+    TEST_ASSERT_INT_WITHIN(1, ref_x, x);
+    TEST_ASSERT_INT_WITHIN(1, ref_y, y);
+
+    // Always on the needle circle
+    double r = sqrt((double)(x - NEEDLE_CENTER_X) * (x - NEEDLE_CENTER_X) +
+                    (double)(y - NEEDLE_CENTER_Y) * (y - NEEDLE_CENTER_Y));
+    TEST_ASSERT_TRUE(r > NEEDLE_LENGTH - 2 && r <= NEEDLE_LENGTH + 0.01);
+  }
+}
+
+void test_bench_display_math(void) {
+  micro_bench_check("celsius_to_fahrenheit", micro_bench_ns(BENCH_CALLS, [](uint32_t i) {
+    float f = celsius_to_fahrenheit((float)(i & 1023) * 0.37f);
+    micro_bench_sink += (uint32_t)f;
+  }), BASELINE_CELSIUS_TO_FAHRENHEIT_NS);
+
+  micro_bench_check("gauge_needle_angle", micro_bench_ns(BENCH_CALLS, [](uint32_t i) {
+    micro_bench_sink += (uint32_t)gauge_needle_angle((float)(i & 511) - 50.0f);
+  }), BASELINE_GAUGE_NEEDLE_ANGLE_NS);
+
+  micro_bench_check("gauge_needle_tip", micro_bench_ns(BENCH_CALLS, [](uint32_t i) {
+    int32_t x, y;
+    gauge_needle_tip(135.0f + (float)(i % 271), NEEDLE_CENTER_X, NEEDLE_CENTER_Y, NEEDLE_LENGTH, &x, &y);
+    micro_bench_sink += x + y;
+  }), BASELINE_GAUGE_NEEDLE_TIP_NS);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_unit_conversion);
+  RUN_TEST(test_needle_angle);
+  RUN_TEST(test_needle_tip);
+  RUN_TEST(test_bench_display_math);
+  return UNITY_END();
+}
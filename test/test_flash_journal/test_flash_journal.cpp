@@ -0,0 +1,245 @@
+#include <unity.h>
+#include <chrono>
+#include <map>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "flash_journal.hpp"
+
+// Host tests for the flash journal commit protocol. FaultFlash emulates NOR flash
+// (program only clears bits, erase sets a sector to 0xFF) and cuts the power after a
+// budget of programmed/erased bytes: the operation in flight stops partway and every
+// later one fails until the next "boot".
+
+struct FaultFlash {
+  std::vector<uint8_t> memory;
+  long budget;      // Bytes left before the power cut, -1 = unlimited
+  bool dead;
+  uint32_t reads;
+};
+
+static bool fault_read(void *context, uint32_t offset, void *data, size_t length) {
+  FaultFlash *flash = (FaultFlash *)context;
+  if (flash->dead || offset + length > flash->memory.size()) return false;
+  memcpy(data, &flash->memory[offset], length);
+  flash->reads++;
+  return true;
+}
+
+// Consume one byte of budget; false when the power is cut before this byte
+static bool fault_spend(FaultFlash *flash) {
+  if (flash->budget < 0) return true;
+  if (flash->budget == 0) {
+    flash->dead = true;
+    return false;
+  }
+  flash->budget--;
+  return true;
+}
+
+static bool fault_program(void *context, uint32_t offset, const void *data, size_t length) {
+  FaultFlash *flash = (FaultFlash *)context;
+  if (flash->dead || offset + length > flash->memory.size()) return false;
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (size_t i = 0; i < length; i++) {
+    if (!fault_spend(flash)) return false;
+    flash->memory[offset + i] &= bytes[i];
+  }
+  return true;
+}
+
+static bool fault_erase_sector(void *context, uint32_t offset) {
+  FaultFlash *flash = (FaultFlash *)context;
+  if (flash->dead || offset + FLASH_JOURNAL_SECTOR_SIZE > flash->memory.size()) return false;
+  for (uint32_t i = 0; i < FLASH_JOURNAL_SECTOR_SIZE; i++) {
+    if (!fault_spend(flash)) return false;  // Cut mid-erase: the sector is half erased
+    flash->memory[offset + i] = 0xFF;
+  }
+  return true;
+}
+
+static FlashJournalIo fault_io(FaultFlash *flash) {
+  FlashJournalIo io = {flash, fault_read, fault_program, fault_erase_sector};
+  return io;
+}
+
+static void fault_init(FaultFlash *flash, uint32_t sectors) {
+  // Start from programmed garbage rather than 0xFF, like a partition reused from a filesystem
+  flash->memory.assign(sectors * FLASH_JOURNAL_SECTOR_SIZE, 0x5A);
+  flash->budget = -1;
+  flash->dead = false;
+  flash->reads = 0;
+}
+
+static uint32_t rng_state = 12345;
+static uint32_t rng() {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+// Deterministic payload for seq, so any record read back can be checked
+static uint16_t make_payload(uint32_t seq, uint8_t *data, uint16_t max) {
+  uint16_t length = 1 + (seq * 7919) % max;
+  for (uint16_t i = 0; i < length; i++) data[i] = (uint8_t)(seq * 31 + i);
+  return length;
+}
+
+static bool check_payload(uint32_t seq, const uint8_t *data, int length, uint16_t max) {
+  uint8_t expected[FLASH_JOURNAL_SECTOR_SIZE];
+  return length == make_payload(seq, expected, max) && !memcmp(data, expected, length);
+}
+
+#define SLOT_SIZE 256
+#define SECTORS 8
+#define PAYLOAD_MAX FLASH_JOURNAL_PAYLOAD_MAX(SLOT_SIZE)
+#define SLOTS_PER_SECTOR (FLASH_JOURNAL_SECTOR_SIZE / SLOT_SIZE)
+
+// Reads a recovery may need: binary search over sectors plus a scan of the head sector
+static uint32_t recovery_read_bound(uint32_t sectors) {
+  uint32_t log2 = 0;
+  while ((1u << log2) < sectors) log2++;
+  return (log2 + 3) * 2 + SLOTS_PER_SECTOR;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_empty_region_opens_empty(void) {
+  FaultFlash flash;
+  fault_init(&flash, SECTORS);
+  FlashJournalIo io = fault_io(&flash);
+  FlashJournal journal;
+  TEST_ASSERT_TRUE(flash_journal_open(&journal, &io, 0, SECTORS, SLOT_SIZE));
+  TEST_ASSERT_EQUAL_UINT32(0, journal.next_seq);
+  TEST_ASSERT_EQUAL_UINT32(FLASH_JOURNAL_NO_SEQ, journal.last_seq);
+}
+
+void test_roundtrip_and_wrap(void) {
+  FaultFlash flash;
+  fault_init(&flash, SECTORS);
+  FlashJournalIo io = fault_io(&flash);
+  FlashJournal journal;
+  flash_journal_open(&journal, &io, 0, SECTORS, SLOT_SIZE);
+
+  uint8_t data[PAYLOAD_MAX];
+  const uint32_t total = SECTORS * SLOTS_PER_SECTOR * 3 + 5;  // Three laps and a bit
+  for (uint32_t seq = 0; seq < total; seq++) {
+    uint16_t length = make_payload(seq, data, PAYLOAD_MAX);
+    uint32_t written;
+    TEST_ASSERT_TRUE(flash_journal_append(&journal, data, length, &written));
+    TEST_ASSERT_EQUAL_UINT32(seq, written);
+  }
+
+  FlashJournal reopened;
+  TEST_ASSERT_TRUE(flash_journal_open(&reopened, &io, 0, SECTORS, SLOT_SIZE));
+  TEST_ASSERT_EQUAL_UINT32(total, reopened.next_seq);
+  TEST_ASSERT_EQUAL_UINT32(total - 1, reopened.last_seq);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(recovery_read_bound(SECTORS), reopened.open_reads);
+
+  uint32_t first = flash_journal_first_seq(&reopened);
+  TEST_ASSERT_EQUAL_UINT32(total - ((SECTORS - 1) * SLOTS_PER_SECTOR + 5), first);
+  for (uint32_t seq = first; seq < total; seq++) {
+    int length = flash_journal_read(&reopened, seq, data, sizeof(data));
+    TEST_ASSERT_TRUE(check_payload(seq, data, length, PAYLOAD_MAX));
+  }
+  TEST_ASSERT_EQUAL_INT(-1, flash_journal_read(&reopened, first - 1, data, sizeof(data)));
+  TEST_ASSERT_EQUAL_INT(-1, flash_journal_read(&reopened, total, data, sizeof(data)));
+}
+
+// Thousands of boots on one region, each ending in a power cut at a random byte of a
+// random write or erase. After every boot: no acknowledged record from first_seq on is
+// lost, first_seq keeps at least (SECTORS - 1) sectors, nothing damaged is returned, only
+// the write in flight may be missing, and recovery stays within its read bound.
+void test_power_cut_at_random_offsets(void) {
+  FaultFlash flash;
+  fault_init(&flash, SECTORS);
+  FlashJournalIo io = fault_io(&flash);
+  uint8_t data[PAYLOAD_MAX];
+  std::map<uint32_t, bool> acked;
+  uint32_t last_acked = FLASH_JOURNAL_NO_SEQ;
+  uint32_t worst_reads = 0;
+  const int boots = 2000;
+
+  for (int boot = 0; boot < boots; boot++) {
+    flash.dead = false;
+    flash.budget = -1;
+    flash.reads = 0;
+    FlashJournal journal;
+    TEST_ASSERT_TRUE(flash_journal_open(&journal, &io, 0, SECTORS, SLOT_SIZE));
+    if (journal.open_reads > worst_reads) worst_reads = journal.open_reads;
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(recovery_read_bound(SECTORS), journal.open_reads);
+
+    if (last_acked != FLASH_JOURNAL_NO_SEQ) {
+      // Only the record in flight can be lost, and the head never moves backwards
+      TEST_ASSERT_TRUE(journal.next_seq > last_acked);
+      TEST_ASSERT_TRUE(journal.last_seq != FLASH_JOURNAL_NO_SEQ && journal.last_seq >= last_acked);
+
+      uint32_t first = flash_journal_first_seq(&journal);
+      TEST_ASSERT_TRUE(first == 0 || journal.next_seq - first >= (SECTORS - 1) * SLOTS_PER_SECTOR);
+      for (uint32_t seq = first; seq < journal.next_seq; seq++) {
+        int length = flash_journal_read(&journal, seq, data, sizeof(data));
+        if (acked.count(seq)) TEST_ASSERT_TRUE(length >= 0);
+        if (length >= 0) TEST_ASSERT_TRUE(check_payload(seq, data, length, PAYLOAD_MAX));
+      }
+    }
+
+    // Append until the power goes: a few hundred bytes up to several sectors of work
+    flash.budget = rng() % (3 * FLASH_JOURNAL_SECTOR_SIZE);
+    for (;;) {
+      uint32_t seq = journal.next_seq;
+      uint16_t length = make_payload(seq, data, PAYLOAD_MAX);
+      if (!flash_journal_append(&journal, data, length, NULL)) break;
+      acked[seq] = true;
+      last_acked = seq;
+    }
+    TEST_ASSERT_TRUE(flash.dead);
+  }
+
+  char message[96];
+  snprintf(message, sizeof(message), "%d power cuts, %u records acknowledged: worst recovery %u reads",
+           boots, (unsigned)acked.size(), worst_reads);
+  TEST_MESSAGE(message);
+}
+
+// The sample log ring: 512 sectors of 512-byte slots, full and wrapped
+void test_recovery_time_scans_only_tail(void) {
+  const uint32_t sectors = 512, slot_size = 512;
+  FaultFlash flash;
+  fault_init(&flash, sectors);
+  FlashJournalIo io = fault_io(&flash);
+  FlashJournal journal;
+  flash_journal_open(&journal, &io, 0, sectors, slot_size);
+
+  uint8_t data[FLASH_JOURNAL_PAYLOAD_MAX(512)];
+  uint32_t total = sectors * (FLASH_JOURNAL_SECTOR_SIZE / slot_size) + 1234;
+  for (uint32_t seq = 0; seq < total; seq++) {
+    flash_journal_append(&journal, data, make_payload(seq, data, sizeof(data)), NULL);
+  }
+
+  flash.reads = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  FlashJournal reopened;
+  TEST_ASSERT_TRUE(flash_journal_open(&reopened, &io, 0, sectors, slot_size));
+  long us = (long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+  TEST_ASSERT_EQUAL_UINT32(total, reopened.next_seq);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(recovery_read_bound(sectors), reopened.open_reads);
+
+  char message[96];
+  snprintf(message, sizeof(message), "2 MB ring recovery: %u slot reads (%u flash reads), %ld us on host",
+           reopened.open_reads, flash.reads, us);
+  TEST_MESSAGE(message);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_region_opens_empty);
+  RUN_TEST(test_roundtrip_and_wrap);
+  RUN_TEST(test_power_cut_at_random_offsets);
+  RUN_TEST(test_recovery_time_scans_only_tail);
+  return UNITY_END();
+}
@@ -0,0 +1,123 @@
+
+#include <unity.h>
+#include "log_index.hpp"
+
+// Host tests for the sample log time index: query level selection, blocks replaced in
+// place, and the ring wrapping over the oldest blocks at every level.
+
+#define BLOCKS 64            // 3 levels: 64, 8 and 1 entries
+#define BLOCK_S 60
+#define BLOCK_SAMPLES 60
+
+static LogIndex index_;
+static LogColumn columns[16];
+
+// Block seq covering [seq * BLOCK_S, seq * BLOCK_S + BLOCK_S - 1], every reading value
+static void add_block(uint32_t seq, int16_t value) {
+  LogSummary block = {seq, seq * BLOCK_S, seq * BLOCK_S + BLOCK_S - 1, value, value,
+                      (int64_t)value * BLOCK_SAMPLES, BLOCK_SAMPLES};
+  log_index_add(&index_, &block);
+}
+
+static void add_blocks(uint32_t from, uint32_t to) {
+  for (uint32_t seq = from; seq < to; seq++) add_block(seq, (int16_t)(seq * 10));
+}
+
+void setUp(void) {
+  TEST_ASSERT_TRUE(log_index_init(&index_, BLOCKS));
+}
+
+void tearDown(void) {}
+
+void test_short_window_uses_blocks(void) {
+  add_blocks(0, BLOCKS);
+  // 10 blocks into 10 columns: one block per column
+  TEST_ASSERT_EQUAL_INT(0, log_index_query(&index_, 0, 10 * BLOCK_S, columns, 10));
+  for (int c = 0; c < 10; c++) {
+    TEST_ASSERT_EQUAL_INT16(c * 10, columns[c].min);
+    TEST_ASSERT_EQUAL_INT16(c * 10, columns[c].max);
+    TEST_ASSERT_EQUAL_UINT32(BLOCK_SAMPLES, columns[c].samples);
+  }
+}
+
+void test_long_window_uses_coarser_levels(void) {
+  add_blocks(0, BLOCKS);
+  // 64 blocks into 4 columns: 8 level 1 entries of 8 blocks, two per column
+  TEST_ASSERT_EQUAL_INT(1, log_index_query(&index_, 0, BLOCKS * BLOCK_S, columns, 4));
+  for (int c = 0; c < 4; c++) {
+    TEST_ASSERT_EQUAL_INT16(c * 160, columns[c].min);
+    TEST_ASSERT_EQUAL_INT16(c * 160 + 150, columns[c].max);
+    TEST_ASSERT_EQUAL_UINT32(16 * BLOCK_SAMPLES, columns[c].samples);
+  }
+
+  // One column: the single top entry
+  TEST_ASSERT_EQUAL_INT(2, log_index_query(&index_, 0, BLOCKS * BLOCK_S, columns, 1));
+  TEST_ASSERT_EQUAL_INT16(0, columns[0].min);
+  TEST_ASSERT_EQUAL_INT16(630, columns[0].max);
+  TEST_ASSERT_EQUAL_INT16(315, columns[0].mean);
+  TEST_ASSERT_EQUAL_UINT32(BLOCKS * BLOCK_SAMPLES, columns[0].samples);
+}
+
+void test_replaced_block_updates_parents(void) {
+  add_blocks(0, 8);
+  add_block(3, 500);  // e.g. the WAL snapshot of block 3 followed by the sealed block
+
+  TEST_ASSERT_EQUAL_INT(1, log_index_query(&index_, 0, 8 * BLOCK_S, columns, 1));
+  TEST_ASSERT_EQUAL_INT16(500, columns[0].max);
+  TEST_ASSERT_EQUAL_UINT32(8 * BLOCK_SAMPLES, columns[0].samples);
+
+  TEST_ASSERT_EQUAL_INT(0, log_index_query(&index_, 3 * BLOCK_S, 4 * BLOCK_S, columns, 1));
+  TEST_ASSERT_EQUAL_INT16(500, columns[0].min);
+}
+
+void test_older_block_never_replaces_newer(void) {
+  add_blocks(0, BLOCKS + 1);  // Block 64 took the slot of block 0
+  uint32_t generation = index_.generation;
+  add_block(0, 999);          // e.g. a late scan of the ring at boot
+  TEST_ASSERT_EQUAL_UINT32(generation, index_.generation);
+
+  uint32_t start_s, end_s;
+  TEST_ASSERT_TRUE(log_index_range(&index_, &start_s, &end_s));
+  TEST_ASSERT_EQUAL_UINT32(1 * BLOCK_S, start_s);
+  TEST_ASSERT_EQUAL_UINT32((BLOCKS + 1) * BLOCK_S - 1, end_s);
+}
+
+void test_ring_wrap_drops_oldest_blocks(void) {
+  add_blocks(0, BLOCKS + 20);  // Blocks 0..19 overwritten
+
+  uint32_t start_s, end_s;
+  TEST_ASSERT_TRUE(log_index_range(&index_, &start_s, &end_s));
+  TEST_ASSERT_EQUAL_UINT32(20 * BLOCK_S, start_s);
+  TEST_ASSERT_EQUAL_UINT32((BLOCKS + 20) * BLOCK_S - 1, end_s);
+
+  TEST_ASSERT_EQUAL_INT(-1, log_index_query(&index_, 0, 20 * BLOCK_S, columns, 4));
+
+  uint32_t first, last;
+  TEST_ASSERT_TRUE(log_index_find_blocks(&index_, 70 * BLOCK_S, 73 * BLOCK_S, &first, &last));
+  TEST_ASSERT_EQUAL_UINT32(70, first);
+  TEST_ASSERT_EQUAL_UINT32(72, last);
+  TEST_ASSERT_FALSE(log_index_find_blocks(&index_, 0, 20 * BLOCK_S, &first, &last));
+}
+
+void test_ring_wrap_keeps_whole_ring_in_coarse_query(void) {
+  add_blocks(0, BLOCKS + 20);
+  // The top entry and the level 1 entry of blocks 16..23 now hold newer blocks; the
+  // query has to fall back to the surviving blocks 20..23
+  TEST_ASSERT_EQUAL_INT(2, log_index_query(&index_, 0, (BLOCKS + 20) * BLOCK_S, columns, 1));
+  TEST_ASSERT_EQUAL_INT16(200, columns[0].min);
+  TEST_ASSERT_EQUAL_INT16(830, columns[0].max);
+  TEST_ASSERT_EQUAL_UINT32(BLOCKS * BLOCK_SAMPLES, columns[0].samples);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_short_window_uses_blocks);
+  RUN_TEST(test_long_window_uses_coarser_levels);
+  RUN_TEST(test_replaced_block_updates_parents);
+  RUN_TEST(test_older_block_never_replaces_newer);
+  RUN_TEST(test_ring_wrap_drops_oldest_blocks);
+  RUN_TEST(test_ring_wrap_keeps_whole_ring_in_coarse_query);
+  return UNITY_END();
+}
@@ -0,0 +1,110 @@
+
+#include <unity.h>
+#include <string.h>
+#include "mem_monitor.hpp"
+
+// Host tests for the memory warning limits and their hysteresis
+
+static MemSnapshot snapshot;
+static MemMonitor monitor;
+
+// Everything comfortably above its limit
+static void healthy_snapshot(MemSnapshot *s) {
+  memset(s, 0, sizeof(*s));
+  for (int i = 0; i < MEM_REGION_COUNT; i++) {
+    s->regions[i].present = true;
+    s->regions[i].total = 512 * 1024;
+    s->regions[i].free = 256 * 1024;
+    s->regions[i].largest_free = 128 * 1024;
+    s->regions[i].min_free = 200 * 1024;
+  }
+  s->lvgl_total = 96 * 1024;
+  s->lvgl_used = 40 * 1024;
+  s->lvgl_largest_free = 32 * 1024;
+  s->task_count = 2;
+  s->tasks[0].name = "loop";
+  s->tasks[0].stack_size = 8192;
+  s->tasks[0].stack_free = 3000;
+  s->tasks[0].present = true;
+  s->tasks[1].name = "sensor";
+  s->tasks[1].stack_size = 4096;
+  s->tasks[1].stack_free = 1500;
+  s->tasks[1].present = true;
+}
+
+void setUp(void) {
+  healthy_snapshot(&snapshot);
+  mem_monitor_init(&monitor);
+}
+
+void tearDown(void) {}
+
+void test_healthy_has_no_warnings(void) {
+  TEST_ASSERT_EQUAL_UINT32(0, mem_monitor_check(&monitor, &snapshot));
+  TEST_ASSERT_EQUAL_UINT32(0, monitor.active);
+}
+
+// Raised once below the limit, cleared only 25 % above it
+void test_internal_free_hysteresis(void) {
+  snapshot.regions[MEM_REGION_INTERNAL].free = MEM_LIMIT_INTERNAL_FREE - 1;
+  TEST_ASSERT_EQUAL_UINT32(MEM_WARN_INTERNAL_FREE, mem_monitor_check(&monitor, &snapshot));
+  TEST_ASSERT_EQUAL_UINT32(0, mem_monitor_check(&monitor, &snapshot));
+  TEST_ASSERT_EQUAL_UINT32(MEM_WARN_INTERNAL_FREE, monitor.active);
+
+  snapshot.regions[MEM_REGION_INTERNAL].free = MEM_LIMIT_INTERNAL_FREE + 1;
+  mem_monitor_check(&monitor, &snapshot);
+  TEST_ASSERT_EQUAL_UINT32(MEM_WARN_INTERNAL_FREE, monitor.active);
+
+  snapshot.regions[MEM_REGION_INTERNAL].free = MEM_LIMIT_INTERNAL_FREE * 5 / 4;
+  mem_monitor_check(&monitor, &snapshot);
+  TEST_ASSERT_EQUAL_UINT32(0, monitor.active);
+
+  snapshot.regions[MEM_REGION_INTERNAL].free = 0;
+  TEST_ASSERT_EQUAL_UINT32(MEM_WARN_INTERNAL_FREE, mem_monitor_check(&monitor, &snapshot));
+  TEST_ASSERT_EQUAL_UINT32(2, monitor.raised);
+}
+
+void test_each_limit(void) {
+  snapshot.regions[MEM_REGION_INTERNAL].largest_free = MEM_LIMIT_INTERNAL_BLOCK - 1;
+  snapshot.regions[MEM_REGION_DMA].free = MEM_LIMIT_DMA_FREE - 1;
+  snapshot.regions[MEM_REGION_PSRAM].free = MEM_LIMIT_PSRAM_FREE - 1;
+  snapshot.lvgl_used = snapshot.lvgl_total - snapshot.lvgl_total * (MEM_LIMIT_LVGL_FREE_PCT - 1) / 100;
+  snapshot.tasks[1].stack_free = MEM_LIMIT_STACK_FREE - 1;
+
+  uint32_t expected = MEM_WARN_INTERNAL_BLOCK | MEM_WARN_DMA_FREE | MEM_WARN_PSRAM_FREE | MEM_WARN_LVGL_FREE |
+                      MEM_WARN_TASK(1);
+  TEST_ASSERT_EQUAL_UINT32(expected, mem_monitor_check(&monitor, &snapshot));
+  TEST_ASSERT_EQUAL_UINT32(5, monitor.raised);
+  TEST_ASSERT_EQUAL_STRING("PSRAM low", mem_warning_name(MEM_WARN_PSRAM_FREE));
+  TEST_ASSERT_EQUAL_STRING("Stack low", mem_warning_name(MEM_WARN_TASK(1)));
+}
+
+// Missing regions and unmeasured tasks never warn (boards without PSRAM, the host build)
+void test_absent_values_ignored(void) {
+  for (int i = 0; i < MEM_REGION_COUNT; i++) {
+    memset(&snapshot.regions[i], 0, sizeof(snapshot.regions[i]));
+  }
+  snapshot.lvgl_total = 0;
+  snapshot.lvgl_used = 0;
+  snapshot.tasks[0].present = false;
+  snapshot.tasks[0].stack_free = 0;
+  TEST_ASSERT_EQUAL_UINT32(0, mem_monitor_check(&monitor, &snapshot));
+
+  // A task that stops being measurable keeps its last state
+  snapshot.tasks[1].stack_free = 100;
+  TEST_ASSERT_EQUAL_UINT32(MEM_WARN_TASK(1), mem_monitor_check(&monitor, &snapshot));
+  snapshot.tasks[1].present = false;
+  mem_monitor_check(&monitor, &snapshot);
+  TEST_ASSERT_EQUAL_UINT32(MEM_WARN_TASK(1), monitor.active);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_healthy_has_no_warnings);
+  RUN_TEST(test_internal_free_hysteresis);
+  RUN_TEST(test_each_limit);
+  RUN_TEST(test_absent_values_ignored);
+  return UNITY_END();
+}
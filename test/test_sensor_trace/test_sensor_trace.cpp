@@ -0,0 +1,211 @@
+
+#include <unity.h>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "sensor_trace.hpp"
+
+// Host tests for the trace format and the replay clock: file round trip, pacing at
+// real, accelerated and unlimited speed against a simulated clock, and the lateness
+// and throughput of a replay against the real clock.
+
+#define REALTIME_RECORDS 50
+#define REALTIME_SPACING_MS 20
+#define REALTIME_MAX_LATE_MS 15          // Generous for a loaded CI machine
+#define THROUGHPUT_RECORDS 1000000
+#define THROUGHPUT_MIN_PER_S 1000000.0
+
+static std::vector<SensorTraceRecord> make_trace(size_t count, uint32_t first_ms, uint32_t spacing_ms) {
+  std::vector<SensorTraceRecord> records(count);
+  for (size_t i = 0; i < count; i++) {
+    SensorTraceRecord &r = records[i];
+    memset(&r, 0, sizeof(r));
+    r.timestamp_ms = first_ms + i * spacing_ms;
+    if (i % 10 == 9) {
+      r.type = SENSOR_TRACE_BUTTON;
+      r.button = i % 3;
+      r.pressed = (i / 10) % 2;
+    } else {
+      r.type = SENSOR_TRACE_SAMPLE;
+      r.object_c = 20.0f + 0.37f * i;
+      r.ambient_c = 22.5f - 0.01f * i;
+    }
+  }
+  return records;
+}
+
+static std::vector<uint8_t> write_trace(const std::vector<SensorTraceRecord> &records) {
+  std::vector<uint8_t> data(SENSOR_TRACE_HEADER_SIZE + records.size() * SENSOR_TRACE_RECORD_SIZE);
+  sensor_trace_write_header(&data[0]);
+  for (size_t i = 0; i < records.size(); i++) {
+    sensor_trace_encode(&records[i], &data[SENSOR_TRACE_HEADER_SIZE + i * SENSOR_TRACE_RECORD_SIZE]);
+  }
+  return data;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_file_roundtrip(void) {
+  std::vector<SensorTraceRecord> records = make_trace(100, 123456, 500);
+  std::vector<uint8_t> data = write_trace(records);
+  TEST_ASSERT_EQUAL_MEMORY("NCTR", &data[0], 4);
+
+  std::vector<SensorTraceRecord> parsed(records.size());
+  TEST_ASSERT_EQUAL_INT32(100, sensor_trace_parse(&data[0], data.size(), &parsed[0], parsed.size()));
+  for (size_t i = 0; i < records.size(); i++) {
+    TEST_ASSERT_EQUAL_UINT32(records[i].timestamp_ms, parsed[i].timestamp_ms);
+    TEST_ASSERT_EQUAL_UINT8(records[i].type, parsed[i].type);
+    TEST_ASSERT_EQUAL_UINT8(records[i].button, parsed[i].button);
+    TEST_ASSERT_EQUAL_UINT8(records[i].pressed, parsed[i].pressed);
+    // Bit exact, so a replay sees the captured readings and not rounded ones
+    TEST_ASSERT_EQUAL_MEMORY(&records[i].object_c, &parsed[i].object_c, sizeof(float));
+    TEST_ASSERT_EQUAL_MEMORY(&records[i].ambient_c, &parsed[i].ambient_c, sizeof(float));
+  }
+
+  // A capture cut short keeps its whole records, max caps the count
+  TEST_ASSERT_EQUAL_INT32(99, sensor_trace_parse(&data[0], data.size() - 5, &parsed[0], parsed.size()));
+  TEST_ASSERT_EQUAL_INT32(10, sensor_trace_parse(&data[0], data.size(), &parsed[0], 10));
+  TEST_ASSERT_EQUAL_INT32(0, sensor_trace_parse(&data[0], SENSOR_TRACE_HEADER_SIZE, &parsed[0], parsed.size()));
+}
+
+void test_rejects_other_files(void) {
+  std::vector<uint8_t> data = write_trace(make_trace(4, 0, 500));
+  SensorTraceRecord parsed[4];
+
+  TEST_ASSERT_EQUAL_INT32(-1, sensor_trace_parse(&data[0], 4, parsed, 4));
+  data[0] = 'X';
+  TEST_ASSERT_EQUAL_INT32(-1, sensor_trace_parse(&data[0], data.size(), parsed, 4));
+  data[0] = 'N';
+  data[4] = SENSOR_TRACE_VERSION + 1;
+  TEST_ASSERT_EQUAL_INT32(-1, sensor_trace_parse(&data[0], data.size(), parsed, 4));
+  data[4] = SENSOR_TRACE_VERSION;
+  data[6] = SENSOR_TRACE_RECORD_SIZE + 4;
+  TEST_ASSERT_EQUAL_INT32(-1, sensor_trace_parse(&data[0], data.size(), parsed, 4));
+}
+
+// Number of records handed out when the clock reaches now_ms
+static size_t due_at(SensorTracePlayer *player, uint32_t now_ms) {
+  SensorTraceRecord record;
+  size_t count = 0;
+  while (sensor_trace_player_next(player, now_ms, &record)) count++;
+  return count;
+}
+
+void test_player_pacing(void) {
+  // Trace captured at 500 ms spacing from 1 h of device uptime, replayed from clock 1000
+  std::vector<SensorTraceRecord> records = make_trace(10, 3600000, 500);
+  SensorTracePlayer player;
+
+  sensor_trace_player_start(&player, &records[0], records.size(), 1.0f, 1000);
+  TEST_ASSERT_EQUAL(1, due_at(&player, 1000));
+  TEST_ASSERT_EQUAL_UINT32(500, sensor_trace_player_wait_ms(&player, 1000));
+  TEST_ASSERT_EQUAL(0, due_at(&player, 1499));
+  TEST_ASSERT_EQUAL_UINT32(1, sensor_trace_player_wait_ms(&player, 1499));
+  TEST_ASSERT_EQUAL(1, due_at(&player, 1500));
+  TEST_ASSERT_EQUAL(3, due_at(&player, 3000));
+  TEST_ASSERT_FALSE(sensor_trace_player_done(&player));
+  TEST_ASSERT_EQUAL(5, due_at(&player, 10000));
+  TEST_ASSERT_TRUE(sensor_trace_player_done(&player));
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, sensor_trace_player_wait_ms(&player, 10000));
+
+  // Four times faster: 125 ms spacing
+  sensor_trace_player_start(&player, &records[0], records.size(), 4.0f, 0);
+  TEST_ASSERT_EQUAL(1, due_at(&player, 0));
+  TEST_ASSERT_EQUAL(0, due_at(&player, 124));
+  TEST_ASSERT_EQUAL(1, due_at(&player, 125));
+  TEST_ASSERT_EQUAL(8, due_at(&player, 1125));
+
+  // Unlimited: everything is due at once, in order
+  sensor_trace_player_start(&player, &records[0], records.size(), 0.0f, 0);
+  SensorTraceRecord record;
+  for (size_t i = 0; i < records.size(); i++) {
+    TEST_ASSERT_EQUAL_UINT32(0, sensor_trace_player_wait_ms(&player, 0));
+    TEST_ASSERT_TRUE(sensor_trace_player_next(&player, 0, &record));
+    TEST_ASSERT_EQUAL_UINT32(records[i].timestamp_ms, record.timestamp_ms);
+  }
+  TEST_ASSERT_FALSE(sensor_trace_player_next(&player, 0, &record));
+
+  // The clock wrapping during a replay does not stall it
+  sensor_trace_player_start(&player, &records[0], records.size(), 1.0f, UINT32_MAX - 100);
+  TEST_ASSERT_EQUAL(1, due_at(&player, UINT32_MAX - 100));
+  TEST_ASSERT_EQUAL(1, due_at(&player, 400));
+
+  // An empty trace is done straight away
+  sensor_trace_player_start(&player, NULL, 0, 1.0f, 0);
+  TEST_ASSERT_TRUE(sensor_trace_player_done(&player));
+  TEST_ASSERT_FALSE(sensor_trace_player_next(&player, 0, &record));
+}
+
+static uint32_t clock_ms(std::chrono::steady_clock::time_point start) {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// A consumer that sleeps for wait_ms between records gets each one close to its due time
+void test_realtime_replay_latency(void) {
+  std::vector<SensorTraceRecord> records = make_trace(REALTIME_RECORDS, 5000, REALTIME_SPACING_MS);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  SensorTracePlayer player;
+  sensor_trace_player_start(&player, &records[0], records.size(), 1.0f, clock_ms(start));
+
+  uint32_t max_late_ms = 0;
+  size_t received = 0;
+  while (!sensor_trace_player_done(&player)) {
+    uint32_t wait = sensor_trace_player_wait_ms(&player, clock_ms(start));
+    if (wait) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(wait));
+      continue;
+    }
+    SensorTraceRecord record;
+    TEST_ASSERT_TRUE(sensor_trace_player_next(&player, clock_ms(start), &record));
+    uint32_t due_ms = record.timestamp_ms - records[0].timestamp_ms;
+    uint32_t now_ms = clock_ms(start);
+    TEST_ASSERT_TRUE(now_ms >= due_ms);
+    if (now_ms - due_ms > max_late_ms) max_late_ms = now_ms - due_ms;
+    received++;
+  }
+
+  char message[96];
+  snprintf(message, sizeof(message), "realtime: %u records, max %u ms late", (unsigned)received, max_late_ms);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_EQUAL(REALTIME_RECORDS, received);
+  TEST_ASSERT_TRUE(max_late_ms <= REALTIME_MAX_LATE_MS);
+}
+
+// Unlimited speed costs next to nothing per record, so replays are bound by the firmware
+void test_unlimited_replay_throughput(void) {
+  std::vector<SensorTraceRecord> records = make_trace(THROUGHPUT_RECORDS, 0, 500);
+  SensorTracePlayer player;
+  sensor_trace_player_start(&player, &records[0], records.size(), 0.0f, 0);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  SensorTraceRecord record;
+  double sum = 0;
+  size_t received = 0;
+  while (sensor_trace_player_next(&player, 0, &record)) {
+    sum += record.object_c;
+    received++;
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  char message[96];
+  snprintf(message, sizeof(message), "unlimited: %.1f M records/s (checksum %.0f)", received / seconds / 1e6, sum);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_EQUAL(THROUGHPUT_RECORDS, received);
+  TEST_ASSERT_TRUE(received / seconds >= THROUGHPUT_MIN_PER_S);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_file_roundtrip);
+  RUN_TEST(test_rejects_other_files);
+  RUN_TEST(test_player_pacing);
+  RUN_TEST(test_realtime_replay_latency);
+  RUN_TEST(test_unlimited_replay_throughput);
+  return UNITY_END();
+}
@@ -0,0 +1,328 @@
+
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <mutex>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "telemetry_frame.hpp"
+
+// Host tests for the telemetry framing, the frame ring and the streaming path end to
+// end: frames go through the ring, are drained in chunks exactly like the device task
+// does and cross a pseudo-terminal to a decoder on the other side.
+
+#define PTY_CHUNK_SIZE 512
+#define PTY_FRAMES 200000
+#define PTY_MIN_BYTES_PER_S (200 * 1024)  // Well above what USB full speed CDC delivers in practice
+
+struct Received {
+  std::vector<uint16_t> seqs;
+  std::vector<std::vector<uint8_t> > payloads;
+  std::vector<uint8_t> types;
+};
+
+static void collect_frame(void *context, uint8_t type, uint16_t seq, const uint8_t *payload, size_t length) {
+  Received *received = (Received *)context;
+  received->types.push_back(type);
+  received->seqs.push_back(seq);
+  received->payloads.push_back(std::vector<uint8_t>(payload, payload + length));
+}
+
+static void count_frame(void *context, uint8_t type, uint16_t seq, const uint8_t *payload, size_t length) {
+  (void)type;
+  (void)payload;
+  (void)length;
+  std::vector<uint16_t> *seqs = (std::vector<uint16_t> *)context;
+  seqs->push_back(seq);
+}
+
+static size_t encode_sample(uint16_t seq, uint8_t *out) {
+  TelemetrySample sample;
+  sample.timestamp_ms = seq * 500u;
+  sample.object_c = 20.0f + (seq % 100) * 0.25f;
+  sample.ambient_c = 22.5f;
+  return telemetry_frame_encode(TELEMETRY_SAMPLE, seq, &sample, sizeof(sample), out);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Every payload length, with zero bytes in all positions COBS has to escape
+void test_roundtrip_all_lengths(void) {
+  srand(1);
+  TelemetryDecoder decoder;
+  telemetry_decoder_init(&decoder);
+  Received received;
+
+  std::vector<std::vector<uint8_t> > sent;
+  for (size_t length = 0; length <= TELEMETRY_PAYLOAD_MAX; length++) {
+    std::vector<uint8_t> payload(length);
+    for (size_t i = 0; i < length; i++) payload[i] = (rand() % 3) ? (uint8_t)rand() : 0;
+    sent.push_back(payload);
+
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+    size_t n = telemetry_frame_encode(TELEMETRY_PROFILE, (uint16_t)(length * 1000), payload.data(), length, frame);
+    TEST_ASSERT_TRUE(n > 0 && n <= TELEMETRY_FRAME_MAX);
+    TEST_ASSERT_NULL(memchr(frame, 0, n - 1));
+    TEST_ASSERT_EQUAL_UINT8(0, frame[n - 1]);
+    telemetry_decoder_feed(&decoder, frame, n, collect_frame, &received);
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(sent.size(), received.payloads.size());
+  TEST_ASSERT_EQUAL_UINT32(0, decoder.rejected);
+  for (size_t i = 0; i < sent.size(); i++) {
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_PROFILE, received.types[i]);
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)(i * 1000), received.seqs[i]);
+    TEST_ASSERT_TRUE(sent[i] == received.payloads[i]);
+  }
+
+  uint8_t frame[TELEMETRY_FRAME_MAX];
+  uint8_t too_long[TELEMETRY_PAYLOAD_MAX + 1] = {0};
+  TEST_ASSERT_EQUAL_UINT32(0, telemetry_frame_encode(TELEMETRY_SAMPLE, 0, too_long, sizeof(too_long), frame));
+}
+
+// Debug text, line noise and a damaged frame cost only themselves
+void test_resync_after_text_and_corruption(void) {
+  TelemetryDecoder decoder;
+  telemetry_decoder_init(&decoder);
+  Received received;
+
+  std::vector<uint8_t> stream;
+  uint8_t frame[TELEMETRY_FRAME_MAX];
+  size_t n;
+
+  const char *text = "Temps - Object: 23.4\xc2\xb0" "C, Ambient: 22.1\xc2\xb0" "C\n";
+  stream.insert(stream.end(), text, text + strlen(text));
+  stream.push_back(0);  // Leading delimiter of the next transmission
+  n = encode_sample(1, frame);
+  stream.insert(stream.end(), frame, frame + n);
+
+  n = encode_sample(2, frame);
+  frame[3] ^= 0x10;     // Bit error inside the payload
+  stream.insert(stream.end(), frame, frame + n);
+
+  for (int i = 0; i < 300; i++) stream.push_back((uint8_t)(i * 7) | 1);  // Longer than any frame
+  stream.push_back(0);
+  n = encode_sample(3, frame);
+  stream.insert(stream.end(), frame, frame + n);
+
+  // Byte by byte, as a serial port may deliver it
+  for (size_t i = 0; i < stream.size(); i++) {
+    telemetry_decoder_feed(&decoder, &stream[i], 1, collect_frame, &received);
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(2, received.seqs.size());
+  TEST_ASSERT_EQUAL_UINT16(1, received.seqs[0]);
+  TEST_ASSERT_EQUAL_UINT16(3, received.seqs[1]);
+  TEST_ASSERT_EQUAL_UINT32(3, decoder.rejected);
+}
+
+// Pops end on a frame boundary, across the wrap, and a full ring refuses whole frames
+void test_ring_keeps_frames_whole(void) {
+  uint8_t buffer[256];
+  TelemetryRing ring;
+  telemetry_ring_init(&ring, buffer, sizeof(buffer));
+  TelemetryDecoder decoder;
+  telemetry_decoder_init(&decoder);
+  std::vector<uint16_t> seqs;
+
+  uint8_t frame[TELEMETRY_FRAME_MAX];
+  uint16_t seq = 0;
+  uint32_t pushed = 0;
+  for (int round = 0; round < 50; round++) {
+    while (telemetry_ring_push(&ring, frame, encode_sample(seq, frame))) {
+      seq++;
+      pushed++;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(sizeof(buffer), telemetry_ring_used(&ring));
+
+    // Odd-sized pops leave the ring at a different offset every round
+    uint8_t out[TELEMETRY_FRAME_MAX + 13];
+    size_t n = telemetry_ring_pop(&ring, out, sizeof(out));
+    TEST_ASSERT_TRUE(n > 0);
+    TEST_ASSERT_EQUAL_UINT8(0, out[n - 1]);
+    telemetry_decoder_feed(&decoder, out, n, count_frame, &seqs);
+  }
+  uint8_t out[sizeof(buffer)];
+  size_t n;
+  while ((n = telemetry_ring_pop(&ring, out, sizeof(out))) > 0) {
+    telemetry_decoder_feed(&decoder, out, n, count_frame, &seqs);
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(pushed, seqs.size());
+  TEST_ASSERT_EQUAL_UINT32(0, decoder.rejected);
+  for (size_t i = 0; i < seqs.size(); i++) TEST_ASSERT_EQUAL_UINT16((uint16_t)i, seqs[i]);
+  TEST_ASSERT_TRUE(ring.high_water > sizeof(buffer) - TELEMETRY_FRAME_MAX);
+}
+
+// Raw pseudo-terminal pair: the master is the device side, the slave the host port
+static bool open_pty(int *master, int *slave) {
+  *master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (*master < 0 || grantpt(*master) || unlockpt(*master)) return false;
+  *slave = open(ptsname(*master), O_RDWR | O_NOCTTY);
+  if (*slave < 0) return false;
+
+  struct termios tio;
+  tcgetattr(*slave, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(*slave, TCSANOW, &tio);
+  return true;
+}
+
+struct PtyRun {
+  uint32_t produced;
+  uint32_t dropped;
+  uint32_t bytes;
+  double seconds;
+  std::vector<uint16_t> seqs;
+  uint32_t rejected;
+};
+
+// Producer -> ring -> drain thread -> pty -> decoder. With block_when_full the producer
+// waits for space (sustained throughput); otherwise it drops like the device does.
+static PtyRun run_pty_stream(uint32_t frames, uint32_t ring_size, bool block_when_full, uint32_t stall_ms) {
+  PtyRun run;
+  run.produced = frames;
+  run.dropped = 0;
+  run.rejected = 0;
+  int master, slave;
+  TEST_ASSERT_TRUE_MESSAGE(open_pty(&master, &slave), "no pseudo-terminal");
+
+  std::vector<uint8_t> buffer(ring_size);
+  TelemetryRing ring;
+  telemetry_ring_init(&ring, buffer.data(), ring_size);
+  std::mutex lock;
+  std::atomic<bool> done(false);
+  std::atomic<bool> drained(false);
+  std::atomic<uint32_t> written(0);
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+  std::thread drain([&]() {
+    uint8_t chunk[PTY_CHUNK_SIZE + 1];
+    chunk[0] = 0;
+    if (stall_ms) std::this_thread::sleep_for(std::chrono::milliseconds(stall_ms));
+    for (;;) {
+      size_t n;
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        n = telemetry_ring_pop(&ring, chunk + 1, PTY_CHUNK_SIZE);
+      }
+      if (!n) {
+        if (done) {
+          drained = true;
+          break;
+        }
+        std::this_thread::yield();
+        continue;
+      }
+      for (size_t off = 0; off < n + 1;) {
+        ssize_t w = write(master, chunk + off, n + 1 - off);
+        if (w <= 0) return;
+        off += (size_t)w;
+      }
+      written += n + 1;
+    }
+  });
+
+  std::thread reader([&]() {
+    TelemetryDecoder decoder;
+    telemetry_decoder_init(&decoder);
+    uint8_t data[4096];
+    struct pollfd pfd = {slave, POLLIN, 0};
+    for (;;) {
+      // Everything written is readable at once, so a short idle spell after the
+      // drain thread finished ends the stream
+      bool finished = drained;
+      int ready = poll(&pfd, 1, finished ? 50 : 1000);
+      if (ready < 0 || (!ready && finished)) break;
+      if (!ready) continue;
+      ssize_t n = read(slave, data, sizeof(data));
+      if (n <= 0) break;
+      telemetry_decoder_feed(&decoder, data, (size_t)n, count_frame, &run.seqs);
+    }
+    run.rejected = decoder.rejected;
+  });
+
+  uint8_t frame[TELEMETRY_FRAME_MAX];
+  for (uint32_t i = 0; i < frames; i++) {
+    size_t n = encode_sample((uint16_t)i, frame);
+    for (;;) {
+      bool queued;
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        queued = telemetry_ring_push(&ring, frame, n);
+      }
+      if (queued || !block_when_full) {
+        if (!queued) run.dropped++;
+        break;
+      }
+      std::this_thread::yield();
+    }
+  }
+  done = true;
+
+  drain.join();
+  reader.join();
+  run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  run.bytes = written;
+  close(slave);
+  close(master);
+  return run;
+}
+
+void test_pty_sustained_throughput(void) {
+  PtyRun run = run_pty_stream(PTY_FRAMES, 8192, true, 0);
+
+  TEST_ASSERT_EQUAL_UINT32(0, run.dropped);
+  TEST_ASSERT_EQUAL_UINT32(0, run.rejected);
+  TEST_ASSERT_EQUAL_UINT32(PTY_FRAMES, run.seqs.size());
+  for (uint32_t i = 0; i < run.seqs.size(); i++) {
+    if (run.seqs[i] != (uint16_t)i) TEST_FAIL_MESSAGE("frame lost or reordered");
+  }
+
+  double bytes_per_s = run.bytes / run.seconds;
+  char message[128];
+  snprintf(message, sizeof(message), "pty: %u frames, %.0f frames/s, %.2f MB/s, %.1f bytes/frame on the wire",
+           PTY_FRAMES, PTY_FRAMES / run.seconds, bytes_per_s / 1e6, (double)run.bytes / PTY_FRAMES);
+  TEST_MESSAGE(message);
+  TEST_ASSERT_TRUE(bytes_per_s >= PTY_MIN_BYTES_PER_S);
+}
+
+// A stalled port makes the producer drop, never wait, and every drop shows on the host
+// as a seq gap
+void test_pty_overload_drops_without_blocking(void) {
+  const uint32_t frames = 20000;
+  PtyRun run = run_pty_stream(frames, 2048, false, 200);
+
+  TEST_ASSERT_TRUE(run.dropped > 0);
+  TEST_ASSERT_EQUAL_UINT32(0, run.rejected);
+  TEST_ASSERT_EQUAL_UINT32(frames - run.dropped, run.seqs.size());
+
+  uint32_t gaps = 0;
+  for (size_t i = 1; i < run.seqs.size(); i++) {
+    TEST_ASSERT_TRUE(run.seqs[i] > run.seqs[i - 1]);
+    gaps += run.seqs[i] - run.seqs[i - 1] - 1;
+  }
+  gaps += run.seqs.empty() ? frames : frames - 1 - run.seqs.back() + run.seqs.front();
+  TEST_ASSERT_EQUAL_UINT32(run.dropped, gaps);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_roundtrip_all_lengths);
+  RUN_TEST(test_resync_after_text_and_corruption);
+  RUN_TEST(test_ring_keeps_frames_whole);
+  RUN_TEST(test_pty_sustained_throughput);
+  RUN_TEST(test_pty_overload_drops_without_blocking);
+  return UNITY_END();
+}
@@ -0,0 +1,133 @@
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "temp_format.hpp"
+#include "../micro_bench.h"
+
+// Host tests and micro-benchmarks for the fixed-point temperature formatting used by
+// every label update, against the snprintf calls it replaced.
+
+#define BENCH_CALLS 100000
+
+static const float bench_samples[] = {-12.4f, 0.0f, 21.6f, 36.9f, 99.5f, 250.2f, 379.9f, -0.3f};
+#define BENCH_SAMPLE_MASK 7
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_to_fixed_rounding(void) {
+  TEST_ASSERT_EQUAL_INT32(25, temp_to_fixed(25.4f, 0));
+  TEST_ASSERT_EQUAL_INT32(26, temp_to_fixed(25.5f, 0));
+  TEST_ASSERT_EQUAL_INT32(-26, temp_to_fixed(-25.5f, 0));   // Half away from zero
+  TEST_ASSERT_EQUAL_INT32(0, temp_to_fixed(-0.3f, 0));
+  TEST_ASSERT_EQUAL_INT32(369, temp_to_fixed(36.9f, 1));
+  TEST_ASSERT_EQUAL_INT32(-1235, temp_to_fixed(-1.2349f, 3));
+  TEST_ASSERT_EQUAL_INT32(temp_to_fixed(1.23456f, 3), temp_to_fixed(1.23456f, 9));  // Decimals capped
+
+  TEST_ASSERT_EQUAL_INT32(0, temp_to_fixed(NAN, 1));
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, temp_to_fixed(3e9f, 0));
+  TEST_ASSERT_EQUAL_INT32(-INT32_MAX, temp_to_fixed(-3e9f, 0));
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, temp_to_fixed(INFINITY, 1));
+}
+
+void test_format_cases(void) {
+  char buf[32];
+  const TempFormat whole = {0, false, "C"};
+  const TempFormat tenths = {1, false, " C"};
+  const TempFormat signed_tenths = {1, true, NULL};
+  const TempFormat thousandths = {3, false, NULL};
+
+  TEST_ASSERT_EQUAL(3, temp_format(buf, sizeof(buf), NULL, 25.4f, whole));
+  TEST_ASSERT_EQUAL_STRING("25C", buf);
+  temp_format(buf, sizeof(buf), "Ambient: ", -3.6f, whole);
+  TEST_ASSERT_EQUAL_STRING("Ambient: -4C", buf);
+  temp_format(buf, sizeof(buf), NULL, -0.3f, whole);
+  TEST_ASSERT_EQUAL_STRING("0C", buf);                      // Never "-0"
+  temp_format(buf, sizeof(buf), NULL, 0.04f, tenths);
+  TEST_ASSERT_EQUAL_STRING("0.0 C", buf);
+  temp_format(buf, sizeof(buf), NULL, -0.06f, tenths);
+  TEST_ASSERT_EQUAL_STRING("-0.1 C", buf);
+  temp_format(buf, sizeof(buf), "sd ", 0.25f, signed_tenths);
+  TEST_ASSERT_EQUAL_STRING("sd +0.3", buf);
+  temp_format(buf, sizeof(buf), NULL, 0.0f, signed_tenths);
+  TEST_ASSERT_EQUAL_STRING("0.0", buf);                     // No "+" on zero
+  temp_format_fixed(buf, sizeof(buf), NULL, 5, thousandths);
+  TEST_ASSERT_EQUAL_STRING("0.005", buf);
+  temp_format_fixed(buf, sizeof(buf), NULL, -INT32_MAX, whole);
+  TEST_ASSERT_EQUAL_STRING("-2147483647C", buf);
+}
+
+// A failed sensor read shows a placeholder, never a plausible "0C"
+void test_format_nan_placeholder(void) {
+  char buf[32];
+  const TempFormat whole = {0, false, "C"};
+  const TempFormat tenths = {1, true, " C"};
+
+  TEST_ASSERT_EQUAL(3, temp_format(buf, sizeof(buf), NULL, NAN, whole));
+  TEST_ASSERT_EQUAL_STRING("--C", buf);
+  temp_format(buf, sizeof(buf), "Ambient: ", -NAN, tenths);
+  TEST_ASSERT_EQUAL_STRING("Ambient: -- C", buf);
+  TEST_ASSERT_EQUAL(4, temp_format(buf, 5, "Obj ", NAN, whole));
+  TEST_ASSERT_EQUAL_STRING("Obj ", buf);
+}
+
+void test_format_truncates(void) {
+  char buf[8];
+  const TempFormat fmt = {1, false, " C"};
+  memset(buf, 'x', sizeof(buf));
+  TEST_ASSERT_EQUAL(7, temp_format(buf, sizeof(buf), "Obj ", 123.4f, fmt));
+  TEST_ASSERT_EQUAL_STRING("Obj 123", buf);
+  TEST_ASSERT_EQUAL(0, temp_format(buf, 1, "Obj ", 1.0f, fmt));
+  TEST_ASSERT_EQUAL_STRING("", buf);
+  TEST_ASSERT_EQUAL(0, temp_format(NULL, 16, NULL, 1.0f, fmt));
+}
+
+// Every fixed-point value prints the same digits as printf does for the exact decimal
+void test_format_matches_printf(void) {
+  char ours[32], ref[32];
+  for (uint8_t decimals = 0; decimals <= TEMP_FORMAT_MAX_DECIMALS; decimals++) {
+    const TempFormat fmt = {decimals, false, NULL};
+    double scale = pow(10.0, decimals);
+    for (int32_t fixed = -50000; fixed <= 50000; fixed += 7) {
+      temp_format_fixed(ours, sizeof(ours), NULL, fixed, fmt);
+      snprintf(ref, sizeof(ref), "%.*f", decimals, fixed / scale);
+      if (fixed < 0 && strcmp(ref, "-0") == 0) strcpy(ref, "0");
+      TEST_ASSERT_EQUAL_STRING(ref, ours);
+    }
+  }
+}
+
+void test_bench_format(void) {
+  micro_bench_check("temp_format_whole", micro_bench_ns(BENCH_CALLS, [](uint32_t i) {
+    char buf[32];
+    const TempFormat fmt = {0, false, "C"};
+    micro_bench_sink += temp_format(buf, sizeof(buf), NULL, bench_samples[i & BENCH_SAMPLE_MASK], fmt);
+  }), BASELINE_TEMP_FORMAT_WHOLE_NS);
+
+  micro_bench_check("temp_format_tenths", micro_bench_ns(BENCH_CALLS, [](uint32_t i) {
+    char buf[32];
+    const TempFormat fmt = {1, true, " C"};
+    micro_bench_sink += temp_format(buf, sizeof(buf), "Ambient: ", bench_samples[i & BENCH_SAMPLE_MASK], fmt);
+  }), BASELINE_TEMP_FORMAT_TENTHS_NS);
+
+  // What the labels used before, for comparison
+  micro_bench_check("snprintf_whole", micro_bench_ns(BENCH_CALLS, [](uint32_t i) {
+    char buf[32];
+    micro_bench_sink += snprintf(buf, sizeof(buf), "%.0fC", bench_samples[i & BENCH_SAMPLE_MASK]);
+  }), BASELINE_SNPRINTF_WHOLE_NS);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_to_fixed_rounding);
+  RUN_TEST(test_format_cases);
+  RUN_TEST(test_format_nan_placeholder);
+  RUN_TEST(test_format_truncates);
+  RUN_TEST(test_format_matches_printf);
+  RUN_TEST(test_bench_format);
+  return UNITY_END();
+}
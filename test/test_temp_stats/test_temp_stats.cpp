@@ -0,0 +1,152 @@
+
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include "temp_stats.hpp"
+#include "../micro_bench.h"
+
+// Host tests and micro-benchmarks for the statistics filters behind the stability
+// indicator, the MIN/AVG/MAX hold and the alert level: the incremental windows are
+// checked against a brute-force recomputation over the same samples.
+
+#define BENCH_CALLS 100000
+#define STREAM_SAMPLES 5000
+
+static const uint16_t window_lengths[TEMP_STATS_WINDOWS] = {8, 60};
+
+// Sensor-like stream: slow swing, noise, a step and some repeated values
+static float stream_value(uint32_t i) {
+  float value = 30.0f + 10.0f * sinf(i * 0.02f) + ((rand() % 200) - 100) * 0.002f;
+  if (i >= 2000 && i < 2500) value += 150.0f;
+  if (i >= 3000 && i < 3100) value = 42.0f;
+  return value;
+}
+
+static void brute_force(const std::vector<float> &values, size_t length, TempStatsSummary *out) {
+  size_t n = values.size() < length ? values.size() : length;
+  double sum = 0;
+  float min = values.back(), max = values.back();
+  for (size_t i = values.size() - n; i < values.size(); i++) {
+    sum += values[i];
+    if (values[i] < min) min = values[i];
+    if (values[i] > max) max = values[i];
+  }
+  double mean = sum / n;
+  double m2 = 0;
+  for (size_t i = values.size() - n; i < values.size(); i++) m2 += (values[i] - mean) * (values[i] - mean);
+  out->count = n;
+  out->min = min;
+  out->max = max;
+  out->mean = (float)mean;
+  out->stddev = (float)sqrt(m2 / n);
+}
+
+void setUp(void) {
+  srand(7);
+}
+
+void tearDown(void) {}
+
+void test_windows_match_brute_force(void) {
+  static TempStats stats;
+  temp_stats_init(&stats, window_lengths);
+  std::vector<float> values;
+
+  for (uint32_t i = 0; i < STREAM_SAMPLES; i++) {
+    float value = stream_value(i);
+    values.push_back(value);
+    temp_stats_add(&stats, value);
+
+    for (int w = 0; w < TEMP_STATS_WINDOWS; w++) {
+      TempStatsSummary got, want;
+      temp_stats_window(&stats, w, &got);
+      brute_force(values, window_lengths[w], &want);
+      TEST_ASSERT_EQUAL_UINT32(want.count, got.count);
+      TEST_ASSERT_EQUAL_FLOAT(want.min, got.min);
+      TEST_ASSERT_EQUAL_FLOAT(want.max, got.max);
+      TEST_ASSERT_FLOAT_WITHIN(0.01f, want.mean, got.mean);
+      TEST_ASSERT_FLOAT_WITHIN(0.01f + want.stddev * 0.01f, want.stddev, got.stddev);
+    }
+  }
+
+  // The session covers everything since init
+  TempStatsSummary session, want;
+  temp_stats_session(&stats, &session);
+  brute_force(values, values.size(), &want);
+  TEST_ASSERT_EQUAL_UINT32(STREAM_SAMPLES, session.count);
+  TEST_ASSERT_EQUAL_FLOAT(want.min, session.min);
+  TEST_ASSERT_EQUAL_FLOAT(want.max, session.max);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, want.mean, session.mean);
+  TEST_ASSERT_FLOAT_WITHIN(0.05f, want.stddev, session.stddev);
+}
+
+// A flat signal reads as exactly zero spread (drives the "Stable" indicator)
+void test_flat_signal_is_stable(void) {
+  static TempStats stats;
+  temp_stats_init(&stats, window_lengths);
+  for (int i = 0; i < 500; i++) temp_stats_add(&stats, 36.6f + (i < 100 ? (i % 7) * 0.3f : 0.0f));
+
+  TempStatsSummary fast;
+  temp_stats_window(&stats, TEMP_STATS_FAST, &fast);
+  TEST_ASSERT_EQUAL_FLOAT(36.6f, fast.mean);
+  TEST_ASSERT_TRUE(fast.stddev < 1e-3f);
+  TEST_ASSERT_EQUAL_FLOAT(36.6f, fast.min);
+  TEST_ASSERT_EQUAL_FLOAT(36.6f, fast.max);
+}
+
+void test_nan_and_reset(void) {
+  static TempStats stats;
+  temp_stats_init(&stats, window_lengths);
+  temp_stats_add(&stats, 20.0f);
+  temp_stats_add(&stats, NAN);
+  temp_stats_add(&stats, 22.0f);
+
+  TempStatsSummary summary;
+  temp_stats_session(&stats, &summary);
+  TEST_ASSERT_EQUAL_UINT32(2, summary.count);
+  TEST_ASSERT_EQUAL_FLOAT(21.0f, summary.mean);
+  temp_stats_window(&stats, TEMP_STATS_FAST, &summary);
+  TEST_ASSERT_EQUAL_UINT32(2, summary.count);
+
+  temp_stats_reset(&stats);
+  temp_stats_session(&stats, &summary);
+  TEST_ASSERT_EQUAL_UINT32(0, summary.count);
+  temp_stats_window(&stats, TEMP_STATS_SLOW, &summary);
+  TEST_ASSERT_EQUAL_UINT32(0, summary.count);
+  TEST_ASSERT_EQUAL_UINT16(60, stats.windows[TEMP_STATS_SLOW].length);
+
+  // Out-of-range window lengths are clamped
+  const uint16_t bad_lengths[TEMP_STATS_WINDOWS] = {0, 1000};
+  temp_stats_init(&stats, bad_lengths);
+  TEST_ASSERT_EQUAL_UINT16(1, stats.windows[0].length);
+  TEST_ASSERT_EQUAL_UINT16(TEMP_STATS_WINDOW_CAPACITY, stats.windows[1].length);
+}
+
+void test_bench_temp_stats(void) {
+  static TempStats stats;
+  temp_stats_init(&stats, window_lengths);
+  static float samples[1024];
+  for (int i = 0; i < 1024; i++) samples[i] = stream_value(i);
+
+  micro_bench_check("temp_stats_add", micro_bench_ns(BENCH_CALLS, [](uint32_t i) {
+    temp_stats_add(&stats, samples[i & 1023]);
+  }), BASELINE_TEMP_STATS_ADD_NS);
+
+  micro_bench_check("temp_stats_window", micro_bench_ns(BENCH_CALLS, [](uint32_t i) {
+    TempStatsSummary summary;
+    temp_stats_window(&stats, i & 1, &summary);
+    micro_bench_sink += summary.count;
+  }), BASELINE_TEMP_STATS_WINDOW_NS);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_windows_match_brute_force);
+  RUN_TEST(test_flat_signal_is_stable);
+  RUN_TEST(test_nan_and_reset);
+  RUN_TEST(test_bench_temp_stats);
+  return UNITY_END();
+}
@@ -0,0 +1,118 @@
+
+#include <unity.h>
+#include <math.h>
+#include "trend_history.hpp"
+
+// Host tests for the trend chart history: column periods against the sample rate,
+// jitter and real sampling gaps, and the cascade into the coarser levels.
+
+// main.cpp's spans: 1 min / 10 min / 1 h over TREND_COLUMNS columns
+static const uint32_t periods_ms[TREND_LEVELS] = {
+  60000 / TREND_COLUMNS, 600000 / TREND_COLUMNS, 3600000 / TREND_COLUMNS
+};
+
+static TrendHistory history;
+
+static uint32_t empty_columns(const TrendLevel *level) {
+  uint32_t empty = 0;
+  for (uint16_t age = 0; age < level->count; age++) {
+    if (trend_history_column(level, age)->min == TREND_NO_DATA) empty++;
+  }
+  return empty;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_default_rate_fills_every_column(void) {
+  // Default update_rate: 1 Hz, with a few ms of scheduling jitter either way
+  trend_history_init(&history, periods_ms, 1000);
+  TEST_ASSERT_EQUAL_UINT32(1000, history.levels[0].period_ms);
+
+  uint32_t jitter[] = {0, 3, 997, 1, 999, 2, 0, 998};
+  for (uint32_t i = 0; i < 300; i++) {
+    trend_history_add(&history, 5000 + i * 1000 + jitter[i % 8], 25.0f + (i % 10));
+  }
+
+  const TrendLevel *level = &history.levels[0];
+  TEST_ASSERT_EQUAL_UINT16(TREND_COLUMNS, level->count);
+  TEST_ASSERT_EQUAL_UINT32(0, empty_columns(level));
+}
+
+void test_fast_rate_keeps_base_period(void) {
+  trend_history_init(&history, periods_ms, 250);
+  TEST_ASSERT_EQUAL_UINT32(500, history.levels[0].period_ms);
+
+  for (uint32_t i = 0; i < 400; i++) trend_history_add(&history, i * 250, 20.0f);
+  TEST_ASSERT_EQUAL_UINT32(0, empty_columns(&history.levels[0]));
+}
+
+void test_odd_rate_uses_divisor_of_next_level(void) {
+  // 1.1 s rounds up to 1.25 s, which still divides the 5 s level 1 columns
+  trend_history_init(&history, periods_ms, 1100);
+  TEST_ASSERT_EQUAL_UINT32(1250, history.levels[0].period_ms);
+
+  trend_history_init(&history, periods_ms, 20000);
+  TEST_ASSERT_EQUAL_UINT32(5000, history.levels[0].period_ms);
+}
+
+void test_sampling_pause_leaves_gap(void) {
+  trend_history_init(&history, periods_ms, 1000);
+  for (uint32_t i = 0; i < 20; i++) trend_history_add(&history, i * 1000, 30.0f);
+  // Sensor silent for 10 s, then back
+  for (uint32_t i = 30; i < 40; i++) trend_history_add(&history, i * 1000, 31.0f);
+
+  TEST_ASSERT_EQUAL_UINT32(10, empty_columns(&history.levels[0]));
+  const TrendBucket *newest = trend_history_column(&history.levels[0], 0);
+  TEST_ASSERT_EQUAL_INT16(310, newest->last);
+}
+
+void test_nan_is_ignored(void) {
+  trend_history_init(&history, periods_ms, 1000);
+  trend_history_add(&history, 0, 30.0f);
+  trend_history_add(&history, 1000, NAN);
+  trend_history_add(&history, 2000, 32.0f);
+  trend_history_add(&history, 3000, 33.0f);
+
+  // The failed read is a missing sample, so its column is a gap
+  const TrendLevel *level = &history.levels[0];
+  TEST_ASSERT_EQUAL_UINT16(3, level->count);
+  TEST_ASSERT_EQUAL_INT16(320, trend_history_column(level, 0)->last);
+  TEST_ASSERT_EQUAL_INT16(TREND_NO_DATA, trend_history_column(level, 1)->min);
+  TEST_ASSERT_EQUAL_INT16(300, trend_history_column(level, 2)->last);
+}
+
+void test_levels_cascade_min_max(void) {
+  trend_history_init(&history, periods_ms, 1000);
+  // Two level 1 columns of 5 s: a ramp 10..14 then a dip to -5. The last two samples
+  // close level 0's bucket at 10 s, which closes the second level 1 column
+  float values[] = {10, 11, 12, 13, 14, 0, -5, 2, 3, 4, 7, 8};
+  for (uint32_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    trend_history_add(&history, i * 1000, values[i]);
+  }
+
+  const TrendLevel *level = &history.levels[1];
+  TEST_ASSERT_EQUAL_UINT16(2, level->count);
+  const TrendBucket *older = trend_history_column(level, 1);
+  const TrendBucket *newer = trend_history_column(level, 0);
+  TEST_ASSERT_EQUAL_INT16(100, older->min);
+  TEST_ASSERT_EQUAL_INT16(140, older->max);
+  TEST_ASSERT_EQUAL_INT16(140, older->last);
+  TEST_ASSERT_EQUAL_INT16(-50, newer->min);
+  TEST_ASSERT_EQUAL_INT16(40, newer->max);
+  TEST_ASSERT_EQUAL_INT16(40, newer->last);
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_default_rate_fills_every_column);
+  RUN_TEST(test_fast_rate_keeps_base_period);
+  RUN_TEST(test_odd_rate_uses_divisor_of_next_level);
+  RUN_TEST(test_sampling_pause_leaves_gap);
+  RUN_TEST(test_nan_is_ignored);
+  RUN_TEST(test_levels_cascade_min_max);
+  return UNITY_END();
+}
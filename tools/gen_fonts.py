@@ -0,0 +1,173 @@
+# PlatformIO pre-build script: generate glyph-subset UI fonts
+#
+# Scans the sources in src/ and lib/ for the string literals that can be shown on
+# screen (everything but comments, #include lines and the literals passed to serial
+# and log calls) and runs
+# lv_font_conv (npm i -g lv_font_conv) to build Montserrat subsets containing only
+# those glyphs, plus a large digit-only font for the main temperature reading.
+# Output goes to src/fonts/ and is regenerated only when the glyph set changes.
+#
+# Project options (platformio.ini):
+#   custom_subset_fonts = yes|no   use the generated fonts (default yes)
+#   custom_font_compress = yes|no  emit compressed bitmaps, needs LV_USE_FONT_COMPRESSED
+#
+# When lv_font_conv is missing and no fonts were generated before, or a conversion
+# fails, the build falls back to LVGL's built-in Montserrat fonts.
+
+Import("env")
+
+import glob
+import hashlib
+import os
+import re
+import shutil
+import subprocess
+
+PROJECT_DIR = env.subst("$PROJECT_DIR")
+SRC_DIR = os.path.join(PROJECT_DIR, "src")
+LIB_DIR = os.path.join(PROJECT_DIR, "lib")
+OUT_DIR = os.path.join(SRC_DIR, "fonts")
+STAMP = os.path.join(OUT_DIR, ".glyphs")
+
+TEXT_SIZES = [12, 14, 16, 18, 20, 24]
+DIGIT_SIZE = 40
+DIGIT_GLYPHS = "0123456789-+.CF"
+ALWAYS_GLYPHS = " 0123456789-+.:%CF"
+BPP = 4
+
+SOURCE_PATTERNS = ["*.cpp", "*.hpp", "*.h"]
+# Console-only code: the host build's entry point and its Arduino/FreeRTOS stand-ins
+SKIP_FILES = {"host_main.cpp"}
+SKIP_DIRS = {OUT_DIR, os.path.join(LIB_DIR, "host_platform")}
+
+# One token per match, in priority order: comments, string and character literals,
+# #include lines, the opening of a serial/log call, and plain parentheses
+TOKEN_RE = re.compile(r"""
+    (?P<comment>//[^\n]*|/\*.*?\*/)
+  | "(?P<string>(?:[^"\\\n]|\\.)*)"
+  | '(?:[^'\\\n]|\\.)*'
+  | (?P<include>^[ \t]*\#[ \t]*include[^\n]*)
+  | (?P<log>\b(?:Serial\.\w+|DLOG_[EWID]|log_[ewidv]|ESP_LOG[EWIDV]|f?printf)\s*\()
+  | (?P<open>\()
+  | (?P<close>\))
+""", re.S | re.M | re.X)
+
+
+def option(name, default):
+    return env.GetProjectOption(name, default).strip().lower() in ("1", "yes", "true", "on")
+
+
+def source_files():
+    for root in (SRC_DIR, LIB_DIR):
+        for pattern in SOURCE_PATTERNS:
+            for path in glob.glob(os.path.join(root, "**", pattern), recursive=True):
+                if os.path.basename(path) in SKIP_FILES:
+                    continue
+                if any(path.startswith(skip + os.sep) for skip in SKIP_DIRS):
+                    continue
+                yield path
+
+
+def screen_literals(source):
+    """String literals of source outside comments and serial/log call arguments"""
+    depth = 0
+    log_depth = None  # Parenthesis depth of the serial/log call being skipped
+    for match in TOKEN_RE.finditer(source):
+        kind = match.lastgroup
+        if kind == "string":
+            if log_depth is None:
+                yield match.group("string")
+        elif kind in ("log", "open"):
+            depth += 1
+            if kind == "log" and log_depth is None:
+                log_depth = depth
+        elif kind == "close":
+            if log_depth == depth:
+                log_depth = None
+            depth = max(depth - 1, 0)
+
+
+def collect_glyphs():
+    glyphs = set(ALWAYS_GLYPHS)
+    for path in source_files():
+        with open(path, encoding="utf-8") as f:
+            source = f.read()
+        for literal in screen_literals(source):
+            text = literal.replace("\\n", "").replace("\\t", "")
+            glyphs.update(ch for ch in text if ord(ch) >= 0x20)
+    return "".join(sorted(glyphs))
+
+
+def find_ttf():
+    pattern = os.path.join(PROJECT_DIR, ".pio", "libdeps", "*", "lvgl", "scripts", "built_in_font", "Montserrat-Medium.ttf")
+    matches = glob.glob(pattern)
+    return matches[0] if matches else None
+
+
+def find_converter():
+    if shutil.which("lv_font_conv"):
+        return ["lv_font_conv"]
+    if shutil.which("npx"):
+        return ["npx", "--no-install", "lv_font_conv"]
+    return None
+
+
+def convert(converter, ttf, size, symbols, name, compress):
+    cmd = converter + [
+        "--font", ttf, "--size", str(size), "--bpp", str(BPP),
+        "--format", "lvgl", "--lv-include", "lvgl.h",
+        "--lv-font-name", name, "--symbols", symbols,
+        "-o", os.path.join(OUT_DIR, name + ".c"),
+    ]
+    if not compress:
+        cmd.append("--no-compress")
+    subprocess.check_call(cmd)
+
+
+def fonts_present():
+    names = ["ncir_font_%d" % size for size in TEXT_SIZES] + ["ncir_font_digits_%d" % DIGIT_SIZE]
+    return all(os.path.isfile(os.path.join(OUT_DIR, name + ".c")) for name in names)
+
+
+def generate():
+    compress = option("custom_font_compress", "no")
+    glyphs = collect_glyphs()
+    stamp = hashlib.sha1(("%s|%d|%d" % (glyphs, BPP, compress)).encode("utf-8")).hexdigest()
+
+    if fonts_present() and os.path.isfile(STAMP) and open(STAMP).read().strip() == stamp:
+        return True
+
+    converter = find_converter()
+    ttf = find_ttf()
+    if not converter or not ttf:
+        if fonts_present():
+            print("gen_fonts: lv_font_conv unavailable, keeping previously generated fonts")
+            return True
+        print("gen_fonts: lv_font_conv or Montserrat TTF not found, using built-in Montserrat fonts")
+        return False
+
+    os.makedirs(OUT_DIR, exist_ok=True)
+    print("gen_fonts: %d glyphs: %s" % (len(glyphs), glyphs))
+    try:
+        for size in TEXT_SIZES:
+            convert(converter, ttf, size, glyphs, "ncir_font_%d" % size, compress)
+        convert(converter, ttf, DIGIT_SIZE, DIGIT_GLYPHS, "ncir_font_digits_%d" % DIGIT_SIZE, compress)
+    except (OSError, subprocess.CalledProcessError):
+        # e.g. npx is installed but lv_font_conv is not; the stamp stays stale so the
+        # next build tries again
+        for path in glob.glob(os.path.join(OUT_DIR, "*.c")):
+            os.remove(path)
+        print("gen_fonts: lv_font_conv failed, using built-in Montserrat fonts")
+        return False
+
+    with open(STAMP, "w") as f:
+        f.write(stamp + "\n")
+    for path in sorted(glob.glob(os.path.join(OUT_DIR, "*.c"))):
+        print("gen_fonts: %-28s %7d bytes of source" % (os.path.basename(path), os.path.getsize(path)))
+    return True
+
+
+if option("custom_subset_fonts", "yes") and generate():
+    env.Append(CPPDEFINES=["NCIR_USE_SUBSET_FONTS"])
+    if option("custom_font_compress", "no"):
+        env.Append(CPPDEFINES=["NCIR_FONT_COMPRESSED"])
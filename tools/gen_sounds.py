@@ -0,0 +1,93 @@
+# PlatformIO pre-build script: synthesize the alert sound clips
+#
+# Renders the alert sounds (two-tone alarms, chirps and the pips used for the
+# temperature readout) as 8-bit unsigned PCM tables so they can be streamed straight
+# from flash with M5.Speaker.playRaw(). Output goes to src/sounds/ and is regenerated
+# only when the clip definitions below change.
+
+Import("env")
+
+import hashlib
+import math
+import os
+
+PROJECT_DIR = env.subst("$PROJECT_DIR")
+OUT_DIR = os.path.join(PROJECT_DIR, "src", "sounds")
+STAMP = os.path.join(OUT_DIR, ".clips")
+
+SAMPLE_RATE = 8000
+AMPLITUDE = 110   # Peak deviation from the 128 midpoint
+FADE_MS = 5       # Raised-cosine attack/release against clicks
+
+# name: list of segments (start_hz, end_hz, ms); 0 Hz is silence
+CLIPS = [
+    ("low", [(800, 800, 220), (0, 0, 80), (600, 600, 220), (0, 0, 80)]),
+    ("high", [(1200, 1200, 100), (1600, 1600, 100), (1200, 1200, 100), (1600, 1600, 100), (0, 0, 80)]),
+    ("chirp_up", [(600, 2000, 300), (0, 0, 60)]),
+    ("chirp_down", [(2000, 600, 300), (0, 0, 60)]),
+    ("pip", [(1500, 1500, 60), (0, 0, 90)]),
+    ("zero", [(700, 700, 250), (0, 0, 100)]),
+    ("minus", [(400, 400, 150), (0, 0, 100)]),
+]
+
+
+def render_segment(start_hz, end_hz, ms):
+    count = SAMPLE_RATE * ms // 1000
+    if start_hz == 0:
+        return [128] * count
+
+    fade = SAMPLE_RATE * FADE_MS // 1000
+    samples = []
+    phase = 0.0
+    for i in range(count):
+        # Exponential sweep sounds even across the octaves
+        hz = start_hz * (end_hz / float(start_hz)) ** (i / float(count))
+        phase += 2 * math.pi * hz / SAMPLE_RATE
+        # A little third harmonic carries better on the small speaker
+        value = 0.8 * math.sin(phase) + 0.2 * math.sin(3 * phase)
+        edge = min(i, count - 1 - i)
+        if edge < fade:
+            value *= 0.5 - 0.5 * math.cos(math.pi * edge / fade)
+        samples.append(128 + int(round(AMPLITUDE * value)))
+    return samples
+
+
+def write_sources():
+    os.makedirs(OUT_DIR, exist_ok=True)
+    total = 0
+    with open(os.path.join(OUT_DIR, "alert_sounds.cpp"), "w") as f:
+        f.write("// Generated by tools/gen_sounds.py - do not edit\n\n")
+        f.write('#include "alert_sounds.h"\n\n')
+        for name, segments in CLIPS:
+            samples = []
+            for segment in segments:
+                samples += render_segment(*segment)
+            total += len(samples)
+            f.write("static const uint8_t clip_%s[%d] = {\n" % (name, len(samples)))
+            for i in range(0, len(samples), 20):
+                f.write("  " + ", ".join("%d" % s for s in samples[i:i + 20]) + ",\n")
+            f.write("};\n\n")
+        f.write("const SoundClip alert_sound_clips[ALERT_CLIP_COUNT] = {\n")
+        for name, _ in CLIPS:
+            f.write("  {clip_%s, sizeof(clip_%s)},\n" % (name, name))
+        f.write("};\n")
+
+    with open(os.path.join(OUT_DIR, "alert_sounds.h"), "w") as f:
+        f.write("// Generated by tools/gen_sounds.py - do not edit\n")
+        f.write("#ifndef __ALERT_SOUNDS_H__\n#define __ALERT_SOUNDS_H__\n\n")
+        f.write('#include "sound_player.hpp"\n\n')
+        f.write("#define ALERT_SOUND_RATE %d\n\n" % SAMPLE_RATE)
+        f.write("enum AlertSoundClip {\n")
+        for name, _ in CLIPS:
+            f.write("  ALERT_CLIP_%s,\n" % name.upper())
+        f.write("  ALERT_CLIP_COUNT\n};\n\n")
+        f.write("extern const SoundClip alert_sound_clips[ALERT_CLIP_COUNT];\n\n")
+        f.write("#endif  // __ALERT_SOUNDS_H__\n")
+    print("gen_sounds: %d clips, %d bytes of PCM" % (len(CLIPS), total))
+
+
+stamp = hashlib.sha1(repr((SAMPLE_RATE, AMPLITUDE, FADE_MS, CLIPS)).encode("utf-8")).hexdigest()
+if not (os.path.isfile(STAMP) and open(STAMP).read().strip() == stamp):
+    write_sources()
+    with open(STAMP, "w") as f:
+        f.write(stamp + "\n")
@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+# Host decoder for the binary telemetry stream (see lib/telemetry/telemetry_frame.hpp)
+# of a telemetry build (pio run -e m5stack-cores3-telemetry -t upload)
+#
+# Reads a serial port, a capture file or stdin, splits the stream at 0x00 delimiters,
+# COBS-decodes and CRC-checks each frame and prints the records. Debug text printed on
+# the same port is passed through, so this replaces `pio device monitor`:
+#
+#   tools/telemetry_decode.py /dev/ttyACM0            # records and debug text
+#   tools/telemetry_decode.py /dev/ttyACM0 --csv      # one CSV line per record
+#   tools/telemetry_decode.py /dev/ttyACM0 --stats    # throughput and loss per second
+#   tools/telemetry_decode.py capture.bin --raw-out copy.bin
+#   tools/telemetry_decode.py /dev/ttyACM0 --trace run.trc   # sensor/button trace for replay
+#
+# Only the standard library is needed; pyserial is used when installed.
+
+import argparse
+import os
+import struct
+import sys
+import time
+
+TELEMETRY_SAMPLE = 1
+TELEMETRY_ALERT = 2
+TELEMETRY_PROFILE = 3
+TELEMETRY_STATUS = 4
+TELEMETRY_BUTTON = 5
+TELEMETRY_MEMORY = 6
+TELEMETRY_STACK = 7
+
+# TelemetryProfileId in src/main.cpp
+PROFILE_NAMES = ["lvgl_handler", "sensor_read", "screen_build"]
+# AlertRuleKind in lib/alert_rules/alert_rules.hpp
+ALERT_KINDS = ["none", "above", "below", "rise_rate", "fall_rate"]
+
+RECORDS = {
+    TELEMETRY_SAMPLE: ("sample", struct.Struct("<Iff"), ("timestamp_ms", "object_c", "ambient_c")),
+    TELEMETRY_ALERT: ("alert", struct.Struct("<IBBBxfff"),
+                      ("timestamp_ms", "rule", "kind", "active", "object_c", "rate_c_per_s", "threshold_c")),
+    TELEMETRY_PROFILE: ("profile", struct.Struct("<IIB3x"), ("timestamp_ms", "duration_us", "id")),
+    TELEMETRY_STATUS: ("status", struct.Struct("<IIII"), ("timestamp_ms", "frames", "dropped", "bytes")),
+    TELEMETRY_BUTTON: ("button", struct.Struct("<IBB2x"), ("timestamp_ms", "button", "pressed")),
+    TELEMETRY_MEMORY: ("memory", struct.Struct("<12I"),
+                       ("timestamp_ms", "internal_free", "internal_largest", "internal_min_free", "dma_free",
+                        "dma_largest", "psram_free", "psram_largest", "lvgl_used", "lvgl_free", "lvgl_largest",
+                        "warnings")),
+    TELEMETRY_STACK: ("stack", struct.Struct("<III16s"), ("timestamp_ms", "stack_size", "min_free", "name")),
+}
+
+# Trace file (lib/sensor_trace/sensor_trace.hpp)
+TRACE_HEADER = b"NCTR" + struct.pack("<HH", 1, 16)
+TRACE_RECORD = struct.Struct("<IBBBxff")
+TRACE_SAMPLE = 1
+TRACE_BUTTON = 2
+
+
+def trace_record(kind, payload):
+    """Trace record for a sample or button frame, None for other frames"""
+    if kind == TELEMETRY_SAMPLE and len(payload) == RECORDS[kind][1].size:
+        timestamp_ms, object_c, ambient_c = RECORDS[kind][1].unpack(payload)
+        return TRACE_RECORD.pack(timestamp_ms, TRACE_SAMPLE, 0, 0, object_c, ambient_c)
+    if kind == TELEMETRY_BUTTON and len(payload) == RECORDS[kind][1].size:
+        timestamp_ms, button, pressed = RECORDS[kind][1].unpack(payload)
+        return TRACE_RECORD.pack(timestamp_ms, TRACE_BUTTON, button, pressed, 0.0, 0.0)
+    return None
+
+
+def crc16(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_decode(chunk):
+    out = bytearray()
+    i = 0
+    while i < len(chunk):
+        code = chunk[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(chunk):
+            return None
+        out += chunk[i:i + code - 1]
+        i += code - 1
+        if code < 0xFF and i < len(chunk):
+            out.append(0)
+    return bytes(out)
+
+
+def decode_frame(chunk):
+    """Returns (type, seq, payload) or None for anything that is not a valid frame"""
+    raw = cobs_decode(chunk)
+    if raw is None or len(raw) < 5:
+        return None
+    if crc16(raw[:-2]) != struct.unpack_from("<H", raw, len(raw) - 2)[0]:
+        return None
+    return raw[0], struct.unpack_from("<H", raw, 1)[0], raw[3:-2]
+
+
+def parse_record(kind, payload):
+    record = RECORDS.get(kind)
+    if record is None or len(payload) != record[1].size:
+        return None
+    values = dict(zip(record[2], record[1].unpack(payload)))
+    if kind == TELEMETRY_PROFILE and values["id"] < len(PROFILE_NAMES):
+        values["id"] = PROFILE_NAMES[values["id"]]
+    if kind == TELEMETRY_ALERT and values["kind"] < len(ALERT_KINDS):
+        values["kind"] = ALERT_KINDS[values["kind"]]
+    if kind == TELEMETRY_MEMORY:
+        values["warnings"] = "0x%04x" % values["warnings"]
+    if kind == TELEMETRY_STACK:
+        values["name"] = values["name"].rstrip(b"\0").decode("ascii", "replace")
+    return record[0], values
+
+
+def format_value(value):
+    return "%.2f" % value if isinstance(value, float) else str(value)
+
+
+class Stats:
+    def __init__(self):
+        self.frames = 0
+        self.bytes = 0
+        self.lost = 0
+        self.rejected = 0
+        self.device_dropped = 0
+        self.last_seq = None
+        self.window_start = time.monotonic()
+        self.window_frames = 0
+        self.window_bytes = 0
+
+    def frame(self, seq):
+        if self.last_seq is not None:
+            self.lost += (seq - self.last_seq - 1) & 0xFFFF
+        self.last_seq = seq
+        self.frames += 1
+        self.window_frames += 1
+
+    def report(self, force=False):
+        elapsed = time.monotonic() - self.window_start
+        if elapsed < 1.0 and not force:
+            return
+        if elapsed > 0:
+            sys.stderr.write("%.0f frames/s, %.1f KB/s, %d frames, %d lost (%d dropped on device), %d text/noise chunks\n" % (
+                self.window_frames / elapsed, self.window_bytes / elapsed / 1024.0, self.frames, self.lost,
+                self.device_dropped, self.rejected))
+        self.window_start = time.monotonic()
+        self.window_frames = 0
+        self.window_bytes = 0
+
+
+def open_input(path, baud):
+    """Returns (read function, True when an empty read means end of input)"""
+    if path == "-":
+        return getattr(sys.stdin.buffer, "raw", sys.stdin.buffer).read, True
+    if os.path.isfile(path):
+        f = open(path, "rb")
+        return f.read, True
+    try:
+        import serial
+        port = serial.Serial(path, baud, timeout=0.2)
+        return port.read, False
+    except ImportError:
+        import termios
+        import tty
+        fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        speed = getattr(termios, "B%d" % baud, termios.B115200)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+        return (lambda n: os.read(fd, n)), False
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the NCIR monitor telemetry stream")
+    parser.add_argument("input", help="serial port, capture file or - for stdin")
+    parser.add_argument("--baud", type=int, default=115200, help="nominal for USB CDC ports")
+    parser.add_argument("--csv", action="store_true", help="print records as CSV")
+    parser.add_argument("--stats", action="store_true", help="print throughput and loss each second instead of records")
+    parser.add_argument("--no-text", action="store_true", help="hide debug text lines")
+    parser.add_argument("--raw-out", help="also save the raw stream to this file")
+    parser.add_argument("--trace", help="also save sample and button records as a replay trace")
+    args = parser.parse_args()
+
+    read, ends = open_input(args.input, args.baud)
+    raw_out = open(args.raw_out, "wb") if args.raw_out else None
+    trace_out = open(args.trace, "wb") if args.trace else None
+    if trace_out:
+        trace_out.write(TRACE_HEADER)
+    stats = Stats()
+    chunk = bytearray()
+    text = bytearray()
+
+    def emit_text(data, flush=False):
+        text.extend(data)
+        while b"\n" in text or (flush and text):
+            line, _, rest = bytes(text).partition(b"\n")
+            del text[:]
+            text.extend(rest)
+            if not args.no_text and not args.stats:
+                print("# " + line.decode("utf-8", "replace").rstrip("\r"))
+            if flush and not rest:
+                break
+
+    try:
+        while True:
+            data = read(4096)
+            if not data:
+                if ends:
+                    break
+                if args.stats:
+                    stats.report()
+                continue
+            if raw_out:
+                raw_out.write(data)
+            stats.bytes += len(data)
+            stats.window_bytes += len(data)
+
+            for byte in data:
+                if byte:
+                    chunk.append(byte)
+                    continue
+                if not chunk:
+                    continue
+                received = bytes(chunk)
+                del chunk[:]
+                frame = decode_frame(received)
+                if frame is None:
+                    # Debug text (or noise) between telemetry transmissions
+                    stats.rejected += 1
+                    emit_text(received)
+                else:
+                    kind, seq, payload = frame
+                    stats.frame(seq)
+                    if trace_out:
+                        record = trace_record(kind, payload)
+                        if record:
+                            trace_out.write(record)
+                    record = parse_record(kind, payload)
+                    if record and record[0] == "status":
+                        stats.device_dropped = record[1]["dropped"]
+                    if args.stats:
+                        continue
+                    if record is None:
+                        print("unknown,%d,%d,%s" % (kind, seq, payload.hex()))
+                    elif args.csv:
+                        print(",".join([record[0], str(seq)] + [format_value(v) for v in record[1].values()]))
+                    else:
+                        print("%-7s #%-5d %s" % (record[0], seq, " ".join(
+                            "%s=%s" % (k, format_value(v)) for k, v in record[1].items())))
+            if args.stats:
+                stats.report()
+    except KeyboardInterrupt:
+        pass
+    emit_text(chunk, flush=True)
+    if args.stats:
+        stats.report(force=True)
+    if trace_out:
+        trace_out.close()
+    sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()